@@ -64,6 +64,27 @@ inline float3 gamma(float3 color)   { return pow(abs(color), 1.0f / g_gamma); }
 ------------------------------------------------------------------------------*/
 inline float3 unpack(float3 value)  { return value * 2.0f - 1.0f; }
 inline float3 pack(float3 value)    { return value * 0.5f + 0.5f; }
+
+/*------------------------------------------------------------------------------
+    VERTEX UNPACKING
+------------------------------------------------------------------------------*/
+inline float3 octahedral_decode(float2 value)
+{
+    float3 n = float3(value.x, value.y, 1.0f - abs(value.x) - abs(value.y));
+    float t  = saturate(-n.z);
+    n.xy    += n.xy >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+inline Vertex_PosUvNorTan vertex_unpack(Vertex_PosUvNorTan_Packed input)
+{
+    Vertex_PosUvNorTan output;
+    output.position = float4(input.position.xyz * g_object_dequantize_position_scale.xyz + g_object_dequantize_position_offset.xyz, 1.0f);
+    output.uv       = input.uv * g_object_dequantize_uv.xy + g_object_dequantize_uv.zw;
+    output.normal   = octahedral_decode(input.normal);
+    output.tangent  = octahedral_decode(input.tangent);
+    return output;
+}
 inline float2 unpack(float2 value)  { return value * 2.0f - 1.0f; }
 inline float2 pack(float2 value)    { return value * 0.5f + 0.5f; }
 
@@ -79,9 +100,15 @@ inline float3 project(float3 position, matrix transform)
     return projectedCoords.xyz;
 }
 
+// Returns uv in the scene render targets, which the scene only covers [0, g_resolution_scale] of
 inline float2 project_uv(float3 position, matrix transform)
 {
-    return project(position, transform).xy;
+    return project(position, transform).xy * g_resolution_scale;
+}
+
+inline bool is_valid_uv(float2 uv)
+{
+    return all(uv >= 0.0f) && all(uv <= g_resolution_scale);
 }
 
 inline float project_depth(float3 position, matrix transform)
@@ -148,6 +175,54 @@ inline float get_linear_depth(float2 uv)
     return get_linear_depth(depth);
 }
 
+/*------------------------------------------------------------------------------
+    UPSAMPLING
+------------------------------------------------------------------------------*/
+// Depth aware upsampling of an effect rendered at a fraction of the resolution of the depth buffer. The four nearest
+// low resolution texels are weighted by how close their depth is to the pixel's, so that they don't bleed across edges.
+// For data that can't be interpolated (like uvs), nearest returns the texel with the closest depth instead.
+inline float4 upsample_bilateral(Texture2D tex_low, float2 uv, bool nearest = false)
+{
+    float2 size_low, size_full;
+    tex_low.GetDimensions(size_low.x, size_low.y);
+    tex_depth.GetDimensions(size_full.x, size_full.y);
+
+    [branch]
+    if (all(size_low == size_full))
+        return tex_low.SampleLevel(sampler_point_clamp, uv, 0);
+
+    float depth         = get_linear_depth(uv);
+    float2 pos          = uv * size_low - 0.5f;
+    float2 pos_base     = floor(pos);
+    float2 f            = pos - pos_base;
+    float4 result       = 0.0f;
+    float weight_sum    = 0.0f;
+    float weight_max    = 0.0f;
+
+    [unroll]
+    for (uint i = 0; i < 4; i++)
+    {
+        float2 offset       = float2(i % 2, i / 2);
+        float2 uv_sample    = (pos_base + offset + 0.5f) / size_low;
+        float2 bilinear     = lerp(1.0f - f, f, offset);
+        float weight        = bilinear.x * bilinear.y / (0.001f + abs(1.0f - get_linear_depth(uv_sample) / depth));
+        float4 value        = tex_low.SampleLevel(sampler_point_clamp, uv_sample, 0);
+
+        if (nearest)
+        {
+            result      = weight > weight_max ? value : result;
+            weight_max  = max(weight, weight_max);
+        }
+        else
+        {
+            result      += value * weight;
+            weight_sum  += weight;
+        }
+    }
+
+    return nearest ? result : result / max(weight_sum, EPSILON);
+}
+
 /*------------------------------------------------------------------------------
     POSITION
 ------------------------------------------------------------------------------*/
@@ -155,6 +230,7 @@ inline float3 get_position(float z, float2 uv)
 {
     // Reconstruct position from depth
 
+    uv                  /= g_resolution_scale;
     float x             = uv.x * 2.0f - 1.0f;
     float y             = (1.0f - uv.y) * 2.0f - 1.0f;
     float4 pos_clip     = float4(x, y, z, 1.0f);
@@ -53,6 +53,9 @@ cbuffer BufferFrame : register(b0)
 
     float2 g_taa_jitter_offset_previous;
 	float2 g_taa_jitter_offset;
+
+    float2 g_resolution_scale; // render resolution over resolution, the scene occupies [0, g_resolution_scale] of the scene render targets
+    float2 g_frame_padding;
 };
 
 // Medium frequency - Updates multiple times per frame
@@ -85,6 +88,11 @@ cbuffer BufferObject : register(b2)
 	matrix g_object_transform;
 	matrix g_object_wvp_current;
 	matrix g_object_wvp_previous;
+    float4 g_object_dequantize_position_scale;
+    float4 g_object_dequantize_position_offset;
+    float4 g_object_dequantize_uv; // xy: scale, zw: offset
+    uint g_object_material_index; // into the material buffer (bindless only)
+    float3 g_object_padding;
 };
 
 // Updates as many times as there are lights
@@ -97,3 +105,33 @@ cbuffer LightBuffer : register(b3)
 	float4 position;
 	float4 direction;
 };
+
+// Updates once per frame, lights without shadows binned into view space clusters (see Renderer::UpdateClusterBuffers())
+static const uint3 g_cluster_count = uint3(16, 9, 24);
+
+cbuffer BufferClusterLights : register(b4)
+{
+    float4 g_cluster_params; // x: depth slice scale, y: depth slice bias, z: light count
+    float4 g_cluster_light_position_range[256];
+    float4 g_cluster_light_color_intensity[256];
+    float4 g_cluster_light_direction_angle[256]; // angle is zero for point lights
+};
+
+cbuffer BufferClusterGrid : register(b5)
+{
+    uint4 g_cluster_grid[864]; // per cluster, offset (low 16 bits) and count (high 16 bits) into the light indices
+};
+
+cbuffer BufferClusterIndices : register(b6)
+{
+    uint4 g_cluster_light_indices[1024]; // two 16 bit light indices per component
+};
+
+// Updates when materials change, indexed with g_object_material_index (bindless only, see Renderer::UpdateMaterialBuffer())
+cbuffer BufferMaterial : register(b7)
+{
+    float4 g_material_albedo[256];
+    float4 g_material_tiling_offset[256];
+    float4 g_material_properties[256]; // x: roughness, y: metallic, z: normal, w: height
+    uint4 g_material_textures[256]; // indices into the material texture table, two 16 bit indices per component, in material texture slot order
+};
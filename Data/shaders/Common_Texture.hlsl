@@ -20,6 +20,19 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 // Material
+#if BINDLESS
+// All material textures live in a single table, the material buffer holds the indices of each material's textures
+Texture2D tex_material_table[256]       : register (t32);
+#define material_texture(slot)          tex_material_table[(g_material_textures[g_object_material_index][slot / 2] >> ((slot % 2) * 16)) & 0xFFFF]
+#define tex_material_albedo             material_texture(0)
+#define tex_material_roughness          material_texture(1)
+#define tex_material_metallic           material_texture(2)
+#define tex_material_normal             material_texture(3)
+#define tex_material_height             material_texture(4)
+#define tex_material_occlusion          material_texture(5)
+#define tex_material_emission           material_texture(6)
+#define tex_material_mask               material_texture(7)
+#else
 Texture2D tex_material_albedo 	        : register (t0);
 Texture2D tex_material_roughness        : register (t1);
 Texture2D tex_material_metallic         : register (t2);
@@ -28,6 +41,7 @@ Texture2D tex_material_height 	        : register (t4);
 Texture2D tex_material_occlusion        : register (t5);
 Texture2D tex_material_emission         : register (t6);
 Texture2D tex_material_mask 	        : register (t7);
+#endif
 
 // G-buffer
 Texture2D tex_albedo                    : register(t8);
@@ -44,6 +44,15 @@ struct Vertex_PosUvNorTan
     float3 tangent		: TANGENT0;
 };
 
+// Static meshes, see RHI_Vertex_PosTexNorTan_Packed, use vertex_unpack() to get the above
+struct Vertex_PosUvNorTan_Packed
+{
+	float4 position 	: POSITION0;    // unorm, relative to the model's bounds
+    float2 uv 			: TEXCOORD0;    // unorm, relative to the model's uv bounds
+    float2 normal 		: NORMAL0;      // octahedral
+    float2 tangent		: TANGENT0;     // octahedral
+};
+
 struct Vertex_Pos2dUvColor
 {
     float2 position     : POSITION0;
@@ -30,11 +30,11 @@ float4 mainPS(Pixel_PosUv input) : SV_TARGET
     
     // Sample from textures
     float4 sample_material  = tex_material.Sample(sampler_point_clamp, uv);
-    float3 light_volumetric = tex_lightVolumetric.Sample(sampler_point_clamp, uv).rgb;
+    float3 light_volumetric = upsample_bilateral(tex_lightVolumetric, uv).rgb;
     float3 normal           = tex_normal.Sample(sampler_point_clamp, uv).xyz;
     float depth             = tex_depth.Sample(sampler_point_clamp, uv).r;
-    float2 sample_ssr       = tex_ssr.Sample(sampler_point_clamp, uv).xy;
-    float sample_ssao       = tex_ssao.Sample(sampler_point_clamp, uv).r;   
+    float2 sample_ssr       = upsample_bilateral(tex_ssr, uv, true).xy;
+    float sample_ssao       = upsample_bilateral(tex_ssao, uv).r;
     float3 camera_to_pixel  = get_view_direction(depth, uv);
     
     // Volumetric lighting
@@ -75,7 +75,7 @@ float4 mainPS(Pixel_PosUv input) : SV_TARGET
         [branch]
         if (g_ssr_enabled && sample_ssr.x != 0.0f && sample_ssr.y != 0.0f)
         {
-            light_reflection = saturate(tex_frame.Sample(sampler_bilinear_clamp, sample_ssr.xy).rgb * F * light_ambient);
+            light_reflection = saturate(tex_frame.Sample(sampler_bilinear_clamp, sample_ssr.xy / g_resolution_scale).rgb * F * light_ambient);
         }
     
         // Light - Emissive
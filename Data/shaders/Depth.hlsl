@@ -23,8 +23,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Common.hlsl"
 //====================
 
+#ifdef VERTEX_PACKED
+Pixel_PosUv mainVS(Vertex_PosUvNorTan_Packed input_packed)
+{
+    Vertex_PosUvNorTan input = vertex_unpack(input_packed);
+#else
 Pixel_PosUv mainVS(Vertex_PosUv input)
 {
+#endif
 	Pixel_PosUv output;
 
 	input.position.w 	= 1.0f;	
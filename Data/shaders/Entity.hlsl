@@ -31,8 +31,14 @@ struct PixelInputType
     float3 positionWS 	: POSITIONT_WS;
 };
 
+#ifdef VERTEX_PACKED
+PixelInputType mainVS(Vertex_PosUvNorTan_Packed input_packed)
+{
+    Vertex_PosUvNorTan input = vertex_unpack(input_packed);
+#else
 PixelInputType mainVS(Vertex_PosUvNorTan input)
 {
+#endif
     PixelInputType output;
 
     input.position.w = 1.0f;
@@ -71,7 +77,7 @@ float4 mainPS(PixelInputType input) : SV_TARGET
 #ifdef OUTLINE
     float normal_threshold = 0.2f;
 
-    float2 uv               = project(input.positionWS.xyz, g_viewProjectionUnjittered).xy;
+    float2 uv               = project_uv(input.positionWS.xyz, g_viewProjectionUnjittered);
     float scale             = 1.0f;
     float halfScaleFloor    = floor(scale * 0.5f);
     float halfScaleCeil     = ceil(scale * 0.5f);
@@ -24,6 +24,17 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ParallaxMapping.hlsl"
 //=============================
 
+#if BINDLESS
+// Material properties come from the material buffer, the draw only provides the material index
+#define materialAlbedoColor     g_material_albedo[g_object_material_index]
+#define materialTiling          g_material_tiling_offset[g_object_material_index].xy
+#define materialOffset          g_material_tiling_offset[g_object_material_index].zw
+#define materialRoughness       g_material_properties[g_object_material_index].x
+#define materialMetallic        g_material_properties[g_object_material_index].y
+#define materialNormalStrength  g_material_properties[g_object_material_index].z
+#define materialHeight          g_material_properties[g_object_material_index].w
+#endif
+
 struct PixelInputType
 {
     float4 position 			: SV_POSITION;
@@ -42,8 +53,14 @@ struct PixelOutputType
 	float2 velocity	: SV_Target3;
 };
 
+#ifdef VERTEX_PACKED
+PixelInputType mainVS(Vertex_PosUvNorTan_Packed input_packed)
+{
+    Vertex_PosUvNorTan input = vertex_unpack(input_packed);
+#else
 PixelInputType mainVS(Vertex_PosUvNorTan input)
 {
+#endif
     PixelInputType output;
     
     input.position.w 			= 1.0f;		
@@ -116,8 +133,9 @@ PixelOutputType mainPS(PixelInputType input)
 	#endif
 	
 	#if NORMAL_MAP
-		// Get tangent space normal and apply intensity
-		float3 tangent_normal 	= normalize(unpack(tex_material_normal.Sample(sampler_anisotropic_wrap, texCoords).rgb));
+		// Get tangent space normal and apply intensity, z is reconstructed since compressed normal maps (BC5) only store x and y
+		float2 tangent_normal_xy = unpack(tex_material_normal.Sample(sampler_anisotropic_wrap, texCoords).rg);
+		float3 tangent_normal 	= float3(tangent_normal_xy, sqrt(saturate(1.0f - dot(tangent_normal_xy, tangent_normal_xy))));
 		tangent_normal.xy 		*= saturate(normal_intensity);
 		normal 					= normalize(mul(tangent_normal, TBN).xyz); // Transform to world space
 	#endif
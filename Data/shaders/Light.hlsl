@@ -29,45 +29,35 @@ struct PixelOutputType
 {
 	float3 diffuse		: SV_Target0;
 	float3 specular		: SV_Target1;
-	float3 volumetric	: SV_Target2;
 };
 
-PixelOutputType mainPS(Pixel_PosUv input)
+// Reflectance equation, returns the fresnel term
+float3 reflectance(Surface surface, Material material, Light light, inout PixelOutputType light_out)
 {
-	PixelOutputType light_out;
-    light_out.diffuse       = 0.0f;
-	light_out.specular 		= 0.0f;
-    light_out.volumetric    = 0.0f;
+    float3 l		= -light.direction;
+    float3 v        = -surface.camera_to_pixel;
+    float3 h 		= normalize(v + l);
+    float v_dot_h 	= saturate(dot(v, h));
+    float n_dot_v   = saturate(dot(surface.normal, v));
+    float n_dot_l   = saturate(dot(surface.normal, l));
+    float n_dot_h   = saturate(dot(surface.normal, h));
+    float3 radiance	= light.color * light.intensity * n_dot_l;
 
-    // Sample normal
-    float4 normal_sample = tex_normal.Sample(sampler_point_clamp, input.uv);
+    // BRDF components
+    float3 F 			= 0.0f;
+    float3 cDiffuse 	= BRDF_Diffuse(material, n_dot_v, n_dot_l, v_dot_h);	
+    float3 cSpecular 	= BRDF_Specular(material, n_dot_v, n_dot_l, n_dot_h, v_dot_h, F);
 
-    // Fill surface struct
-    Surface surface;
-    surface.uv                      = input.uv;
-    surface.depth                   = tex_depth.Sample(sampler_point_clamp, surface.uv).r;
-    surface.position                = get_position(surface.depth, surface.uv);
-    surface.normal                  = normal_decode(normal_sample.xyz);
-    surface.camera_to_pixel         = normalize(surface.position - g_camera_position.xyz);
-    surface.camera_to_pixel_length  = length(surface.position - g_camera_position.xyz);
+    light_out.diffuse.rgb   += cDiffuse * radiance * energy_conservation(F, material.metallic);
+    light_out.specular.rgb	+= cSpecular * radiance;
 
-    // Create material
-    Material material;
-    {
-        float4 sample_albedo    = tex_albedo.Sample(sampler_point_clamp, input.uv);
-        float4 sample_material  = tex_material.Sample(sampler_point_clamp, input.uv);
-        
-        material.albedo         = sample_albedo.rgb;
-        material.roughness      = sample_material.r;
-        material.metallic       = sample_material.g;
-        material.emissive       = sample_material.b;
-        material.occlusion      = min(normal_sample.a, tex_ssao.Sample(sampler_point_clamp, input.uv).r); // min(occlusion, ssao)
-        material.F0             = lerp(0.04f, material.albedo, material.metallic);
-        material.is_transparent = sample_albedo.a != 1.0f;
-        material.is_sky         = sample_material.a == 0.0f;
-    }
-    
-    // Fill light struct
+    return F;
+}
+
+#if !CLUSTERED
+// Fills the light struct from the light buffer
+Light get_light(Surface surface)
+{
     Light light;
     light.color 	                = color.xyz;
     light.position 	                = position.xyz;
@@ -99,6 +89,105 @@ PixelOutputType mainPS(Pixel_PosUv input)
     light.attenuation   *= saturate(1.0f - light.distance_to_pixel / light.range); light.attenuation *= light.attenuation;
     #endif
     light.intensity     *= light.attenuation;
+
+    return light;
+}
+#endif
+
+#if VOLUMETRIC
+// Volumetric lighting only, it's a pass of its own so that it can run at a fraction of the resolution (see Renderer::Pass_LightVolumetric())
+float4 mainPS(Pixel_PosUv input) : SV_TARGET
+{
+    Surface surface                 = (Surface)0;
+    surface.uv                      = input.uv;
+    surface.depth                   = tex_depth.Sample(sampler_point_clamp, surface.uv).r;
+    surface.position                = get_position(surface.depth, surface.uv);
+    surface.camera_to_pixel         = normalize(surface.position - g_camera_position.xyz);
+    surface.camera_to_pixel_length  = length(surface.position - g_camera_position.xyz);
+
+    Light light = get_light(surface);
+    return float4(VolumetricLighting(surface, light), 1.0f);
+}
+#else
+PixelOutputType mainPS(Pixel_PosUv input)
+{
+	PixelOutputType light_out;
+    light_out.diffuse       = 0.0f;
+	light_out.specular 		= 0.0f;
+
+    // Sample normal
+    float4 normal_sample = tex_normal.Sample(sampler_point_clamp, input.uv);
+
+    // Fill surface struct
+    Surface surface;
+    surface.uv                      = input.uv;
+    surface.depth                   = tex_depth.Sample(sampler_point_clamp, surface.uv).r;
+    surface.position                = get_position(surface.depth, surface.uv);
+    surface.normal                  = normal_decode(normal_sample.xyz);
+    surface.camera_to_pixel         = normalize(surface.position - g_camera_position.xyz);
+    surface.camera_to_pixel_length  = length(surface.position - g_camera_position.xyz);
+
+    // Create material
+    Material material;
+    {
+        float4 sample_albedo    = tex_albedo.Sample(sampler_point_clamp, input.uv);
+        float4 sample_material  = tex_material.Sample(sampler_point_clamp, input.uv);
+        
+        material.albedo         = sample_albedo.rgb;
+        material.roughness      = sample_material.r;
+        material.metallic       = sample_material.g;
+        material.emissive       = sample_material.b;
+        material.occlusion      = min(normal_sample.a, upsample_bilateral(tex_ssao, input.uv).r); // min(occlusion, ssao)
+        material.F0             = lerp(0.04f, material.albedo, material.metallic);
+        material.is_transparent = sample_albedo.a != 1.0f;
+        material.is_sky         = sample_material.a == 0.0f;
+    }
+
+    #if CLUSTERED
+    // Find the cluster of the pixel, it has a list of the lights (without shadows) which can reach it
+    float depth_view    = mul(float4(surface.position, 1.0f), g_view).z;
+    float slice         = clamp(log(max(depth_view, g_camera_near)) * g_cluster_params.x - g_cluster_params.y, 0.0f, g_cluster_count.z - 1);
+    uint2 tile          = min(uint2(input.uv * g_cluster_count.xy), g_cluster_count.xy - 1);
+    uint cluster        = tile.x + tile.y * g_cluster_count.x + uint(slice) * g_cluster_count.x * g_cluster_count.y;
+    uint cluster_data   = g_cluster_grid[cluster / 4][cluster % 4];
+    uint light_offset   = cluster_data & 0xFFFF;
+    uint light_count    = material.is_sky ? 0 : cluster_data >> 16;
+
+    for (uint i = 0; i < light_count; i++)
+    {
+        uint slot   = light_offset + i;
+        uint index  = (g_cluster_light_indices[slot / 8][(slot % 8) / 2] >> ((slot % 2) * 16)) & 0xFFFF;
+
+        Light light             = (Light)0;
+        light.color             = g_cluster_light_color_intensity[index].rgb;
+        light.intensity         = g_cluster_light_color_intensity[index].w;
+        light.position          = g_cluster_light_position_range[index].xyz;
+        light.range             = g_cluster_light_position_range[index].w;
+        light.angle             = g_cluster_light_direction_angle[index].w;
+        light.distance_to_pixel = length(surface.position - light.position);
+        light.direction         = normalize(surface.position - light.position);
+        light.attenuation       = saturate(1.0f - light.distance_to_pixel / light.range);
+
+        // Spot
+        [branch]
+        if (light.angle > 0.0f)
+        {
+            float cutoffAngle   = 1.0f - light.angle;
+            float theta         = dot(g_cluster_light_direction_angle[index].xyz, light.direction);
+            float epsilon       = cutoffAngle - cutoffAngle * 0.9f;
+            light.attenuation   *= saturate((theta - cutoffAngle) / epsilon); // attenuate when approaching the outer cone
+        }
+        light.attenuation   *= light.attenuation;
+        light.intensity     *= light.attenuation * material.occlusion;
+
+        [branch]
+        if (light.intensity > 0.0f)
+        {
+            reflectance(surface, material, light, light_out);
+        }
+    }
+    #else
+    Light light = get_light(surface);
     
     // Shadow 
     {
@@ -109,13 +198,6 @@ PixelOutputType mainPS(Pixel_PosUv input)
         if (light.cast_shadows)
         {
             shadow = Shadow_Map(surface, light, material.is_transparent);
-
-            // Volumetric lighting (requires shadow maps)
-            [branch]
-            if (light.is_volumetric)
-            {
-                light_out.volumetric.rgb = VolumetricLighting(surface, light);
-            }
         }
         
         // Screen space shadows
@@ -137,33 +219,21 @@ PixelOutputType mainPS(Pixel_PosUv input)
     [branch]
     if (light.intensity > 0.0f && !material.is_sky)
     {
-        // Compute some stuff
-        float3 l		= -light.direction;
-        float3 v        = -surface.camera_to_pixel;
-        float3 h 		= normalize(v + l);
-        float v_dot_h 	= saturate(dot(v, h));
-        float n_dot_v   = saturate(dot(surface.normal, v));
-        float n_dot_l   = saturate(dot(surface.normal, l));
-        float n_dot_h   = saturate(dot(surface.normal, h));
-        float3 radiance	= light.color * light.intensity * n_dot_l;
-    
-        // BRDF components
-        float3 F 			= 0.0f;
-        float3 cDiffuse 	= BRDF_Diffuse(material, n_dot_v, n_dot_l, v_dot_h);	
-        float3 cSpecular 	= BRDF_Specular(material, n_dot_v, n_dot_l, n_dot_h, v_dot_h, F);
+        float3 F = reflectance(surface, material, light, light_out);
 
         // SSR
         float3 light_reflection = 0.0f;
-        float2 sample_ssr       = tex_ssr.Sample(sampler_point_clamp, input.uv).xy;
+        float2 sample_ssr       = upsample_bilateral(tex_ssr, input.uv, true).xy;
         [branch]
         if (g_ssr_enabled && (sample_ssr.x * sample_ssr.y) != 0.0f)
         {
-            light_reflection = saturate(tex_frame.Sample(sampler_bilinear_clamp, sample_ssr.xy).rgb * F);
+            light_reflection = saturate(tex_frame.Sample(sampler_bilinear_clamp, sample_ssr.xy / g_resolution_scale).rgb * F);
         }
     
-        light_out.diffuse.rgb   = cDiffuse * radiance * energy_conservation(F, material.metallic);
-        light_out.specular.rgb	= cSpecular * radiance + light_reflection;
+        light_out.specular.rgb += light_reflection;
     }
+    #endif
 
 	return light_out;
 }
+#endif
@@ -42,6 +42,11 @@ Pixel_PosUv mainVS(Vertex_PosUv input)
     input.position.w 	= 1.0f;
     output.position 	= mul(input.position, g_viewProjectionOrtho);
     output.uv 			= input.uv;
+
+#if RESOLUTION_SCALED
+    // Only the top-left g_resolution_scale of the scene render targets holds the scene
+    output.uv *= g_resolution_scale;
+#endif
 	
     return output;
 }
@@ -150,6 +155,24 @@ float4 mainPS(Pixel_PosUv input) : SV_TARGET
 	color = MotionBlur(uv, tex);
 #endif
 
+#if PASS_TEMPORAL_ACCUMULATE
+	// Blend with the re-projected history, clamped to the neighbourhood of the current sample to avoid ghosting
+	float4 current      = tex.Sample(sampler_point_clamp, uv);
+	float4 color_min    = current;
+	float4 color_max    = current;
+	[unroll]
+	for (int i = 0; i < 4; i++)
+	{
+		float2 offset    = float2((i % 2) * 2 - 1, (i / 2) * 2 - 1) * g_texel_size;
+		float4 neighbour = tex.Sample(sampler_point_clamp, uv + offset);
+		color_min        = min(color_min, neighbour);
+		color_max        = max(color_max, neighbour);
+	}
+	float2 uv_reprojected   = uv - tex_velocity.Sample(sampler_point_clamp, uv).xy * g_resolution_scale;
+	float4 history          = clamp(tex2.Sample(sampler_bilinear_clamp, uv_reprojected), color_min, color_max);
+	color                   = lerp(history, current, is_valid_uv(uv_reprojected) ? 0.1f : 1.0f);
+#endif
+
 #if DEBUG_NORMAL
 	float3 normal = tex.Sample(sampler_point_clamp, uv).rgb;
 	normal = pack(normal);
@@ -69,19 +69,22 @@ float3 clip_aabb(float3 aabb_min, float3 aabb_max, float3 p, float3 q)
 
 float4 ResolveTAA(float2 uv, Texture2D tex_history, Texture2D tex_current)
 {
+	// The current frame (and the g-buffer) only covers [0, g_resolution_scale] of its render target, the history and the output cover all of it
+	float2 uv_current = uv * g_resolution_scale;
+
 	//= Sample neighbourhood ==============================================================================
 	float2 du = float2(g_texel_size.x, 0.0f);
 	float2 dv = float2(0.0f, g_texel_size.y);
 
-	float3 ctl = Reinhard(tex_current.Sample(sampler_point_clamp, uv - dv - du).rgb);
-	float3 ctc = Reinhard(tex_current.Sample(sampler_point_clamp, uv - dv).rgb);
-	float3 ctr = Reinhard(tex_current.Sample(sampler_point_clamp, uv - dv + du).rgb);
-	float3 cml = Reinhard(tex_current.Sample(sampler_point_clamp, uv - du).rgb);
-	float3 cmc = Reinhard(tex_current.Sample(sampler_point_clamp, uv).rgb);
-	float3 cmr = Reinhard(tex_current.Sample(sampler_point_clamp, uv + du).rgb);
-	float3 cbl = Reinhard(tex_current.Sample(sampler_point_clamp, uv + dv - du).rgb);
-	float3 cbc = Reinhard(tex_current.Sample(sampler_point_clamp, uv + dv).rgb);
-	float3 cbr = Reinhard(tex_current.Sample(sampler_point_clamp, uv + dv + du).rgb);
+	float3 ctl = Reinhard(tex_current.Sample(sampler_point_clamp, uv_current - dv - du).rgb);
+	float3 ctc = Reinhard(tex_current.Sample(sampler_point_clamp, uv_current - dv).rgb);
+	float3 ctr = Reinhard(tex_current.Sample(sampler_point_clamp, uv_current - dv + du).rgb);
+	float3 cml = Reinhard(tex_current.Sample(sampler_point_clamp, uv_current - du).rgb);
+	float3 cmc = Reinhard(tex_current.Sample(sampler_bilinear_clamp, uv_current).rgb);
+	float3 cmr = Reinhard(tex_current.Sample(sampler_point_clamp, uv_current + du).rgb);
+	float3 cbl = Reinhard(tex_current.Sample(sampler_point_clamp, uv_current + dv - du).rgb);
+	float3 cbc = Reinhard(tex_current.Sample(sampler_point_clamp, uv_current + dv).rgb);
+	float3 cbr = Reinhard(tex_current.Sample(sampler_point_clamp, uv_current + dv + du).rgb);
 
 	float3 color_min = min(ctl, min(ctc, min(ctr, min(cml, min(cmc, min(cmr, min(cbl, min(cbc, cbr))))))));
 	float3 color_max = max(ctl, max(ctc, max(ctr, max(cml, max(cmc, max(cmr, max(cbl, max(cbc, cbr))))))));
@@ -89,7 +92,7 @@ float4 ResolveTAA(float2 uv, Texture2D tex_history, Texture2D tex_current)
 	//=====================================================================================================
 	
     // Get history and current colors
-	float2 velocity			= GetVelocity_Dilate_Min(uv);
+	float2 velocity			= GetVelocity_Dilate_Min(uv_current);
 	float2 uv_reprojected   = uv - velocity;
 	float3 color_history    = Reinhard(tex_history.Sample(sampler_bilinear_clamp, uv_reprojected).rgb);
 	float3 color_current    = cmc;
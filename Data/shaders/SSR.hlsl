@@ -97,7 +97,7 @@ float2 mainPS(Pixel_PosUv input) : SV_TARGET
         }
 
         // Reject if the reflection is pointing outside of the viewport
-        ray_uv_hit *= is_saturated(ray_uv_hit);
+        ray_uv_hit *= is_valid_uv(ray_uv_hit);
     }
     
     return ray_uv_hit;
@@ -50,7 +50,7 @@ float ScreenSpaceShadows(Surface surface, Light light)
         ray_uv  = project_uv(ray_pos, g_projection);
 
         [branch]
-        if (is_saturated(ray_uv))
+        if (is_valid_uv(ray_uv))
         {
             // Compare depth
             float depth_z       = get_linear_depth(ray_uv);
@@ -66,7 +66,7 @@ float ScreenSpaceShadows(Surface surface, Light light)
     }
 
 	// fade when out of screen
-    occlusion *= screen_fade(ray_uv);
+    occlusion *= screen_fade(ray_uv / g_resolution_scale);
     
     return 1.0f - occlusion;
 }
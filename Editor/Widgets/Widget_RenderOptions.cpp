@@ -65,6 +65,7 @@ void Widget_RenderOptions::Tick()
         bool do_sharperning             = m_renderer->GetOption(Render_Sharpening_LumaSharpen);
         bool do_chromatic_aberration    = m_renderer->GetOption(Render_ChromaticAberration);
         bool do_dithering               = m_renderer->GetOption(Render_Dithering);  
+        bool do_dynamic_resolution      = m_renderer->GetOption(Render_DynamicResolution);
         int resolution_shadow           = m_renderer->GetOptionValue<int>(Option_Value_ShadowResolution);
 
         // Display
@@ -92,6 +93,21 @@ void Widget_RenderOptions::Tick()
                 }
             };
 
+            const auto render_option_quality = [this](const char* id, Renderer_Option_Value render_option)
+            {
+                static const char* quality_options[] = { "Full", "Half", "Quarter" };
+                int quality = m_renderer->GetOptionValue<int>(render_option);
+
+                ImGui::PushID(id);
+                ImGui::PushItemWidth(120);
+                if (ImGui::Combo("Resolution", &quality, quality_options, IM_ARRAYSIZE(quality_options)))
+                {
+                    m_renderer->SetOptionValue(render_option, static_cast<float>(quality));
+                }
+                ImGui::PopItemWidth();
+                ImGui::PopID();
+            };
+
             // Tonemapping
             if (ImGui::BeginCombo("Tonemapping", tonemapping_selection.c_str()))
             {
@@ -122,6 +138,7 @@ void Widget_RenderOptions::Tick()
             // Volumetric lighting
             ImGui::Checkbox("Volumetric lighting", &do_volumetric_lighting);
             ImGuiEx::Tooltip("Requires a light with shadows enabled");
+            ImGui::SameLine(); render_option_quality("##volumetric_lighting_option_1", Option_Value_VolumetricLighting_Quality);
             ImGui::Separator();
 
             // Screen space shadows
@@ -130,10 +147,12 @@ void Widget_RenderOptions::Tick()
 
             // Screen space ambient occlusion
             ImGui::Checkbox("SSAO - Screen Space Ambient Occlusion", &do_ssao);
+            ImGui::SameLine(); render_option_quality("##ssao_option_1", Option_Value_Ssao_Quality);
             ImGui::Separator();
 
             // Screen space reflections
             ImGui::Checkbox("SSR - Screen Space Reflections", &do_ssr);
+            ImGui::SameLine(); render_option_quality("##ssr_option_1", Option_Value_Ssr_Quality);
             ImGui::Separator();
 
             // Motion blur
@@ -165,6 +184,13 @@ void Widget_RenderOptions::Tick()
             ImGuiEx::Tooltip("Reduces color banding");
             ImGui::Separator();
 
+            // Dynamic resolution
+            ImGui::Checkbox("Dynamic Resolution", &do_dynamic_resolution);
+            ImGuiEx::Tooltip(("Lowers the render resolution when the GPU misses the target time (currently at " + to_string(static_cast<int>(m_renderer->GetResolutionScale() * 100.0f)) + "%%)").c_str());
+            ImGui::SameLine(); render_option_float("##dynamic_resolution_option_1", "Target (ms)",   Option_Value_DynamicResolution_TargetMs, "", 1.0f);
+            ImGui::SameLine(); render_option_float("##dynamic_resolution_option_2", "Min scale",     Option_Value_DynamicResolution_ScaleMin, "Lowest fraction of the resolution to render at", 0.05f);
+            ImGui::Separator();
+
             // Shadow resolution
             ImGui::InputInt("Shadow Resolution", &resolution_shadow, 1);
         }
@@ -181,6 +207,7 @@ void Widget_RenderOptions::Tick()
         m_renderer->SetOption(Render_Sharpening_LumaSharpen,        do_sharperning);
         m_renderer->SetOption(Render_ChromaticAberration,           do_chromatic_aberration);
         m_renderer->SetOption(Render_Dithering,                     do_dithering);
+        m_renderer->SetOption(Render_DynamicResolution,             do_dynamic_resolution);
         m_renderer->SetOptionValue(Option_Value_ShadowResolution,   static_cast<float>(resolution_shadow));
     }
 
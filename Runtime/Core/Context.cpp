@@ -0,0 +1,242 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =====================
+#include "Context.h"
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include "../Threading/Threading.h"
+//================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    namespace _Context
+    {
+        // Shared with the pool tasks, a task that lost the race to the main thread can run after Tick() has returned
+        struct TickState
+        {
+            explicit TickState(const size_t count) : dependencies_left(new atomic<uint32_t>[count]), claimed(new atomic<bool>[count]) {}
+
+            unique_ptr<atomic<uint32_t>[]> dependencies_left;
+            unique_ptr<atomic<bool>[]> claimed;
+            deque<uint32_t> ready;
+            uint32_t done = 0;
+            mutex mutex_state;
+            condition_variable condition;
+        };
+
+        static bool conflict(const _subystem& a, const _subystem& b)
+        {
+            return (a.writes & (b.reads | b.writes)) || (b.writes & a.reads);
+        }
+    }
+
+    void Context::Tick(const Tick_Group tick_group, const float delta_time /*= 0.0f*/)
+    {
+        if (m_graph_dirty)
+        {
+            BuildGraph();
+        }
+
+        const vector<uint32_t>& group = m_groups[tick_group];
+        const auto time_start = chrono::steady_clock::now();
+
+        // Without a pool (it's registered after the first few subsystems) there is nothing to schedule
+        if (m_threading && m_threading->GetThreadCount() != 0)
+        {
+            TickParallel(group, delta_time);
+        }
+        else
+        {
+            TickSerial(group, delta_time);
+        }
+
+        // Statistics
+        m_critical_path_ms[tick_group] = 0.0f;
+        for (const uint32_t index : group)
+        {
+            _subystem& subsystem = m_subsystems[index];
+
+            float dependencies_ms = 0.0f;
+            for (const uint32_t dependency : subsystem.dependencies)
+            {
+                dependencies_ms = max(dependencies_ms, m_subsystems[dependency].critical_path_ms);
+            }
+
+            subsystem.critical_path_ms      = dependencies_ms + subsystem.time_ms;
+            m_critical_path_ms[tick_group]  = max(m_critical_path_ms[tick_group], subsystem.critical_path_ms);
+        }
+        m_tick_time_ms[tick_group] = static_cast<float>(chrono::duration<double, milli>(chrono::steady_clock::now() - time_start).count());
+    }
+
+    void Context::BuildGraph()
+    {
+        for (vector<uint32_t>& group : m_groups)
+        {
+            group.clear();
+        }
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_subsystems.size()); i++)
+        {
+            _subystem& subsystem = m_subsystems[i];
+            subsystem.dependencies.clear();
+            subsystem.dependents.clear();
+
+            // Depend on every earlier subsystem of the same group we conflict with, so that registration order is kept where it matters
+            for (const uint32_t j : m_groups[subsystem.tick_group])
+            {
+                if (_Context::conflict(m_subsystems[j], subsystem))
+                {
+                    subsystem.dependencies.emplace_back(j);
+                    m_subsystems[j].dependents.emplace_back(i);
+                }
+            }
+
+            m_groups[subsystem.tick_group].emplace_back(i);
+        }
+
+        m_threading     = GetSubsystem<Threading>();
+        m_graph_dirty   = false;
+    }
+
+    void Context::TickSerial(const vector<uint32_t>& group, const float delta_time)
+    {
+        for (const uint32_t index : group)
+        {
+            TickSubsystem(index, delta_time);
+        }
+    }
+
+    void Context::TickParallel(const vector<uint32_t>& group, const float delta_time)
+    {
+        auto state = make_shared<_Context::TickState>(m_subsystems.size());
+        for (const uint32_t index : group)
+        {
+            state->dependencies_left[index] = static_cast<uint32_t>(m_subsystems[index].dependencies.size());
+            state->claimed[index]           = false;
+
+            if (state->dependencies_left[index] == 0)
+            {
+                state->ready.emplace_back(index);
+            }
+        }
+
+        // Ticks a subsystem and releases its dependents, runs on the main thread or on a pool thread
+        const auto tick = [this, delta_time](_Context::TickState* state, const uint32_t index)
+        {
+            TickSubsystem(index, delta_time);
+
+            {
+                lock_guard<mutex> lock(state->mutex_state);
+                for (const uint32_t dependent : m_subsystems[index].dependents)
+                {
+                    if (--state->dependencies_left[dependent] == 0)
+                    {
+                        state->ready.emplace_back(dependent);
+                    }
+                }
+                state->done++;
+            }
+            state->condition.notify_one();
+        };
+
+        deque<uint32_t> ready;
+        deque<uint32_t> ready_main;
+        deque<uint32_t> ready_any;
+        while (true)
+        {
+            {
+                lock_guard<mutex> lock(state->mutex_state);
+                if (state->done == group.size())
+                    break;
+
+                ready.swap(state->ready);
+            }
+
+            // Hand whatever became ready to the pool, keep main thread subsystems for ourselves
+            for (const uint32_t index : ready)
+            {
+                if (m_subsystems[index].thread == Tick_Thread_Any)
+                {
+                    m_threading->AddTask([state, index, tick]()
+                    {
+                        // The main thread may have stolen it (and Tick() may have returned already)
+                        if (!state->claimed[index].exchange(true))
+                        {
+                            tick(state.get(), index);
+                        }
+                    });
+                    ready_any.emplace_back(index);
+                }
+                else
+                {
+                    ready_main.emplace_back(index);
+                }
+            }
+            ready.clear();
+
+            if (!ready_main.empty())
+            {
+                const uint32_t index = ready_main.front();
+                ready_main.pop_front();
+                tick(state.get(), index);
+                continue;
+            }
+
+            // Idle, steal a subsystem that no pool thread has started yet (the pool might be busy with long tasks)
+            bool stolen = false;
+            while (!ready_any.empty() && !stolen)
+            {
+                const uint32_t index = ready_any.front();
+                ready_any.pop_front();
+
+                if (!state->claimed[index].exchange(true))
+                {
+                    tick(state.get(), index);
+                    stolen = true;
+                }
+            }
+
+            if (!stolen)
+            {
+                unique_lock<mutex> lock(state->mutex_state);
+                state->condition.wait(lock, [&state, &group] { return !state->ready.empty() || state->done == group.size(); });
+            }
+        }
+    }
+
+    void Context::TickSubsystem(const uint32_t index, const float delta_time)
+    {
+        _subystem& subsystem    = m_subsystems[index];
+        const auto time_start   = chrono::steady_clock::now();
+
+        subsystem.ptr->Tick(delta_time);
+
+        subsystem.time_ms = static_cast<float>(chrono::duration<double, milli>(chrono::steady_clock::now() - time_start).count());
+    }
+}
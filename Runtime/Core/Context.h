@@ -22,6 +22,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ==============
+#include <vector>
+#include <string>
 #include "EngineDefs.h"
 #include "ISubsystem.h"
 #include "../Logging/Log.h"
@@ -30,23 +32,70 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace Spartan
 {
     class Engine;
+    class Threading;
 
     enum Tick_Group
     {
         Tick_Variable,
-        Tick_Smoothed
+        Tick_Smoothed,
+        Tick_Group_Count
+    };
+
+    // Which thread a subsystem can tick on
+    enum Tick_Thread
+    {
+        Tick_Thread_Main,   // the thread which calls Context::Tick()
+        Tick_Thread_Any     // any thread of the pool (or the main thread, if it's idle)
+    };
+
+    // What a subsystem touches during Tick(), subsystems which don't conflict tick concurrently
+    enum Subsystem_Data : uint32_t
+    {
+        Subsystem_Data_None         = 0,
+        Subsystem_Data_Time         = 1 << 0,
+        Subsystem_Data_Input        = 1 << 1,
+        Subsystem_Data_Entities     = 1 << 2,
+        Subsystem_Data_Transforms   = 1 << 3,
+        Subsystem_Data_Resources    = 1 << 4,
+        Subsystem_Data_Audio        = 1 << 5,
+        Subsystem_Data_Physics      = 1 << 6,
+        Subsystem_Data_Rendering    = 1 << 7,
+        Subsystem_Data_All          = 0xFFFFFFFF
     };
 
     struct _subystem
     {
-        _subystem(const std::shared_ptr<ISubsystem>& subsystem, Tick_Group tick_group)
+        _subystem(const std::shared_ptr<ISubsystem>& subsystem, Tick_Group tick_group, uint32_t reads, uint32_t writes, Tick_Thread thread, const char* type_name)
         {
-            ptr = subsystem;
-            this->tick_group = tick_group;
+            ptr                 = subsystem;
+            this->tick_group    = tick_group;
+            this->reads         = reads;
+            this->writes        = writes;
+            this->thread        = thread;
+
+            // "class Spartan::Renderer" -> "Renderer"
+            name = type_name;
+            const size_t pos = name.find_last_of(": ");
+            if (pos != std::string::npos)
+            {
+                name = name.substr(pos + 1);
+            }
         }
 
         std::shared_ptr<ISubsystem> ptr;
         Tick_Group tick_group;
+        uint32_t reads;
+        uint32_t writes;
+        Tick_Thread thread;
+        std::string name;
+
+        // Scheduling (indices into the subsystem list, earlier registrations only)
+        std::vector<uint32_t> dependencies;
+        std::vector<uint32_t> dependents;
+
+        // Statistics (last tick)
+        float time_ms           = 0.0f;
+        float critical_path_ms  = 0.0f; // longest chain of dependencies which ends with this subsystem
     };
 
 	class SPARTAN_CLASS Context
@@ -65,13 +114,15 @@ namespace Spartan
             m_subsystems.clear();
         }
 
-		// Register a subsystem
+		// Register a subsystem. By default it reads and writes everything on the main thread, which makes it tick
+        // in registration order, declaring less allows it to tick alongside the subsystems it doesn't conflict with.
 		template <class T>
-		void RegisterSubsystem(Tick_Group tick_group = Tick_Variable)
+		void RegisterSubsystem(Tick_Group tick_group = Tick_Variable, uint32_t reads = Subsystem_Data_All, uint32_t writes = Subsystem_Data_All, Tick_Thread thread = Tick_Thread_Main)
 		{
             validate_subsystem_type<T>();
 
-            m_subsystems.emplace_back(std::make_shared<T>(this), tick_group);
+            m_subsystems.emplace_back(std::make_shared<T>(this), tick_group, reads, writes, thread, typeid(T).name());
+            m_graph_dirty = true;
 		}
 
 		// Initialize subsystems
@@ -91,16 +142,7 @@ namespace Spartan
 		}
 
         // Tick
-		void Tick(Tick_Group tick_group, float delta_time = 0.0f)
-		{
-            for (const auto& subsystem : m_subsystems)
-            {
-                if (subsystem.tick_group != tick_group)
-                    continue;
-
-                subsystem.ptr->Tick(delta_time);
-            }
-		}
+		void Tick(Tick_Group tick_group, float delta_time = 0.0f);
 
 		// Get a subsystem
 		template <class T> 
@@ -117,9 +159,24 @@ namespace Spartan
 			return nullptr;
 		}
 
+        // Statistics
+        const auto& GetSubsystems() const                           { return m_subsystems; }
+        float GetTickTimeMs(Tick_Group tick_group) const            { return m_tick_time_ms[tick_group]; }
+        float GetCriticalPathMs(Tick_Group tick_group) const        { return m_critical_path_ms[tick_group]; }
+
         Engine* m_engine = nullptr;
 
 	private:
+        void BuildGraph();
+        void TickSerial(const std::vector<uint32_t>& group, float delta_time);
+        void TickParallel(const std::vector<uint32_t>& group, float delta_time);
+        void TickSubsystem(uint32_t index, float delta_time);
+
 		std::vector<_subystem> m_subsystems;
+        std::vector<uint32_t> m_groups[Tick_Group_Count];
+        Threading* m_threading                      = nullptr;
+        bool m_graph_dirty                          = true;
+        float m_tick_time_ms[Tick_Group_Count]      = { 0.0f };
+        float m_critical_path_ms[Tick_Group_Count]  = { 0.0f };
 	};
 }
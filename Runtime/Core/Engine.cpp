@@ -55,18 +55,19 @@ namespace Spartan
 		m_context = make_shared<Context>();
         m_context->m_engine = this;
 
-		// Register subsystems     
-        m_context->RegisterSubsystem<Timer>(Tick_Variable);         // must be first so it ticks first
-		m_context->RegisterSubsystem<ResourceCache>(Tick_Variable);		
-		m_context->RegisterSubsystem<Threading>(Tick_Variable);			
-		m_context->RegisterSubsystem<Audio>(Tick_Variable);
-        m_context->RegisterSubsystem<Physics>(Tick_Variable);       // integrates internally
-        m_context->RegisterSubsystem<Input>(Tick_Smoothed);
-		m_context->RegisterSubsystem<Scripting>(Tick_Smoothed);
-		m_context->RegisterSubsystem<World>(Tick_Smoothed);
+		// Register subsystems (what they read, what they write and where they can tick, conflicting subsystems tick in registration order)
+        // Subsystems without a Tick() of their own declare nothing and stay on the main thread, there is no point in dispatching them
+        m_context->RegisterSubsystem<Timer>(Tick_Variable,          Subsystem_Data_None,                                Subsystem_Data_All);                                                // must be first so it ticks first
+		m_context->RegisterSubsystem<ResourceCache>(Tick_Variable,  Subsystem_Data_None,                                Subsystem_Data_None);
+		m_context->RegisterSubsystem<Threading>(Tick_Variable,      Subsystem_Data_None,                                Subsystem_Data_None);
+		m_context->RegisterSubsystem<Audio>(Tick_Variable,          Subsystem_Data_Time | Subsystem_Data_Transforms,    Subsystem_Data_Audio,                           Tick_Thread_Any);
+        m_context->RegisterSubsystem<Physics>(Tick_Variable,        Subsystem_Data_Time,                                Subsystem_Data_Physics | Subsystem_Data_Transforms | Subsystem_Data_Rendering, Tick_Thread_Any); // integrates internally, debug draws into the renderer's line lists
+        m_context->RegisterSubsystem<Input>(Tick_Smoothed,          Subsystem_Data_None,                                Subsystem_Data_Input);
+		m_context->RegisterSubsystem<Scripting>(Tick_Smoothed,      Subsystem_Data_None,                                Subsystem_Data_None);
+		m_context->RegisterSubsystem<World>(Tick_Smoothed,          Subsystem_Data_Input,                               Subsystem_Data_Entities | Subsystem_Data_Transforms);
         m_context->RegisterSubsystem<Renderer>(Tick_Smoothed);
-        m_context->RegisterSubsystem<Profiler>(Tick_Variable);
-        m_context->RegisterSubsystem<Settings>(Tick_Variable);
+        m_context->RegisterSubsystem<Profiler>(Tick_Variable,       Subsystem_Data_Time | Subsystem_Data_Rendering | Subsystem_Data_Resources, Subsystem_Data_None);
+        m_context->RegisterSubsystem<Settings>(Tick_Variable,       Subsystem_Data_None,                                Subsystem_Data_None);
              	
 		// Initialize above subsystems
 		m_context->Initialize();
@@ -81,6 +82,12 @@ namespace Spartan
 
 	void Engine::Tick() const
     {
+        // Deliver events which were queued during the previous frame (possibly by other threads)
+        EventSystem::Get().Dispatch();
+
+        // Deliver log messages to the logger implementation (e.g. the editor's console)
+        Log::Tick();
+
         m_context->Tick(Tick_Variable, static_cast<float>(m_timer->GetDeltaTimeSec()));
         m_context->Tick(Tick_Smoothed, static_cast<float>(m_timer->GetDeltaTimeSmoothedSec()));
 	}
@@ -24,20 +24,30 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===============
 #include <map>
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
 #include <functional>
 #include "../Core/Variant.h"
+#include "../Core/Stopwatch.h"
 //==========================
 
 /*
 HOW TO USE
-=================================================================================
-To subscribe a function to an event		-> SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
-To unsubscribe a function from an event	-> SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
-To fire an event						-> FIRE_EVENT(EVENT_ID);
-To fire an event with data				-> FIRE_EVENT_DATA(EVENT_ID, Variant);
-
-Note: Currently, this is a blocking event system
-=================================================================================
+======================================================================================================
+To subscribe a function to an event					-> SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
+To subscribe a function to an event (queued delivery)	-> SUBSCRIBE_TO_EVENT_QUEUED(EVENT_ID, Handler);
+To unsubscribe a function from an event				-> SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
+To fire an event									-> FIRE_EVENT(EVENT_ID);
+To fire an event with data							-> FIRE_EVENT_DATA(EVENT_ID, Variant);
+To fire an event with data (queued delivery)			-> FIRE_EVENT_DATA_QUEUED(EVENT_ID, Variant);
+
+Immediate subscribers run on the firing thread, before Fire() returns.
+Queued subscribers (and queued events) are delivered once per frame, on the thread
+which calls Dispatch() (the engine does this at the beginning of every tick).
+Firing is thread-safe, so worker threads can fire events, but immediate subscribers
+have to be thread-safe themselves, use queued delivery if that's not the case.
+======================================================================================================
 */
 
 enum Event_Type
@@ -56,7 +66,13 @@ enum Event_Type
     Event_Frame_Resolution_Changed
 };
 
-//= MACROS ====================================================================================================
+enum Event_Delivery
+{
+    Event_Delivery_Immediate,   // On the firing thread, when the event is fired
+    Event_Delivery_Queued       // On the dispatching thread, when Dispatch() is called
+};
+
+//= MACROS ===========================================================================================================
 #define EVENT_HANDLER_EXPRESSION(expression)		[this](const Spartan::Variant& var)	{ ##expression }
 #define EVENT_HANDLER_EXPRESSION_STATIC(expression)	[](const Spartan::Variant& var)		{ ##expression }
 
@@ -68,10 +84,12 @@ enum Event_Type
 
 #define FIRE_EVENT(eventID)							Spartan::EventSystem::Get().Fire(eventID)
 #define FIRE_EVENT_DATA(eventID, data)				Spartan::EventSystem::Get().Fire(eventID, data)
+#define FIRE_EVENT_DATA_QUEUED(eventID, data)		Spartan::EventSystem::Get().Queue(eventID, data)
 
 #define SUBSCRIBE_TO_EVENT(eventID, function)		Spartan::EventSystem::Get().Subscribe(eventID, function);
+#define SUBSCRIBE_TO_EVENT_QUEUED(eventID, function)	Spartan::EventSystem::Get().Subscribe(eventID, function, Event_Delivery_Queued);
 #define UNSUBSCRIBE_FROM_EVENT(eventID, function)	Spartan::EventSystem::Get().Unsubscribe(eventID, function);
-//=============================================================================================================
+//====================================================================================================================
 
 namespace Spartan
 {
@@ -79,6 +97,23 @@ namespace Spartan
 
 	class SPARTAN_CLASS EventSystem
 	{
+        struct _subscriber
+        {
+            subscriber function;
+            Event_Delivery delivery;
+        };
+
+        struct _event
+        {
+            Event_Type id;
+            Variant data;
+            bool all_subscribers; // false: only queued subscribers, immediate ones were already invoked
+        };
+
+        // Subscriber lists are copy-on-write, so firing only has to copy a pointer (under the lock)
+        // and subscribers can (un)subscribe from within a handler.
+        using subscriber_list = std::shared_ptr<const std::vector<_subscriber>>;
+
 	public:
 		static EventSystem& Get()
 		{
@@ -86,44 +121,154 @@ namespace Spartan
 			return instance;
 		}
 
-		void Subscribe(const Event_Type event_id, subscriber&& function)
+		void Subscribe(const Event_Type event_id, subscriber&& function, const Event_Delivery delivery = Event_Delivery_Immediate)
 		{
-			m_subscribers[event_id].push_back(std::forward<subscriber>(function));
+            std::lock_guard<std::mutex> lock(m_mutex_subscribers);
+
+            const subscriber_list& subscribers_old  = m_subscribers[event_id];
+            auto subscribers_new                    = subscribers_old ? std::make_shared<std::vector<_subscriber>>(*subscribers_old) : std::make_shared<std::vector<_subscriber>>();
+            subscribers_new->push_back({ std::forward<subscriber>(function), delivery });
+            m_subscribers[event_id] = subscribers_new;
 		}
 
 		void Unsubscribe(const Event_Type event_id, subscriber&& function)
 		{
+            std::lock_guard<std::mutex> lock(m_mutex_subscribers);
+
+            const subscriber_list& subscribers_old = m_subscribers[event_id];
+            if (!subscribers_old)
+                return;
+
 			const size_t function_adress	= *reinterpret_cast<long*>(reinterpret_cast<char*>(&function));
-			auto& subscribers				= m_subscribers[event_id];
+			auto subscribers_new		    = std::make_shared<std::vector<_subscriber>>(*subscribers_old);
 
-			for (auto it = subscribers.begin(); it != subscribers.end();)
+			for (auto it = subscribers_new->begin(); it != subscribers_new->end(); it++)
 			{
-				const size_t subscriber_adress = *reinterpret_cast<long*>(reinterpret_cast<char*>(&(*it)));
+				const size_t subscriber_adress = *reinterpret_cast<long*>(reinterpret_cast<char*>(&it->function));
 				if (subscriber_adress == function_adress)
 				{
-					it = subscribers.erase(it);
+					subscribers_new->erase(it);
+                    m_subscribers[event_id] = subscribers_new;
 					return;
 				}
 			}
 		}
 
+        // Invokes immediate subscribers now and queues the event for queued subscribers
 		void Fire(const Event_Type event_id, const Variant& data = 0)
 		{
-			if (m_subscribers.find(event_id) == m_subscribers.end())
-				return;
+            const subscriber_list subscribers = GetSubscribers(event_id);
+            if (!subscribers)
+                return;
 
-			for (const auto& subscriber : m_subscribers[event_id])
+            const Stopwatch timer;
+            bool has_queued_subscribers = false;
+			for (const _subscriber& subscriber : *subscribers)
 			{
-				subscriber(data);
+                if (subscriber.delivery == Event_Delivery_Immediate)
+                {
+                    subscriber.function(data);
+                }
+                else
+                {
+                    has_queued_subscribers = true;
+                }
 			}
+            m_time_us += static_cast<uint64_t>(timer.GetElapsedTimeMs() * 1000.0f);
+            m_fired_count++;
+
+            if (has_queued_subscribers)
+            {
+                Enqueue({ event_id, data, false });
+            }
 		}
 
+        // Queues the event for all subscribers, to be delivered by Dispatch()
+        void Queue(const Event_Type event_id, const Variant& data = 0)
+        {
+            Enqueue({ event_id, data, true });
+        }
+
+        // Delivers queued events, on the calling thread
+        void Dispatch()
+        {
+            // Swap, so events fired by the subscribers are delivered on the next dispatch
+            {
+                std::lock_guard<std::mutex> lock(m_mutex_queue);
+                m_queue_dispatch.swap(m_queue);
+            }
+
+            if (m_queue_dispatch.empty())
+                return;
+
+            const Stopwatch timer;
+            for (const _event& event : m_queue_dispatch)
+            {
+                const subscriber_list subscribers = GetSubscribers(event.id);
+                if (!subscribers)
+                    continue;
+
+                for (const _subscriber& subscriber : *subscribers)
+                {
+                    if (event.all_subscribers || subscriber.delivery == Event_Delivery_Queued)
+                    {
+                        subscriber.function(event.data);
+                    }
+                }
+            }
+            m_time_us += static_cast<uint64_t>(timer.GetElapsedTimeMs() * 1000.0f);
+            m_dispatched_count += static_cast<uint32_t>(m_queue_dispatch.size());
+
+            // Clear but keep the capacity, to avoid allocations next frame
+            m_queue_dispatch.clear();
+        }
+
 		void Clear() 
 		{
-			m_subscribers.clear(); 
+            std::lock_guard<std::mutex> lock_subscribers(m_mutex_subscribers);
+            std::lock_guard<std::mutex> lock_queue(m_mutex_queue);
+			m_subscribers.clear();
+            m_queue.clear();
 		}
 
+        // Statistics (since the last reset), the profiler reads and resets them every frame
+        uint32_t GetFiredCount()        const { return m_fired_count; }
+        uint32_t GetDispatchedCount()   const { return m_dispatched_count; }
+        float GetTimeMs()               const { return static_cast<float>(m_time_us) / 1000.0f; }
+        void ResetStatistics()
+        {
+            m_fired_count       = 0;
+            m_dispatched_count  = 0;
+            m_time_us           = 0;
+        }
+
 	private:
-		std::map<Event_Type, std::vector<subscriber>> m_subscribers;
+        subscriber_list GetSubscribers(const Event_Type event_id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex_subscribers);
+
+            const auto it = m_subscribers.find(event_id);
+            return it != m_subscribers.end() ? it->second : nullptr;
+        }
+
+        void Enqueue(_event&& event)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex_queue);
+            m_queue.emplace_back(std::move(event));
+        }
+
+        // Subscribers
+		std::map<Event_Type, subscriber_list> m_subscribers;
+        std::mutex m_mutex_subscribers;
+
+        // Queued events (double buffered)
+        std::vector<_event> m_queue;
+        std::vector<_event> m_queue_dispatch;
+        std::mutex m_mutex_queue;
+
+        // Statistics
+        std::atomic<uint32_t> m_fired_count         = 0;
+        std::atomic<uint32_t> m_dispatched_count    = 0;
+        std::atomic<uint64_t> m_time_us             = 0;
 	};
 }
@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/FileSystem.h"
 #include "../Rendering/Renderer.h"
 #include "../Threading/Threading.h"
+#include "../Physics/Physics.h"
 #include "pugixml.hpp"
 //=================================
 
@@ -130,6 +131,8 @@ namespace Spartan
 		_Settings::write_setting(_Settings::fout, "fFPSLimit",              m_fps_limit);
 		_Settings::write_setting(_Settings::fout, "iMaxThreadCount",        m_max_thread_count);
         _Settings::write_setting(_Settings::fout, "iRendererFlags",         m_renderer_flags);
+        _Settings::write_setting(_Settings::fout, "iPhysicsSubStepsMax",    m_physics_sub_steps_max);
+        _Settings::write_setting(_Settings::fout, "fPhysicsFixedRate",      m_physics_fixed_rate);
 
 		// Close the file.
 		_Settings::fout.close();
@@ -153,6 +156,8 @@ namespace Spartan
 		_Settings::read_setting(_Settings::fin, "fFPSLimit",               m_fps_limit);
 		_Settings::read_setting(_Settings::fin, "iMaxThreadCount",         m_max_thread_count);
         _Settings::read_setting(_Settings::fin, "iRendererFlags",          m_renderer_flags);
+        _Settings::read_setting(_Settings::fin, "iPhysicsSubStepsMax",     m_physics_sub_steps_max);
+        _Settings::read_setting(_Settings::fin, "fPhysicsFixedRate",       m_physics_fixed_rate);
 
 		// Close the file.
 		_Settings::fin.close();
@@ -168,6 +173,10 @@ namespace Spartan
         m_shadow_map_resolution = renderer->GetOptionValue<uint32_t>(Option_Value_ShadowResolution);
         m_anisotropy            = renderer->GetOptionValue<uint32_t>(Option_Value_Anisotropy);
         m_renderer_flags        = renderer->GetOptions();
+
+        Physics* physics        = m_context->GetSubsystem<Physics>();
+        m_physics_sub_steps_max = physics->GetSubStepsMax();
+        m_physics_fixed_rate    = physics->GetFixedRate();
     }
 
     void Settings::Map() const
@@ -178,5 +187,9 @@ namespace Spartan
         renderer->SetOptionValue(Option_Value_Anisotropy, static_cast<float>(m_anisotropy));
         renderer->SetOptionValue(Option_Value_ShadowResolution, static_cast<float>(m_shadow_map_resolution));
         renderer->SetOptions(m_renderer_flags);
+
+        Physics* physics = m_context->GetSubsystem<Physics>();
+        physics->SetSubStepsMax(m_physics_sub_steps_max);
+        physics->SetFixedRate(m_physics_fixed_rate);
     }
 }
@@ -78,6 +78,8 @@ namespace Spartan
 		uint32_t m_anisotropy				= 0;
 		uint32_t m_max_thread_count			= 0;
         double m_fps_limit                  = 0;
+        int m_physics_sub_steps_max         = 1;
+        float m_physics_fixed_rate          = 60.0f;
         Context* m_context                  = nullptr;
         std::vector<ThirdPartyLib> m_third_party_libs;
 	};
@@ -28,6 +28,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Math/Quaternion.h"
 #include "../Math/Matrix.h"
 #include "EngineDefs.h"
+#include <memory>
 #include <variant>
 //=============================
 
@@ -35,6 +36,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace Spartan
 {
 	class Entity;
+	struct WorldDelta;
 }
 //========================
 
@@ -50,16 +52,17 @@ namespace Spartan
 	Spartan::Entity*,								\
 	std::shared_ptr<Spartan::Entity>,				\
 	std::weak_ptr<Spartan::Entity>,					\
-	std::vector<std::weak_ptr<Spartan::Entity>>,	\
-	std::vector<std::shared_ptr<Spartan::Entity>>,	\
+	const Spartan::WorldDelta*,						\
 	Spartan::Math::Vector2,							\
 	Spartan::Math::Vector3,							\
 	Spartan::Math::Vector4,							\
 	Spartan::Math::Matrix,							\
 	Spartan::Math::Quaternion
 
+// Only small types, so that copying a variant (e.g. when queuing an event) never allocates.
+// Pass large payloads by pointer and make sure they outlive the delivery.
 #define VARIANT_TYPES std::variant<_VARIANT_TYPES>
-typedef std::variant<_VARIANT_TYPES, VARIANT_TYPES> VariantInternal;
+typedef VARIANT_TYPES VariantInternal;
 
 namespace Spartan
 {
@@ -87,6 +90,9 @@ namespace Spartan
 		template<class T>
 		inline const T& Get() const { return std::get<T>(m_variant); }
 
+		template<class T>
+		inline bool Is() const { return std::holds_alternative<T>(m_variant); }
+
 	private:
 		VariantInternal m_variant;
 	};
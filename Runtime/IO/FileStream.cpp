@@ -201,6 +201,42 @@ namespace Spartan
 		in.read(reinterpret_cast<char*>(vec->data()), sizeof(uint32_t) * length);
 	}
 
+	template<typename T>
+	static void read_range(ifstream& in, const uint32_t length, vector<T>* vec, const uint32_t offset, const uint32_t count)
+	{
+		const streamoff start = in.tellg();
+
+		if (static_cast<uint64_t>(offset) + count > length)
+		{
+			LOG_ERROR("Range [%d, %d) exceeds the %d stored elements", offset, offset + count, length);
+			vec->clear();
+		}
+		else
+		{
+			in.seekg(start + static_cast<streamoff>(sizeof(T)) * offset);
+			vec->resize(count);
+			in.read(reinterpret_cast<char*>(vec->data()), sizeof(T) * count);
+		}
+
+		in.seekg(start + static_cast<streamoff>(sizeof(T)) * length);
+	}
+
+	void FileStream::Read(vector<RHI_Vertex_PosTexNorTan>* vec, const uint32_t offset, const uint32_t count)
+	{
+		if (!vec)
+			return;
+
+		read_range(in, ReadAs<uint32_t>(), vec, offset, count);
+	}
+
+	void FileStream::Read(vector<uint32_t>* vec, const uint32_t offset, const uint32_t count)
+	{
+		if (!vec)
+			return;
+
+		read_range(in, ReadAs<uint32_t>(), vec, offset, count);
+	}
+
 	void FileStream::Read(vector<unsigned char>* vec)
 	{
 		if (!vec)
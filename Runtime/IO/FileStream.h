@@ -51,6 +51,10 @@ namespace Spartan
 		auto IsOpen() const { return m_is_open; }
 		void Close();
 
+		// Version of the format being read or written, set by the owner of the file so that nested readers can tell older data apart
+		void SetVersion(const uint32_t version)	{ m_version = version; }
+		auto GetVersion() const					{ return m_version; }
+
 		//= WRITING ==================================================
 		template <class T, class = typename std::enable_if<
 			std::is_same<T, bool>::value				||
@@ -123,6 +127,10 @@ namespace Spartan
 		void Read(std::vector<unsigned char>* vec);
 		void Read(std::vector<std::byte>* vec);
 
+		// Read a range of a vector, the stream is left past the whole vector
+		void Read(std::vector<RHI_Vertex_PosTexNorTan>* vec, uint32_t offset, uint32_t count);
+		void Read(std::vector<uint32_t>* vec, uint32_t offset, uint32_t count);
+
 		// Reading with explicit type definition
 		template <class T, class = typename std::enable_if
 		<
@@ -155,6 +163,7 @@ namespace Spartan
 		std::ofstream out;
 		std::ifstream in;
 		uint32_t m_flags;
+		uint32_t m_version = 0;
 		bool m_is_open;
 	};
 }
@@ -19,15 +19,22 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ===================
+//= INCLUDES =======================
 #include "Log.h"
 #include "ILogger.h"
 #include <fstream>
 #include <cstdarg>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <string_view>
+#include <condition_variable>
 #include "../World/Entity.h"
 #include "../Core/EventSystem.h"
 #include "../Core/FileSystem.h"
-//==============================
+#include "../Threading/RingBuffer.h"
+//==================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -40,10 +47,206 @@ namespace Spartan
 	ofstream Log::m_fout;
 	mutex Log::m_mutex_log;
     vector<LogCmd> Log::m_log_buffer;
-	string Log::m_log_file_name	    = "log.txt";
-	bool Log::m_log_to_file		    = true; // start logging to file (unless changed by the user, e.g. Renderer initialization was successful, so logging can happen on screen)
-	bool Log::m_first_log		    = true;
-   
+    atomic<bool> Log::m_has_logger          = false;
+    atomic<Log_Type> Log::m_log_level       = Log_Info;
+    atomic<uint32_t> Log::m_repeat_limit    = 10;
+	string Log::m_log_file_name	            = "log.txt";
+	bool Log::m_log_to_file		            = true; // start logging to file (unless changed by the user, e.g. Renderer initialization was successful, so logging can happen on screen)
+	bool Log::m_first_log		            = true;
+
+    namespace _Log
+    {
+        constexpr uint32_t ring_capacity        = 256;  // messages per thread, must be a power of two
+        constexpr uint32_t message_size         = 1024; // bytes per message, longer messages are truncated
+        constexpr uint32_t logger_buffer_max    = 1000; // messages waiting for the logger, older ones are dropped
+        constexpr auto flush_interval           = chrono::milliseconds(10);
+        constexpr auto repeat_window            = chrono::seconds(1);
+
+        struct Message
+        {
+            uint64_t sequence;
+            Log_Type type;
+            char text[message_size];
+        };
+
+        using MessageRingBuffer = RingBuffer<Message, ring_capacity>;
+
+        // Per thread state for rate limiting repeated messages
+        struct RepeatState
+        {
+            size_t hash         = 0;
+            Log_Type type       = Log_Info;
+            uint32_t count      = 0;
+            uint32_t suppressed = 0;
+            chrono::steady_clock::time_point window_start;
+        };
+
+        atomic<bool> backend_destroyed = false;
+    }
+
+    // Owns the per-thread ring buffers and the thread which drains them
+    class LogBackend
+    {
+    public:
+        LogBackend()
+        {
+            m_thread = thread(&LogBackend::Run, this);
+        }
+
+        ~LogBackend()
+        {
+            {
+                lock_guard<mutex> lock(m_mutex_wake);
+                m_stopping = true;
+            }
+            m_condition.notify_one();
+            m_thread.join();
+            _Log::backend_destroyed = true;
+        }
+
+        static LogBackend& Get()
+        {
+            static LogBackend instance;
+            return instance;
+        }
+
+        void Push(const char* text, const Log_Type type)
+        {
+            thread_local shared_ptr<_Log::MessageRingBuffer> ring = RegisterRing();
+
+            const uint64_t sequence = m_sequence++;
+            auto fill = [text, type, sequence](_Log::Message& message)
+            {
+                const size_t length = min(strlen(text), static_cast<size_t>(_Log::message_size - 1));
+                memcpy(message.text, text, length);
+                message.text[length]    = '\0';
+                message.type            = type;
+                message.sequence        = sequence;
+            };
+
+            // If the ring is full, wake up the log thread and wait for it to make space
+            while (!ring->TryPush(fill))
+            {
+                m_condition.notify_one();
+                this_thread::yield();
+            }
+        }
+
+        void Flush()
+        {
+            // Wait for everything that has a sequence number so far
+            const uint64_t sequence = m_sequence.load();
+            while (m_sequence_written.load() + 1 < sequence)
+            {
+                m_condition.notify_one();
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        }
+
+    private:
+        shared_ptr<_Log::MessageRingBuffer> RegisterRing()
+        {
+            auto ring = make_shared<_Log::MessageRingBuffer>();
+            lock_guard<mutex> lock(m_mutex_rings);
+            m_rings.emplace_back(ring);
+            return ring;
+        }
+
+        void Run()
+        {
+            vector<pair<uint64_t, LogCmd>> messages;
+            vector<LogCmd> messages_ordered;
+
+            while (true)
+            {
+                bool stopping = false;
+                {
+                    unique_lock<mutex> lock(m_mutex_wake);
+                    m_condition.wait_for(lock, _Log::flush_interval, [this] { return m_stopping; });
+                    stopping = m_stopping;
+                }
+
+                // Drain every ring
+                {
+                    lock_guard<mutex> lock(m_mutex_rings);
+
+                    for (const auto& ring : m_rings)
+                    {
+                        ring->Pop([&messages](const _Log::Message& message) { messages.emplace_back(message.sequence, LogCmd(message.text, message.type)); });
+                    }
+
+                    // Rings of threads which have exited are only referenced by us
+                    m_rings.erase(remove_if(m_rings.begin(), m_rings.end(), [](const shared_ptr<_Log::MessageRingBuffer>& ring) { return ring.use_count() == 1 && ring->IsEmpty(); }), m_rings.end());
+                }
+
+                if (!messages.empty())
+                {
+                    // Restore the order in which the messages were written
+                    sort(messages.begin(), messages.end(), [](const pair<uint64_t, LogCmd>& a, const pair<uint64_t, LogCmd>& b) { return a.first < b.first; });
+
+                    for (auto& message : messages)
+                    {
+                        messages_ordered.emplace_back(move(message.second));
+                    }
+
+                    Log::OnMessagesWritten(messages_ordered);
+                    m_sequence_written = max(m_sequence_written.load(), messages.back().first);
+
+                    messages.clear();
+                    messages_ordered.clear();
+                }
+
+                if (stopping)
+                    return;
+            }
+        }
+
+        vector<shared_ptr<_Log::MessageRingBuffer>> m_rings;
+        mutex m_mutex_rings;
+        thread m_thread;
+        mutex m_mutex_wake;
+        condition_variable m_condition;
+        bool m_stopping = false;
+        atomic<uint64_t> m_sequence         = 1;
+        atomic<uint64_t> m_sequence_written = 0;
+    };
+
+    void Log::SetLogger(const weak_ptr<ILogger>& logger)
+    {
+        lock_guard<mutex> guard(m_mutex_log);
+        m_logger        = logger;
+        m_has_logger    = !logger.expired();
+    }
+
+    void Log::Tick()
+    {
+        vector<LogCmd> messages;
+        shared_ptr<ILogger> logger;
+        {
+            lock_guard<mutex> guard(m_mutex_log);
+
+            logger          = m_logger.lock();
+            m_has_logger    = logger != nullptr;
+            if (!logger || m_log_buffer.empty())
+                return;
+
+            messages.swap(m_log_buffer);
+        }
+
+        for (const LogCmd& message : messages)
+        {
+            logger->Log(message.text, message.type);
+        }
+    }
+
+    void Log::Flush()
+    {
+        if (!_Log::backend_destroyed)
+        {
+            LogBackend::Get().Flush();
+        }
+    }
+
 	// Everything resolves to this
 	void Log::Write(const char* text, const Log_Type type)
 	{
@@ -53,24 +256,65 @@ namespace Spartan
             return;
         }
 
-        lock_guard<mutex> guard(m_mutex_log);
-
-        const auto log_to_file = m_logger.expired() || m_log_to_file;
+        if (!IsEnabled(type))
+            return;
 
-        if (log_to_file)
+        // Rate limit identical consecutive messages
+        thread_local _Log::RepeatState repeat;
+        const size_t hash   = std::hash<string_view>{}(string_view(text)) ^ static_cast<size_t>(type);
+        const auto now      = chrono::steady_clock::now();
+        string summary;
+        Log_Type summary_type = type;
+        if (hash == repeat.hash && (now - repeat.window_start) < _Log::repeat_window)
         {
-            m_log_buffer.emplace_back(text, type);
-            LogToFile(text, type);
+            if (++repeat.count > m_repeat_limit)
+            {
+                repeat.suppressed++;
+                return;
+            }
         }
         else
         {
-            FlushBuffer();
-            LogString(text, type);
+            if (repeat.suppressed != 0)
+            {
+                summary         = "Previous message repeated " + to_string(repeat.suppressed) + " more times";
+                summary_type    = repeat.type;
+            }
+
+            repeat.hash         = hash;
+            repeat.type         = type;
+            repeat.count        = 1;
+            repeat.suppressed   = 0;
+            repeat.window_start = now;
         }
+
+        auto write = [](const char* message, const Log_Type message_type)
+        {
+            // The backend is gone during static destruction, so write synchronously
+            if (_Log::backend_destroyed)
+            {
+                lock_guard<mutex> guard(m_mutex_log);
+                LogToFile(message, message_type);
+                m_fout.flush();
+                return;
+            }
+
+            LogBackend::Get().Push(message, message_type);
+        };
+
+        if (!summary.empty())
+        {
+            write(summary.c_str(), summary_type);
+        }
+
+        write(text, type);
 	}
 
     void Log::WriteFInfo(const char* text, ...)
 	{
+        if (!IsEnabled(Log_Info))
+            return;
+
 		char buffer[1024];
 		va_list args;
 		va_start(args, text);
@@ -82,6 +326,9 @@ namespace Spartan
 
     void Log::WriteFWarning(const char* text, ...)
 	{
+        if (!IsEnabled(Log_Warning))
+            return;
+
 		char buffer[1024];
 		va_list args;
 		va_start(args, text);
@@ -93,6 +340,9 @@ namespace Spartan
 
     void Log::WriteFError(const char* text, ...)
 	{
+        if (!IsEnabled(Log_Error))
+            return;
+
 		char buffer[1024];
 		va_list args;
 		va_start(args, text);
@@ -109,6 +359,9 @@ namespace Spartan
 
     void Log::WriteFInfo(const string text, ...)
     {
+        if (!IsEnabled(Log_Info))
+            return;
+
         char buffer[2048];
         va_list args;
         va_start(args, text);
@@ -120,6 +373,9 @@ namespace Spartan
 
     void Log::WriteFWarning(const string text, ...)
     {
+        if (!IsEnabled(Log_Warning))
+            return;
+
         char buffer[2048];
         va_list args;
         va_start(args, text);
@@ -131,6 +387,9 @@ namespace Spartan
 
     void Log::WriteFError(const string text, ...)
     {
+        if (!IsEnabled(Log_Error))
+            return;
+
         char buffer[2048];
         va_list args;
         va_start(args, text);
@@ -175,40 +434,34 @@ namespace Spartan
 		Write(value.ToString(), type);
 	}
 
-    void Log::FlushBuffer()
+    void Log::OnMessagesWritten(vector<LogCmd>& messages)
     {
-        if (m_logger.expired() || m_log_buffer.empty())
-            return;
+        lock_guard<mutex> guard(m_mutex_log);
 
-         // Log everything from memory to the logger implementation
-        for (const auto& log : m_log_buffer)
+        // Until there is a logger (or if asked to), log to file as well
+        if (m_log_to_file || !m_has_logger)
         {
-            LogString(log.text.c_str(), log.type);
+            for (const LogCmd& message : messages)
+            {
+                LogToFile(message.text.c_str(), message.type);
+            }
+            m_fout.flush();
         }
-        m_log_buffer.clear();
-    }
 
-    void Log::LogString(const char* text, const Log_Type type)
-	{
-        if (!text)
+        // Stage for the logger
+        m_log_buffer.insert(m_log_buffer.end(), make_move_iterator(messages.begin()), make_move_iterator(messages.end()));
+        if (m_log_buffer.size() > _Log::logger_buffer_max)
         {
-            LOG_ERROR_INVALID_PARAMETER();
-            return;
+            m_log_buffer.erase(m_log_buffer.begin(), m_log_buffer.begin() + (m_log_buffer.size() - _Log::logger_buffer_max));
         }
-
-		m_logger.lock()->Log(string(text), type);
-	}
+    }
 
 	void Log::LogToFile(const char* text, const Log_Type type)
     {
         if (!text)
-        {
-            LOG_ERROR_INVALID_PARAMETER();
             return;
-        }
 
 		const string prefix		= (type == Log_Info) ? "Info:" : (type == Log_Warning) ? "Warning:" : "Error:";
-		const auto final_text	= prefix + " " + text;
 
 		// Delete the previous log file (if it exists)
 		if (m_first_log)
@@ -217,16 +470,15 @@ namespace Spartan
 			m_first_log = false;
 		}
 
-		// Open/Create a log file to write the error message to
-		m_fout.open(m_log_file_name, ofstream::out | ofstream::app);
+		// Open/Create the log file once, it's kept open
+        if (!m_fout.is_open())
+        {
+		    m_fout.open(m_log_file_name, ofstream::out | ofstream::app);
+        }
 
 		if (m_fout.is_open())
 		{
-			// Write out the error message
-			m_fout << final_text << endl;
-
-			// Close the file
-			m_fout.close();
+			m_fout << prefix << " " << text << "\n";
 		}
 	}
 }
@@ -25,15 +25,35 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <string>
 #include <memory>
 #include <mutex>
+#include <atomic>
 #include <vector>
 #include "../Core/EngineDefs.h"
 //=============================
 
+// Compile time filtering, messages below this level are compiled out (0: info, 1: warning, 2: error, 3: nothing)
+#ifndef SPARTAN_LOG_LEVEL
+#define SPARTAN_LOG_LEVEL 0
+#endif
+
 namespace Spartan
 {
+    #if SPARTAN_LOG_LEVEL <= 0
     #define LOG_INFO(text, ...)	    { Spartan::Log::WriteFInfo(std::string(__FUNCTION__)    + ": " + std::string(text), __VA_ARGS__); }
+    #else
+    #define LOG_INFO(text, ...)	    {}
+    #endif
+
+    #if SPARTAN_LOG_LEVEL <= 1
     #define LOG_WARNING(text, ...)	{ Spartan::Log::WriteFWarning(std::string(__FUNCTION__) + ": " + std::string(text), __VA_ARGS__); }
+    #else
+    #define LOG_WARNING(text, ...)	{}
+    #endif
+
+    #if SPARTAN_LOG_LEVEL <= 2
     #define LOG_ERROR(text, ...)	{ Spartan::Log::WriteFError(std::string(__FUNCTION__)   + ": " + std::string(text), __VA_ARGS__); }
+    #else
+    #define LOG_ERROR(text, ...)	{}
+    #endif
 
 	// Standard errors
 	#define LOG_ERROR_GENERIC_FAILURE()		LOG_ERROR("Failed.")
@@ -73,14 +93,33 @@ namespace Spartan
         Log_Type type;
     };
 
+	/*
+	Messages are formatted on the calling thread into a lock-free, per-thread ring buffer.
+	A background thread drains the ring buffers, writes the log file and stages the
+	messages for the logger implementation, which receives them on the main thread (see Tick()).
+	*/
 	class SPARTAN_CLASS Log
 	{
 		friend class ILogger;
+        friend class LogBackend;
 	public:
         Log() = default;
 
 		// Set a logger to be used (if not set, logging will done in a text file.
-		static void SetLogger(const std::weak_ptr<ILogger>& logger) { m_logger = logger; }
+		static void SetLogger(const std::weak_ptr<ILogger>& logger);
+
+        // Runtime filtering, messages below this level are discarded before they are formatted
+        static void SetLevel(const Log_Type level)          { m_log_level = level; }
+        static Log_Type GetLevel()                          { return m_log_level; }
+
+        // Identical consecutive messages (per thread) beyond this count are dropped for a second, and then summarized
+        static void SetRepeatLimit(const uint32_t limit)    { m_repeat_limit = limit; }
+
+        // Delivers pending messages to the logger, must be called from the thread that owns it (the engine does it every tick)
+        static void Tick();
+
+        // Blocks until every message written so far has reached the log file
+        static void Flush();
 
 		// Alpha
 		static void Write(const char* text, const Log_Type type);
@@ -126,15 +165,20 @@ namespace Spartan
 		static bool m_log_to_file;     
 
 	private:
-        static void FlushBuffer();
-		static void LogString(const char* text, Log_Type type);
+        static bool IsEnabled(const Log_Type type) { return type >= m_log_level; }
 		static void LogToFile(const char* text, Log_Type type);
 
+        // Called by the background thread
+        static void OnMessagesWritten(std::vector<LogCmd>& messages);
+
         static std::mutex m_mutex_log;
 		static std::weak_ptr<ILogger> m_logger;
+        static std::atomic<bool> m_has_logger;
+        static std::atomic<Log_Type> m_log_level;
+        static std::atomic<uint32_t> m_repeat_limit;
 		static std::ofstream m_fout;	
 		static std::string m_log_file_name;
 		static bool m_first_log;
-        static std::vector<LogCmd> m_log_buffer;
+        static std::vector<LogCmd> m_log_buffer; // messages waiting for the logger
 	};
 }
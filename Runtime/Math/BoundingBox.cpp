@@ -112,18 +112,43 @@ namespace Spartan::Math
 
 	BoundingBox BoundingBox::Transform(const Matrix& transform) const
 	{
-        const Vector3 center_new = transform * GetCenter();
-        const Vector3 extent_old = GetExtents();
-        const Vector3 extend_new = Vector3
-		(
-			Abs(transform.m00) * extent_old.x + Abs(transform.m10) * extent_old.y + Abs(transform.m20) * extent_old.z,
-			Abs(transform.m01) * extent_old.x + Abs(transform.m11) * extent_old.y + Abs(transform.m21) * extent_old.z,
-			Abs(transform.m02) * extent_old.x + Abs(transform.m12) * extent_old.y + Abs(transform.m22) * extent_old.z
-		);
-
-		return BoundingBox(center_new - extend_new, center_new + extend_new);
+        BoundingBox result;
+        Transform(this, &transform, &result, 1);
+        return result;
 	}
 
+    void BoundingBox::Transform(const BoundingBox* boxes, const Matrix* transforms, BoundingBox* out, const uint32_t count)
+    {
+        const Simd::float4 half = Simd::Splat(0.5f);
+        const Simd::float4 one  = Simd::Splat(1.0f);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Simd::float4 rows[4];
+            transforms[i].LoadRows(rows);
+
+            const Simd::float4 min          = Simd::Load3(&boxes[i].m_min.x);
+            const Simd::float4 max          = Simd::Load3(&boxes[i].m_max.x);
+            const Simd::float4 extent_old   = Simd::Mul(Simd::Sub(max, min), half);
+
+            // Transform the center as a point
+            Simd::float4 center_new = Simd::TransformPoint(rows, Simd::Mul(Simd::Add(max, min), half));
+            center_new = Simd::Mul(center_new, Simd::Div(one, Simd::Splat<3>(center_new)));
+
+            // The new extent is the old one projected onto the absolute axes
+            Simd::float4 extent_new = Simd::Mul(Simd::Abs(rows[0]), Simd::Splat<0>(extent_old));
+            extent_new = Simd::Add(extent_new, Simd::Mul(Simd::Abs(rows[1]), Simd::Splat<1>(extent_old)));
+            extent_new = Simd::Add(extent_new, Simd::Mul(Simd::Abs(rows[2]), Simd::Splat<2>(extent_old)));
+
+            alignas(16) float result_min[4];
+            alignas(16) float result_max[4];
+            Simd::Store(result_min, Simd::Sub(center_new, extent_new));
+            Simd::Store(result_max, Simd::Add(center_new, extent_new));
+            out[i].m_min = Vector3(result_min[0], result_min[1], result_min[2]);
+            out[i].m_max = Vector3(result_max[0], result_max[1], result_max[2]);
+        }
+    }
+
     void BoundingBox::Merge(const BoundingBox& box)
     {
         m_min.x = Min(m_min.x, box.m_min.x);
@@ -75,6 +75,9 @@ namespace Spartan
 			// Returns a transformed bounding box
 			BoundingBox Transform(const Matrix& transform) const;
 
+			// Transforms boxes[i] by transforms[i] into out[i], in and out can alias
+			static void Transform(const BoundingBox* boxes, const Matrix* transforms, BoundingBox* out, uint32_t count);
+
 			// Merge with another bounding box
 			void Merge(const BoundingBox& box);
 
@@ -0,0 +1,255 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =======
+#include "Bvh.h"
+#include <numeric>
+#include <algorithm>
+//==================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::Math
+{
+    namespace
+    {
+        const uint32_t bin_count            = 12;
+        const uint32_t leaf_primitives_max  = 8;  // more than this and a leaf is split even when the heuristic disagrees
+        const float cost_traversal          = 1.0f; // relative to testing a primitive
+
+        Vector3 min3(const Vector3& a, const Vector3& b) { return Vector3(Min(a.x, b.x), Min(a.y, b.y), Min(a.z, b.z)); }
+        Vector3 max3(const Vector3& a, const Vector3& b) { return Vector3(Max(a.x, b.x), Max(a.y, b.y), Max(a.z, b.z)); }
+
+        float surface_area(const Vector3& min, const Vector3& max)
+        {
+            const Vector3 size = max - min;
+            return (size.x < 0.0f) ? 0.0f : 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        struct Bin
+        {
+            Vector3 min     = Vector3::Infinity;
+            Vector3 max     = Vector3::InfinityNeg;
+            uint32_t count  = 0;
+        };
+    }
+
+    void Bvh::Build(const vector<BoundingBox>& bounds)
+    {
+        Clear();
+
+        if (bounds.empty())
+            return;
+
+        const uint32_t primitive_count = static_cast<uint32_t>(bounds.size());
+
+        m_primitives.resize(primitive_count);
+        iota(m_primitives.begin(), m_primitives.end(), 0);
+
+        vector<Vector3> centroids(primitive_count);
+        for (uint32_t i = 0; i < primitive_count; i++)
+        {
+            centroids[i] = bounds[i].GetCenter();
+        }
+
+        // A binary tree with N leaves at most has 2N - 1 nodes, reserving keeps node references valid while subdividing
+        m_nodes.reserve(primitive_count * 2 - 1);
+        m_nodes.emplace_back();
+        m_nodes[0].first = 0;
+        m_nodes[0].count = primitive_count;
+
+        Subdivide(0, bounds, centroids, 0);
+
+        m_nodes.shrink_to_fit();
+    }
+
+    void Bvh::Refit(const vector<BoundingBox>& bounds)
+    {
+        if (m_nodes.empty() || bounds.size() != m_primitives.size())
+            return;
+
+        // Children always come after their parent, so going backwards visits them first
+        for (size_t i = m_nodes.size(); i-- > 0;)
+        {
+            Node& node  = m_nodes[i];
+            node.min    = Vector3::Infinity;
+            node.max    = Vector3::InfinityNeg;
+
+            if (node.count != 0)
+            {
+                for (uint32_t primitive = node.first; primitive < node.first + node.count; primitive++)
+                {
+                    const BoundingBox& primitive_bounds = bounds[m_primitives[primitive]];
+                    node.min = min3(node.min, primitive_bounds.GetMin());
+                    node.max = max3(node.max, primitive_bounds.GetMax());
+                }
+            }
+            else
+            {
+                const Node& left    = m_nodes[node.first];
+                const Node& right   = m_nodes[node.first + 1];
+                node.min            = min3(left.min, right.min);
+                node.max            = max3(left.max, right.max);
+            }
+        }
+    }
+
+    void Bvh::Clear()
+    {
+        m_nodes.clear();
+        m_nodes.shrink_to_fit();
+        m_primitives.clear();
+        m_primitives.shrink_to_fit();
+    }
+
+    void Bvh::Subdivide(const uint32_t node_index, const vector<BoundingBox>& bounds, const vector<Vector3>& centroids, const uint32_t depth)
+    {
+        Node& node = m_nodes[node_index];
+        const uint32_t first = node.first;
+        const uint32_t count = node.count;
+
+        // Node and centroid bounds
+        Vector3 centroid_min    = Vector3::Infinity;
+        Vector3 centroid_max    = Vector3::InfinityNeg;
+        node.min                = Vector3::Infinity;
+        node.max                = Vector3::InfinityNeg;
+        for (uint32_t i = first; i < first + count; i++)
+        {
+            const uint32_t primitive = m_primitives[i];
+            node.min        = min3(node.min, bounds[primitive].GetMin());
+            node.max        = max3(node.max, bounds[primitive].GetMax());
+            centroid_min    = min3(centroid_min, centroids[primitive]);
+            centroid_max    = max3(centroid_max, centroids[primitive]);
+        }
+
+        const Vector3 centroid_extent = centroid_max - centroid_min;
+        if (count <= 2 || depth + 1 >= bvh_depth_max || (centroid_extent.x <= 0.0f && centroid_extent.y <= 0.0f && centroid_extent.z <= 0.0f))
+            return; // leaf
+
+        // Find the cheapest split plane among the bin boundaries of all axes
+        float split_cost    = INFINITY;
+        uint32_t split_axis = 0;
+        uint32_t split_bin  = 0;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            const float extent = centroid_extent.Data()[axis];
+            if (extent <= 0.0f)
+                continue;
+
+            Bin bins[bin_count];
+            const float bin_scale = bin_count / extent;
+            for (uint32_t i = first; i < first + count; i++)
+            {
+                const uint32_t primitive    = m_primitives[i];
+                const uint32_t bin_index    = Min(bin_count - 1, static_cast<uint32_t>((centroids[primitive].Data()[axis] - centroid_min.Data()[axis]) * bin_scale));
+                Bin& bin                    = bins[bin_index];
+                bin.min                     = min3(bin.min, bounds[primitive].GetMin());
+                bin.max                     = max3(bin.max, bounds[primitive].GetMax());
+                bin.count++;
+            }
+
+            // Sweep from the right to get the cost of everything past each boundary, then from the left
+            float area_right[bin_count - 1];
+            uint32_t count_right[bin_count - 1];
+            {
+                Vector3 min = Vector3::Infinity;
+                Vector3 max = Vector3::InfinityNeg;
+                uint32_t sum = 0;
+                for (uint32_t i = bin_count - 1; i > 0; i--)
+                {
+                    min = min3(min, bins[i].min);
+                    max = max3(max, bins[i].max);
+                    sum += bins[i].count;
+                    area_right[i - 1]   = surface_area(min, max);
+                    count_right[i - 1]  = sum;
+                }
+            }
+
+            Vector3 min = Vector3::Infinity;
+            Vector3 max = Vector3::InfinityNeg;
+            uint32_t count_left = 0;
+            for (uint32_t i = 0; i < bin_count - 1; i++)
+            {
+                min = min3(min, bins[i].min);
+                max = max3(max, bins[i].max);
+                count_left += bins[i].count;
+
+                if (count_left == 0 || count_right[i] == 0)
+                    continue;
+
+                const float cost = count_left * surface_area(min, max) + count_right[i] * area_right[i];
+                if (cost < split_cost)
+                {
+                    split_cost  = cost;
+                    split_axis  = axis;
+                    split_bin   = i;
+                }
+            }
+        }
+
+        // Compare against testing every primitive of this node, both relative to the node's surface area
+        const float cost_leaf = static_cast<float>(count);
+        split_cost = cost_traversal + split_cost / Max(surface_area(node.min, node.max), numeric_limits<float>::min());
+        if (split_cost >= cost_leaf && count <= leaf_primitives_max)
+            return; // leaf
+
+        // Partition
+        uint32_t* begin = m_primitives.data() + first;
+        uint32_t* end   = begin + count;
+        uint32_t* middle;
+        if (split_cost != INFINITY)
+        {
+            const float bin_scale = bin_count / centroid_extent.Data()[split_axis];
+            middle = partition(begin, end, [&](const uint32_t primitive)
+            {
+                return Min(bin_count - 1, static_cast<uint32_t>((centroids[primitive].Data()[split_axis] - centroid_min.Data()[split_axis]) * bin_scale)) <= split_bin;
+            });
+        }
+        else
+        {
+            // No usable bin boundary, split at the median of the longest axis
+            const uint32_t axis = centroid_extent.x > centroid_extent.y ? (centroid_extent.x > centroid_extent.z ? 0 : 2) : (centroid_extent.y > centroid_extent.z ? 1 : 2);
+            middle = begin + count / 2;
+            nth_element(begin, middle, end, [&](const uint32_t a, const uint32_t b) { return centroids[a].Data()[axis] < centroids[b].Data()[axis]; });
+        }
+
+        const uint32_t count_left = static_cast<uint32_t>(middle - begin);
+        if (count_left == 0 || count_left == count)
+            return; // leaf
+
+        // Children
+        const uint32_t child_left = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        m_nodes.emplace_back();
+        m_nodes[child_left].first       = first;
+        m_nodes[child_left].count       = count_left;
+        m_nodes[child_left + 1].first   = first + count_left;
+        m_nodes[child_left + 1].count   = count - count_left;
+
+        node.first = child_left;
+        node.count = 0;
+
+        Subdivide(child_left, bounds, centroids, depth + 1);
+        Subdivide(child_left + 1, bounds, centroids, depth + 1);
+    }
+}
@@ -0,0 +1,164 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =============
+#include <vector>
+#include <utility>
+#include "Ray.h"
+#include "BoundingBox.h"
+//========================
+
+namespace Spartan::Math
+{
+    // Bounding volume hierarchy over primitive bounds, built with binned surface area heuristic splits.
+    // Primitives are tested by the caller during traversal, so the same structure serves entity bounds and triangles.
+    class SPARTAN_CLASS Bvh
+    {
+    public:
+        Bvh() = default;
+        ~Bvh() = default;
+
+        void Build(const std::vector<BoundingBox>& bounds);
+        void Clear();
+
+        // Updates the node bounds for primitives which moved, keeping the tree. Much cheaper than Build(), but the
+        // tree gets worse the further primitives move from where they were when it was built. Bounds have the same order as in Build().
+        void Refit(const std::vector<BoundingBox>& bounds);
+
+        // Visits the primitives whose bounds the ray hits within distance_max, nearest child first.
+        // intersect(primitive_index, distance_max) returns the hit distance, or infinity if there is no hit.
+        // With any_hit, traversal stops at the first hit. Returns the closest hit distance, or infinity if there is no hit.
+        template<typename Intersect>
+        float Trace(const Ray& ray, float distance_max, const bool any_hit, Intersect&& intersect) const
+        {
+            if (m_nodes.empty() || ray.GetLength() == 0.0f)
+                return INFINITY;
+
+            const Vector3& origin           = ray.GetStart();
+            const Vector3& direction        = ray.GetDirection();
+            const Vector3 direction_inverse = Vector3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+
+            // Entry distance into a node, or infinity if it's missed or further than the closest hit
+            const auto hit_node = [&origin, &direction_inverse](const Node& node, const float distance_closest)
+            {
+                const float x0 = (node.min.x - origin.x) * direction_inverse.x;
+                const float x1 = (node.max.x - origin.x) * direction_inverse.x;
+                const float y0 = (node.min.y - origin.y) * direction_inverse.y;
+                const float y1 = (node.max.y - origin.y) * direction_inverse.y;
+                const float z0 = (node.min.z - origin.z) * direction_inverse.z;
+                const float z1 = (node.max.z - origin.z) * direction_inverse.z;
+
+                const float entry   = Max(Max(Min(x0, x1), Min(y0, y1)), Max(Min(z0, z1), 0.0f));
+                const float exit    = Min(Min(Max(x0, x1), Max(y0, y1)), Max(z0, z1));
+
+                return (entry <= exit && entry <= distance_closest) ? entry : INFINITY;
+            };
+
+            float distance_closest = distance_max;
+            bool hit = false;
+
+            std::pair<uint32_t, float> stack[bvh_depth_max * 2];
+            uint32_t stack_size = 0;
+
+            float node_distance = hit_node(m_nodes[0], distance_closest);
+            if (node_distance != INFINITY)
+            {
+                stack[stack_size++] = { 0, node_distance };
+            }
+
+            while (stack_size != 0)
+            {
+                const std::pair<uint32_t, float> entry = stack[--stack_size];
+
+                // A closer hit may have been found since this node was pushed
+                if (entry.second > distance_closest)
+                    continue;
+
+                const Node& node = m_nodes[entry.first];
+
+                // Leaf
+                if (node.count != 0)
+                {
+                    for (uint32_t i = node.first; i < node.first + node.count; i++)
+                    {
+                        const float distance = intersect(m_primitives[i], distance_closest);
+                        if (distance != INFINITY && distance <= distance_closest)
+                        {
+                            distance_closest    = distance;
+                            hit                 = true;
+
+                            if (any_hit)
+                                return distance_closest;
+                        }
+                    }
+
+                    continue;
+                }
+
+                // Interior, push the far child first so that the near one is visited next
+                uint32_t child_near         = node.first;
+                uint32_t child_far          = node.first + 1;
+                float child_near_distance   = hit_node(m_nodes[child_near], distance_closest);
+                float child_far_distance    = hit_node(m_nodes[child_far], distance_closest);
+                if (child_far_distance < child_near_distance)
+                {
+                    std::swap(child_near, child_far);
+                    std::swap(child_near_distance, child_far_distance);
+                }
+
+                if (child_far_distance != INFINITY)
+                {
+                    stack[stack_size++] = { child_far, child_far_distance };
+                }
+
+                if (child_near_distance != INFINITY)
+                {
+                    stack[stack_size++] = { child_near, child_near_distance };
+                }
+            }
+
+            return hit ? distance_closest : INFINITY;
+        }
+
+        bool IsEmpty()              const { return m_nodes.empty(); }
+        uint32_t GetNodeCount()     const { return static_cast<uint32_t>(m_nodes.size()); }
+        uint64_t GetMemoryUsage()   const { return m_nodes.size() * sizeof(Node) + m_primitives.size() * sizeof(uint32_t); }
+
+    private:
+        // Deeper nodes become leaves, which keeps the traversal stack fixed
+        static const uint32_t bvh_depth_max = 64;
+
+        struct Node
+        {
+            Vector3 min;
+            uint32_t first = 0; // leaves: first primitive, interior nodes: left child (the right one follows it)
+            Vector3 max;
+            uint32_t count = 0; // primitive count, 0 for interior nodes
+        };
+
+        void Subdivide(uint32_t node_index, const std::vector<BoundingBox>& bounds, const std::vector<Vector3>& centroids, uint32_t depth);
+
+        std::vector<Node> m_nodes;
+        std::vector<uint32_t> m_primitives; // primitive indices, leaves reference ranges of it
+    };
+}
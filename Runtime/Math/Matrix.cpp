@@ -37,6 +37,54 @@ namespace Spartan::Math
 		0, 0, 0, 1
 	);
 
+	void Matrix::Multiply(const Matrix* lhs, const Matrix& rhs, Matrix* out, const uint32_t count)
+	{
+        Simd::float4 rhs_columns[4];
+        rhs.LoadColumns(rhs_columns);
+
+        // The right hand side is the same for all, so broadcast the left hand side columns instead
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Simd::float4 lhs_columns[4];
+            Simd::float4 result_columns[4];
+            lhs[i].LoadColumns(lhs_columns);
+            Simd::MatrixMultiply(lhs_columns, rhs_columns, result_columns);
+            out[i].StoreColumns(result_columns);
+        }
+	}
+
+	void Matrix::Multiply(const Matrix* lhs, const Matrix* rhs, Matrix* out, const uint32_t count)
+	{
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Simd::float4 lhs_columns[4];
+            Simd::float4 rhs_columns[4];
+            Simd::float4 result_columns[4];
+            lhs[i].LoadColumns(lhs_columns);
+            rhs[i].LoadColumns(rhs_columns);
+            Simd::MatrixMultiply(lhs_columns, rhs_columns, result_columns);
+            out[i].StoreColumns(result_columns);
+        }
+	}
+
+	void Matrix::TransformPoints(const Matrix& transform, const Vector3* points, Vector3* out, const uint32_t count)
+	{
+        // Transpose once for the whole batch
+        Simd::float4 rows[4];
+        transform.LoadRows(rows);
+        const Simd::float4 one = Simd::Splat(1.0f);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Simd::float4 v = Simd::TransformPoint(rows, Simd::Load3(&points[i].x));
+            v = Simd::Mul(v, Simd::Div(one, Simd::Splat<3>(v)));
+
+            alignas(16) float result[4];
+            Simd::Store(result, v);
+            out[i] = Vector3(result[0], result[1], result[2]);
+        }
+	}
+
 	string Matrix::ToString() const
 	{
 		char tempBuffer[200];
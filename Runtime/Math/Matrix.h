@@ -25,11 +25,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Quaternion.h"
 #include "Vector3.h"
 #include "Vector4.h"
+#include "Simd.h"
 //=====================
 
 namespace Spartan::Math
 {
-	class SPARTAN_CLASS Matrix
+	class SPARTAN_CLASS alignas(16) Matrix
 	{
 	public:
 		Matrix()
@@ -61,10 +62,13 @@ namespace Spartan::Math
 		{
             const Matrix mRotation = CreateRotation(rotation);
 
-			m00 = scale.x * mRotation.m00;  m01 = scale.x * mRotation.m01;  m02 = scale.x * mRotation.m02;  m03 = 0.0f;
-			m10 = scale.y * mRotation.m10;  m11 = scale.y * mRotation.m11;  m12 = scale.y * mRotation.m12;  m13 = 0.0f;
-			m20 = scale.z * mRotation.m20;  m21 = scale.z * mRotation.m21;  m22 = scale.z * mRotation.m22;  m23 = 0.0f;
-			m30 = translation.x;            m31 = translation.y;            m32 = translation.z;            m33 = 1.0f;
+            // Row i is scaled by scale[i], so every column is scaled by (x, y, z) and carries the translation in w
+            const Simd::float4 scale_xyz = Simd::Set(scale.x, scale.y, scale.z, 1.0f);
+            float* data = &m00;
+            Simd::Store(data + 0,  Simd::Mul(Simd::Set(mRotation.m00, mRotation.m10, mRotation.m20, translation.x), scale_xyz));
+            Simd::Store(data + 4,  Simd::Mul(Simd::Set(mRotation.m01, mRotation.m11, mRotation.m21, translation.y), scale_xyz));
+            Simd::Store(data + 8,  Simd::Mul(Simd::Set(mRotation.m02, mRotation.m12, mRotation.m22, translation.z), scale_xyz));
+            Simd::Store(data + 12, Simd::Set(0.0f, 0.0f, 0.0f, 1.0f));
 		}
 
         ~Matrix() = default;
@@ -286,59 +290,13 @@ namespace Spartan::Math
         [[nodiscard]] Matrix Inverted() const { return Invert(*this); }
 		static Matrix Invert(const Matrix& matrix)
 		{
-			float v0 = matrix.m20 * matrix.m31 - matrix.m21 * matrix.m30;
-			float v1 = matrix.m20 * matrix.m32 - matrix.m22 * matrix.m30;
-			float v2 = matrix.m20 * matrix.m33 - matrix.m23 *matrix.m30;
-			float v3 = matrix.m21 * matrix.m32 - matrix.m22 * matrix.m31;
-			float v4 = matrix.m21 * matrix.m33 - matrix.m23 * matrix.m31;
-			float v5 = matrix.m22 * matrix.m33 - matrix.m23 * matrix.m32;
-
-			float i00 = (v5 * matrix.m11 - v4 * matrix.m12 + v3 * matrix.m13);
-			float i10 = -(v5 * matrix.m10 - v2 * matrix.m12 + v1 * matrix.m13);
-			float i20 = (v4 * matrix.m10 - v2 * matrix.m11 + v0 * matrix.m13);
-			float i30 = -(v3 * matrix.m10 - v1 * matrix.m11 + v0 * matrix.m12);
-
-            const float invDet = 1.0f / (i00 * matrix.m00 + i10 * matrix.m01 + i20 * matrix.m02 + i30 * matrix.m03);
-
-			i00 *= invDet;
-			i10 *= invDet;
-			i20 *= invDet;
-			i30 *= invDet;
-
-            const float i01 = -(v5 * matrix.m01 - v4 * matrix.m02 + v3 * matrix.m03) * invDet;
-            const float i11 = (v5 * matrix.m00 - v2 * matrix.m02 + v1 * matrix.m03) * invDet;
-            const float i21 = -(v4 * matrix.m00 - v2 * matrix.m01 + v0 * matrix.m03) * invDet;
-            const float i31 = (v3 * matrix.m00 - v1 * matrix.m01 + v0 * matrix.m02) * invDet;
-
-			v0 = matrix.m10 * matrix.m31 - matrix.m11 * matrix.m30;
-			v1 = matrix.m10 * matrix.m32 - matrix.m12 * matrix.m30;
-			v2 = matrix.m10 * matrix.m33 - matrix.m13 * matrix.m30;
-			v3 = matrix.m11 * matrix.m32 - matrix.m12 * matrix.m31;
-			v4 = matrix.m11 * matrix.m33 - matrix.m13 * matrix.m31;
-			v5 = matrix.m12 * matrix.m33 - matrix.m13 * matrix.m32;
-
-            const float i02 = (v5 * matrix.m01 - v4 * matrix.m02 + v3 * matrix.m03) * invDet;
-            const float i12 = -(v5 * matrix.m00 - v2 * matrix.m02 + v1 * matrix.m03) * invDet;
-            const float i22 = (v4 * matrix.m00 - v2 * matrix.m01 + v0 * matrix.m03) * invDet;
-            const float i32 = -(v3 * matrix.m00 - v1 * matrix.m01 + v0 * matrix.m02) * invDet;
-
-			v0 = matrix.m21 * matrix.m10 - matrix.m20 * matrix.m11;
-			v1 = matrix.m22 * matrix.m10 - matrix.m20 * matrix.m12;
-			v2 = matrix.m23 * matrix.m10 - matrix.m20 * matrix.m13;
-			v3 = matrix.m22 * matrix.m11 - matrix.m21 * matrix.m12;
-			v4 = matrix.m23 * matrix.m11 - matrix.m21 * matrix.m13;
-			v5 = matrix.m23 * matrix.m12 - matrix.m22 * matrix.m13;
-
-            const float i03 = -(v5 * matrix.m01 - v4 * matrix.m02 + v3 * matrix.m03) * invDet;
-            const float i13 = (v5 * matrix.m00 - v2 * matrix.m02 + v1 * matrix.m03) * invDet;
-            const float i23 = -(v4 * matrix.m00 - v2 * matrix.m01 + v0 * matrix.m03) * invDet;
-            const float i33 = (v3 * matrix.m00 - v1 * matrix.m01 + v0 * matrix.m02) * invDet;
+            Simd::float4 columns[4];
+            matrix.LoadColumns(columns);
+            Simd::MatrixInverse(columns, columns);
 
-			return Matrix(
-				i00, i01, i02, i03,
-				i10, i11, i12, i13,
-				i20, i21, i22, i23,
-				i30, i31, i32, i33);
+            Matrix inverse;
+            inverse.StoreColumns(columns);
+            return inverse;
 		}
 		//================================================================================================
 
@@ -360,50 +318,53 @@ namespace Spartan::Math
 		//= MULTIPLICATION ================================================================================================================
 		Matrix operator*(const Matrix& rhs) const
 		{
-			return Matrix(
-				m00 * rhs.m00 + m01 * rhs.m10 + m02 * rhs.m20 + m03 * rhs.m30,
-				m00 * rhs.m01 + m01 * rhs.m11 + m02 * rhs.m21 + m03 * rhs.m31,
-				m00 * rhs.m02 + m01 * rhs.m12 + m02 * rhs.m22 + m03 * rhs.m32,
-				m00 * rhs.m03 + m01 * rhs.m13 + m02 * rhs.m23 + m03 * rhs.m33,
-				m10 * rhs.m00 + m11 * rhs.m10 + m12 * rhs.m20 + m13 * rhs.m30,
-				m10 * rhs.m01 + m11 * rhs.m11 + m12 * rhs.m21 + m13 * rhs.m31,
-				m10 * rhs.m02 + m11 * rhs.m12 + m12 * rhs.m22 + m13 * rhs.m32,
-				m10 * rhs.m03 + m11 * rhs.m13 + m12 * rhs.m23 + m13 * rhs.m33,
-				m20 * rhs.m00 + m21 * rhs.m10 + m22 * rhs.m20 + m23 * rhs.m30,
-				m20 * rhs.m01 + m21 * rhs.m11 + m22 * rhs.m21 + m23 * rhs.m31,
-				m20 * rhs.m02 + m21 * rhs.m12 + m22 * rhs.m22 + m23 * rhs.m32,
-				m20 * rhs.m03 + m21 * rhs.m13 + m22 * rhs.m23 + m23 * rhs.m33,
-				m30 * rhs.m00 + m31 * rhs.m10 + m32 * rhs.m20 + m33 * rhs.m30,
-				m30 * rhs.m01 + m31 * rhs.m11 + m32 * rhs.m21 + m33 * rhs.m31,
-				m30 * rhs.m02 + m31 * rhs.m12 + m32 * rhs.m22 + m33 * rhs.m32,
-				m30 * rhs.m03 + m31 * rhs.m13 + m32 * rhs.m23 + m33 * rhs.m33
-			);
+            Simd::float4 lhs_columns[4];
+            Simd::float4 rhs_columns[4];
+            Simd::float4 result_columns[4];
+            LoadColumns(lhs_columns);
+            rhs.LoadColumns(rhs_columns);
+            Simd::MatrixMultiply(lhs_columns, rhs_columns, result_columns);
+
+            Matrix result;
+            result.StoreColumns(result_columns);
+            return result;
 		}
 
 		void operator*=(const Matrix& rhs) { (*this) = (*this) * rhs; }
 
 		Vector3 operator*(const Vector3& rhs) const
 		{
-			Vector4 vWorking;
+            Simd::float4 rows[4];
+            LoadRows(rows);
 
-			vWorking.x = (rhs.x * m00) + (rhs.y * m10) + (rhs.z * m20) + m30;
-			vWorking.y = (rhs.x * m01) + (rhs.y * m11) + (rhs.z * m21) + m31;
-			vWorking.z = (rhs.x * m02) + (rhs.y * m12) + (rhs.z * m22) + m32;
-			vWorking.w = 1 / ((rhs.x * m03) + (rhs.y * m13) + (rhs.z * m23) + m33);
+            Simd::float4 v = Simd::TransformPoint(rows, Simd::Load3(&rhs.x));
+            v = Simd::Mul(v, Simd::Div(Simd::Splat(1.0f), Simd::Splat<3>(v)));
 
-			return Vector3(vWorking.x * vWorking.w, vWorking.y * vWorking.w, vWorking.z * vWorking.w);
+            alignas(16) float result[4];
+            Simd::Store(result, v);
+			return Vector3(result[0], result[1], result[2]);
 		}
 
         Vector4 operator*(const Vector4& rhs) const
         {
-            return Vector4
-            (
-                (rhs.x * m00) + (rhs.y * m10) + (rhs.z * m20) + (rhs.w * m30),
-                (rhs.x * m01) + (rhs.y * m11) + (rhs.z * m21) + (rhs.w * m31),
-                (rhs.x * m02) + (rhs.y * m12) + (rhs.z * m22) + (rhs.w * m32),
-                (rhs.x * m03) + (rhs.y * m13) + (rhs.z * m23) + (rhs.w * m33)
-            );
+            Simd::float4 rows[4];
+            LoadRows(rows);
+
+            Vector4 result;
+            Simd::StoreUnaligned(&result.x, Simd::TransformVector4(rows, Simd::LoadUnaligned(&rhs.x)));
+            return result;
         }
+
+        //= BATCH =================================================================================================================
+        // out[i] = lhs[i] * rhs, e.g. world matrices into world-view-projection matrices
+        static void Multiply(const Matrix* lhs, const Matrix& rhs, Matrix* out, uint32_t count);
+
+        // out[i] = lhs[i] * rhs[i]
+        static void Multiply(const Matrix* lhs, const Matrix* rhs, Matrix* out, uint32_t count);
+
+        // out[i] = points[i] * transform, with the perspective divide, in and out can alias
+        static void TransformPoints(const Matrix& transform, const Vector3* points, Vector3* out, uint32_t count);
+        //=========================================================================================================================
 		//=================================================================================================================================
 
 		//= COMPARISON =================================================
@@ -427,7 +388,32 @@ namespace Spartan::Math
         [[nodiscard]] const float* Data() const { return &m00; }
         [[nodiscard]] std::string ToString() const;
 
-		// Column-major memory representation 
+        // Column j is (m0j, m1j, m2j, m3j), which is how the matrix is laid out in memory
+        void LoadColumns(Simd::float4 columns[4]) const
+        {
+            const float* data = Data();
+            columns[0] = Simd::Load(data + 0);
+            columns[1] = Simd::Load(data + 4);
+            columns[2] = Simd::Load(data + 8);
+            columns[3] = Simd::Load(data + 12);
+        }
+
+        void LoadRows(Simd::float4 rows[4]) const
+        {
+            LoadColumns(rows);
+            Simd::Transpose(rows[0], rows[1], rows[2], rows[3]);
+        }
+
+        void StoreColumns(const Simd::float4 columns[4])
+        {
+            float* data = &m00;
+            Simd::Store(data + 0,  columns[0]);
+            Simd::Store(data + 4,  columns[1]);
+            Simd::Store(data + 8,  columns[2]);
+            Simd::Store(data + 12, columns[3]);
+        }
+
+		// Column-major memory representation, 16 byte aligned so that every column is a single SIMD load
 		float m00{}, m10{}, m20{}, m30{};
 		float m01{}, m11{}, m21{}, m31{};
 		float m02{}, m12{}, m22{}, m32{};
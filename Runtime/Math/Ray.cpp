@@ -21,13 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==============================
 #include "Ray.h"
-#include <algorithm>
 #include "RayHit.h"
+#include "Vector2.h"
+#include "BoundingBox.h"
 #include "../Core/Context.h"
 #include "../World/World.h"
-#include "../World/Entity.h"
-#include "../World/Components/Environment.h"
-#include "../World/Components/Renderable.h"
 //=========================================
 
 //= NAMESPACES =====
@@ -47,40 +45,7 @@ namespace Spartan::Math
 
 	vector<RayHit> Ray::Trace(Context* context) const
 	{
-		// Find all the entities that the ray hits
-		vector<RayHit> hits;
-		const auto& entities = context->GetSubsystem<World>()->EntityGetAll();
-		for (const auto& entity : entities)
-		{
-			// Make sure there entity has a renderable
-			if (!entity->HasComponent<Renderable>())
-				continue;
-
-			// Get object oriented bounding box
-			const auto& aabb = entity->GetComponent<Renderable>()->GetAabb();
-
-			// Compute hit distance
-			auto distance = HitDistance(aabb);
-
-			// Don't store hit data if there was no hit
-			if (distance == INFINITY)
-				continue;
-
-			hits.emplace_back(
-                entity,                             // Entity
-                m_start + distance * m_direction,   // Position
-                distance,                           // Distance
-                distance == 0.0f                    // Inside
-            );
-		}
-
-		// Sort by distance (ascending)
-		sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b)
-		{
-			return a.m_distance < b.m_distance;
-		});
-
-		return hits;
+		return context->GetSubsystem<World>()->RayTraceAll(*this);
 	}
 
 	float Ray::HitDistance(const BoundingBox& box) const
@@ -175,4 +140,40 @@ namespace Spartan::Math
 
 		return dist;
 	}
+
+	float Ray::HitDistance(const Vector3& v0, const Vector3& v1, const Vector3& v2, Vector2* barycentrics /*= nullptr*/) const
+	{
+		// Moller-Trumbore
+		const Vector3 edge_1	= v1 - v0;
+		const Vector3 edge_2	= v2 - v0;
+		const Vector3 p			= Vector3::Cross(m_direction, edge_2);
+		const float determinant	= Vector3::Dot(edge_1, p);
+
+		// Parallel to the triangle (or degenerate triangle)
+		if (determinant == 0.0f)
+			return INFINITY;
+
+		const float determinant_inverse = 1.0f / determinant;
+
+		const Vector3 t = m_start - v0;
+		const float u	= Vector3::Dot(t, p) * determinant_inverse;
+		if (u < 0.0f || u > 1.0f)
+			return INFINITY;
+
+		const Vector3 q	= Vector3::Cross(t, edge_1);
+		const float v	= Vector3::Dot(m_direction, q) * determinant_inverse;
+		if (v < 0.0f || u + v > 1.0f)
+			return INFINITY;
+
+		const float distance = Vector3::Dot(edge_2, q) * determinant_inverse;
+		if (distance < 0.0f)
+			return INFINITY;
+
+		if (barycentrics)
+		{
+			*barycentrics = Vector2(u, v);
+		}
+
+		return distance;
+	}
 }
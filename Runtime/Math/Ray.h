@@ -35,6 +35,7 @@ namespace Spartan
 	{
 		class RayHit;
 		class BoundingBox;
+		class Vector2;
 
 		class SPARTAN_CLASS Ray
 		{
@@ -43,12 +44,15 @@ namespace Spartan
 			Ray(const Vector3& start, const Vector3& end);
 			~Ray() = default;
 
-			// Traces a ray against all entities in the world, returns all hits in a vector.
+			// Traces a ray against all entities in the world, returns all hits sorted by distance (see World::RayTraceAll).
 			std::vector<RayHit> Trace(Context* context) const;
 
 			// Returns hit distance to a bounding box, or infinity if there is no hit.
 			float HitDistance(const BoundingBox& box) const;
 
+			// Returns hit distance to a triangle (either side), or infinity if there is no hit. Barycentrics are the weights of v1 and v2.
+			float HitDistance(const Vector3& v0, const Vector3& v1, const Vector3& v2, Vector2* barycentrics = nullptr) const;
+
 			const auto& GetStart()      const { return m_start; }
 			const auto& GetEnd()        const { return m_end; }
             const auto& GetLength()     const { return m_length; }
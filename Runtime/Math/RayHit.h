@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==================
 #include <memory>
+#include "Vector2.h"
+#include "Vector3.h"
 #include "../Core/EngineDefs.h"
 //=============================
 
@@ -35,18 +37,23 @@ namespace Spartan
 		class SPARTAN_CLASS RayHit
 		{
 		public:
-			RayHit(const std::shared_ptr<Entity>& entity, const Vector3& position, float distance, bool is_inside)
+			RayHit() = default;
+			RayHit(const std::shared_ptr<Entity>& entity, const Vector3& position, float distance, bool is_inside, uint32_t triangle_index = 0, const Vector2& barycentrics = Vector2::Zero)
 			{
-				m_entity	= entity;
-                m_position  = position;
-				m_distance	= distance;
-				m_inside	= is_inside;
+				m_entity			= entity;
+                m_position			= position;
+				m_distance			= distance;
+				m_inside			= is_inside;
+				m_triangle_index	= triangle_index;
+				m_barycentrics		= barycentrics;
 			};
 
 			std::shared_ptr<Entity> m_entity;
             Vector3 m_position;
-			float m_distance;
-			bool m_inside;
+			float m_distance			= INFINITY;
+			bool m_inside				= false;
+			uint32_t m_triangle_index	= 0;			// within the renderable's index range, only meaningful for triangle hits
+			Vector2 m_barycentrics;						// weights of the triangle's second and third vertices
 		};
 	}
 }
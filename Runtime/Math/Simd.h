@@ -0,0 +1,231 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+// Thin 4-wide float abstraction used by the math classes. Every backend performs
+// the same IEEE operations in the same order as the scalar code it replaces, so
+// results match the scalar path (products, transforms) or stay within a few ULP
+// (inverse, which uses a different cofactor expansion).
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #define SPARTAN_SIMD_SSE2
+    #include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+    #define SPARTAN_SIMD_NEON
+    #include <arm_neon.h>
+#else
+    #define SPARTAN_SIMD_SCALAR
+    #include <cmath>
+#endif
+
+namespace Spartan::Math::Simd
+{
+#if defined(SPARTAN_SIMD_SSE2)
+    using float4 = __m128;
+
+    inline float4 Load(const float* p)                          { return _mm_load_ps(p); }
+    inline float4 LoadUnaligned(const float* p)                 { return _mm_loadu_ps(p); }
+    inline float4 Load3(const float* p)                         { return _mm_setr_ps(p[0], p[1], p[2], 0.0f); }
+    inline void Store(float* p, const float4 v)                 { _mm_store_ps(p, v); }
+    inline void StoreUnaligned(float* p, const float4 v)        { _mm_storeu_ps(p, v); }
+    inline float4 Set(float x, float y, float z, float w)       { return _mm_setr_ps(x, y, z, w); }
+    inline float4 Splat(const float x)                          { return _mm_set1_ps(x); }
+    inline float4 Add(const float4 a, const float4 b)           { return _mm_add_ps(a, b); }
+    inline float4 Sub(const float4 a, const float4 b)           { return _mm_sub_ps(a, b); }
+    inline float4 Mul(const float4 a, const float4 b)           { return _mm_mul_ps(a, b); }
+    inline float4 Div(const float4 a, const float4 b)           { return _mm_div_ps(a, b); }
+    inline float4 Min(const float4 a, const float4 b)           { return _mm_min_ps(a, b); }
+    inline float4 Max(const float4 a, const float4 b)           { return _mm_max_ps(a, b); }
+    inline float4 Abs(const float4 a)                           { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+    // Returns (a[x], a[y], b[z], b[w]), same semantics as _mm_shuffle_ps
+    template<int x, int y, int z, int w>
+    inline float4 Shuffle(const float4 a, const float4 b)       { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x)); }
+
+    inline void Transpose(float4& r0, float4& r1, float4& r2, float4& r3) { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+
+#elif defined(SPARTAN_SIMD_NEON)
+    using float4 = float32x4_t;
+
+    inline float4 Load(const float* p)                          { return vld1q_f32(p); }
+    inline float4 LoadUnaligned(const float* p)                 { return vld1q_f32(p); }
+    inline float4 Load3(const float* p)                         { return vsetq_lane_f32(0.0f, vcombine_f32(vld1_f32(p), vld1_dup_f32(p + 2)), 3); }
+    inline void Store(float* p, const float4 v)                 { vst1q_f32(p, v); }
+    inline void StoreUnaligned(float* p, const float4 v)        { vst1q_f32(p, v); }
+    inline float4 Set(float x, float y, float z, float w)       { const float v[4] = { x, y, z, w }; return vld1q_f32(v); }
+    inline float4 Splat(const float x)                          { return vdupq_n_f32(x); }
+    inline float4 Add(const float4 a, const float4 b)           { return vaddq_f32(a, b); }
+    inline float4 Sub(const float4 a, const float4 b)           { return vsubq_f32(a, b); }
+    inline float4 Mul(const float4 a, const float4 b)           { return vmulq_f32(a, b); }
+    inline float4 Div(const float4 a, const float4 b)           { return vdivq_f32(a, b); }
+    inline float4 Min(const float4 a, const float4 b)           { return vminq_f32(a, b); }
+    inline float4 Max(const float4 a, const float4 b)           { return vmaxq_f32(a, b); }
+    inline float4 Abs(const float4 a)                           { return vabsq_f32(a); }
+
+    template<int x, int y, int z, int w>
+    inline float4 Shuffle(const float4 a, const float4 b)
+    {
+        float4 r = vdupq_n_f32(vgetq_lane_f32(a, x));
+        r = vsetq_lane_f32(vgetq_lane_f32(a, y), r, 1);
+        r = vsetq_lane_f32(vgetq_lane_f32(b, z), r, 2);
+        r = vsetq_lane_f32(vgetq_lane_f32(b, w), r, 3);
+        return r;
+    }
+
+    inline void Transpose(float4& r0, float4& r1, float4& r2, float4& r3)
+    {
+        const float32x4x2_t t0 = vzipq_f32(r0, r2);
+        const float32x4x2_t t1 = vzipq_f32(r1, r3);
+        const float32x4x2_t u0 = vzipq_f32(t0.val[0], t1.val[0]);
+        const float32x4x2_t u1 = vzipq_f32(t0.val[1], t1.val[1]);
+        r0 = u0.val[0]; r1 = u0.val[1]; r2 = u1.val[0]; r3 = u1.val[1];
+    }
+
+#else
+    struct float4 { float v[4]; };
+
+    inline float4 Load(const float* p)                          { return { { p[0], p[1], p[2], p[3] } }; }
+    inline float4 LoadUnaligned(const float* p)                 { return Load(p); }
+    inline float4 Load3(const float* p)                         { return { { p[0], p[1], p[2], 0.0f } }; }
+    inline void Store(float* p, const float4 v)                 { for (int i = 0; i < 4; i++) p[i] = v.v[i]; }
+    inline void StoreUnaligned(float* p, const float4 v)        { Store(p, v); }
+    inline float4 Set(float x, float y, float z, float w)       { return { { x, y, z, w } }; }
+    inline float4 Splat(const float x)                          { return { { x, x, x, x } }; }
+    inline float4 Add(const float4 a, const float4 b)           { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+    inline float4 Sub(const float4 a, const float4 b)           { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+    inline float4 Mul(const float4 a, const float4 b)           { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+    inline float4 Div(const float4 a, const float4 b)           { return { { a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3] } }; }
+    inline float4 Min(const float4 a, const float4 b)           { return { { fminf(a.v[0], b.v[0]), fminf(a.v[1], b.v[1]), fminf(a.v[2], b.v[2]), fminf(a.v[3], b.v[3]) } }; }
+    inline float4 Max(const float4 a, const float4 b)           { return { { fmaxf(a.v[0], b.v[0]), fmaxf(a.v[1], b.v[1]), fmaxf(a.v[2], b.v[2]), fmaxf(a.v[3], b.v[3]) } }; }
+    inline float4 Abs(const float4 a)                           { return { { fabsf(a.v[0]), fabsf(a.v[1]), fabsf(a.v[2]), fabsf(a.v[3]) } }; }
+
+    template<int x, int y, int z, int w>
+    inline float4 Shuffle(const float4 a, const float4 b)       { return { { a.v[x], a.v[y], b.v[z], b.v[w] } }; }
+
+    inline void Transpose(float4& r0, float4& r1, float4& r2, float4& r3)
+    {
+        const float4 t0 = r0, t1 = r1, t2 = r2, t3 = r3;
+        r0 = { { t0.v[0], t1.v[0], t2.v[0], t3.v[0] } };
+        r1 = { { t0.v[1], t1.v[1], t2.v[1], t3.v[1] } };
+        r2 = { { t0.v[2], t1.v[2], t2.v[2], t3.v[2] } };
+        r3 = { { t0.v[3], t1.v[3], t2.v[3], t3.v[3] } };
+    }
+#endif
+
+    // Broadcasts one lane to all four
+    template<int i>
+    inline float4 Splat(const float4 a) { return Shuffle<i, i, i, i>(a, a); }
+
+    //= 4x4 MATRIX KERNELS =========================================================================
+    // Matrices are passed as four float4 holding the four memory columns of Math::Matrix,
+    // i.e. column j is (m0j, m1j, m2j, m3j).
+
+    // out = a * b, column j of the result is a.col0 * b.m0j + a.col1 * b.m1j + a.col2 * b.m2j + a.col3 * b.m3j
+    inline void MatrixMultiply(const float4 a[4], const float4 b[4], float4 out[4])
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            float4 c = Mul(a[0], Splat<0>(b[j]));
+            c = Add(c, Mul(a[1], Splat<1>(b[j])));
+            c = Add(c, Mul(a[2], Splat<2>(b[j])));
+            c = Add(c, Mul(a[3], Splat<3>(b[j])));
+            out[j] = c;
+        }
+    }
+
+    // Row i of the matrix is (mi0, mi1, mi2, mi3), this is what point transforms want
+    inline void MatrixRows(const float4 columns[4], float4 rows[4])
+    {
+        rows[0] = columns[0]; rows[1] = columns[1]; rows[2] = columns[2]; rows[3] = columns[3];
+        Transpose(rows[0], rows[1], rows[2], rows[3]);
+    }
+
+    // (x, y, z, w) * M, with w implicitly 1 when transforming points
+    inline float4 TransformPoint(const float4 rows[4], const float4 point)
+    {
+        float4 r = Mul(Splat<0>(point), rows[0]);
+        r = Add(r, Mul(Splat<1>(point), rows[1]));
+        r = Add(r, Mul(Splat<2>(point), rows[2]));
+        return Add(r, rows[3]);
+    }
+
+    inline float4 TransformVector4(const float4 rows[4], const float4 v)
+    {
+        float4 r = Mul(Splat<0>(v), rows[0]);
+        r = Add(r, Mul(Splat<1>(v), rows[1]));
+        r = Add(r, Mul(Splat<2>(v), rows[2]));
+        return Add(r, Mul(Splat<3>(v), rows[3]));
+    }
+
+    // General inverse using 2x2 block sub-matrices. The inverse of the transpose is the transpose
+    // of the inverse, so this works on columns just as well as on rows.
+    inline void MatrixInverse(const float4 m[4], float4 out[4])
+    {
+        // 2x2 helpers, each float4 holds a 2x2 matrix as (m00, m01, m10, m11)
+        const auto mat2_mul     = [](const float4 a, const float4 b) { return Add(Mul(a, Shuffle<0, 3, 0, 3>(b, b)), Mul(Shuffle<1, 0, 3, 2>(a, a), Shuffle<2, 1, 2, 1>(b, b))); };
+        const auto mat2_adj_mul = [](const float4 a, const float4 b) { return Sub(Mul(Shuffle<3, 3, 0, 0>(a, a), b), Mul(Shuffle<1, 1, 2, 2>(a, a), Shuffle<2, 3, 0, 1>(b, b))); };
+        const auto mat2_mul_adj = [](const float4 a, const float4 b) { return Sub(Mul(a, Shuffle<3, 0, 3, 0>(b, b)), Mul(Shuffle<1, 0, 3, 2>(a, a), Shuffle<2, 1, 2, 1>(b, b))); };
+
+        // Sub-matrices
+        const float4 a = Shuffle<0, 1, 0, 1>(m[0], m[1]);
+        const float4 b = Shuffle<2, 3, 2, 3>(m[0], m[1]);
+        const float4 c = Shuffle<0, 1, 0, 1>(m[2], m[3]);
+        const float4 d = Shuffle<2, 3, 2, 3>(m[2], m[3]);
+
+        // Determinants of the sub-matrices as (|a|, |b|, |c|, |d|)
+        const float4 det_sub = Sub
+        (
+            Mul(Shuffle<0, 2, 0, 2>(m[0], m[2]), Shuffle<1, 3, 1, 3>(m[1], m[3])),
+            Mul(Shuffle<1, 3, 1, 3>(m[0], m[2]), Shuffle<0, 2, 0, 2>(m[1], m[3]))
+        );
+        const float4 det_a = Splat<0>(det_sub);
+        const float4 det_b = Splat<1>(det_sub);
+        const float4 det_c = Splat<2>(det_sub);
+        const float4 det_d = Splat<3>(det_sub);
+
+        const float4 d_c = mat2_adj_mul(d, c);
+        const float4 a_b = mat2_adj_mul(a, b);
+        float4 x = Sub(Mul(det_d, a), mat2_mul(b, d_c));
+        float4 w = Sub(Mul(det_a, d), mat2_mul(c, a_b));
+        float4 y = Sub(Mul(det_b, c), mat2_mul_adj(d, a_b));
+        float4 z = Sub(Mul(det_c, b), mat2_mul_adj(a, d_c));
+
+        // |m| = |a| * |d| + |b| * |c| - trace(a_b * d_c)
+        float4 trace = Mul(a_b, Shuffle<0, 2, 1, 3>(d_c, d_c));
+        trace = Add(trace, Shuffle<2, 3, 0, 1>(trace, trace));
+        trace = Add(trace, Shuffle<1, 0, 3, 2>(trace, trace));
+        const float4 det = Sub(Add(Mul(det_a, det_d), Mul(det_b, det_c)), trace);
+
+        const float4 det_rcp = Div(Set(1.0f, -1.0f, -1.0f, 1.0f), det);
+        x = Mul(x, det_rcp);
+        y = Mul(y, det_rcp);
+        z = Mul(z, det_rcp);
+        w = Mul(w, det_rcp);
+
+        // Apply the adjugate shuffle and re-assemble
+        out[0] = Shuffle<3, 1, 3, 1>(x, y);
+        out[1] = Shuffle<2, 0, 2, 0>(x, y);
+        out[2] = Shuffle<3, 1, 3, 1>(z, w);
+        out[3] = Shuffle<2, 0, 2, 0>(z, w);
+    }
+    //==============================================================================================
+}
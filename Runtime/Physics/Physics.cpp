@@ -225,4 +225,15 @@ namespace Spartan
 		}
 		return gravity ? ToVector3(gravity) : Vector3::Zero;
 	}
+
+    void Physics::SetFixedRate(const float rate)
+    {
+        if (rate <= 0.0f)
+        {
+            LOG_WARNING("The fixed rate must be positive");
+            return;
+        }
+
+        m_internal_fps = rate;
+    }
 }
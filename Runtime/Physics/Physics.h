@@ -75,6 +75,12 @@ namespace Spartan
         auto GetPhysicsDebugDraw()  const { return m_debug_draw; }
 		bool IsSimulating()         const { return m_simulating; }
 
+        // Simulation settings
+        void SetSubStepsMax(const int sub_steps_max)    { m_max_sub_steps = sub_steps_max; } // < 0: variable step, 0: as many as needed, > 0: capped
+        int GetSubStepsMax()                    const   { return m_max_sub_steps; }
+        void SetFixedRate(float rate);                                                       // internal steps per second
+        float GetFixedRate()                    const   { return m_internal_fps; }
+
 	private:
         btBroadphaseInterface* m_broadphase                         = nullptr;
         btCollisionDispatcher* m_collision_dispatcher               = nullptr;
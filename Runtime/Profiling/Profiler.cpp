@@ -20,12 +20,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
 //= INCLUDES =========================
+#include <fstream>
 #include "Profiler.h"
 #include "../RHI/RHI_Device.h"
 #include "../Rendering/Renderer.h"
 #include "../RHI/RHI_CommandList.h"
 #include "../Resource/ResourceCache.h"
 #include "../RHI/RHI_Implementation.h"
+#include "../Core/EventSystem.h"
+#include "../Core/Context.h"
 //====================================
 
 //= NAMESPACES =====
@@ -34,8 +37,44 @@ using namespace std;
 
 namespace Spartan
 {
+    namespace _Profiler
+    {
+        static const uint32_t capture_thread_gpu = 0xFFFF;
+
+        // Per thread state, the ring buffer is shared with the profiler which drains it
+        struct ThreadState
+        {
+            Profiler* profiler = nullptr;
+            shared_ptr<TimeBlockRingBuffer> ring;
+            vector<TimeBlockThread> stack;
+            uint32_t index      = 0;
+            uint32_t id_next    = 0;
+        };
+        thread_local ThreadState thread_state;
+
+        static string json_escape(const string& text)
+        {
+            string escaped;
+            escaped.reserve(text.size());
+            for (const char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    escaped += '\\';
+                    escaped += c;
+                }
+                else if (static_cast<unsigned char>(c) >= 0x20)
+                {
+                    escaped += c;
+                }
+            }
+            return escaped;
+        }
+    }
+
 	Profiler::Profiler(Context* context) : ISubsystem(context)
 	{
+        m_thread_id_main = this_thread::get_id();
         m_time_blocks_read.reserve(m_time_block_capacity);
         m_time_blocks_read.resize(m_time_block_capacity);
 		m_time_blocks_write.reserve(m_time_block_capacity);
@@ -45,6 +84,7 @@ namespace Spartan
     Profiler::~Profiler()
     {
         if (m_profile) OnFrameEnd();
+        if (IsCapturing()) CaptureSave();
         m_time_blocks_write.clear();
         m_time_blocks_read.clear();
         ClearRhiMetrics();
@@ -70,12 +110,26 @@ namespace Spartan
         if (!m_renderer || !m_renderer->GetRhiDevice()->GetContextRhi()->profiler)
             return;
 
+        // Drain other threads every frame, so their buffers don't overflow
+        CollectThreadTimeBlocks();
+
         // End previous frame
         if (m_profile)
         {
             OnFrameEnd();
         }
 
+        // Start a requested capture on a frame boundary, so that no time block is cut in half
+        if (m_capture_frames_requested != 0)
+        {
+            m_capture_frames_left       = m_capture_frames_requested;
+            m_capture_frames_requested  = 0;
+            m_capture_epoch             = chrono::steady_clock::now();
+            m_capture_events.clear();
+        }
+
+        m_frame_index++;
+        m_frame_start = chrono::steady_clock::now();
         m_timer.Start();
 
         // Compute fps
@@ -93,6 +147,18 @@ namespace Spartan
             m_profile = false;
         }
 
+        // Every frame of a capture has to be profiled, and so does every frame when requested
+        m_profile = m_profile || IsCapturing() || m_profile_every_frame;
+
+        // Event metrics (previous frame)
+        {
+            EventSystem& event_system   = EventSystem::Get();
+            m_events_fired              = event_system.GetFiredCount();
+            m_events_dispatched         = event_system.GetDispatchedCount();
+            m_time_events_ms            = event_system.GetTimeMs();
+            event_system.ResetStatistics();
+        }
+
         // Updating every m_profiling_interval_sec
         if (m_profile)
         {
@@ -111,6 +177,8 @@ namespace Spartan
 
     void Profiler::OnFrameEnd()
     {
+        const uint32_t time_block_count = m_time_block_count;
+
         // Clear time blocks
         {
             for (uint32_t i = 0; i < m_time_block_count; i++)
@@ -134,6 +202,14 @@ namespace Spartan
             }
 
             m_time_block_count = 0;
+
+            m_time_blocks_threads_read.swap(m_time_blocks_threads_write);
+            m_time_blocks_threads_write.clear();
+
+            if (const uint32_t dropped = m_time_blocks_dropped.exchange(0))
+            {
+                LOG_WARNING("%d time blocks from other threads were dropped, their buffers were full", dropped);
+            }
         }
 
         // Compute cpu and gpu times
@@ -171,10 +247,30 @@ namespace Spartan
             m_cpu_avg_ms = m_cpu_avg_ms * (1.0 - delta_feedback) + m_time_cpu_ms * delta_feedback;
             m_gpu_avg_ms = m_gpu_avg_ms * (1.0 - delta_feedback) + m_time_gpu_ms * delta_feedback;
         }
+
+        if (IsCapturing())
+        {
+            CaptureFrame(time_block_count);
+
+            if (--m_capture_frames_left == 0)
+            {
+                CaptureSave();
+            }
+        }
     }
 
     void Profiler::TimeBlockStart(const char* func_name, TimeBlock_Type type, RHI_CommandList* cmd_list /*= nullptr*/)
 	{
+        // Other threads are not frame bound, they always record (cpu only) and are drained every frame
+        if (this_thread::get_id() != m_thread_id_main)
+        {
+            if (type == TimeBlock_Cpu && m_profile_cpu_enabled)
+            {
+                TimeBlockStartThread(func_name);
+            }
+            return;
+        }
+
 		if (!m_profile)
 			return;
 
@@ -195,12 +291,208 @@ namespace Spartan
 
 	void Profiler::TimeBlockEnd()
 	{
+        if (this_thread::get_id() != m_thread_id_main)
+        {
+            TimeBlockEndThread();
+            return;
+        }
+
 		if (auto time_block = GetLastIncompleteTimeBlock())
 		{
 			time_block->End();
 		}
 	}
 
+    void Profiler::CaptureStart(const uint32_t frame_count, const string& file_path)
+    {
+        if (!m_renderer || !m_renderer->GetRhiDevice()->GetContextRhi()->profiler)
+        {
+            LOG_WARNING("Profiling is disabled, can't capture");
+            return;
+        }
+
+        if (frame_count == 0 || IsCapturing())
+            return;
+
+        m_capture_frames_requested  = frame_count;
+        m_capture_file_path         = file_path;
+    }
+
+    void Profiler::TimeBlockStartThread(const char* func_name)
+    {
+        _Profiler::ThreadState& state = _Profiler::thread_state;
+
+        // Register this thread
+        if (state.profiler != this)
+        {
+            state.profiler  = this;
+            state.ring      = make_shared<TimeBlockRingBuffer>();
+            state.index     = ++m_thread_count;
+            state.id_next   = 0;
+            state.stack.clear();
+
+            lock_guard<mutex> lock(m_mutex_thread_rings);
+            m_thread_rings.emplace_back(state.ring);
+        }
+
+        TimeBlockThread& time_block = state.stack.emplace_back();
+        time_block.name             = func_name;
+        time_block.thread_index     = state.index;
+        time_block.tree_depth       = static_cast<uint32_t>(state.stack.size() - 1);
+        time_block.id               = ++state.id_next;
+        time_block.parent_id        = state.stack.size() > 1 ? state.stack[state.stack.size() - 2].id : 0;
+        time_block.start            = chrono::steady_clock::now();
+    }
+
+    void Profiler::TimeBlockEndThread()
+    {
+        _Profiler::ThreadState& state = _Profiler::thread_state;
+
+        if (state.profiler != this || state.stack.empty())
+            return;
+
+        TimeBlockThread& time_block = state.stack.back();
+        time_block.end              = chrono::steady_clock::now();
+
+        // Never block a worker, if the buffer is full the time block is lost
+        if (!state.ring->TryPush([&time_block](TimeBlockThread& slot) { slot = time_block; }))
+        {
+            m_time_blocks_dropped++;
+        }
+
+        state.stack.pop_back();
+    }
+
+    void Profiler::CollectThreadTimeBlocks()
+    {
+        lock_guard<mutex> lock(m_mutex_thread_rings);
+
+        for (auto it = m_thread_rings.begin(); it != m_thread_rings.end();)
+        {
+            TimeBlockRingBuffer* ring = it->get();
+
+            ring->Pop([this](const TimeBlockThread& time_block)
+            {
+                TimeBlockThread& collected  = m_time_blocks_threads_write.emplace_back(time_block);
+                collected.frame             = m_frame_index;
+            });
+
+            // The thread has exited, we are the last owner
+            if (it->use_count() == 1)
+            {
+                it = m_thread_rings.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void Profiler::CaptureFrame(const uint32_t time_block_count)
+    {
+        const auto to_us = [this](const chrono::steady_clock::time_point& time)
+        {
+            return chrono::duration<double, micro>(time - m_capture_epoch).count();
+        };
+
+        const auto add_event = [this](const char* name, const bool gpu, const uint32_t thread_index, const double start_us, const double duration_us)
+        {
+            CaptureEvent& capture_event = m_capture_events.emplace_back();
+            capture_event.name          = name ? name : "N/A";
+            capture_event.gpu           = gpu;
+            capture_event.thread_index  = thread_index;
+            capture_event.start_us      = start_us;
+            capture_event.duration_us   = duration_us;
+            capture_event.frame         = m_frame_index;
+        };
+
+        // Frame
+        const double frame_start_us = to_us(m_frame_start);
+        add_event(("Frame " + to_string(m_frame_index)).c_str(), false, 0, frame_start_us, to_us(chrono::steady_clock::now()) - frame_start_us);
+
+        // Main thread
+        vector<double> gpu_cursor_us; // per tree depth
+        for (uint32_t i = 0; i < time_block_count; i++)
+        {
+            const TimeBlock& time_block = m_time_blocks_read[i];
+            if (!time_block.IsComplete())
+                continue;
+
+            const double start_us = to_us(time_block.GetStart());
+
+            if (time_block.GetType() == TimeBlock_Cpu)
+            {
+                add_event(time_block.GetName(), false, 0, start_us, to_us(time_block.GetEnd()) - start_us);
+            }
+            else if (time_block.GetType() == TimeBlock_Gpu)
+            {
+                // The gpu only reports durations, so blocks are anchored to when they were recorded on the
+                // cpu, and pushed back so that they don't overlap previous blocks of the same depth or start before their parent.
+                const uint32_t depth = time_block.GetTreeDepth();
+                gpu_cursor_us.resize(Math::Max(static_cast<uint32_t>(gpu_cursor_us.size()), depth + 1), 0.0);
+
+                const double gpu_start_us = Math::Max(start_us, gpu_cursor_us[depth]);
+                const double duration_us = static_cast<double>(time_block.GetDuration()) * 1000.0;
+                add_event(time_block.GetName(), true, _Profiler::capture_thread_gpu, gpu_start_us, duration_us);
+
+                // Children start after their parent's start, siblings after each other's end
+                gpu_cursor_us.resize(depth + 1);
+                gpu_cursor_us[depth] = gpu_start_us + duration_us;
+                gpu_cursor_us.emplace_back(gpu_start_us);
+            }
+        }
+
+        // Other threads
+        for (const TimeBlockThread& time_block : m_time_blocks_threads_read)
+        {
+            // Skip what was recorded before the capture started
+            if (time_block.start < m_capture_epoch)
+                continue;
+
+            const double start_us = to_us(time_block.start);
+            add_event(time_block.name, false, time_block.thread_index, start_us, to_us(time_block.end) - start_us);
+        }
+    }
+
+    void Profiler::CaptureSave()
+    {
+        m_capture_frames_left = 0;
+
+        ofstream file(m_capture_file_path, ios::out | ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_ERROR("Failed to open \"%s\" for writing", m_capture_file_path.c_str());
+            return;
+        }
+
+        file << fixed;
+        file.precision(3);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+        // Thread names
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Main\"}},\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << _Profiler::capture_thread_gpu << ",\"args\":{\"name\":\"GPU\"}}";
+        for (uint32_t i = 1; i <= m_thread_count; i++)
+        {
+            file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i << ",\"args\":{\"name\":\"Worker " << i << "\"}}";
+        }
+
+        // Time blocks
+        for (const CaptureEvent& capture_event : m_capture_events)
+        {
+            file << ",\n{\"name\":\"" << _Profiler::json_escape(capture_event.name) << "\",\"cat\":\"" << (capture_event.gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":0";
+            file << ",\"tid\":" << capture_event.thread_index << ",\"ts\":" << capture_event.start_us << ",\"dur\":" << capture_event.duration_us;
+            file << ",\"args\":{\"frame\":" << capture_event.frame << "}}";
+        }
+
+        file << "\n]}\n";
+        file.close();
+
+        LOG_INFO("Saved %d time blocks to \"%s\"", static_cast<uint32_t>(m_capture_events.size()), m_capture_file_path.c_str());
+        m_capture_events.clear();
+    }
+
     TimeBlock* Profiler::GetNewTimeBlock()
 	{
 		// Grow capacity if needed
@@ -277,9 +569,16 @@ namespace Spartan
             "RHI Compute Shader bindings:\t%d\n"
             "RHI Render Target bindings:\t%d\n"
             "RHI Pipeline bindings:\t\t\t%d\n"
-            "RHI Descriptor Set bindings:\t%d";
-
-		static char buffer[1024]; // real usage is around 800
+            "RHI Descriptor Set bindings:\t%d\n"
+            "RHI Descriptor Set allocations:\t%d\n"
+            "RHI Descriptor Set evictions:\t%d\n"
+            "RHI Descriptor Set hits/misses:\t%d/%d\n"
+            // Events
+            "Events fired:\t\t\t\t\t\t%d\n"
+            "Events dispatched (queued):\t%d\n"
+            "Event time:\t\t\t\t\t\t%.2f ms";
+
+		static char buffer[2048]; // real usage is around 900
 		sprintf_s
 		(
 			buffer, text,
@@ -311,9 +610,32 @@ namespace Spartan
             m_rhi_bindings_shader_compute,
 			m_rhi_bindings_render_target,
             m_rhi_bindings_pipeline,
-            m_rhi_bindings_descriptor_set
+            m_rhi_bindings_descriptor_set,
+            m_rhi_descriptor_set_allocations.load(),
+            m_rhi_descriptor_set_evictions.load(),
+            m_rhi_descriptor_set_hits.load(),
+            m_rhi_descriptor_set_misses.load(),
+
+            // Events
+            m_events_fired,
+            m_events_dispatched,
+            m_time_events_ms
 		);
 
 		m_metrics = string(buffer);
+
+        // Subsystems (time spent ticking them, and the longest chain of dependencies, which is what limits a concurrent tick)
+        m_metrics += "\n";
+        for (uint32_t i = 0; i < Tick_Group_Count; i++)
+        {
+            const Tick_Group tick_group = static_cast<Tick_Group>(i);
+            sprintf_s(buffer, "\nTick group %d:\t\t\t\t\t\t%.2f ms (critical path %.2f ms)", i, m_context->GetTickTimeMs(tick_group), m_context->GetCriticalPathMs(tick_group));
+            m_metrics += buffer;
+        }
+        for (const _subystem& subsystem : m_context->GetSubsystems())
+        {
+            sprintf_s(buffer, "\n%s:\t\t\t\t\t\t\t%.2f ms", subsystem.name.c_str(), subsystem.time_ms);
+            m_metrics += buffer;
+        }
 	}
 }
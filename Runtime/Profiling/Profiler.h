@@ -21,14 +21,18 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ==================
+//= INCLUDES ========================
 #include <string>
 #include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
 #include "TimeBlock.h"
 #include "../Core/EngineDefs.h"
 #include "../Core/ISubsystem.h"
 #include "../Core/Stopwatch.h"
-//=============================
+#include "../Threading/RingBuffer.h"
+//===================================
 
 #define TIME_BLOCK_START_NAMED(profiler, name)  profiler->TimeBlockStart(name, Spartan::TimeBlock_Type::TimeBlock_Cpu);
 #define TIME_BLOCK_END(profiler)			    profiler->TimeBlockEnd();
@@ -42,6 +46,22 @@ namespace Spartan
 	class Renderer;
     class Variant;
 
+    // A cpu time block recorded by a thread other than the main one
+    struct TimeBlockThread
+    {
+        const char* name    = nullptr;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+        uint32_t thread_index   = 0;
+        uint32_t tree_depth     = 0;
+        uint32_t id             = 0; // unique per thread
+        uint32_t parent_id      = 0; // 0 means no parent
+        uint64_t frame          = 0; // frame during which the block was collected
+    };
+
+    static const uint32_t time_block_thread_capacity = 1024; // per thread, per frame
+    using TimeBlockRingBuffer = RingBuffer<TimeBlockThread, time_block_thread_capacity>;
+
 	class SPARTAN_CLASS Profiler : public ISubsystem
 	{
 	public:
@@ -57,11 +77,18 @@ namespace Spartan
 		void TimeBlockStart(const char* func_name, TimeBlock_Type type, RHI_CommandList* cmd_list = nullptr);
 		void TimeBlockEnd();
 
+        // Captures the next frame_count frames and saves them as a Chrome trace (chrome://tracing, Perfetto)
+        void CaptureStart(uint32_t frame_count, const std::string& file_path);
+        bool IsCapturing() const { return m_capture_frames_left != 0; }
+
         // Properties
 		void SetProfilingEnabledCpu(const bool enabled)	{ m_profile_cpu_enabled = enabled; }
 		void SetProfilingEnabledGpu(const bool enabled)	{ m_profile_gpu_enabled = enabled; }
+        void SetProfilingEveryFrame(const bool enabled) { m_profile_every_frame = enabled; }
 		const auto& GetMetrics() const			        { return m_metrics; }
 		const auto& GetTimeBlocks() const				{ return m_time_blocks_read; }
+		const auto& GetTimeBlocksThreads() const		{ return m_time_blocks_threads_read; }
+        auto GetFrameIndex() const                      { return m_frame_index; }
 		auto GetTimeCpu() const						    { return m_time_cpu_ms; }
 		auto GetTimeGpu() const						    { return m_time_gpu_ms; }
 		auto GetTimeFrame() const						{ return m_time_frame_ms; }
@@ -87,10 +114,20 @@ namespace Spartan
 		uint32_t m_rhi_bindings_render_target	= 0;
         uint32_t m_rhi_bindings_descriptor_set  = 0;
         uint32_t m_rhi_bindings_pipeline        = 0;
+        // Descriptor set cache, command lists can be recorded off the thread that reads these
+        std::atomic<uint32_t> m_rhi_descriptor_set_allocations  = 0;
+        std::atomic<uint32_t> m_rhi_descriptor_set_evictions    = 0;
+        std::atomic<uint32_t> m_rhi_descriptor_set_hits         = 0;
+        std::atomic<uint32_t> m_rhi_descriptor_set_misses       = 0;
 
 		// Metrics - Renderer
 		uint32_t m_renderer_meshes_rendered = 0;
 
+        // Metrics - Events
+        uint32_t m_events_fired         = 0;
+        uint32_t m_events_dispatched    = 0;
+        float m_time_events_ms          = 0.0f;
+
 		// Metrics - Time
 		float m_time_frame_ms	= 0.0f;
 		float m_time_cpu_ms		= 0.0f;
@@ -112,10 +149,19 @@ namespace Spartan
             m_rhi_bindings_render_target    = 0;
             m_rhi_bindings_descriptor_set   = 0;
             m_rhi_bindings_pipeline         = 0;
+            m_rhi_descriptor_set_allocations    = 0;
+            m_rhi_descriptor_set_evictions      = 0;
+            m_rhi_descriptor_set_hits           = 0;
+            m_rhi_descriptor_set_misses         = 0;
         }
 
 		TimeBlock* GetNewTimeBlock();
 		TimeBlock* GetLastIncompleteTimeBlock(TimeBlock_Type type = TimeBlock_Undefined);
+        void TimeBlockStartThread(const char* func_name);
+        void TimeBlockEndThread();
+        void CollectThreadTimeBlocks();
+        void CaptureFrame(uint32_t time_block_count);
+        void CaptureSave();
 		void ComputeFps(float delta_time);
 		void UpdateRhiMetricsString();
 
@@ -123,6 +169,7 @@ namespace Spartan
 		bool m_profile_cpu_enabled			= true; // cheap
 		bool m_profile_gpu_enabled			= true; // expensive
 		float m_profiling_interval_sec		= 0.3f;
+        bool m_profile_every_frame          = false; // for consumers that need a fresh gpu time each frame
 		float m_time_since_profiling_sec	= m_profiling_interval_sec;
 
 		// Time blocks (double buffered)
@@ -131,6 +178,33 @@ namespace Spartan
 		std::vector<TimeBlock> m_time_blocks_write;
         std::vector<TimeBlock> m_time_blocks_read;
 
+        // Time blocks from other threads (each thread owns a lock-free ring buffer, drained every frame)
+        std::thread::id m_thread_id_main;
+        std::vector<std::shared_ptr<TimeBlockRingBuffer>> m_thread_rings;
+        std::mutex m_mutex_thread_rings;
+        std::atomic<uint32_t> m_thread_count            = 0;
+        std::atomic<uint32_t> m_time_blocks_dropped     = 0;
+        std::vector<TimeBlockThread> m_time_blocks_threads_write;
+        std::vector<TimeBlockThread> m_time_blocks_threads_read;
+        uint64_t m_frame_index = 0;
+        std::chrono::steady_clock::time_point m_frame_start;
+
+        // Capture
+        struct CaptureEvent
+        {
+            std::string name;
+            bool gpu                = false;
+            uint32_t thread_index   = 0;
+            double start_us         = 0.0;
+            double duration_us      = 0.0;
+            uint64_t frame          = 0;
+        };
+        std::vector<CaptureEvent> m_capture_events;
+        std::string m_capture_file_path;
+        std::chrono::steady_clock::time_point m_capture_epoch;
+        uint32_t m_capture_frames_requested = 0;
+        uint32_t m_capture_frames_left      = 0;
+
 		// FPS
         float m_delta_time      = 0.0f;
 		float m_fps				= 0.0f;
@@ -52,11 +52,10 @@ namespace Spartan
         m_type              = type;
         m_max_tree_depth    = Math::Max(m_max_tree_depth, m_tree_depth);
 
-		if (type == TimeBlock_Cpu)
-		{
-			m_start = chrono::high_resolution_clock::now();
-		}
-		else if (type == TimeBlock_Gpu)
+        // Gpu blocks keep the cpu time too, so they can be placed on the same timeline
+        m_start = chrono::steady_clock::now();
+
+		if (type == TimeBlock_Gpu)
 		{
 			// Create required queries
 			if (!m_query_disjoint)
@@ -75,11 +74,9 @@ namespace Spartan
 
 	void TimeBlock::End()
 	{
-		if (m_type == TimeBlock_Cpu)
-		{
-			m_end = chrono::high_resolution_clock::now();
-		}
-		else if (m_type == TimeBlock_Gpu)
+        m_end = chrono::steady_clock::now();
+
+		if (m_type == TimeBlock_Gpu)
 		{
             if (m_cmd_list)
             {
@@ -55,6 +55,8 @@ namespace Spartan
         uint32_t GetTreeDepthMax()      const { return m_max_tree_depth; }
         float GetDuration()             const { return m_duration; }
         bool IsComplete()               const { return m_is_complete; }
+        const auto& GetStart()          const { return m_start; } // for gpu blocks, this is when the block was recorded
+        const auto& GetEnd()            const { return m_end; }
 
 	private:	
 		static uint32_t FindTreeDepth(const TimeBlock* time_block, uint32_t depth = 0);
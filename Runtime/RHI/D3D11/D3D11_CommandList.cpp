@@ -486,6 +486,24 @@ namespace Spartan
         const UINT range                    = 1;
         ID3D11DeviceContext* device_context = m_rhi_device->GetContextRhi()->device_context;
 
+        // Dynamic buffers are bound by offset (in 16 byte constants), the offset can change with every draw so they are always bound
+        if (constant_buffer && constant_buffer->IsDynamic())
+        {
+            ID3D11DeviceContext1* device_context_1  = m_rhi_device->GetContextRhi()->device_context_1;
+            const UINT first_constant               = constant_buffer->GetOffsetDynamic() / 16;
+            const UINT constant_count               = constant_buffer->GetStride() / 16;
+            ID3D11Buffer* const* buffers            = reinterpret_cast<ID3D11Buffer* const*>(&buffer_array);
+
+            if (scope & RHI_Shader_Vertex)  device_context_1->VSSetConstantBuffers1(slot, range, buffers, &first_constant, &constant_count);
+            if (scope & RHI_Shader_Pixel)   device_context_1->PSSetConstantBuffers1(slot, range, buffers, &first_constant, &constant_count);
+            if (scope & RHI_Shader_Compute) device_context_1->CSSetConstantBuffers1(slot, range, buffers, &first_constant, &constant_count);
+
+            m_profiler->m_rhi_bindings_buffer_constant += scope & RHI_Shader_Vertex   ? 1 : 0;
+            m_profiler->m_rhi_bindings_buffer_constant += scope & RHI_Shader_Pixel    ? 1 : 0;
+            m_profiler->m_rhi_bindings_buffer_constant += scope & RHI_Shader_Compute  ? 1 : 0;
+            return;
+        }
+
         if (scope & RHI_Shader_Vertex)
         {
             // Set only if not set
@@ -591,6 +609,35 @@ namespace Spartan
         m_profiler->m_rhi_bindings_texture++;
 	}
 
+    void RHI_CommandList::SetTextureArray(const uint32_t slot, vector<RHI_Texture*>& textures, const uint8_t scope /*= RHI_Shader_Pixel*/)
+    {
+        // D3D11 has no descriptor arrays, a texture array takes one slot per element
+        if (slot + textures.size() > D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT)
+        {
+            LOG_ERROR("Texture array exceeds the available slots");
+            return;
+        }
+
+        vector<void*> resource_array(textures.size());
+        for (uint32_t i = 0; i < static_cast<uint32_t>(textures.size()); i++)
+        {
+            textures[i]         = textures[i] ? textures[i] : m_renderer->GetBlackTexture();
+            resource_array[i]   = textures[i]->Get_View_Texture();
+        }
+
+        ID3D11DeviceContext* device_context = m_rhi_device->GetContextRhi()->device_context;
+        if (scope & RHI_Shader_Pixel)
+        {
+            device_context->PSSetShaderResources(slot, static_cast<UINT>(resource_array.size()), reinterpret_cast<ID3D11ShaderResourceView* const*>(resource_array.data()));
+        }
+        else if (scope & RHI_Shader_Compute)
+        {
+            device_context->CSSetShaderResources(slot, static_cast<UINT>(resource_array.size()), reinterpret_cast<ID3D11ShaderResourceView* const*>(resource_array.data()));
+        }
+
+        m_profiler->m_rhi_bindings_texture++;
+    }
+
 	bool RHI_CommandList::Submit()
 	{
 		return true;
@@ -49,15 +49,25 @@ namespace Spartan
 			return nullptr;
 		}
 
+        if (offset_index >= m_element_count)
+        {
+            LOG_ERROR("Offset index %d is out of range", offset_index);
+            return nullptr;
+        }
+
+        // Elements of dynamic buffers are written in order and bound by offset, so only the first one discards (renames) the buffer,
+        // the rest are appended without overwriting what's in use.
+        const D3D11_MAP map_type = (offset_index == 0) ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+
 		D3D11_MAPPED_SUBRESOURCE mapped_resource;
-		const auto result = m_rhi_device->GetContextRhi()->device_context->Map(static_cast<ID3D11Buffer*>(m_buffer), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource);
+		const auto result = m_rhi_device->GetContextRhi()->device_context->Map(static_cast<ID3D11Buffer*>(m_buffer), 0, map_type, 0, &mapped_resource);
 		if (FAILED(result))
 		{
 			LOG_ERROR("Failed to map constant buffer.");
 			return nullptr;
 		}
 
-		return mapped_resource.pData;
+		return static_cast<uint8_t*>(mapped_resource.pData) + static_cast<uint64_t>(offset_index) * m_stride;
 	}
 
 	bool RHI_ConstantBuffer::Unmap() const
@@ -82,9 +92,20 @@ namespace Spartan
 
         safe_release(*reinterpret_cast<ID3D11Buffer**>(&m_buffer));
 
+        // Dynamic buffers are bound by offset, which has to be a multiple of 16 constants (256 bytes)
+        if (m_is_dynamic)
+        {
+            m_stride = (m_stride + 255) & ~255;
+        }
+        else
+        {
+            m_element_count = 1;
+        }
+        m_size_gpu = static_cast<uint64_t>(m_stride) * m_element_count;
+
 		D3D11_BUFFER_DESC buffer_desc;
 		ZeroMemory(&buffer_desc, sizeof(buffer_desc));
-		buffer_desc.ByteWidth			= static_cast<UINT>(m_stride);
+		buffer_desc.ByteWidth			= static_cast<UINT>(m_size_gpu);
 		buffer_desc.Usage				= D3D11_USAGE_DYNAMIC;
 		buffer_desc.BindFlags			= D3D11_BIND_CONSTANT_BUFFER;
 		buffer_desc.CPUAccessFlags		= D3D11_CPU_ACCESS_WRITE;
@@ -44,6 +44,11 @@ namespace Spartan
         return nullptr;
     }
 
+    void RHI_DescriptorSetLayout::FreeDescriptorSets(const vector<void*>& descriptor_sets, const RHI_DescriptorCache* descriptor_cache)
+    {
+        // D3D11 binds resources directly, there are no descriptor sets to free (RHI_DescriptorCache doesn't evict on this backend)
+    }
+
     void RHI_DescriptorSetLayout::UpdateDescriptorSet(void* descriptor_set, const vector<RHI_Descriptor>& descriptors)
     {
         
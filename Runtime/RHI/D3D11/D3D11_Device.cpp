@@ -180,6 +180,17 @@ namespace Spartan
 			}
 		}
 
+        // Constant buffer offsets (D3D11.1), dynamic constant buffers hold many elements and are bound by offset
+        {
+            D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+            m_rhi_context->device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options));
+            if (!options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer || FAILED(m_rhi_context->device_context->QueryInterface(IID_PPV_ARGS(&m_rhi_context->device_context_1))))
+            {
+                LOG_ERROR("Device doesn't support constant buffer offsets");
+                return;
+            }
+        }
+
 		// Annotations
         if (m_rhi_context->debug)
         {
@@ -196,6 +207,7 @@ namespace Spartan
 
 	RHI_Device::~RHI_Device()
 	{
+		safe_release(m_rhi_context->device_context_1);
 		safe_release(m_rhi_context->device_context);
 		safe_release(m_rhi_context->device);
 		safe_release(m_rhi_context->annotation);
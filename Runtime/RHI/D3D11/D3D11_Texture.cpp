@@ -120,6 +120,9 @@ namespace Spartan
 		texture_desc.MiscFlags				= 0;
 		texture_desc.CPUAccessFlags			= 0;
 
+		// Block compressed formats are laid out in rows of 4x4 blocks
+		const bool block_compressed = format == DXGI_FORMAT_BC1_UNORM || format == DXGI_FORMAT_BC4_UNORM || format == DXGI_FORMAT_BC5_UNORM || format == DXGI_FORMAT_BC7_UNORM;
+
 		// Fill subresource data
 		vector<D3D11_SUBRESOURCE_DATA> vec_subresource_data;
 		for (uint32_t mip_level = 0; mip_level < static_cast<uint32_t>(data.size()); mip_level++)
@@ -130,9 +133,12 @@ namespace Spartan
 				return false;
 			}
 
+			const uint32_t mip_height = height >> mip_level;
+			const uint32_t block_rows = mip_height > 4 ? (mip_height + 3) / 4 : 1;
+
 			auto& subresource_data				= vec_subresource_data.emplace_back(D3D11_SUBRESOURCE_DATA{});
 			subresource_data.pSysMem			= data[mip_level].data();					    // Data pointer		
-			subresource_data.SysMemPitch		= (width >> mip_level) * channels * (bpc / 8);	// Line width in bytes
+			subresource_data.SysMemPitch		= block_compressed ? static_cast<UINT>(data[mip_level].size() / block_rows) : (width >> mip_level) * channels * (bpc / 8);	// Line width in bytes
 			subresource_data.SysMemSlicePitch	= 0;								            // This is only used for 3D textures
 		}
 
@@ -257,6 +263,12 @@ namespace Spartan
         }
     }
 
+    bool RHI_Texture::BindMemory(void* memory, const uint64_t offset)
+    {
+        // D3D11 has no placed resources, transient textures get their own memory when created
+        return false;
+    }
+
 	bool RHI_Texture2D::CreateResourceGpu()
 	{
 		if (!m_rhi_device || !m_rhi_device->GetContextRhi()->device)
@@ -0,0 +1,52 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#include "../RHI_Implementation.h"
+#ifdef API_GRAPHICS_D3D11
+//================================
+
+//= INCLUDES ==================
+#include "../RHI_TransientHeap.h"
+//=============================
+
+namespace Spartan
+{
+    // D3D11 has no placed resources, so there is nothing to alias into
+
+    RHI_TransientHeap::RHI_TransientHeap(const std::shared_ptr<RHI_Device>& rhi_device, const uint64_t size, const uint32_t memory_type_bits)
+    {
+        m_rhi_device = rhi_device;
+    }
+
+    RHI_TransientHeap::~RHI_TransientHeap() = default;
+
+    bool RHI_TransientHeap::Bind(RHI_Texture* texture, const uint64_t offset) const
+    {
+        return false;
+    }
+
+    bool RHI_TransientHeap::IsSupported()
+    {
+        return false;
+    }
+}
+#endif
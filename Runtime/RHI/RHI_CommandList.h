@@ -82,6 +82,9 @@ namespace Spartan
 		// Texture
         void SetTexture(const uint32_t slot, RHI_Texture* texture, const uint8_t scope = RHI_Shader_Pixel);
         inline void SetTexture(const uint32_t slot, const std::shared_ptr<RHI_Texture>& texture, const uint8_t scope = RHI_Shader_Pixel) { SetTexture(slot, texture.get(), scope); }
+
+        // Texture array (bindless), null textures are replaced with a black texture
+        void SetTextureArray(const uint32_t slot, std::vector<RHI_Texture*>& textures, const uint8_t scope = RHI_Shader_Pixel);
         
         // Submit/Flush
 		bool Submit();
@@ -48,6 +48,8 @@ namespace Spartan
             return _Create();
 		}
 
+        // Returns a pointer to the element at offset_index, it stays valid up to the end of the buffer until Unmap() is called.
+        // Vulkan keeps the buffer mapped, so mapping is free, D3D11 only discards the buffer when mapping the first element of a dynamic buffer.
 		void* Map(const uint32_t offset_index = 0) const;
 		bool Unmap() const;
         bool Flush(const uint32_t offset_index = 0);
@@ -79,6 +81,7 @@ namespace Spartan
 		// API
 		void* m_buffer			= nullptr;
 		void* m_buffer_memory	= nullptr;
+        void* m_mapped          = nullptr;
 
         // Dependencies
         std::shared_ptr<RHI_Device> m_rhi_device;
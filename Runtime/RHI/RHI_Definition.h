@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ===============
 #include <stdint.h>
+#include <vector>
 #include "..\Math\Vector4.h"
 //==========================
 
@@ -52,12 +53,14 @@ namespace Spartan
 	class RHI_Texture;
 	class RHI_Texture2D;
 	class RHI_TextureCube;
+    class RHI_TransientHeap;
 	class RHI_Shader;
 	struct RHI_Vertex_Undefined;
 	struct RHI_Vertex_PosTex;
 	struct RHI_Vertex_PosCol;
 	struct RHI_Vertex_PosUvCol;
 	struct RHI_Vertex_PosTexNorTan;
+	struct RHI_Vertex_PosTexNorTan_Packed;
 
     enum RHI_PhysicalDevice_Type
     {
@@ -189,6 +192,15 @@ namespace Spartan
         // DEPTH
         RHI_Format_D32_Float,
         RHI_Format_D32_Float_S8X24_Uint,
+        // VERTEX (appended to keep serialized values)
+        RHI_Format_R16G16_Unorm,
+        RHI_Format_R16G16_Snorm,
+        RHI_Format_R16G16B16A16_Unorm,
+        // BLOCK COMPRESSED (appended to keep serialized values)
+        RHI_Format_BC1_Unorm,
+        RHI_Format_BC4_Unorm,
+        RHI_Format_BC5_Unorm,
+        RHI_Format_BC7_Unorm,
 
         RHI_Format_Undefined
 	};
@@ -251,25 +263,29 @@ namespace Spartan
 
         RHI_Descriptor(const RHI_Descriptor& descriptor)
         {
-            type    = descriptor.type;
-            slot    = descriptor.slot;
-            stage   = descriptor.stage;
+            type        = descriptor.type;
+            slot        = descriptor.slot;
+            stage       = descriptor.stage;
+            array_size  = descriptor.array_size;
         }
 
-        RHI_Descriptor(RHI_Descriptor_Type type, uint32_t slot, uint32_t stage)
+        RHI_Descriptor(RHI_Descriptor_Type type, uint32_t slot, uint32_t stage, uint32_t array_size = 1)
         {
-            this->type  = type;
-            this->slot  = slot;
-            this->stage = stage;
+            this->type          = type;
+            this->slot          = slot;
+            this->stage         = stage;
+            this->array_size    = array_size;
         }
 
         uint32_t slot               = 0;
         uint32_t stage              = 0;
+        uint32_t array_size         = 1; // more than one for descriptor arrays (bindless), their resources are in resource_array
         uint64_t offset             = 0;
         uint64_t range              = 0;
         RHI_Descriptor_Type type    = RHI_Descriptor_Undefined;
         RHI_Image_Layout layout     = RHI_Image_Undefined;
         void* resource              = nullptr;
+        std::vector<void*> resource_array;
     };
 
     inline const char* rhi_format_to_string(const RHI_Format result)
@@ -290,6 +306,13 @@ namespace Spartan
             case RHI_Format_R32G32B32A32_Float:	    return "RHI_Format_R32G32B32A32_Float";
             case RHI_Format_D32_Float:	            return "RHI_Format_D32_Float";
             case RHI_Format_D32_Float_S8X24_Uint:	return "RHI_Format_D32_Float_S8X24_Uint";
+            case RHI_Format_R16G16_Unorm:		    return "RHI_Format_R16G16_Unorm";
+            case RHI_Format_R16G16_Snorm:		    return "RHI_Format_R16G16_Snorm";
+            case RHI_Format_R16G16B16A16_Unorm:	    return "RHI_Format_R16G16B16A16_Unorm";
+            case RHI_Format_BC1_Unorm:	            return "RHI_Format_BC1_Unorm";
+            case RHI_Format_BC4_Unorm:	            return "RHI_Format_BC4_Unorm";
+            case RHI_Format_BC5_Unorm:	            return "RHI_Format_BC5_Unorm";
+            case RHI_Format_BC7_Unorm:	            return "RHI_Format_BC7_Unorm";
             case RHI_Format_Undefined:              return "RHI_Format_Undefined";
         }
 
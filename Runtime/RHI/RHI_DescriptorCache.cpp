@@ -47,32 +47,43 @@ namespace Spartan
 
     void RHI_DescriptorCache::SetPipelineState(RHI_PipelineState& pipeline_state)
     {
-        // Name this resource, very useful for Vulkan debugging
-        m_name = (pipeline_state.shader_vertex ? pipeline_state.shader_vertex->GetName() : "null") + "-" + (pipeline_state.shader_pixel ? pipeline_state.shader_pixel->GetName() : "null");
-
-       // Compute shader hash (which defines the descriptor set layout)
-       size_t hash = 0;
-       Utility::Hash::hash_combine(hash, pipeline_state.shader_vertex->GetId());
-       if (pipeline_state.shader_pixel)
-       {
-           Utility::Hash::hash_combine(hash, pipeline_state.shader_pixel->GetId());
-       }
-
-       // If there is no descriptor set layout for this particular hash, create one
-       if (m_descriptor_set_layouts.find(hash) == m_descriptor_set_layouts.end())
-       {
-           // Generate descriptors from the reflected shaders
-           vector<RHI_Descriptor> descriptors = GenerateDescriptors(pipeline_state);
-
-           // Emplace a new descriptor set layout
-           m_descriptor_set_layouts.emplace(make_pair(hash, make_shared<RHI_DescriptorSetLayout>(m_rhi_device, descriptors)));
-       }
-
-       // Get the descriptor set layout we will be using
-        m_descriptor_layout_current = m_descriptor_set_layouts.at(hash).get();
+        RHI_DescriptorSetLayout* descriptor_set_layout = GetDescriptorSetLayout(pipeline_state);
+
+        // Name this resource, very useful for Vulkan debugging (only when it changes, this runs for every pass)
+        if (descriptor_set_layout != m_descriptor_layout_current)
+        {
+            m_name = (pipeline_state.shader_vertex ? pipeline_state.shader_vertex->GetName() : "null") + "-" + (pipeline_state.shader_pixel ? pipeline_state.shader_pixel->GetName() : "null");
+        }
+
+        // Get the descriptor set layout we will be using
+        m_descriptor_layout_current = descriptor_set_layout;
         m_descriptor_layout_current->NeedsToBind();
     }
 
+    RHI_DescriptorSetLayout* RHI_DescriptorCache::GetDescriptorSetLayout(RHI_PipelineState& pipeline_state)
+    {
+        // Compute shader hash (which defines the descriptor set layout)
+        size_t hash = 0;
+        Utility::Hash::hash_combine(hash, pipeline_state.shader_vertex->GetId());
+        if (pipeline_state.shader_pixel)
+        {
+            Utility::Hash::hash_combine(hash, pipeline_state.shader_pixel->GetId());
+        }
+
+        // If there is no descriptor set layout for this particular hash, create one
+        auto it = m_descriptor_set_layouts.find(hash);
+        if (it == m_descriptor_set_layouts.end())
+        {
+            // Generate descriptors from the reflected shaders
+            vector<RHI_Descriptor> descriptors = GenerateDescriptors(pipeline_state);
+
+            // Emplace a new descriptor set layout
+            it = m_descriptor_set_layouts.emplace(make_pair(hash, make_shared<RHI_DescriptorSetLayout>(m_rhi_device, descriptors))).first;
+        }
+
+        return it->second.get();
+    }
+
     void RHI_DescriptorCache::SetConstantBuffer(const uint32_t slot, RHI_ConstantBuffer* constant_buffer)
     {
         if (!m_descriptor_layout_current)
@@ -106,6 +117,17 @@ namespace Spartan
         m_descriptor_layout_current->SetTexture(slot, texture);
     }
 
+    void RHI_DescriptorCache::SetTextureArray(const uint32_t slot, const vector<RHI_Texture*>& textures)
+    {
+        if (!m_descriptor_layout_current)
+        {
+            LOG_ERROR("Invalid descriptor set layout");
+            return;
+        }
+
+        m_descriptor_layout_current->SetTextureArray(slot, textures);
+    }
+
     void* RHI_DescriptorCache::GetResource_DescriptorSetLayout() const
     {
         if (!m_descriptor_layout_current)
@@ -117,6 +139,11 @@ namespace Spartan
         return m_descriptor_layout_current->GetResource_DescriptorSetLayout();
     }
 
+    void* RHI_DescriptorCache::GetResource_DescriptorSetLayout(RHI_PipelineState& pipeline_state)
+    {
+        return GetDescriptorSetLayout(pipeline_state)->GetResource_DescriptorSetLayout();
+    }
+
     bool RHI_DescriptorCache::GetResource_DescriptorSet(void*& descriptor_set)
     {
         if (!m_descriptor_layout_current)
@@ -139,20 +166,41 @@ namespace Spartan
         return m_descriptor_layout_current->GetDynamicOffsets();
     }
 
-    bool RHI_DescriptorCache::HasEnoughCapacity() const
+    bool RHI_DescriptorCache::HasEnoughCapacity()
     {
-        return m_descriptor_set_capacity > GetDescriptorSetCount();
+        // D3D11 binds resources directly, it has no descriptor pool to fill, so nothing is ever evicted
+        #if defined(API_GRAPHICS_D3D11)
+            return true;
+        #else
+            if (m_descriptor_set_capacity > GetDescriptorSetCount())
+                return true;
+
+            // Free the descriptor sets which haven't been used for a few frames, the GPU is done with them
+            if (m_frame >= m_descriptor_set_frames_unused)
+            {
+                uint32_t evicted = 0;
+                for (const auto& it : m_descriptor_set_layouts)
+                {
+                    evicted += it.second->EvictDescriptorSets(this, m_frame - m_descriptor_set_frames_unused + 1);
+                }
+
+                if (evicted != 0)
+                    return true;
+            }
+
+            // Everything is in use, grow
+            m_descriptor_set_pool_full = true;
+            return false;
+        #endif
     }
 
     void RHI_DescriptorCache::GrowIfNeeded()
     {
-        // If there is room for at least one more descriptor set (hence +1), we don't need to re-allocate yet
-        const uint32_t required_capacity = GetDescriptorSetCount() + 1;
-
-        // If we are over-budget, re-allocate the descriptor pool with double size
-        if (required_capacity > m_descriptor_set_capacity)
+        // If a descriptor set couldn't be allocated, re-allocate the descriptor pool with double size
+        if (m_descriptor_set_pool_full)
         {
-            m_descriptor_set_capacity *= 2;
+            m_descriptor_set_pool_full  = false;
+            m_descriptor_set_capacity   *= 2;
             SetDescriptorSetCapacity(m_descriptor_set_capacity);
             LOG_INFO("Capacity has been increased to %d elements", m_descriptor_set_capacity);
         }
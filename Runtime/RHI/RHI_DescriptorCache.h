@@ -43,30 +43,43 @@ namespace Spartan
         void SetConstantBuffer(const uint32_t slot, RHI_ConstantBuffer* constant_buffer);
         void SetSampler(const uint32_t slot, RHI_Sampler* sampler);
         void SetTexture(const uint32_t slot, RHI_Texture* texture);
+        void SetTextureArray(const uint32_t slot, const std::vector<RHI_Texture*>& textures);
 
         // Properties
         void* GetResource_DescriptorSetPool() const { return m_descriptor_pool; }
         void* GetResource_DescriptorSetLayout() const;
+        void* GetResource_DescriptorSetLayout(RHI_PipelineState& pipeline_state); // doesn't make it current, used to precompile pipelines
         bool GetResource_DescriptorSet(void*& descriptor_set);
         const std::vector<uint32_t>& GetDynamicOffsets() const;
 
-        // Capacity
-        bool HasEnoughCapacity() const;
+        // Capacity, when the pool is full, descriptor sets which weren't used for a few frames are evicted.
+        // Only if there are none, the pool grows (which re-creates everything) at the start of the next pass.
+        bool HasEnoughCapacity();
         void GrowIfNeeded();
 
+        // Frame, to track when descriptor sets were last used
+        void AdvanceFrame()         { m_frame++; }
+        uint64_t GetFrame() const   { return m_frame; }
+
     private:
         uint32_t GetDescriptorSetCount() const;
         void SetDescriptorSetCapacity(uint32_t descriptor_capacity);
         bool CreateDescriptorPool(uint32_t descriptor_set_capacity);
         std::vector<RHI_Descriptor> GenerateDescriptors(RHI_PipelineState& pipeline_state);
+        RHI_DescriptorSetLayout* GetDescriptorSetLayout(RHI_PipelineState& pipeline_state);
 
         // Descriptor set layouts 
         std::unordered_map<std::size_t, std::shared_ptr<RHI_DescriptorSetLayout>> m_descriptor_set_layouts;
         RHI_DescriptorSetLayout* m_descriptor_layout_current = nullptr;
 
         // Descriptor pool
-        uint32_t m_descriptor_set_capacity = 16;
-        void* m_descriptor_pool = nullptr;
+        uint32_t m_descriptor_set_capacity  = 16;
+        bool m_descriptor_set_pool_full     = false;
+        void* m_descriptor_pool             = nullptr;
+
+        // Eviction, the frames a descriptor set has to go unused, more than there can be in flight
+        const uint64_t m_descriptor_set_frames_unused = 3;
+        uint64_t m_frame = 0;
 
         // Dependencies
         const RHI_Device* m_rhi_device;
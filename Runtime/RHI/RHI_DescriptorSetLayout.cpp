@@ -27,6 +27,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "RHI_Implementation.h"
 #include "RHI_DescriptorCache.h"
 #include "../Utilities/Hash.h"
+#include "../Core/Context.h"
+#include "../Profiling/Profiler.h"
 //==================================
 
 //= NAMESPACES =====
@@ -38,8 +40,16 @@ namespace Spartan
     RHI_DescriptorSetLayout::RHI_DescriptorSetLayout(const RHI_Device* rhi_device, const std::vector<RHI_Descriptor>& descriptors)
     {
         m_rhi_device            = rhi_device;
+        m_profiler              = rhi_device->GetContext()->GetSubsystem<Profiler>();
         m_descriptors           = descriptors;
         m_descriptor_set_layout = CreateDescriptorSetLayout(m_descriptors);
+
+        m_descriptor_hashes.reserve(m_descriptors.size());
+        for (const RHI_Descriptor& descriptor : m_descriptors)
+        {
+            m_descriptor_hashes.emplace_back(ComputeDescriptorHash(descriptor));
+            m_hash ^= m_descriptor_hashes.back();
+        }
     }
 
     void RHI_DescriptorSetLayout::SetConstantBuffer(const uint32_t slot, RHI_ConstantBuffer* constant_buffer)
@@ -64,6 +74,8 @@ namespace Spartan
                 descriptor.offset   = constant_buffer->GetOffset();
                 descriptor.range    = constant_buffer->GetStride();
 
+                UpdateDescriptorHash(descriptor);
+
                 // Update the dynamic offset.
                 // Note: This is not directly related to the descriptor, it's a value that gets set when vkCmdBindDescriptorSets is called, just before a draw call.
                 if (is_dynamic)
@@ -94,6 +106,7 @@ namespace Spartan
 
                 // Update
                 descriptor.resource = sampler->GetResource();
+                UpdateDescriptorHash(descriptor);
 
                 break;
             }
@@ -124,35 +137,73 @@ namespace Spartan
                 // Update
                 descriptor.resource = texture->Get_View_Texture();
                 descriptor.layout   = texture->GetLayout();
+                UpdateDescriptorHash(descriptor);
 
                 break;
             }
         }
     }
 
-    bool RHI_DescriptorSetLayout::GetResource_DescriptorSet(RHI_DescriptorCache* descriptor_cache, void*& descriptor_set)
+    void RHI_DescriptorSetLayout::SetTextureArray(const uint32_t slot, const vector<RHI_Texture*>& textures)
     {
-        // Get the hash of the current state of the descriptors
-        const size_t hash = ComputeDescriptorSetHash(m_descriptors);
-
-        // If we don't have a descriptor set to match that state, create one
-        if (m_descriptor_sets.find(hash) == m_descriptor_sets.end())
+        for (RHI_Descriptor& descriptor : m_descriptors)
         {
-            // Only allocate if the descriptor set cache hash enough capacity
-            if (descriptor_cache->HasEnoughCapacity())
+            if (descriptor.type == RHI_Descriptor_Texture && descriptor.slot == slot + m_rhi_device->GetContextRhi()->shader_shift_texture)
             {
-                descriptor_set = CreateDescriptorSet(hash, descriptor_cache);
+                if (descriptor.array_size < 2)
+                {
+                    LOG_ERROR("Descriptor at slot %d is not an array", slot);
+                    return;
+                }
+
+                if (textures.size() != descriptor.array_size)
+                {
+                    LOG_ERROR("Expected %d textures, got %d", descriptor.array_size, static_cast<uint32_t>(textures.size()));
+                    return;
+                }
+
+                // Update (the array is expected to be full, elements which aren't used must point to a valid texture)
+                descriptor.resource_array.resize(textures.size());
+                for (uint32_t i = 0; i < static_cast<uint32_t>(textures.size()); i++)
+                {
+                    descriptor.resource_array[i] = textures[i]->Get_View_Texture();
+                }
+                descriptor.layout = RHI_Image_Shader_Read_Only_Optimal;
+
+                // Determine if the descriptor set needs to bind (comparing every element is what the hash is for)
+                const size_t hash_previous = m_hash;
+                UpdateDescriptorHash(descriptor);
+                m_needs_to_bind = m_hash != hash_previous ? true : m_needs_to_bind; // affects vkUpdateDescriptorSets
+
+                break;
             }
-            else
-            {
+        }
+    }
+
+    bool RHI_DescriptorSetLayout::GetResource_DescriptorSet(RHI_DescriptorCache* descriptor_cache, void*& descriptor_set)
+    {
+        auto it = m_descriptor_sets.find(m_hash);
+
+        // If we don't have a descriptor set to match the current state of the descriptors, create one
+        if (it == m_descriptor_sets.end())
+        {
+            m_profiler->m_rhi_descriptor_set_misses++;
+
+            // Only allocate if the descriptor set cache has enough capacity (it evicts unused descriptor sets to make room)
+            if (!descriptor_cache->HasEnoughCapacity())
                 return false;
-            }
+
+            descriptor_set = CreateDescriptorSet(m_hash, descriptor_cache);
+            m_profiler->m_rhi_descriptor_set_allocations++;
         }
         else // retrieve the existing one
         {
+            m_profiler->m_rhi_descriptor_set_hits++;
+            it->second.frame_used = descriptor_cache->GetFrame();
+
             if (m_needs_to_bind)
             {
-                descriptor_set  = m_descriptor_sets[hash];
+                descriptor_set  = it->second.resource;
                 m_needs_to_bind = false;
             }
         }
@@ -160,21 +211,60 @@ namespace Spartan
         return true;
     }
 
-    size_t RHI_DescriptorSetLayout::ComputeDescriptorSetHash(const vector<RHI_Descriptor>& descriptors)
+    uint32_t RHI_DescriptorSetLayout::EvictDescriptorSets(const RHI_DescriptorCache* descriptor_cache, const uint64_t frame_unused_since)
+    {
+        vector<void*> descriptor_sets;
+        for (auto it = m_descriptor_sets.begin(); it != m_descriptor_sets.end();)
+        {
+            if (it->second.frame_used < frame_unused_since)
+            {
+                descriptor_sets.emplace_back(it->second.resource);
+                it = m_descriptor_sets.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (!descriptor_sets.empty())
+        {
+            FreeDescriptorSets(descriptor_sets, descriptor_cache);
+            m_profiler->m_rhi_descriptor_set_evictions += static_cast<uint32_t>(descriptor_sets.size());
+
+            // The bound descriptor set might be one of them
+            m_needs_to_bind = true;
+        }
+
+        return static_cast<uint32_t>(descriptor_sets.size());
+    }
+
+    size_t RHI_DescriptorSetLayout::ComputeDescriptorHash(const RHI_Descriptor& descriptor)
     {
         size_t hash = 0;
 
-        for (const RHI_Descriptor& descriptor : descriptors)
+        Utility::Hash::hash_combine(hash, descriptor.slot);
+        Utility::Hash::hash_combine(hash, descriptor.stage);
+        Utility::Hash::hash_combine(hash, descriptor.offset);
+        Utility::Hash::hash_combine(hash, descriptor.range);
+        Utility::Hash::hash_combine(hash, descriptor.resource);
+        Utility::Hash::hash_combine(hash, static_cast<uint32_t>(descriptor.type));
+        Utility::Hash::hash_combine(hash, static_cast<uint32_t>(descriptor.layout));
+
+        for (void* resource : descriptor.resource_array)
         {
-            Utility::Hash::hash_combine(hash, descriptor.slot);
-            Utility::Hash::hash_combine(hash, descriptor.stage);
-            Utility::Hash::hash_combine(hash, descriptor.offset);
-            Utility::Hash::hash_combine(hash, descriptor.range);
-            Utility::Hash::hash_combine(hash, descriptor.resource);
-            Utility::Hash::hash_combine(hash, static_cast<uint32_t>(descriptor.type));
-            Utility::Hash::hash_combine(hash, static_cast<uint32_t>(descriptor.layout));
+            Utility::Hash::hash_combine(hash, resource);
         }
 
         return hash;
     }
+
+    void RHI_DescriptorSetLayout::UpdateDescriptorHash(const RHI_Descriptor& descriptor)
+    {
+        const size_t index  = &descriptor - m_descriptors.data();
+        const size_t hash   = ComputeDescriptorHash(descriptor);
+
+        m_hash                      ^= m_descriptor_hashes[index] ^ hash;
+        m_descriptor_hashes[index]  = hash;
+    }
 }
@@ -30,6 +30,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan
 {
+    class Profiler;
+
     class SPARTAN_CLASS RHI_DescriptorSetLayout : public RHI_Object
     {
     public:
@@ -40,8 +42,10 @@ namespace Spartan
         void SetConstantBuffer(const uint32_t slot, RHI_ConstantBuffer* constant_buffer);
         void SetSampler(const uint32_t slot, RHI_Sampler* sampler);
         void SetTexture(const uint32_t slot, RHI_Texture* texture);
+        void SetTextureArray(const uint32_t slot, const std::vector<RHI_Texture*>& textures);
 
         bool GetResource_DescriptorSet(RHI_DescriptorCache* descriptor_cache, void*& descriptor_set);
+        uint32_t EvictDescriptorSets(const RHI_DescriptorCache* descriptor_cache, const uint64_t frame_unused_since);
         void* GetResource_DescriptorSetLayout()             const { return m_descriptor_set_layout; }
         const std::vector<uint32_t>& GetDynamicOffsets()    const { return m_constant_buffer_dynamic_offsets; }
         uint32_t GetDescriptorSetCount()                    const { return static_cast<uint32_t>(m_descriptor_sets.size()); }
@@ -49,8 +53,10 @@ namespace Spartan
         void NeedsToBind() { m_needs_to_bind = true; }
 
     private:
-        std::size_t ComputeDescriptorSetHash(const std::vector<RHI_Descriptor>& descriptors);
+        static std::size_t ComputeDescriptorHash(const RHI_Descriptor& descriptor);
+        void UpdateDescriptorHash(const RHI_Descriptor& descriptor);
         void* CreateDescriptorSet(const std::size_t hash, const RHI_DescriptorCache* descriptor_cache);
+        void FreeDescriptorSets(const std::vector<void*>& descriptor_sets, const RHI_DescriptorCache* descriptor_cache);
         void UpdateDescriptorSet(void* descriptor_set, const std::vector<RHI_Descriptor>& descriptors);
         void* CreateDescriptorSetLayout(const std::vector<RHI_Descriptor>& descriptors);
 
@@ -58,16 +64,24 @@ namespace Spartan
         bool m_needs_to_bind = false;
         std::vector<uint32_t> m_constant_buffer_dynamic_offsets;
 
-        // Descriptors
+        // Descriptors, the hash of their current state is the xor of their individual hashes, so setting one only re-hashes that one
         std::vector<RHI_Descriptor> m_descriptors;
+        std::vector<std::size_t> m_descriptor_hashes;
+        std::size_t m_hash = 0;
 
-        // Descriptor sets
-        std::unordered_map<std::size_t, void*> m_descriptor_sets;
+        // Descriptor sets (and the frame they were last used in, so that unused ones can be evicted)
+        struct DescriptorSet
+        {
+            void* resource      = nullptr;
+            uint64_t frame_used = 0;
+        };
+        std::unordered_map<std::size_t, DescriptorSet> m_descriptor_sets;
 
         // Descriptor set layout
         void* m_descriptor_set_layout = nullptr;
 
         // Dependencies
-        const RHI_Device* m_rhi_device = nullptr;
+        const RHI_Device* m_rhi_device  = nullptr;
+        Profiler* m_profiler            = nullptr;
     };
 }
@@ -167,6 +167,9 @@ namespace Spartan
         const DisplayMode* GetPrimaryDisplayMode();
         bool ValidateResolution(const uint32_t width, const uint32_t height) const;
 
+        // Formats
+        bool IsBlockCompressionSupported() const;
+
         // Queue
         bool Queue_Present(void* swapchain_view, uint32_t* image_index) const;
         bool Queue_Submit(const RHI_Queue_Type type, void* cmd_buffer, void* wait_semaphore = nullptr, void* wait_fence = nullptr, const uint32_t wait_flags = 0) const;
@@ -79,6 +79,15 @@ static const DXGI_FORMAT d3d11_format[] =
     // Depth
     DXGI_FORMAT_D32_FLOAT,
     DXGI_FORMAT_D32_FLOAT_S8X24_UINT,
+    // Vertex
+    DXGI_FORMAT_R16G16_UNORM,
+    DXGI_FORMAT_R16G16_SNORM,
+    DXGI_FORMAT_R16G16B16A16_UNORM,
+    // Block compressed
+    DXGI_FORMAT_BC1_UNORM,
+    DXGI_FORMAT_BC4_UNORM,
+    DXGI_FORMAT_BC5_UNORM,
+    DXGI_FORMAT_BC7_UNORM,
 
     DXGI_FORMAT_UNKNOWN
 };
@@ -198,6 +207,15 @@ static const VkFormat vulkan_format[] =
     // DEPTH
     VK_FORMAT_D32_SFLOAT,
     VK_FORMAT_D32_SFLOAT_S8_UINT,
+    // VERTEX
+    VK_FORMAT_R16G16_UNORM,
+    VK_FORMAT_R16G16_SNORM,
+    VK_FORMAT_R16G16B16A16_UNORM,
+    // BLOCK COMPRESSED
+    VK_FORMAT_BC1_RGBA_UNORM_BLOCK,
+    VK_FORMAT_BC4_UNORM_BLOCK,
+    VK_FORMAT_BC5_UNORM_BLOCK,
+    VK_FORMAT_BC7_UNORM_BLOCK,
 
     VK_FORMAT_MAX_ENUM
 };
@@ -315,6 +333,7 @@ namespace Spartan
         #if defined(API_GRAPHICS_D3D11)
             ID3D11Device* device                    = nullptr;
             ID3D11DeviceContext* device_context     = nullptr;
+            ID3D11DeviceContext1* device_context_1  = nullptr; // constant buffer offsets, for dynamic constant buffers
             ID3DUserDefinedAnnotation* annotation   = nullptr;
         #endif
 
@@ -377,10 +396,13 @@ namespace Spartan
         static const uint32_t descriptor_max_constant_buffers_dynamic   = 10;
         static const uint32_t descriptor_max_samplers                   = 10;
         static const uint32_t descriptor_max_textures                   = 10;
+        static const uint32_t descriptor_max_texture_array              = 256; // bindless texture table
 
         // Device limits
         uint32_t max_texture_dimension_2d   = 16384;
         uint32_t max_msaa_level             = 0;
+        bool bindless_textures              = false; // texture arrays which can be indexed with values from a constant buffer
+        bool block_compression              = true;  // BC1-BC7 texture formats
 
         // Queues
         void* queue_graphics            = nullptr;
@@ -117,6 +117,17 @@ namespace Spartan
 				};
 			}
 
+			if (vertex_type == RHI_Vertex_Type_PositionTextureNormalTangentPacked)
+			{
+				m_vertex_attributes =
+				{
+					{ "POSITION",	0, binding, RHI_Format_R16G16B16A16_Unorm,	offsetof(RHI_Vertex_PosTexNorTan_Packed, pos) },
+					{ "TEXCOORD",	1, binding, RHI_Format_R16G16_Unorm,		offsetof(RHI_Vertex_PosTexNorTan_Packed, tex) },
+					{ "NORMAL",		2, binding, RHI_Format_R16G16_Snorm,		offsetof(RHI_Vertex_PosTexNorTan_Packed, nor) },
+					{ "TANGENT",	3, binding, RHI_Format_R16G16_Snorm,		offsetof(RHI_Vertex_PosTexNorTan_Packed, tan) }
+				};
+			}
+
 			if (vertex_shader_blob && !m_vertex_attributes.empty())
 			{
 				return _CreateResource(vertex_shader_blob);
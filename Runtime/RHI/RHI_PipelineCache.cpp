@@ -42,41 +42,49 @@ namespace Spartan
             return nullptr;
         }
 
-        // Render target layout transitions
+        // Update its hash, which is only recomputed if the state changed since the last time
+        pipeline_state.ComputeHash();
+
+        // Most passes submit the same state every frame, so there is no need to look it up again
+        if (RHI_Pipeline* pipeline = pipeline_state.GetPipelineCached())
+            return pipeline;
+
+        RHI_Pipeline* pipeline = Acquire(pipeline_state, descriptor_set_layout);
+        pipeline_state.SetPipelineCached(pipeline);
+
+        return pipeline;
+    }
+
+    bool RHI_PipelineCache::Precompile(RHI_PipelineState& pipeline_state, void* descriptor_set_layout)
+    {
+        if (!pipeline_state.IsValid())
         {
-            // Color
-            for (auto i = 0; i < state_max_render_target_count; i++)
-            {
-                if (RHI_Texture* texture = pipeline_state.render_target_color_textures[i])
-                {
-                    texture->SetLayout(RHI_Image_Shader_Read_Only_Optimal, cmd_list);
-                }
-            }
-
-            // Depth
-            if (RHI_Texture* texture = pipeline_state.render_target_depth_texture)
-            {
-                texture->SetLayout(RHI_Image_Depth_Stencil_Attachment_Optimal, cmd_list);
-            }
-
-            // Swapchain
-            if (RHI_SwapChain* swapchain = pipeline_state.render_target_swapchain)
-            {
-                swapchain->SetLayout(RHI_Image_Present_Src, cmd_list);
-            }
+            LOG_ERROR("Invalid pipeline state");
+            return false;
         }
 
-        // Compute a hash for it
         pipeline_state.ComputeHash();
-        size_t hash = pipeline_state.GetHash();
 
-        // If no pipeline exists for this state, create one
-        if (m_cache.find(hash) == m_cache.end())
+        return Acquire(pipeline_state, descriptor_set_layout) != nullptr;
+    }
+
+    RHI_Pipeline* RHI_PipelineCache::Acquire(RHI_PipelineState& pipeline_state, void* descriptor_set_layout)
+    {
+        const size_t hash = pipeline_state.GetHash();
+
+        // Return the pipeline if it exists
         {
-            // Cache a new pipeline
-            m_cache.emplace(make_pair(hash, move(make_shared<RHI_Pipeline>(m_rhi_device, pipeline_state, descriptor_set_layout))));
+            lock_guard<mutex> lock(m_mutex);
+            auto it = m_cache.find(hash);
+            if (it != m_cache.end())
+                return it->second.get();
         }
 
-        return m_cache[hash].get();
+        // Create a new one, outside of the lock as this is the expensive part
+        shared_ptr<RHI_Pipeline> pipeline = make_shared<RHI_Pipeline>(m_rhi_device, pipeline_state, descriptor_set_layout);
+
+        // Cache it, if another thread got there first, theirs is kept
+        lock_guard<mutex> lock(m_mutex);
+        return m_cache.emplace(hash, move(pipeline)).first->second.get();
     }
 }
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES ==============
+#include <mutex>
 #include <memory>
 #include <unordered_map>
 #include "RHI_Definition.h"
@@ -36,9 +37,16 @@ namespace Spartan
         RHI_PipelineCache(const RHI_Device* rhi_device) { m_rhi_device = rhi_device; }
         RHI_Pipeline* GetPipeline(RHI_CommandList* cmd_list, RHI_PipelineState& pipeline_state, void* descriptor_set_layout);
 
+        // Creates the pipeline ahead of time, so that drawing with this state doesn't have to, safe to call from multiple threads
+        bool Precompile(RHI_PipelineState& pipeline_state, void* descriptor_set_layout);
+
 	private:
+        RHI_Pipeline* Acquire(RHI_PipelineState& pipeline_state, void* descriptor_set_layout);
+
         // <hash of pipeline state, pipeline state object>
+        // Pipelines are never removed, pipeline states keep pointers to them (see RHI_PipelineState::GetPipelineCached())
         std::unordered_map<std::size_t, std::shared_ptr<RHI_Pipeline>> m_cache;
+        std::mutex m_mutex;
 
         // Dependencies
         const RHI_Device* m_rhi_device;
@@ -127,40 +127,64 @@ namespace Spartan
 
 	void RHI_PipelineState::ComputeHash()
     {
-        m_hash = 0;
-
-        Utility::Hash::hash_combine(m_hash, scissor.left);
-        Utility::Hash::hash_combine(m_hash, scissor.top);
-        Utility::Hash::hash_combine(m_hash, scissor.right);
-        Utility::Hash::hash_combine(m_hash, scissor.bottom);
-        Utility::Hash::hash_combine(m_hash, viewport.x);
-        Utility::Hash::hash_combine(m_hash, viewport.y);
-        Utility::Hash::hash_combine(m_hash, viewport.width);
-        Utility::Hash::hash_combine(m_hash, viewport.height);
-        Utility::Hash::hash_combine(m_hash, primitive_topology);
-        Utility::Hash::hash_combine(m_hash, vertex_buffer_stride);
-        Utility::Hash::hash_combine(m_hash, rasterizer_state->GetId());
-        Utility::Hash::hash_combine(m_hash, blend_state->GetId());
-        Utility::Hash::hash_combine(m_hash, depth_stencil_state->GetId());
-        Utility::Hash::hash_combine(m_hash, shader_vertex->GetId());
-        Utility::Hash::hash_combine(m_hash, dynamic_scissor);
-
-        if (shader_pixel)
-        {
-            Utility::Hash::hash_combine(m_hash, shader_pixel->GetId());
-        }
+        // Gather what the pipeline depends on, viewport, scissor and clear values are dynamic, so they are left out
+        HashInputs inputs                   = {};
+        inputs.primitive_topology           = primitive_topology;
+        inputs.vertex_buffer_stride         = vertex_buffer_stride;
+        inputs.rasterizer_state             = rasterizer_state->GetId();
+        inputs.blend_state                  = blend_state->GetId();
+        inputs.depth_stencil_state          = depth_stencil_state->GetId();
+        inputs.shader_vertex                = shader_vertex->GetId();
+        inputs.shader_pixel                 = shader_pixel ? shader_pixel->GetId() : 0;
+        inputs.render_target_depth_texture  = render_target_depth_texture ? render_target_depth_texture->GetId() : 0;
 
         for (auto i = 0; i < state_max_render_target_count; i++)
         {
             if (render_target_color_textures[i])
             {
-                Utility::Hash::hash_combine(m_hash, render_target_color_textures[i]->GetId());
+                inputs.render_target_color_textures[i] = render_target_color_textures[i]->GetId();
+                inputs.clear_mask |= (clear_color[i] != state_dont_clear_color) ? (1 << i) : 0;
             }
         }
 
         if (render_target_depth_texture)
         {
-            Utility::Hash::hash_combine(m_hash, render_target_depth_texture->GetId());
+            inputs.clear_mask |= (clear_depth != state_dont_clear_depth)        ? (1 << state_max_render_target_count) : 0;
+            inputs.clear_mask |= (clear_stencil != state_dont_clear_stencil)    ? (1 << (state_max_render_target_count + 1)) : 0;
+        }
+
+        if (render_target_swapchain)
+        {
+            // The swapchain resizes in place, so its size goes in as well (the frame buffers depend on it)
+            inputs.render_target_swapchain  = render_target_swapchain->GetId();
+            inputs.swapchain_width          = render_target_swapchain->GetWidth();
+            inputs.swapchain_height         = render_target_swapchain->GetHeight();
+            inputs.clear_mask               |= (clear_color[0] != state_dont_clear_color) ? (1 << (state_max_render_target_count + 2)) : 0;
+        }
+
+        // Passes assign their state before every use, but it rarely changes, in which case the hash still holds
+        if (m_hash_inputs_valid && memcmp(&inputs, &m_hash_inputs, sizeof(HashInputs)) == 0)
+            return;
+
+        m_hash_inputs       = inputs;
+        m_hash_inputs_valid = true;
+
+        m_hash = 0;
+        Utility::Hash::hash_combine(m_hash, inputs.primitive_topology);
+        Utility::Hash::hash_combine(m_hash, inputs.vertex_buffer_stride);
+        Utility::Hash::hash_combine(m_hash, inputs.rasterizer_state);
+        Utility::Hash::hash_combine(m_hash, inputs.blend_state);
+        Utility::Hash::hash_combine(m_hash, inputs.depth_stencil_state);
+        Utility::Hash::hash_combine(m_hash, inputs.shader_vertex);
+        Utility::Hash::hash_combine(m_hash, inputs.shader_pixel);
+        Utility::Hash::hash_combine(m_hash, inputs.render_target_depth_texture);
+        for (const uint32_t id : inputs.render_target_color_textures)
+        {
+            Utility::Hash::hash_combine(m_hash, id);
         }
+        Utility::Hash::hash_combine(m_hash, inputs.render_target_swapchain);
+        Utility::Hash::hash_combine(m_hash, inputs.swapchain_width);
+        Utility::Hash::hash_combine(m_hash, inputs.swapchain_height);
+        Utility::Hash::hash_combine(m_hash, inputs.clear_mask);
     }
 }
@@ -40,7 +40,7 @@ namespace Spartan
         bool AcquireNextImage() const;      
         bool CreateFrameResources(const RHI_Device* rhi_device);
         void* GetFrameBuffer() const;
-        void ComputeHash();
+        void ComputeHash(); // only re-hashes if something the pipeline depends on changed since the last call
         uint32_t GetWidth() const;
         uint32_t GetHeight() const;
         void ResetClearValues();
@@ -48,6 +48,10 @@ namespace Spartan
         void* GetRenderPass()                           const { return m_render_pass; }
         bool operator==(const RHI_PipelineState& rhs)   const { return m_hash == rhs.GetHash(); }
 
+        // The pipeline this state resolved to the last time, valid for as long as the hash doesn't change
+        RHI_Pipeline* GetPipelineCached()               const { return m_pipeline_hash == m_hash ? m_pipeline : nullptr; }
+        void SetPipelineCached(RHI_Pipeline* pipeline)        { m_pipeline = pipeline; m_pipeline_hash = m_hash; }
+
         //= State (things that if changed, will cause a new pipeline to be generated) ==============================
         RHI_Shader* shader_vertex                                                   = nullptr; 
         RHI_RasterizerState* rasterizer_state                                       = nullptr;
@@ -55,12 +59,15 @@ namespace Spartan
         RHI_DepthStencilState* depth_stencil_state                                  = nullptr;
         RHI_SwapChain* render_target_swapchain                                      = nullptr;
         RHI_PrimitiveTopology_Mode primitive_topology                               = RHI_PrimitiveTopology_Unknown;
-        RHI_Viewport viewport                                                       = RHI_Viewport::Undefined;
-        Math::Rectangle scissor                                                     = Math::Rectangle::Zero;
         uint32_t vertex_buffer_stride                                               = 0;
         RHI_Texture* render_target_depth_texture                                    = nullptr;    
         RHI_Texture* render_target_color_textures[state_max_render_target_count]    = { nullptr };
-        bool dynamic_scissor                                                        = false;
+        //==========================================================================================================
+
+        //= Dynamic state (set when the command list begins, doesn't generate new pipelines) =======================
+        RHI_Viewport viewport                                                       = RHI_Viewport::Undefined;
+        Math::Rectangle scissor                                                     = Math::Rectangle::Zero;
+        bool dynamic_scissor                                                        = false; // the scissor is set by the pass, not from the state
         //==========================================================================================================
         RHI_Shader* shader_pixel                                                    = nullptr;
         RHI_Shader* shader_compute                                                  = nullptr;
@@ -74,7 +81,7 @@ namespace Spartan
         // Dynamic constant buffers
         int dynamic_constant_buffer_slot = 2; // such a hack, must fix
 
-        // Clear values
+        // Clear values, only whether an attachment is cleared or not is part of the pipeline (render pass load op)
         float clear_depth                                         = state_dont_clear_depth;
         uint8_t clear_stencil                                     = state_dont_clear_stencil;
         Math::Vector4 clear_color[state_max_render_target_count]  = { state_dont_clear_color };
@@ -86,8 +93,30 @@ namespace Spartan
 
     private:
         void DestroyFrameResources();
+
+        // What the hash was computed from, plain values only (no padding), so that they can be compared with memcmp
+        struct HashInputs
+        {
+            RHI_PrimitiveTopology_Mode primitive_topology;
+            uint32_t vertex_buffer_stride;
+            uint32_t rasterizer_state;
+            uint32_t blend_state;
+            uint32_t depth_stencil_state;
+            uint32_t shader_vertex;
+            uint32_t shader_pixel;
+            uint32_t render_target_depth_texture;
+            uint32_t render_target_color_textures[state_max_render_target_count];
+            uint32_t render_target_swapchain;
+            uint32_t swapchain_width;
+            uint32_t swapchain_height;
+            uint32_t clear_mask; // one bit per color attachment, then depth, stencil and swapchain
+        };
+        HashInputs m_hash_inputs    = {};
+        bool m_hash_inputs_valid    = false;
   
         std::size_t m_hash          = 0;
+        std::size_t m_pipeline_hash = 0;
+        RHI_Pipeline* m_pipeline    = nullptr;
         void* m_render_pass         = nullptr;
         void* m_frame_buffers[state_max_render_target_count];
 
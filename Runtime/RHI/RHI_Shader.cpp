@@ -193,11 +193,14 @@ namespace Spartan
 		// Get textures
 		for (const auto& resource : resources.separate_images)
 		{
+            const spirv_cross::SPIRType& type = compiler.get_type(resource.type_id);
+
             m_descriptors.emplace_back
             (
                 RHI_Descriptor_Type::RHI_Descriptor_Texture,                    // Type
                 compiler.get_decoration(resource.id, spv::DecorationBinding),   // Slot
-                shader_type                                                     // Stage
+                shader_type,                                                    // Stage
+                type.array.empty() ? 1 : type.array[0]                          // Array size
             );
 		}
 
@@ -220,5 +223,6 @@ namespace Spartan
     template void RHI_Shader::CompileAsync<RHI_Vertex_PosCol>(Context*, const RHI_Shader_Type, const std::string&);
     template void RHI_Shader::CompileAsync<RHI_Vertex_Pos2dTexCol8>(Context*, const RHI_Shader_Type, const std::string&);
     template void RHI_Shader::CompileAsync<RHI_Vertex_PosTexNorTan>(Context*, const RHI_Shader_Type, const std::string&);
+    template void RHI_Shader::CompileAsync<RHI_Vertex_PosTexNorTan_Packed>(Context*, const RHI_Shader_Type, const std::string&);
     //===============================================================================================================
 }
@@ -168,7 +168,7 @@ namespace Spartan
                 const uint32_t mip_height = m_height >> mip_index;
 
                 m_size_cpu += mip_index < m_data.size() ? m_data[mip_index].size() * sizeof(std::byte) : 0;
-                m_size_gpu += mip_width * mip_height * (m_bits_per_channel / 8);
+                m_size_gpu += mip_width * mip_height * m_bits_per_channel / 8; // block compressed formats have less than 8 bits per pixel
             }
         }
 
@@ -290,6 +290,13 @@ namespace Spartan
 			case RHI_Format_R32G32B32A32_Float:	    return 4;
             case RHI_Format_D32_Float:			    return 1;
             case RHI_Format_D32_Float_S8X24_Uint:   return 2;
+			case RHI_Format_R16G16_Unorm:		    return 2;
+			case RHI_Format_R16G16_Snorm:		    return 2;
+			case RHI_Format_R16G16B16A16_Unorm:	    return 4;
+			case RHI_Format_BC1_Unorm:	            return 3;
+			case RHI_Format_BC4_Unorm:	            return 1;
+			case RHI_Format_BC5_Unorm:	            return 2;
+			case RHI_Format_BC7_Unorm:	            return 4;
 			default:						        return 0;
 		}
 	}
@@ -40,7 +40,11 @@ namespace Spartan
         RHI_Texture_DepthStencilViewReadOnly    = 1 << 4,
         RHI_Texture_Grayscale                   = 1 << 5,
         RHI_Texture_Transparent                 = 1 << 6,
-        RHI_Texture_GenerateMipsWhenLoading     = 1 << 7
+        RHI_Texture_GenerateMipsWhenLoading     = 1 << 7,
+        RHI_Texture_Transient                   = 1 << 8, // Contents don't outlive the frame, memory is bound later (see RenderGraph)
+        RHI_Texture_CompressWhenLoading         = 1 << 9, // Block compressed on import, sRGB color to BC1/BC7, normal maps to BC5, anything else to BC4 (red only)
+        RHI_Texture_Srgb                        = 1 << 10, // Gamma encoded color (albedo)
+        RHI_Texture_NormalMap                   = 1 << 11  // Tangent space normals
 	};
 
     enum RHI_Shader_View_Type : uint8_t
@@ -110,7 +114,15 @@ namespace Spartan
         void SetLayout(const RHI_Image_Layout layout, RHI_CommandList* command_list = nullptr);
         RHI_Image_Layout GetLayout() const { return m_layout; }
 
+        // Memory (transient textures are created without it and get bound into a shared heap)
+        bool IsTransient()          const { return m_flags & RHI_Texture_Transient; }
+        bool IsMemoryBound()        const { return m_resource_memory != nullptr; }
+        auto GetMemoryAlignment()   const { return m_memory_alignment; }
+        auto GetMemoryTypeBits()    const { return m_memory_type_bits; }
+        bool BindMemory(void* memory, const uint64_t offset);
+
         // Misc
+        auto GetFlags()             const { return m_flags; }
         auto GetArraySize()         const { return m_array_size; }
         const auto& GetViewport()   const { return m_viewport; }
 
@@ -138,6 +150,8 @@ namespace Spartan
 		RHI_Format m_format		                = RHI_Format_Undefined;
         RHI_Image_Layout m_layout               = RHI_Image_Undefined;
         uint16_t m_flags	                    = 0;
+        uint64_t m_memory_alignment             = 0;
+        uint32_t m_memory_type_bits             = 0;
 		RHI_Viewport m_viewport;
 		std::vector<std::vector<std::byte>> m_data;
 		std::shared_ptr<RHI_Device> m_rhi_device;
@@ -65,10 +65,10 @@ namespace Spartan
 		}
 
 		// Creates an empty texture (intended for deferred loading)
-		RHI_Texture2D(Context* context, const bool generate_mipmaps = true) : RHI_Texture(context)
+		RHI_Texture2D(Context* context, const bool generate_mipmaps = true, const uint16_t flags = 0) : RHI_Texture(context)
 		{
 			m_resource_type = Resource_Texture2d;
-			m_flags         = RHI_Texture_ShaderView;
+			m_flags         = RHI_Texture_ShaderView | flags;
             m_flags         |= generate_mipmaps ? RHI_Texture_GenerateMipsWhenLoading : 0;
 		}
 
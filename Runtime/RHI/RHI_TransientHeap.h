@@ -0,0 +1,56 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ==============
+#include <memory>
+#include "RHI_Object.h"
+#include "RHI_Definition.h"
+//=========================
+
+namespace Spartan
+{
+    // A block of device memory that transient textures get bound into at
+    // offsets, textures whose lifetimes don't overlap can share the same range.
+	class RHI_TransientHeap : public RHI_Object
+	{
+	public:
+		RHI_TransientHeap(const std::shared_ptr<RHI_Device>& rhi_device, const uint64_t size, const uint32_t memory_type_bits);
+		~RHI_TransientHeap();
+
+        // Binds a transient texture at the given offset (it has to satisfy the texture's alignment)
+        bool Bind(RHI_Texture* texture, const uint64_t offset) const;
+
+        bool IsValid()              const { return m_resource != nullptr; }
+		void* GetResource()         const { return m_resource; }
+
+        // Whether the API can place multiple resources in the same memory
+        static bool IsSupported();
+
+	private:
+		// API
+		void* m_resource = nullptr;
+
+        // Dependencies
+        std::shared_ptr<RHI_Device> m_rhi_device;
+	};
+}
@@ -127,11 +127,24 @@ namespace Spartan
 		float tan[3] = { 0 };
 	};
 
+	// RHI_Vertex_PosTexNorTan in 20 bytes instead of 44, for static meshes. Positions and uvs are normalized
+	// to the bounds of the model they belong to (which the shaders get, to undo it), normals and tangents are
+	// octahedral encoded.
+	struct RHI_Vertex_PosTexNorTan_Packed
+	{
+		uint16_t pos[4]	= { 0 }; // unorm, w is padding
+		uint16_t tex[2]	= { 0 }; // unorm
+		int16_t nor[2]	= { 0 }; // snorm
+		int16_t tan[2]	= { 0 }; // snorm
+	};
+
 	static_assert(std::is_trivially_copyable<RHI_Vertex_Pos>::value,			"RHI_Vertex_Pos is not trivially copyable");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_PosTex>::value,			"RHI_Vertex_PosTex is not trivially copyable");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_PosCol>::value,			"RHI_Vertex_PosCol is not trivially copyable");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_Pos2dTexCol8>::value,	"RHI_Vertex_Pos2dTexCol8 is not trivially copyable");
 	static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTan>::value,	"RHI_Vertex_PosTexNorTan is not trivially copyable");
+	static_assert(std::is_trivially_copyable<RHI_Vertex_PosTexNorTan_Packed>::value, "RHI_Vertex_PosTexNorTan_Packed is not trivially copyable");
+	static_assert(sizeof(RHI_Vertex_PosTexNorTan_Packed) == 20,					"RHI_Vertex_PosTexNorTan_Packed is not tightly packed");
 
 	enum RHI_Vertex_Type
 	{
@@ -140,7 +153,8 @@ namespace Spartan
 		RHI_Vertex_Type_PositionColor,
 		RHI_Vertex_Type_PositionTexture,
 		RHI_Vertex_Type_PositionTextureNormalTangent,
-		RHI_Vertex_Type_Position2dTextureColor8
+		RHI_Vertex_Type_Position2dTextureColor8,
+		RHI_Vertex_Type_PositionTextureNormalTangentPacked
 	};
 
 	template <typename T>
@@ -151,4 +165,5 @@ namespace Spartan
 	template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosCol>()			{ return RHI_Vertex_Type_PositionColor; }
 	template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_Pos2dTexCol8>()	{ return RHI_Vertex_Type_Position2dTextureColor8; }
 	template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosTexNorTan>()	{ return RHI_Vertex_Type_PositionTextureNormalTangent; }
+	template<> inline RHI_Vertex_Type RHI_Vertex_Type_To_Enum<RHI_Vertex_PosTexNorTan_Packed>() { return RHI_Vertex_Type_PositionTextureNormalTangentPacked; }
 }
@@ -137,6 +137,29 @@ namespace Spartan
         // Prepare descriptor cache for pipeline state
         m_descriptor_cache->SetPipelineState(pipeline_state);
 
+        // Transition the attachments to the layouts the render pass is built around. Transient render targets
+        // start every frame in an undefined layout (see RenderGraph), so this is also where they get discarded.
+        if (pipeline_state.IsValid())
+        {
+            for (uint32_t i = 0; i < state_max_render_target_count; i++)
+            {
+                if (RHI_Texture* texture = pipeline_state.render_target_color_textures[i])
+                {
+                    texture->SetLayout(RHI_Image_Shader_Read_Only_Optimal, this);
+                }
+            }
+
+            if (RHI_Texture* texture = pipeline_state.render_target_depth_texture)
+            {
+                texture->SetLayout(RHI_Image_Depth_Stencil_Attachment_Optimal, this);
+            }
+
+            if (RHI_SwapChain* swapchain = pipeline_state.render_target_swapchain)
+            {
+                swapchain->SetLayout(RHI_Image_Present_Src, this);
+            }
+        }
+
         // Get pipeline
         m_pipeline = m_pipeline_cache->GetPipeline(this, pipeline_state, m_descriptor_cache->GetResource_DescriptorSetLayout());
         if (!m_pipeline)
@@ -154,6 +177,18 @@ namespace Spartan
             return false;
         }
 
+        // Viewport and scissor are dynamic state, the pipeline doesn't carry them
+        if (pipeline_state.viewport.IsDefined())
+        {
+            SetViewport(pipeline_state.viewport);
+        }
+
+        if (!pipeline_state.dynamic_scissor)
+        {
+            const Math::Rectangle scissor = pipeline_state.scissor.IsDefined() ? pipeline_state.scissor : Math::Rectangle(0.0f, 0.0f, static_cast<float>(pipeline_state.GetWidth()), static_cast<float>(pipeline_state.GetHeight()));
+            SetScissorRectangle(scissor);
+        }
+
         // Keep a local pointer for convenience
         m_pipeline_state = &pipeline_state;
 
@@ -419,6 +454,33 @@ namespace Spartan
         m_descriptor_cache->SetTexture(slot, texture);
     }
 
+    void RHI_CommandList::SetTextureArray(const uint32_t slot, vector<RHI_Texture*>& textures, const uint8_t scope /*= RHI_Shader_Pixel*/)
+    {
+        if (m_cmd_state != RHI_Cmd_List_Recording)
+        {
+            LOG_WARNING("Can't record command");
+            return;
+        }
+
+        for (RHI_Texture*& texture : textures)
+        {
+            // Every element must be valid, so null textures and textures which are still staging are replaced with black
+            if (!texture || !texture->Get_View_Texture() || !texture->IsColorFormat() || texture->GetLayout() == RHI_Image_Undefined || texture->GetLayout() == RHI_Image_Preinitialized)
+            {
+                texture = m_renderer->GetBlackTexture();
+            }
+
+            // Transition to appropriate layout (if needed)
+            if (texture->GetLayout() != RHI_Image_Shader_Read_Only_Optimal)
+            {
+                texture->SetLayout(RHI_Image_Shader_Read_Only_Optimal, this);
+            }
+        }
+
+        // Set (will only happen if it's not already set)
+        m_descriptor_cache->SetTextureArray(slot, textures);
+    }
+
 	bool RHI_CommandList::Submit()
 	{
         if (m_cmd_state != RHI_Cmd_List_Ended)
@@ -872,6 +872,13 @@ namespace Spartan::vulkan_common
                 {
                     source_stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
                 }
+                else if (image_barrier.oldLayout == VK_IMAGE_LAYOUT_UNDEFINED)
+                {
+                    // The contents are discarded, but the memory can be aliased by a render target which was
+                    // just written to (see RenderGraph), so wait for every prior write before reusing it
+                    image_barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+                    source_stage                = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+                }
                 else if (image_barrier.srcAccessMask != 0)
                 {
                     source_stage = access_flags_to_pipeline_stage(image_barrier.srcAccessMask, rhi_device->GetEnabledGraphicsStages());
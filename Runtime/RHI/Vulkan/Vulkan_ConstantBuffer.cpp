@@ -42,6 +42,12 @@ namespace Spartan
         // Wait in case the buffer is still in use
         m_rhi_device->Queue_WaitAll();
 
+        if (m_mapped)
+        {
+            vkUnmapMemory(m_rhi_device->GetContextRhi()->device, static_cast<VkDeviceMemory>(m_buffer_memory));
+            m_mapped = nullptr;
+        }
+
 		vulkan_common::buffer::destroy(m_rhi_device->GetContextRhi(), m_buffer);
 		vulkan_common::memory::free(m_rhi_device->GetContextRhi(), m_buffer_memory);
 	}
@@ -61,6 +67,11 @@ namespace Spartan
         }
 
 		// Clear previous buffer
+        if (m_mapped)
+        {
+            vkUnmapMemory(m_rhi_device->GetContextRhi()->device, static_cast<VkDeviceMemory>(m_buffer_memory));
+            m_mapped = nullptr;
+        }
 		vulkan_common::buffer::destroy(m_rhi_device->GetContextRhi(), m_buffer);
 		vulkan_common::memory::free(m_rhi_device->GetContextRhi(), m_buffer_memory);
 
@@ -80,45 +91,34 @@ namespace Spartan
         vulkan_common::debug::set_buffer_name(m_rhi_device->GetContextRhi()->device, static_cast<VkBuffer>(m_buffer), "constant_buffer");
         vulkan_common::debug::set_device_memory_name(m_rhi_device->GetContextRhi()->device, static_cast<VkDeviceMemory>(m_buffer_memory), "constant_buffer");
 
+        // Keep it mapped, the memory is host coherent so writes don't need to be flushed
+        if (!vulkan_common::error::check(vkMapMemory(m_rhi_device->GetContextRhi()->device, static_cast<VkDeviceMemory>(m_buffer_memory), 0, m_size_gpu, 0, &m_mapped)))
+            return false;
+
 		return true;
 	}
 
     void* RHI_ConstantBuffer::Map(const uint32_t offset_index /*= 0*/) const
     {
-        if (!m_rhi_device || !m_rhi_device->GetContextRhi()->device || !m_buffer_memory)
+        if (!m_mapped)
         {
             LOG_ERROR_INVALID_INTERNALS();
             return nullptr;
         }
 
-        void* ptr = nullptr;
-        vulkan_common::error::check
-        (
-            vkMapMemory
-            (
-                m_rhi_device->GetContextRhi()->device,
-                static_cast<VkDeviceMemory>(m_buffer_memory),
-                static_cast<uint64_t>(offset_index * m_stride),   // offset
-                m_stride,                                         // size
-                0,                                                // flags
-                reinterpret_cast<void**>(&ptr)
-            )
-        );
-
-        return ptr;
-    }
-
-    bool RHI_ConstantBuffer::Unmap() const
-    {
-        if (!m_rhi_device || !m_rhi_device->GetContextRhi()->device || !m_buffer_memory)
+        if (offset_index >= m_element_count)
         {
-            LOG_ERROR_INVALID_INTERNALS();
-            return false;
+            LOG_ERROR("Offset index %d is out of range", offset_index);
+            return nullptr;
         }
 
-        vkUnmapMemory(m_rhi_device->GetContextRhi()->device, static_cast<VkDeviceMemory>(m_buffer_memory));
+        return static_cast<uint8_t*>(m_mapped) + static_cast<uint64_t>(offset_index) * m_stride;
+    }
 
-        return true;
+    bool RHI_ConstantBuffer::Unmap() const
+    {
+        // The buffer stays mapped for its lifetime
+        return m_mapped != nullptr;
     }
 
     bool RHI_ConstantBuffer::Flush(const uint32_t offset_index /*= 0*/)
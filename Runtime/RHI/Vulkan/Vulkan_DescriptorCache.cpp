@@ -72,21 +72,21 @@ namespace Spartan
 
     bool RHI_DescriptorCache::CreateDescriptorPool(uint32_t descriptor_set_capacity)
     {
-        // Pool sizes
+        // Pool sizes (the descriptor counts are for the whole pool, so they scale with the set capacity)
         vector<VkDescriptorPoolSize> pool_sizes(4);
         pool_sizes[0].type              = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        pool_sizes[0].descriptorCount   = RHI_Context::descriptor_max_constant_buffers;
+        pool_sizes[0].descriptorCount   = RHI_Context::descriptor_max_constant_buffers * descriptor_set_capacity;
         pool_sizes[1].type              = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-        pool_sizes[1].descriptorCount   = RHI_Context::descriptor_max_constant_buffers_dynamic;
+        pool_sizes[1].descriptorCount   = RHI_Context::descriptor_max_constant_buffers_dynamic * descriptor_set_capacity;
         pool_sizes[2].type              = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-        pool_sizes[2].descriptorCount   = RHI_Context::descriptor_max_textures;
+        pool_sizes[2].descriptorCount   = (RHI_Context::descriptor_max_textures + RHI_Context::descriptor_max_texture_array) * descriptor_set_capacity;
         pool_sizes[3].type              = VK_DESCRIPTOR_TYPE_SAMPLER;
-        pool_sizes[3].descriptorCount   = RHI_Context::descriptor_max_samplers;
+        pool_sizes[3].descriptorCount   = RHI_Context::descriptor_max_samplers * descriptor_set_capacity;
 
         // Create info
         VkDescriptorPoolCreateInfo pool_create_info = {};
         pool_create_info.sType          = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        pool_create_info.flags          = 0;
+        pool_create_info.flags          = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT; // unused descriptor sets are evicted
         pool_create_info.poolSizeCount  = static_cast<uint32_t>(pool_sizes.size());
         pool_create_info.pPoolSizes     = pool_sizes.data();
         pool_create_info.maxSets        = descriptor_set_capacity;
@@ -66,20 +66,38 @@ namespace Spartan
         UpdateDescriptorSet(descriptor_set, m_descriptors);
 
         // Cache descriptor
-        m_descriptor_sets[hash] = descriptor_set;
+        m_descriptor_sets[hash] = DescriptorSet{ descriptor_set, descriptor_cache->GetFrame() };
 
         return descriptor_set;
     }
 
+    void RHI_DescriptorSetLayout::FreeDescriptorSets(const vector<void*>& descriptor_sets, const RHI_DescriptorCache* descriptor_cache)
+    {
+        vkFreeDescriptorSets
+        (
+            m_rhi_device->GetContextRhi()->device,
+            static_cast<VkDescriptorPool>(descriptor_cache->GetResource_DescriptorSetPool()),
+            static_cast<uint32_t>(descriptor_sets.size()),
+            reinterpret_cast<const VkDescriptorSet*>(descriptor_sets.data())
+        );
+    }
+
     void RHI_DescriptorSetLayout::UpdateDescriptorSet(void* descriptor_set, const vector<RHI_Descriptor>& descriptors)
     {
         if (!descriptor_set)
             return;
 
         const uint32_t descriptor_count = static_cast<uint32_t>(descriptors.size());
+
+        // Descriptor arrays need an image info per element, reserve for all of them so that the pointers below stay valid
+        uint32_t image_info_count = 0;
+        for (const RHI_Descriptor& descriptor : descriptors)
+        {
+            image_info_count += descriptor.array_size;
+        }
         
         vector<VkDescriptorImageInfo> image_infos;
-        image_infos.reserve(descriptor_count);
+        image_infos.reserve(image_info_count);
         
         vector<VkDescriptorBufferInfo> buffer_infos;
         buffer_infos.reserve(descriptor_count);
@@ -90,8 +108,39 @@ namespace Spartan
         for (const RHI_Descriptor& descriptor : descriptors)
         {
             // Ignore null resources (this is legal, as a render pass can choose to not use one or more resources)
-            if (!descriptor.resource)
+            if (!descriptor.resource && descriptor.resource_array.empty())
                 continue;
+
+            // Texture array
+            if (!descriptor.resource_array.empty())
+            {
+                const size_t image_info_first = image_infos.size();
+                for (void* resource : descriptor.resource_array)
+                {
+                    image_infos.push_back
+                    ({
+                        nullptr,                                // sampler
+                        static_cast<VkImageView>(resource),     // imageView
+                        vulkan_image_layout[descriptor.layout]  // imageLayout
+                    });
+                }
+
+                write_descriptor_sets.push_back
+                ({
+                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,                     // sType
+                    nullptr,                                                    // pNext
+                    static_cast<VkDescriptorSet>(descriptor_set),               // dstSet
+                    descriptor.slot,                                            // dstBinding
+                    0,                                                          // dstArrayElement
+                    static_cast<uint32_t>(descriptor.resource_array.size()),    // descriptorCount
+                    vulkan_descriptor_type[descriptor.type],                    // descriptorType
+                    &image_infos[image_info_first],                             // pImageInfo
+                    nullptr,                                                    // pBufferInfo
+                    nullptr                                                     // pTexelBufferView
+                });
+
+                continue;
+            }
         
             // Texture or Sampler
             image_infos.push_back
@@ -145,7 +194,7 @@ namespace Spartan
                 ({
                     descriptor.slot,							// binding
                     vulkan_descriptor_type[descriptor.type],	// descriptorType
-                    1,										    // descriptorCount
+                    descriptor.array_size,					    // descriptorCount
                     stage_flags,							    // stageFlags
                     nullptr									    // pImmutableSamplers
                     });
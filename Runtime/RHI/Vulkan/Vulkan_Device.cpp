@@ -190,8 +190,18 @@ namespace Spartan
                 ENABLE_FEATURE(samplerAnisotropy)
                 ENABLE_FEATURE(fillModeNonSolid)
                 ENABLE_FEATURE(wideLines)
+                ENABLE_FEATURE(shaderSampledImageArrayDynamicIndexing)
+                ENABLE_FEATURE(textureCompressionBC)
             }
 
+            // Block compressed textures, the image importer falls back to uncompressed ones without them
+            m_rhi_context->block_compression = device_features_enabled.textureCompressionBC;
+
+            // Bindless textures, a texture array (and the regular textures) must fit in a single stage
+            m_rhi_context->bindless_textures =
+                device_features_enabled.shaderSampledImageArrayDynamicIndexing &&
+                m_rhi_context->device_properties.limits.maxPerStageDescriptorSampledImages >= RHI_Context::descriptor_max_textures + RHI_Context::descriptor_max_texture_array;
+
             // Determine enabled graphics shader stages
             m_enabled_graphics_shader_stages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
             if (device_features_enabled.geometryShader)
@@ -51,23 +51,12 @@ namespace Spartan
         m_state.CreateFrameResources(rhi_device);
 
         // Viewport & Scissor
-        vector<VkDynamicState> dynamic_states;
+        // Both are dynamic, the command list sets them when it begins (see RHI_CommandList::Begin()),
+        // so pipelines don't have to be re-created whenever the resolution changes.
+        vector<VkDynamicState> dynamic_states               = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
         VkPipelineDynamicStateCreateInfo dynamic_state      = {};   
-        VkViewport vkViewport                               = {};
-        VkRect2D scissor                                    = {};
         VkPipelineViewportStateCreateInfo viewport_state    = {};
         {
-            // If no viewport has been provided, assume dynamic
-            if (!m_state.viewport.IsDefined())
-            {
-                dynamic_states.emplace_back(VK_DYNAMIC_STATE_VIEWPORT);
-            }
-
-            if (m_state.dynamic_scissor)
-            {
-                dynamic_states.emplace_back(VK_DYNAMIC_STATE_SCISSOR);
-            }
-
             // Dynamic states
 		    dynamic_state.sType				= VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
 		    dynamic_state.pNext				= nullptr;
@@ -75,34 +64,12 @@ namespace Spartan
 		    dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
 		    dynamic_state.pDynamicStates	= dynamic_states.data();
 
-		    // Viewport 
-		    vkViewport.x			= m_state.viewport.x;
-		    vkViewport.y			= m_state.viewport.y;
-		    vkViewport.width		= m_state.viewport.width;
-		    vkViewport.height		= m_state.viewport.height;
-		    vkViewport.minDepth		= m_state.viewport.depth_min;
-		    vkViewport.maxDepth		= m_state.viewport.depth_max;
-
-		    // Scissor	   
-            if (!m_state.scissor.IsDefined())
-            {
-                scissor.offset          = { 0, 0 };
-                scissor.extent.width    = static_cast<uint32_t>(vkViewport.width);
-                scissor.extent.height   = static_cast<uint32_t>(vkViewport.height);
-            }
-            else
-            {
-                scissor.offset          = { static_cast<int32_t>(m_state.scissor.left), static_cast<int32_t>(m_state.scissor.top) };
-                scissor.extent.width    = static_cast<uint32_t>(m_state.scissor.Width());
-                scissor.extent.height   = static_cast<uint32_t>(m_state.scissor.Height());
-            }
-
 		    // Viewport state
 		    viewport_state.sType		    = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 		    viewport_state.viewportCount    = 1;
-		    viewport_state.pViewports	    = &vkViewport;
+		    viewport_state.pViewports	    = nullptr;
 		    viewport_state.scissorCount	    = 1;
-		    viewport_state.pScissors	    = &scissor;
+		    viewport_state.pScissors	    = nullptr;
         }
 
         // Shader stages
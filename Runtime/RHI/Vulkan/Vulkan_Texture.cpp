@@ -52,9 +52,72 @@ namespace Spartan
         vulkan_common::image::view::destroy(rhi_context, m_view_attachment_depth_stencil);
         vulkan_common::frame_buffer::destroy(rhi_context, m_view_attachment_color);
         vulkan_common::image::destroy(rhi_context, m_texture);
-		vulkan_common::memory::free(m_rhi_device->GetContextRhi(), m_resource_memory);
+
+        // Transient textures are bound to a heap they don't own
+        if (!IsTransient())
+        {
+		    vulkan_common::memory::free(m_rhi_device->GetContextRhi(), m_resource_memory);
+        }
 	}
 
+    static RHI_Image_Layout get_target_layout(const RHI_Texture* texture)
+    {
+        RHI_Image_Layout target_layout = texture->GetLayout();
+
+        if (texture->IsSampled() && texture->IsColorFormat())
+            target_layout = RHI_Image_Shader_Read_Only_Optimal;
+
+        if (texture->IsRenderTargetColor())
+            target_layout = RHI_Image_Color_Attachment_Optimal;
+
+        if (texture->IsRenderTargetDepthStencil())
+            target_layout = RHI_Image_Depth_Stencil_Attachment_Optimal;
+
+        return target_layout;
+    }
+
+    static bool create_views(const RHI_Context* rhi_context, RHI_Texture* texture, void* image, void*& view_texture, void*& view_stencil)
+    {
+        string name = texture->GetResourceName();
+
+        // Sampled
+        if (texture->IsSampled())
+        {
+            name += name.empty() ? "sampled" : "-sampled";
+
+            // Unlike D3D11, Vulkan doesn't support a single view for a depth-stencil buffer, so we have to create a separate one for the stencil
+
+            if (texture->IsColorFormat() || texture->IsDepthFormat())
+            {
+                if (!vulkan_common::image::view::create(rhi_context, image, view_texture, texture, true))
+                    return false;
+            }
+
+            if (texture->IsStencilFormat())
+            {
+                if (!vulkan_common::image::view::create(rhi_context, image, view_stencil, texture, false, true))
+                    return false;
+            }
+        }
+
+        // Color and depth-stencil
+        if (texture->IsRenderTargetColor() || texture->IsRenderTargetDepthStencil())
+        {
+            name += name.empty() ? "render_target" : "-render_target";
+            // Unlike D3D11, Vulkan uses a framebuffer instead instead of dedicated views for attachments, so nothing to do here
+        }
+
+        // Name the image and image view
+        vulkan_common::debug::set_image_name(rhi_context->device, static_cast<VkImage>(image), name.c_str());
+        vulkan_common::debug::set_image_view_name(rhi_context->device, static_cast<VkImageView>(view_texture), name.c_str());
+        if (texture->IsSampled() && texture->IsStencilFormat())
+        {
+            vulkan_common::debug::set_image_view_name(rhi_context->device, static_cast<VkImageView>(view_stencil), name.c_str());
+        }
+
+        return true;
+    }
+
     void RHI_Texture::SetLayout(const RHI_Image_Layout layout, RHI_CommandList* command_list /*= nullptr*/)
     {
         if (m_layout == layout)
@@ -69,6 +132,38 @@ namespace Spartan
         m_layout = layout;
     }
 
+    bool RHI_Texture::BindMemory(void* memory, const uint64_t offset)
+    {
+        if (!IsTransient() || !m_texture || IsMemoryBound())
+        {
+            LOG_ERROR("Only transient textures which are not bound yet can be bound to memory");
+            return false;
+        }
+
+        const RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+
+        if (!vulkan_common::error::check(vkBindImageMemory(rhi_context->device, static_cast<VkImage>(m_texture), static_cast<VkDeviceMemory>(memory), offset)))
+            return false;
+
+        m_resource_memory = memory;
+
+        // Transition to target layout
+        {
+            VkCommandBuffer cmd_buffer          = vulkan_common::command_buffer_immediate::begin(m_rhi_device.get(), RHI_Queue_Graphics);
+            RHI_Image_Layout target_layout      = get_target_layout(this);
+
+            if (!vulkan_common::image::set_layout(m_rhi_device.get(), cmd_buffer, this, target_layout))
+                return false;
+
+            if (!vulkan_common::command_buffer_immediate::end(RHI_Queue_Graphics))
+                return false;
+
+            m_layout = target_layout;
+        }
+
+        return create_views(rhi_context, this, m_texture, m_view_texture[0], m_view_texture[1]);
+    }
+
 	bool RHI_Texture2D::CreateResourceGpu()
 	{
         const RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
@@ -118,7 +213,19 @@ namespace Spartan
                 return false;
             }
 
-            if (!vulkan_common::image::allocate_bind(rhi_context, *image, image_memory))
+            // Transient textures get their memory from a heap laid out by the render graph, it binds them and finishes their creation
+            if (IsTransient())
+            {
+                VkMemoryRequirements memory_requirements;
+                vkGetImageMemoryRequirements(rhi_context->device, *image, &memory_requirements);
+                m_size_gpu          = memory_requirements.size;
+                m_memory_alignment  = memory_requirements.alignment;
+                m_memory_type_bits  = memory_requirements.memoryTypeBits;
+
+                return true;
+            }
+
+            if (!vulkan_common::image::allocate_bind(rhi_context, *image, image_memory, &m_size_gpu))
             {
                 LOG_ERROR("Failed to allocate and bind image memory");
                 return false;
@@ -161,8 +268,8 @@ namespace Spartan
                     // Update offset
                     offset += static_cast<uint32_t>(m_data[mip_index].size());
 
-                    // Update memory requirements
-                    uint64_t memory_required = mip_width * mip_height * m_channels * (m_bytes_per_channel / 8);
+                    // Update memory requirements (the data is already laid out as the image expects it, including block compressed formats)
+                    uint64_t memory_required = m_data[array_index + mip_index].size();
                     mip_memory[array_index + mip_index] = memory_required;
                     buffer_size += memory_required;
                 }
@@ -218,16 +325,7 @@ namespace Spartan
         // Transition to target layout
         {
             // Deduce target layout
-            RHI_Image_Layout target_layout = m_layout;
-
-            if (IsSampled() && IsColorFormat())
-                target_layout = RHI_Image_Shader_Read_Only_Optimal;
-
-            if (IsRenderTargetColor())
-                target_layout = RHI_Image_Color_Attachment_Optimal;
-
-            if (IsRenderTargetDepthStencil())
-                target_layout = RHI_Image_Depth_Stencil_Attachment_Optimal;
+            RHI_Image_Layout target_layout = get_target_layout(this);
 
             // Transition
             if (!vulkan_common::image::set_layout(m_rhi_device.get(), cmd_buffer, this, target_layout))
@@ -246,46 +344,7 @@ namespace Spartan
         vulkan_common::memory::free(rhi_context, staging_buffer_memory);
 
         // Create image views
-        {
-            string name = GetResourceName();
-
-            // Sampled
-            if (IsSampled())
-            {
-                name += name.empty() ? "sampled" : "-sampled";
-
-                // Unlike D3D11, Vulkan doesn't support a single view for a depth-stencil buffer, so we have to create a separate one for the stencil
-
-                if (IsColorFormat() || IsDepthFormat())
-                {
-                    if (!vulkan_common::image::view::create(rhi_context, *image, m_view_texture[0], this, true))
-                        return false;
-                }
-
-                if (IsStencilFormat())
-                {
-                    if (!vulkan_common::image::view::create(rhi_context, *image, m_view_texture[1], this, false, true))
-                        return false;
-                }
-            }
-
-            // Color and depth-stencil
-            if (IsRenderTargetColor() || IsRenderTargetDepthStencil())
-            {
-                name += name.empty() ? "render_target" : "-render_target";
-                // Unlike D3D11, Vulkan uses a framebuffer instead instead of dedicated views for attachments, so nothing to do here
-            }
-
-            // Name the image and image view
-            vulkan_common::debug::set_image_name(rhi_context->device, *image, name.c_str());
-            vulkan_common::debug::set_image_view_name(rhi_context->device, static_cast<VkImageView>(m_view_texture[0]), name.c_str());
-            if (IsSampled() && IsStencilFormat())
-            {
-                vulkan_common::debug::set_image_view_name(rhi_context->device, static_cast<VkImageView>(m_view_texture[1]), name.c_str());
-            }
-        }
-
-		return true;
+        return create_views(rhi_context, this, *image, m_view_texture[0], m_view_texture[1]);
 	}
 
 	// TEXTURE CUBE
@@ -0,0 +1,84 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= IMPLEMENTATION ===============
+#ifdef API_GRAPHICS_VULKAN
+#include "../RHI_Implementation.h"
+//================================
+
+//= INCLUDES ==================
+#include "../RHI_TransientHeap.h"
+#include "../RHI_Device.h"
+#include "../RHI_Texture.h"
+#include "../../Logging/Log.h"
+//=============================
+
+namespace Spartan
+{
+    RHI_TransientHeap::RHI_TransientHeap(const std::shared_ptr<RHI_Device>& rhi_device, const uint64_t size, const uint32_t memory_type_bits)
+    {
+        m_rhi_device    = rhi_device;
+        m_size_gpu      = size;
+
+        const RHI_Context* rhi_context = m_rhi_device->GetContextRhi();
+
+        VkMemoryAllocateInfo allocate_info  = {};
+        allocate_info.sType                 = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocate_info.allocationSize        = size;
+        allocate_info.memoryTypeIndex       = vulkan_common::memory::get_type(rhi_context, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memory_type_bits);
+
+        if (!vulkan_common::error::check(vkAllocateMemory(rhi_context->device, &allocate_info, nullptr, reinterpret_cast<VkDeviceMemory*>(&m_resource))))
+        {
+            LOG_ERROR("Failed to allocate %.2f MB", static_cast<float>(size) / (1024.0f * 1024.0f));
+            m_resource = nullptr;
+        }
+    }
+
+    RHI_TransientHeap::~RHI_TransientHeap()
+    {
+        if (!m_resource)
+            return;
+
+        // Textures that were bound to the heap might still be in flight
+        m_rhi_device->Queue_WaitAll();
+        vulkan_common::memory::free(m_rhi_device->GetContextRhi(), m_resource);
+    }
+
+    bool RHI_TransientHeap::Bind(RHI_Texture* texture, const uint64_t offset) const
+    {
+        if (!m_resource || !texture)
+            return false;
+
+        if (offset + texture->GetSizeGpu() > m_size_gpu)
+        {
+            LOG_ERROR("Texture doesn't fit in the heap");
+            return false;
+        }
+
+        return texture->BindMemory(m_resource, offset);
+    }
+
+    bool RHI_TransientHeap::IsSupported()
+    {
+        return true;
+    }
+}
+#endif
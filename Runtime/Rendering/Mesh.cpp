@@ -51,7 +51,8 @@ namespace Spartan
 
 	void Mesh::Geometry_Get(uint32_t indexOffset, uint32_t indexCount, uint32_t vertexOffset, unsigned vertexCount, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices)
 	{
-		if (indexOffset == 0 || indexCount == 0 || vertexOffset == 0 || vertexCount == 0 || !vertices || !indices)
+		// Offsets of zero are valid, the first sub-mesh starts there
+		if (indexCount == 0 || vertexCount == 0 || !vertices || !indices || indexOffset + indexCount > m_indices.size() || vertexOffset + vertexCount > m_vertices.size())
 		{
 			LOG_ERROR("Mesh::Geometry_Get: Invalid parameters");
 			return;
@@ -0,0 +1,804 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ===================
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include "../RHI/RHI_Vertex.h"
+//==============================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan::MeshOptimizer
+{
+    namespace
+    {
+        // Forsyth's scoring
+        const uint32_t forsyth_cache_size       = 32;
+        const float forsyth_cache_decay_power   = 1.5f;
+        const float forsyth_last_triangle_score = 0.75f;
+        const float forsyth_valence_boost_scale = 2.0f;
+        const float forsyth_valence_boost_power = 0.5f;
+
+        float forsyth_vertex_score(const int32_t cache_position, const uint32_t triangles_left)
+        {
+            // Nothing left to draw with this vertex
+            if (triangles_left == 0)
+                return -1.0f;
+
+            float score = 0.0f;
+            if (cache_position >= 0)
+            {
+                // The last triangle's vertices get a fixed score, so that the next triangle doesn't favour any of them
+                if (cache_position < 3)
+                {
+                    score = forsyth_last_triangle_score;
+                }
+                else
+                {
+                    const float scaler = 1.0f / (forsyth_cache_size - 3);
+                    score = powf(1.0f - (cache_position - 3) * scaler, forsyth_cache_decay_power);
+                }
+            }
+
+            // Boost vertices with few triangles left, so that lone triangles don't get left behind
+            score += forsyth_valence_boost_scale * powf(static_cast<float>(triangles_left), -forsyth_valence_boost_power);
+
+            return score;
+        }
+
+        struct VertexHasher
+        {
+            size_t operator()(const RHI_Vertex_PosTexNorTan& vertex) const
+            {
+                // FNV-1a over the raw bytes
+                const auto* bytes = reinterpret_cast<const uint8_t*>(&vertex);
+                size_t hash = 2166136261u;
+                for (size_t i = 0; i < sizeof(RHI_Vertex_PosTexNorTan); i++)
+                {
+                    hash = (hash ^ bytes[i]) * 16777619u;
+                }
+                return hash;
+            }
+        };
+
+        struct VertexEqual
+        {
+            bool operator()(const RHI_Vertex_PosTexNorTan& a, const RHI_Vertex_PosTexNorTan& b) const
+            {
+                return memcmp(&a, &b, sizeof(RHI_Vertex_PosTexNorTan)) == 0;
+            }
+        };
+
+        bool is_valid(const vector<uint32_t>& indices, const size_t vertex_count)
+        {
+            if (indices.empty() || indices.size() % 3 != 0)
+                return false;
+
+            for (const uint32_t index : indices)
+            {
+                if (index >= vertex_count)
+                    return false;
+            }
+
+            return true;
+        }
+    }
+
+    uint32_t SimulateVertexCache(const vector<uint32_t>& indices, const uint32_t vertex_count, const uint32_t cache_size /*= MeshOptimizer::cache_size*/)
+    {
+        // A vertex is still in a FIFO cache if less than cache_size vertices were inserted after it
+        vector<uint32_t> timestamps(vertex_count, 0);
+        uint32_t time   = cache_size + 1;
+        uint32_t misses = 0;
+
+        for (const uint32_t index : indices)
+        {
+            if (time - timestamps[index] > cache_size)
+            {
+                timestamps[index] = time++;
+                misses++;
+            }
+        }
+
+        return misses;
+    }
+
+    void WeldVertices(vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        unordered_map<RHI_Vertex_PosTexNorTan, uint32_t, VertexHasher, VertexEqual> unique_vertices;
+        unique_vertices.reserve(vertices.size());
+
+        vector<uint32_t> remap(vertices.size());
+        vector<RHI_Vertex_PosTexNorTan> vertices_welded;
+        vertices_welded.reserve(vertices.size());
+
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const auto it = unique_vertices.emplace(vertices[i], static_cast<uint32_t>(vertices_welded.size()));
+            if (it.second)
+            {
+                vertices_welded.emplace_back(vertices[i]);
+            }
+            remap[i] = it.first->second;
+        }
+
+        if (vertices_welded.size() == vertices.size())
+            return;
+
+        for (uint32_t& index : indices)
+        {
+            index = remap[index];
+        }
+        vertices.swap(vertices_welded);
+    }
+
+    void OptimizeVertexCache(vector<uint32_t>& indices, const uint32_t vertex_count)
+    {
+        const uint32_t triangle_count = static_cast<uint32_t>(indices.size() / 3);
+        if (triangle_count == 0)
+            return;
+
+        // Triangles which use each vertex
+        vector<uint32_t> triangles_left(vertex_count, 0);
+        for (const uint32_t index : indices)
+        {
+            triangles_left[index]++;
+        }
+
+        vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            adjacency_offsets[i + 1] = adjacency_offsets[i] + triangles_left[i];
+        }
+
+        vector<uint32_t> adjacency(indices.size());
+        {
+            vector<uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+            for (uint32_t i = 0; i < static_cast<uint32_t>(indices.size()); i++)
+            {
+                adjacency[cursor[indices[i]]++] = i / 3;
+            }
+        }
+
+        // Initial scores
+        vector<int32_t> cache_position(vertex_count, -1);
+        vector<float> vertex_score(vertex_count);
+        for (uint32_t i = 0; i < vertex_count; i++)
+        {
+            vertex_score[i] = forsyth_vertex_score(-1, triangles_left[i]);
+        }
+
+        vector<float> triangle_score(triangle_count);
+        vector<bool> triangle_emitted(triangle_count, false);
+        uint32_t triangle_best      = 0;
+        float triangle_best_score   = -1.0f;
+        for (uint32_t i = 0; i < triangle_count; i++)
+        {
+            triangle_score[i] = vertex_score[indices[i * 3 + 0]] + vertex_score[indices[i * 3 + 1]] + vertex_score[indices[i * 3 + 2]];
+            if (triangle_score[i] > triangle_best_score)
+            {
+                triangle_best_score = triangle_score[i];
+                triangle_best       = i;
+            }
+        }
+
+        vector<uint32_t> indices_optimized;
+        indices_optimized.reserve(indices.size());
+        vector<uint32_t> cache;
+        vector<uint32_t> cache_new;
+        cache.reserve(forsyth_cache_size + 3);
+        cache_new.reserve(forsyth_cache_size + 3);
+        uint32_t input_cursor = 0;
+
+        for (uint32_t emitted = 0; emitted < triangle_count; emitted++)
+        {
+            // No candidate in the cache, continue with the next triangle in input order
+            if (triangle_best_score < 0.0f)
+            {
+                while (triangle_emitted[input_cursor])
+                {
+                    input_cursor++;
+                }
+                triangle_best = input_cursor;
+            }
+
+            // Emit
+            const uint32_t* triangle = &indices[triangle_best * 3];
+            indices_optimized.insert(indices_optimized.end(), triangle, triangle + 3);
+            triangle_emitted[triangle_best] = true;
+
+            // Remove it from the adjacency of its vertices
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                const uint32_t vertex   = triangle[i];
+                uint32_t* list          = &adjacency[adjacency_offsets[vertex]];
+                const uint32_t count    = triangles_left[vertex];
+
+                for (uint32_t j = 0; j < count; j++)
+                {
+                    if (list[j] == triangle_best)
+                    {
+                        list[j] = list[count - 1];
+                        break;
+                    }
+                }
+                triangles_left[vertex]--;
+            }
+
+            // Move its vertices to the front of the (LRU) cache
+            cache_new.clear();
+            cache_new.insert(cache_new.end(), triangle, triangle + 3);
+            for (const uint32_t vertex : cache)
+            {
+                if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                {
+                    cache_new.emplace_back(vertex);
+                }
+            }
+            cache.swap(cache_new);
+
+            // Update the scores of the vertices in the cache (and of those which fell out of it)
+            for (uint32_t i = 0; i < static_cast<uint32_t>(cache.size()); i++)
+            {
+                const uint32_t vertex   = cache[i];
+                cache_position[vertex]  = i < forsyth_cache_size ? static_cast<int32_t>(i) : -1;
+                vertex_score[vertex]    = forsyth_vertex_score(cache_position[vertex], triangles_left[vertex]);
+            }
+
+            // Update the scores of their triangles, and pick the best one
+            triangle_best_score = -1.0f;
+            for (const uint32_t vertex : cache)
+            {
+                const uint32_t* list = &adjacency[adjacency_offsets[vertex]];
+                for (uint32_t j = 0; j < triangles_left[vertex]; j++)
+                {
+                    const uint32_t t    = list[j];
+                    triangle_score[t]   = vertex_score[indices[t * 3 + 0]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+
+                    if (triangle_score[t] > triangle_best_score)
+                    {
+                        triangle_best_score = triangle_score[t];
+                        triangle_best       = t;
+                    }
+                }
+            }
+
+            if (cache.size() > forsyth_cache_size)
+            {
+                cache.resize(forsyth_cache_size);
+            }
+        }
+
+        indices.swap(indices_optimized);
+    }
+
+    void OptimizeOverdraw(vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, const float threshold /*= 1.05f*/)
+    {
+        const uint32_t triangle_count = static_cast<uint32_t>(indices.size() / 3);
+        if (triangle_count < 2)
+            return;
+
+        const auto position = [&vertices](const uint32_t index) { return Vector3(vertices[index].pos[0], vertices[index].pos[1], vertices[index].pos[2]); };
+
+        // Split into clusters where the cache restarts (a triangle misses on all of its vertices),
+        // reordering these keeps the cache efficiency of what's in between.
+        vector<uint32_t> cluster_starts;
+        {
+            vector<uint32_t> timestamps(vertices.size(), 0);
+            uint32_t time = cache_size + 1;
+
+            for (uint32_t i = 0; i < triangle_count; i++)
+            {
+                uint32_t misses = 0;
+                for (uint32_t j = 0; j < 3; j++)
+                {
+                    const uint32_t index = indices[i * 3 + j];
+                    if (time - timestamps[index] > cache_size)
+                    {
+                        timestamps[index] = time++;
+                        misses++;
+                    }
+                }
+
+                if (i == 0 || misses == 3)
+                {
+                    cluster_starts.emplace_back(i);
+                }
+            }
+        }
+
+        if (cluster_starts.size() < 2)
+            return;
+
+        // Mesh centroid
+        Vector3 mesh_centroid   = Vector3::Zero;
+        float mesh_area         = 0.0f;
+        vector<Vector3> cluster_centroid(cluster_starts.size(), Vector3::Zero);
+        vector<Vector3> cluster_normal(cluster_starts.size(), Vector3::Zero);
+        for (uint32_t c = 0; c < static_cast<uint32_t>(cluster_starts.size()); c++)
+        {
+            const uint32_t start    = cluster_starts[c];
+            const uint32_t end      = c + 1 < cluster_starts.size() ? cluster_starts[c + 1] : triangle_count;
+            float cluster_area      = 0.0f;
+
+            for (uint32_t i = start; i < end; i++)
+            {
+                const Vector3 p0        = position(indices[i * 3 + 0]);
+                const Vector3 p1        = position(indices[i * 3 + 1]);
+                const Vector3 p2        = position(indices[i * 3 + 2]);
+                const Vector3 normal    = Vector3::Cross(p1 - p0, p2 - p0); // length is twice the area
+                const float area        = normal.Length();
+                const Vector3 centroid  = (p0 + p1 + p2) / 3.0f;
+
+                cluster_centroid[c] += centroid * area;
+                cluster_normal[c]   += normal;
+                cluster_area        += area;
+            }
+
+            mesh_centroid       += cluster_centroid[c];
+            mesh_area           += cluster_area;
+            cluster_centroid[c] = cluster_area > 0.0f ? cluster_centroid[c] / cluster_area : position(indices[start * 3]);
+            cluster_normal[c]   = cluster_normal[c].Normalized();
+        }
+        mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : Vector3::Zero;
+
+        // Clusters that face away from the centre, and are further away from it, are likely to occlude the others, so draw them first
+        vector<pair<float, uint32_t>> cluster_order(cluster_starts.size());
+        for (uint32_t c = 0; c < static_cast<uint32_t>(cluster_starts.size()); c++)
+        {
+            cluster_order[c] = make_pair(Vector3::Dot(cluster_centroid[c] - mesh_centroid, cluster_normal[c]), c);
+        }
+        stable_sort(cluster_order.begin(), cluster_order.end(), [](const pair<float, uint32_t>& a, const pair<float, uint32_t>& b) { return a.first > b.first; });
+
+        vector<uint32_t> indices_sorted;
+        indices_sorted.reserve(indices.size());
+        for (const auto& cluster : cluster_order)
+        {
+            const uint32_t c        = cluster.second;
+            const uint32_t start    = cluster_starts[c];
+            const uint32_t end      = c + 1 < cluster_starts.size() ? cluster_starts[c + 1] : triangle_count;
+            indices_sorted.insert(indices_sorted.end(), indices.begin() + start * 3, indices.begin() + end * 3);
+        }
+
+        // Keep the new order only if the cache doesn't suffer too much
+        const uint32_t vertex_count     = static_cast<uint32_t>(vertices.size());
+        const uint32_t misses_before    = SimulateVertexCache(indices, vertex_count);
+        const uint32_t misses_after     = SimulateVertexCache(indices_sorted, vertex_count);
+        if (misses_after <= misses_before * threshold)
+        {
+            indices.swap(indices_sorted);
+        }
+    }
+
+    void OptimizeVertexFetch(vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        const uint32_t unused = static_cast<uint32_t>(-1);
+        vector<uint32_t> remap(vertices.size(), unused);
+        uint32_t vertex_count = 0;
+
+        for (uint32_t& index : indices)
+        {
+            if (remap[index] == unused)
+            {
+                remap[index] = vertex_count++;
+            }
+            index = remap[index];
+        }
+
+        vector<RHI_Vertex_PosTexNorTan> vertices_ordered(vertex_count);
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            if (remap[i] != unused)
+            {
+                vertices_ordered[remap[i]] = vertices[i];
+            }
+        }
+        vertices.swap(vertices_ordered);
+    }
+
+    Statistics Optimize(vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    {
+        Statistics statistics;
+        statistics.triangle_count       = static_cast<uint32_t>(indices.size() / 3);
+        statistics.vertex_count_before  = static_cast<uint32_t>(vertices.size());
+        statistics.vertex_count_after   = statistics.vertex_count_before;
+
+        if (!is_valid(indices, vertices.size()))
+            return statistics;
+
+        statistics.cache_misses_before = SimulateVertexCache(indices, statistics.vertex_count_before);
+
+        WeldVertices(indices, vertices);
+        OptimizeVertexCache(indices, static_cast<uint32_t>(vertices.size()));
+        OptimizeOverdraw(indices, vertices);
+        OptimizeVertexFetch(indices, vertices);
+
+        statistics.vertex_count_after   = static_cast<uint32_t>(vertices.size());
+        statistics.cache_misses_after   = SimulateVertexCache(indices, statistics.vertex_count_after);
+
+        return statistics;
+    }
+
+    namespace
+    {
+        // Normal and uv differences are weighted against the (relative, squared) distance error
+        const float simplify_attribute_weight   = 0.01f;
+        const float simplify_border_weight      = 10.0f;
+
+        enum Simplify_Vertex_Kind : uint8_t
+        {
+            Simplify_Vertex_Manifold,   // can collapse onto any neighbour
+            Simplify_Vertex_Border,     // can collapse along the border only
+            Simplify_Vertex_Locked      // seams and non-manifold vertices, others can collapse onto it
+        };
+
+        struct Quadric
+        {
+            double a2 = 0.0, b2 = 0.0, c2 = 0.0, d2 = 0.0;
+            double ab = 0.0, ac = 0.0, ad = 0.0;
+            double bc = 0.0, bd = 0.0, cd = 0.0;
+            double weight = 0.0;
+
+            void AddPlane(const Vector3& normal, const float distance, const double plane_weight)
+            {
+                const double a = normal.x, b = normal.y, c = normal.z, d = distance;
+                a2 += a * a * plane_weight; b2 += b * b * plane_weight; c2 += c * c * plane_weight; d2 += d * d * plane_weight;
+                ab += a * b * plane_weight; ac += a * c * plane_weight; ad += a * d * plane_weight;
+                bc += b * c * plane_weight; bd += b * d * plane_weight; cd += c * d * plane_weight;
+                weight += plane_weight;
+            }
+
+            void operator+=(const Quadric& q)
+            {
+                a2 += q.a2; b2 += q.b2; c2 += q.c2; d2 += q.d2;
+                ab += q.ab; ac += q.ac; ad += q.ad;
+                bc += q.bc; bd += q.bd; cd += q.cd;
+                weight += q.weight;
+            }
+
+            // Weighted average of the squared distance to the planes
+            float Error(const Vector3& p) const
+            {
+                const double x = p.x, y = p.y, z = p.z;
+                const double error =
+                    a2 * x * x + b2 * y * y + c2 * z * z + d2 +
+                    2.0 * (ab * x * y + ac * x * z + bc * y * z + ad * x + bd * y + cd * z);
+
+                return weight > 0.0 ? static_cast<float>(fabs(error) / weight) : 0.0f;
+            }
+        };
+
+        struct Collapse
+        {
+            uint32_t from;
+            uint32_t to;
+            float error;
+        };
+
+        uint64_t edge_key(const uint32_t a, const uint32_t b) { return (static_cast<uint64_t>(a) << 32) | b; }
+    }
+
+    vector<uint32_t> Simplify(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, const uint32_t index_count_target, const float error_target)
+    {
+        vector<uint32_t> result = indices;
+        if (!is_valid(indices, vertices.size()) || result.size() <= index_count_target)
+            return result;
+
+        const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+
+        // Positions, normalized so that the error is relative to the size of the mesh
+        vector<Vector3> positions(vertex_count);
+        {
+            Vector3 min = Vector3::Infinity;
+            Vector3 max = Vector3::InfinityNeg;
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                positions[i] = Vector3(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]);
+                min = Vector3((std::min)(min.x, positions[i].x), (std::min)(min.y, positions[i].y), (std::min)(min.z, positions[i].z));
+                max = Vector3((std::max)(max.x, positions[i].x), (std::max)(max.y, positions[i].y), (std::max)(max.z, positions[i].z));
+            }
+
+            const Vector3 extent    = max - min;
+            const float scale       = (std::max)((std::max)(extent.x, extent.y), extent.z);
+            const float scale_inv   = scale > 0.0f ? 1.0f / scale : 1.0f;
+            for (Vector3& position : positions)
+            {
+                position = (position - min) * scale_inv;
+            }
+        }
+
+        // Vertices which share a position (uv or normal seams) map to the first one
+        vector<uint32_t> position_ids(vertex_count);
+        vector<uint32_t> position_users(vertex_count, 0);
+        {
+            vector<bool> used(vertex_count, false);
+            for (const uint32_t index : indices)
+            {
+                used[index] = true;
+            }
+
+            unordered_map<uint64_t, uint32_t> position_first;
+            position_first.reserve(vertex_count);
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                uint32_t bits[3];
+                memcpy(bits, vertices[i].pos, sizeof(bits));
+                const uint64_t hash = (static_cast<uint64_t>(bits[0]) * 73856093u) ^ (static_cast<uint64_t>(bits[1]) * 19349663u) ^ (static_cast<uint64_t>(bits[2]) << 21);
+
+                // Resolve hash collisions by probing, positions are compared exactly
+                uint64_t key = hash;
+                auto it = position_first.find(key);
+                while (it != position_first.end() && memcmp(vertices[it->second].pos, vertices[i].pos, sizeof(bits)) != 0)
+                {
+                    it = position_first.find(++key);
+                }
+
+                position_ids[i] = it == position_first.end() ? position_first.emplace(key, i).first->second : it->second;
+                if (used[i])
+                {
+                    position_users[position_ids[i]]++;
+                }
+            }
+        }
+
+        // Border edges are the ones without a twin, in position space so that seams are not borders
+        unordered_map<uint64_t, uint32_t> edges;
+        edges.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                edges[edge_key(position_ids[indices[i + e]], position_ids[indices[i + (e + 1) % 3]])]++;
+            }
+        }
+
+        const auto is_border_edge = [&edges, &position_ids](const uint32_t a, const uint32_t b)
+        {
+            const uint32_t pa = position_ids[a];
+            const uint32_t pb = position_ids[b];
+            return edges.find(edge_key(pa, pb)) == edges.end() || edges.find(edge_key(pb, pa)) == edges.end();
+        };
+
+        // Classify vertices
+        vector<Simplify_Vertex_Kind> kinds(vertex_count, Simplify_Vertex_Manifold);
+        {
+            vector<uint32_t> border_edges(vertex_count, 0);
+            for (const auto& edge : edges)
+            {
+                const uint32_t pa = static_cast<uint32_t>(edge.first >> 32);
+                const uint32_t pb = static_cast<uint32_t>(edge.first & 0xFFFFFFFF);
+
+                if (edge.second > 1 || edges.find(edge_key(pb, pa)) == edges.end())
+                {
+                    border_edges[pa] += edge.second > 1 ? 3 : 1; // edges used more than once are non-manifold
+                    border_edges[pb] += edge.second > 1 ? 3 : 1;
+                }
+            }
+
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                const uint32_t id = position_ids[i];
+                if (position_users[id] > 1 || (border_edges[id] != 0 && border_edges[id] != 2))
+                {
+                    kinds[i] = Simplify_Vertex_Locked;
+                }
+                else if (border_edges[id] == 2)
+                {
+                    kinds[i] = Simplify_Vertex_Border;
+                }
+            }
+        }
+
+        // Quadrics, from the planes of the triangles (weighted by area) and from planes perpendicular to the border edges
+        vector<Quadric> quadrics(vertex_count);
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const uint32_t v[3] = { indices[i], indices[i + 1], indices[i + 2] };
+            Vector3 normal      = Vector3::Cross(positions[v[1]] - positions[v[0]], positions[v[2]] - positions[v[0]]);
+            const float area    = normal.Length() * 0.5f;
+            normal              = normal.Normalized();
+            const float d       = -Vector3::Dot(normal, positions[v[0]]);
+
+            for (uint32_t e = 0; e < 3; e++)
+            {
+                quadrics[v[e]].AddPlane(normal, d, area);
+
+                const uint32_t a = v[e];
+                const uint32_t b = v[(e + 1) % 3];
+                if (is_border_edge(a, b))
+                {
+                    const Vector3 edge          = positions[b] - positions[a];
+                    const float length          = edge.Length();
+                    const Vector3 perpendicular = Vector3::Cross(edge, normal).Normalized();
+                    const float dp              = -Vector3::Dot(perpendicular, positions[a]);
+                    const double weight         = length * length * simplify_border_weight;
+
+                    quadrics[a].AddPlane(perpendicular, dp, weight);
+                    quadrics[b].AddPlane(perpendicular, dp, weight);
+                }
+            }
+        }
+
+        const auto attribute_error = [&vertices](const uint32_t a, const uint32_t b)
+        {
+            const RHI_Vertex_PosTexNorTan& va = vertices[a];
+            const RHI_Vertex_PosTexNorTan& vb = vertices[b];
+            float error = 0.0f;
+            for (uint32_t i = 0; i < 3; i++) error += (va.nor[i] - vb.nor[i]) * (va.nor[i] - vb.nor[i]);
+            for (uint32_t i = 0; i < 2; i++) error += (va.tex[i] - vb.tex[i]) * (va.tex[i] - vb.tex[i]);
+            return error * simplify_attribute_weight;
+        };
+
+        const float error_limit = error_target * error_target;
+        vector<Collapse> collapses;
+        vector<uint32_t> remap(vertex_count);
+        vector<bool> touched(vertex_count);
+        vector<uint32_t> adjacency_offsets(vertex_count + 1);
+        vector<uint32_t> adjacency;
+
+        // Collapse in passes, each vertex at most once per pass, until nothing can collapse within the error
+        while (result.size() > index_count_target)
+        {
+            // Candidates
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                for (uint32_t e = 0; e < 3; e++)
+                {
+                    const uint32_t a = result[i + e];
+                    const uint32_t b = result[i + (e + 1) % 3];
+
+                    for (uint32_t direction = 0; direction < 2; direction++)
+                    {
+                        const uint32_t from = direction == 0 ? a : b;
+                        const uint32_t to   = direction == 0 ? b : a;
+
+                        if (kinds[from] == Simplify_Vertex_Locked)
+                            continue;
+
+                        if (kinds[from] == Simplify_Vertex_Border && (kinds[to] == Simplify_Vertex_Manifold || !is_border_edge(from, to)))
+                            continue;
+
+                        Quadric quadric = quadrics[from];
+                        quadric += quadrics[to];
+                        const float error = quadric.Error(positions[to]) + attribute_error(from, to);
+                        if (error <= error_limit)
+                        {
+                            collapses.push_back({ from, to, error });
+                        }
+                    }
+                }
+            }
+
+            if (collapses.empty())
+                break;
+
+            sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+            // Triangles around each vertex
+            fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+            for (const uint32_t index : result)
+            {
+                adjacency_offsets[index + 1]++;
+            }
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                adjacency_offsets[i + 1] += adjacency_offsets[i];
+            }
+            adjacency.resize(result.size());
+            {
+                vector<uint32_t> cursor(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+                for (uint32_t i = 0; i < static_cast<uint32_t>(result.size()); i++)
+                {
+                    adjacency[cursor[result[i]]++] = i / 3;
+                }
+            }
+
+            // Collapse
+            for (uint32_t i = 0; i < vertex_count; i++)
+            {
+                remap[i] = i;
+            }
+            fill(touched.begin(), touched.end(), false);
+
+            const uint32_t triangles_to_remove  = static_cast<uint32_t>((result.size() - index_count_target) / 3);
+            uint32_t triangles_removed          = 0;
+            uint32_t collapsed                  = 0;
+            for (const Collapse& collapse : collapses)
+            {
+                if (touched[collapse.from] || touched[collapse.to])
+                    continue;
+
+                // Reject collapses which would flip a triangle
+                bool flips          = false;
+                uint32_t removes    = 0;
+                for (uint32_t j = adjacency_offsets[collapse.from]; j < adjacency_offsets[collapse.from + 1] && !flips; j++)
+                {
+                    const uint32_t* triangle = &result[adjacency[j] * 3];
+                    if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to)
+                    {
+                        removes++;
+                        continue;
+                    }
+
+                    Vector3 p[3]            = { positions[triangle[0]], positions[triangle[1]], positions[triangle[2]] };
+                    const Vector3 normal    = Vector3::Cross(p[1] - p[0], p[2] - p[0]);
+                    for (uint32_t k = 0; k < 3; k++)
+                    {
+                        if (triangle[k] == collapse.from)
+                        {
+                            p[k] = positions[collapse.to];
+                        }
+                    }
+                    flips = Vector3::Dot(normal, Vector3::Cross(p[1] - p[0], p[2] - p[0])) <= 0.0f;
+                }
+
+                if (flips)
+                    continue;
+
+                // Lock the neighbourhood for the rest of the pass, so that the checks above stay valid
+                for (uint32_t j = adjacency_offsets[collapse.from]; j < adjacency_offsets[collapse.from + 1]; j++)
+                {
+                    const uint32_t* triangle = &result[adjacency[j] * 3];
+                    touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+                }
+
+                remap[collapse.from]        = collapse.to;
+                quadrics[collapse.to]       += quadrics[collapse.from];
+                triangles_removed           += removes;
+                collapsed++;
+
+                if (triangles_removed >= triangles_to_remove)
+                    break;
+            }
+
+            if (collapsed == 0)
+                break;
+
+            // Remap and drop the triangles which became degenerate
+            size_t index_count = 0;
+            for (size_t i = 0; i < result.size(); i += 3)
+            {
+                const uint32_t a = remap[result[i + 0]];
+                const uint32_t b = remap[result[i + 1]];
+                const uint32_t c = remap[result[i + 2]];
+
+                if (a != b && b != c && a != c)
+                {
+                    result[index_count++] = a;
+                    result[index_count++] = b;
+                    result[index_count++] = c;
+                }
+            }
+            result.resize(index_count);
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,86 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES =====================
+#include <vector>
+#include "../RHI/RHI_Definition.h"
+//================================
+
+// Reorders (and welds) the geometry of a mesh for faster rendering, all functions expect triangle lists
+// with indices which are relative to the vertices they are given (as appended to a Model).
+namespace Spartan::MeshOptimizer
+{
+    // Post-transform vertex cache efficiency, simulated with a FIFO cache
+    struct Statistics
+    {
+        uint32_t triangle_count         = 0;
+        uint32_t vertex_count_before    = 0;
+        uint32_t vertex_count_after     = 0;
+        uint32_t cache_misses_before    = 0;
+        uint32_t cache_misses_after     = 0;
+
+        // Average cache miss ratio, vertices transformed per triangle (0.5 is ideal for large grids, 3.0 is the worst)
+        float GetAcmrBefore()   const { return triangle_count       ? static_cast<float>(cache_misses_before) / triangle_count       : 0.0f; }
+        float GetAcmrAfter()    const { return triangle_count       ? static_cast<float>(cache_misses_after)  / triangle_count       : 0.0f; }
+        // Average transform to vertex ratio, how many times each vertex is transformed (1.0 is ideal)
+        float GetAtvrBefore()   const { return vertex_count_before  ? static_cast<float>(cache_misses_before) / vertex_count_before  : 0.0f; }
+        float GetAtvrAfter()    const { return vertex_count_after   ? static_cast<float>(cache_misses_after)  / vertex_count_after   : 0.0f; }
+
+        void Accumulate(const Statistics& other)
+        {
+            triangle_count      += other.triangle_count;
+            vertex_count_before += other.vertex_count_before;
+            vertex_count_after  += other.vertex_count_after;
+            cache_misses_before += other.cache_misses_before;
+            cache_misses_after  += other.cache_misses_after;
+        }
+    };
+
+    static const uint32_t cache_size = 16; // conservative, matches older hardware and is close enough for newer one
+
+    // Returns the number of vertices a FIFO cache of the given size would have to transform
+    uint32_t SimulateVertexCache(const std::vector<uint32_t>& indices, uint32_t vertex_count, uint32_t cache_size = MeshOptimizer::cache_size);
+
+    // Merges bitwise identical vertices
+    void WeldVertices(std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+
+    // Reorders triangles for post-transform cache reuse (Forsyth, "Linear-Speed Vertex Cache Optimisation")
+    void OptimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertex_count);
+
+    // Reorders clusters of triangles front to back from the outside in, to reduce overdraw, as long as the cache
+    // efficiency doesn't get worse than threshold times the current one (Sander et al., "Fast Triangle Reordering")
+    void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<RHI_Vertex_PosTexNorTan>& vertices, float threshold = 1.05f);
+
+    // Reorders vertices in the order they are first used, for vertex fetch locality, and drops unused ones
+    void OptimizeVertexFetch(std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+
+    // All of the above, in the order they should run
+    Statistics Optimize(std::vector<uint32_t>& indices, std::vector<RHI_Vertex_PosTexNorTan>& vertices);
+
+    // Collapses edges in order of quadric error (Garland & Heckbert, "Surface Simplification Using Quadric Error Metrics"), plus
+    // the normal and uv difference, until the index count or the error target is reached. Vertices are collapsed onto existing ones,
+    // so the returned indices still reference the given vertices. Borders only collapse along themselves, uv/normal seams are kept.
+    // The error is relative to the size of the mesh, 0.01 means 1%.
+    std::vector<uint32_t> Simplify(const std::vector<uint32_t>& indices, const std::vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t index_count_target, float error_target);
+}
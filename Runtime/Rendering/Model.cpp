@@ -33,6 +33,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_VertexBuffer.h"
 #include "../RHI/RHI_IndexBuffer.h"
 #include "../RHI/RHI_Texture2D.h"
+#include "../RHI/RHI_Vertex.h"
 //===========================================
 
 //= NAMESPACES ================
@@ -42,6 +43,37 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // Beyond this, unorm16 uvs are too coarse (1/4 of a texel on a 1024 texture at this range)
+    static const float vertex_packing_uv_range_max = 16.0f;
+
+    static uint16_t unorm16(const float value) { return static_cast<uint16_t>(Math::Round(Math::Saturate(value) * 65535.0f)); }
+    static int16_t snorm16(const float value)  { return static_cast<int16_t>(Math::Round(Math::Clamp(value, -1.0f, 1.0f) * 32767.0f)); }
+
+    static void octahedral_encode(const float* direction, int16_t* encoded)
+    {
+        const float length = fabs(direction[0]) + fabs(direction[1]) + fabs(direction[2]);
+        if (length == 0.0f)
+        {
+            encoded[0] = encoded[1] = 0;
+            return;
+        }
+
+        float x = direction[0] / length;
+        float y = direction[1] / length;
+
+        // Fold the lower hemisphere over the diagonals
+        if (direction[2] < 0.0f)
+        {
+            const float x_folded = (1.0f - fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const float y_folded = (1.0f - fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = x_folded;
+            y = y_folded;
+        }
+
+        encoded[0] = snorm16(x);
+        encoded[1] = snorm16(y);
+    }
+
 	Model::Model(Context* context) : IResource(context, Resource_Model)
 	{
 		m_resource_manager	= m_context->GetSubsystem<ResourceCache>();
@@ -60,7 +92,18 @@ namespace Spartan
         m_vertex_buffer.reset();
         m_index_buffer.reset();
         m_mesh->Geometry_Clear();
+        m_geometry_file_path.clear();
+        m_geometry_positions.clear();
+        m_geometry_positions.shrink_to_fit();
+        m_geometry_indices.clear();
+        m_geometry_indices.shrink_to_fit();
+        m_geometry_keep_for_rays = false;
+        m_index_count = 0;
+        m_vertex_count = 0;
         m_aabb.Undefine();
+        m_optimization_statistics = MeshOptimizer::Statistics();
+        m_sub_meshes.clear();
+        m_vertex_packed = false;
         m_normalized_scale = 1.0f;
         m_is_animated = false;
     }
@@ -87,8 +130,27 @@ namespace Spartan
             file->Read(&m_normalized_scale);
             file->Read(&m_mesh->Indices_Get());
             file->Read(&m_mesh->Vertices_Get());
+            file->Read(&m_optimization_statistics.triangle_count);
+            file->Read(&m_optimization_statistics.vertex_count_before);
+            file->Read(&m_optimization_statistics.vertex_count_after);
+            file->Read(&m_optimization_statistics.cache_misses_before);
+            file->Read(&m_optimization_statistics.cache_misses_after);
+            file->Read(&m_vertex_packing);
+            uint32_t sub_mesh_count = 0;
+            file->Read(&sub_mesh_count);
+            m_sub_meshes.resize(sub_mesh_count);
+            for (SubMesh& sub_mesh : m_sub_meshes)
+            {
+                file->Read(&sub_mesh.index_offset);
+                file->Read(&sub_mesh.index_count);
+                file->Read(&sub_mesh.vertex_offset);
+                file->Read(&sub_mesh.vertex_count);
+            }
 
             UpdateGeometry();
+
+            // The file holds the geometry, so it doesn't have to stay in memory after the upload
+            GeometryRelease(file_path);
         }
         // Load foreign format
         else
@@ -111,7 +173,7 @@ namespace Spartan
         // Compute memory usage
         {
             // Cpu
-            m_size_cpu = !m_mesh ? 0 : m_mesh->Geometry_MemoryUsage();
+            GeometryUpdateMemoryUsage();
 
             // Gpu
             if (m_vertex_buffer && m_index_buffer)
@@ -123,11 +185,30 @@ namespace Spartan
 
 		LOG_INFO("Loading \"%s\" took %d ms", FileSystem::GetFileNameFromFilePath(file_path).c_str(), static_cast<int>(timer.GetElapsedTimeMs()));
 
+        const MeshOptimizer::Statistics& stats = m_optimization_statistics;
+        if (stats.triangle_count != 0)
+        {
+            LOG_INFO("Optimized \"%s\": ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, vertices %u -> %u",
+                FileSystem::GetFileNameFromFilePath(file_path).c_str(),
+                stats.GetAcmrBefore(), stats.GetAcmrAfter(),
+                stats.GetAtvrBefore(), stats.GetAtvrAfter(),
+                stats.vertex_count_before, stats.vertex_count_after
+            );
+        }
+
 		return true;
 	}
 
 	bool Model::SaveToFile(const string& file_path)
 	{
+		// Released geometry was read from this very file, there is nothing new to write
+		if (!IsGeometryResident() && file_path == m_geometry_file_path)
+			return true;
+
+		// Saving elsewhere (or exporting) needs the complete geometry
+		if (!GeometryAcquire())
+			return false;
+
 		auto file = make_unique<FileStream>(file_path, FileStream_Write);
 		if (!file->IsOpen())
 			return false;
@@ -136,13 +217,30 @@ namespace Spartan
 		file->Write(m_normalized_scale);
 		file->Write(m_mesh->Indices_Get());
 		file->Write(m_mesh->Vertices_Get());
+		file->Write(m_optimization_statistics.triangle_count);
+		file->Write(m_optimization_statistics.vertex_count_before);
+		file->Write(m_optimization_statistics.vertex_count_after);
+		file->Write(m_optimization_statistics.cache_misses_before);
+		file->Write(m_optimization_statistics.cache_misses_after);
+		file->Write(m_vertex_packing);
+		file->Write(static_cast<uint32_t>(m_sub_meshes.size()));
+		for (const SubMesh& sub_mesh : m_sub_meshes)
+		{
+			file->Write(sub_mesh.index_offset);
+			file->Write(sub_mesh.index_count);
+			file->Write(sub_mesh.vertex_offset);
+			file->Write(sub_mesh.vertex_count);
+		}
 
         file->Close();
 
+		// The file holds the geometry now
+		GeometryRelease(file_path);
+
 		return true;
 	}
 
-	void Model::AppendGeometry(const vector<uint32_t>& indices, const vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t* index_offset, uint32_t* vertex_offset) const
+	void Model::AppendGeometry(vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices, uint32_t* index_offset, uint32_t* vertex_offset, const bool optimize /*= false*/)
 	{
 		if (indices.empty() || vertices.empty())
 		{
@@ -150,27 +248,171 @@ namespace Spartan
 			return;
 		}
 
+		if (!GeometryAcquire())
+			return;
+
+        // Reorder for the vertex cache, overdraw and vertex fetch, before it ends up in any buffer
+        if (optimize)
+        {
+            m_optimization_statistics.Accumulate(MeshOptimizer::Optimize(indices, vertices));
+        }
+
+		// Keep track of the range, ray queries test its triangles
+		SubMesh& sub_mesh		= m_sub_meshes.emplace_back();
+		sub_mesh.index_offset	= m_mesh->Indices_Count();
+		sub_mesh.index_count	= static_cast<uint32_t>(indices.size());
+		sub_mesh.vertex_offset	= m_mesh->Vertices_Count();
+		sub_mesh.vertex_count	= static_cast<uint32_t>(vertices.size());
+
 		// Append indices and vertices to the main mesh
 		m_mesh->Indices_Append(indices, index_offset);
 		m_mesh->Vertices_Append(vertices, vertex_offset);
 	}
 
+	void Model::AppendIndices(const vector<uint32_t>& indices, uint32_t* index_offset)
+	{
+		if (indices.empty())
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		if (!GeometryAcquire())
+			return;
+
+		m_mesh->Indices_Append(indices, index_offset);
+	}
+
 	void Model::GetGeometry(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset, const uint32_t vertex_count, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices) const
 	{
-		m_mesh->Geometry_Get(index_offset, index_count, vertex_offset, vertex_count, indices, vertices);
+		if (IsGeometryResident())
+		{
+			m_mesh->Geometry_Get(index_offset, index_count, vertex_offset, vertex_count, indices, vertices);
+			return;
+		}
+
+		GeometryRead(index_offset, index_count, vertex_offset, vertex_count, indices, vertices);
+	}
+
+	void Model::GetGeometryPositions(const uint32_t vertex_offset, const uint32_t vertex_count, vector<Vector3>* positions) const
+	{
+		const uint32_t vertex_count_total = IsGeometryResident() ? m_mesh->Vertices_Count() : m_vertex_count;
+		if (!positions || vertex_count == 0 || vertex_offset + vertex_count > vertex_count_total)
+		{
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
+		}
+
+		// Kept position copy
+		if (!m_geometry_positions.empty())
+		{
+			positions->assign(m_geometry_positions.begin() + vertex_offset, m_geometry_positions.begin() + vertex_offset + vertex_count);
+			return;
+		}
+
+		// Resident or re-read vertices
+		vector<RHI_Vertex_PosTexNorTan> vertices_read;
+		const vector<RHI_Vertex_PosTexNorTan>* vertices = &vertices_read;
+		uint32_t first = 0;
+		if (IsGeometryResident())
+		{
+			vertices	= &m_mesh->Vertices_Get();
+			first		= vertex_offset;
+		}
+		else if (!GeometryRead(0, 0, vertex_offset, vertex_count, nullptr, &vertices_read))
+		{
+			return;
+		}
+
+		positions->resize(vertex_count);
+		for (uint32_t i = 0; i < vertex_count; i++)
+		{
+			const RHI_Vertex_PosTexNorTan& vertex = (*vertices)[first + i];
+			(*positions)[i] = Vector3(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+		}
+	}
+
+	void Model::SetGeometryKeepPositions(const bool keep_positions)
+	{
+		if (m_geometry_keep_positions == keep_positions)
+			return;
+
+		m_geometry_keep_positions = keep_positions;
+
+		// Ray queries need the positions as well
+		if (m_geometry_keep_for_rays)
+			return;
+
+		// Positions are copied on release, so only a model which is already released needs to catch up
+		m_geometry_positions.clear();
+		m_geometry_positions.shrink_to_fit();
+		if (keep_positions && !IsGeometryResident() && m_vertex_count != 0)
+		{
+			vector<Vector3> positions;
+			GetGeometryPositions(0, m_vertex_count, &positions);
+			m_geometry_positions = move(positions);
+		}
+
+		GeometryUpdateMemoryUsage();
 	}
 
 	void Model::UpdateGeometry()
 	{
+		if (!GeometryAcquire())
+			return;
+
 		if (m_mesh->Indices_Count() == 0 || m_mesh->Vertices_Count() == 0)
 		{
 			LOG_ERROR_INVALID_PARAMETER();
 			return;
 		}
 
-		GeometryCreateBuffers();
-		m_normalized_scale	= GeometryComputeNormalizedScale();
+		m_index_count	= m_mesh->Indices_Count();
+		m_vertex_count	= m_mesh->Vertices_Count();
+
+		// The bounding box comes first, the scale and the vertex packing depend on it
 		m_aabb				= BoundingBox(m_mesh->Vertices_Get());
+		m_normalized_scale	= GeometryComputeNormalizedScale();
+		GeometryCreateBuffers();
+	}
+
+	bool Model::RayTrace(const uint32_t index_offset, const Ray& ray, const bool any_hit, float* distance, uint32_t* triangle_index /*= nullptr*/, Vector2* barycentrics /*= nullptr*/)
+	{
+		// Sub-meshes are appended in index order
+		const auto it = lower_bound(m_sub_meshes.begin(), m_sub_meshes.end(), index_offset, [](const SubMesh& sub_mesh, const uint32_t offset) { return sub_mesh.index_offset < offset; });
+		if (it == m_sub_meshes.end() || it->index_offset != index_offset)
+			return false;
+
+		// Build on demand, most models are never ray traced
+		{
+			lock_guard<mutex> lock(m_mutex_bvh);
+			if (it->bvh.IsEmpty() && !GeometryBuildBvh(*it))
+				return false;
+		}
+
+		const SubMesh& sub_mesh = *it;
+		uint32_t triangle_hit	= 0;
+		Vector2 barycentrics_hit;
+		*distance = sub_mesh.bvh.Trace(ray, ray.GetLength(), any_hit, [&](const uint32_t triangle, const float distance_max)
+		{
+			Vector3 v0, v1, v2;
+			GeometryTriangle(sub_mesh, triangle, &v0, &v1, &v2);
+
+			Vector2 triangle_barycentrics;
+			const float triangle_distance = ray.HitDistance(v0, v1, v2, &triangle_barycentrics);
+
+			if (triangle_distance > distance_max)
+				return INFINITY;
+
+			triangle_hit		= triangle;
+			barycentrics_hit	= triangle_barycentrics;
+			return triangle_distance;
+		});
+
+		if (triangle_index)	*triangle_index	= triangle_hit;
+		if (barycentrics)	*barycentrics	= barycentrics_hit;
+
+		return true;
 	}
 
 	void Model::AddMaterial(shared_ptr<Material>& material, const shared_ptr<Entity>& entity) const
@@ -242,7 +484,9 @@ namespace Spartan
 		if (!vertices.empty())
 		{
 			m_vertex_buffer = make_shared<RHI_VertexBuffer>(m_rhi_device);
-			if (!m_vertex_buffer->Create(vertices))
+			vector<RHI_Vertex_PosTexNorTan_Packed> vertices_packed;
+			const bool created = GeometryPackVertices(vertices, &vertices_packed) ? m_vertex_buffer->Create(vertices_packed) : m_vertex_buffer->Create(vertices);
+			if (!created)
 			{
 				LOG_ERROR("Failed to create vertex buffer for \"%s\".", GetResourceName().c_str());
 				success = false;
@@ -257,6 +501,212 @@ namespace Spartan
 		return success;
 	}
 
+	bool Model::GeometryPackVertices(const vector<RHI_Vertex_PosTexNorTan>& vertices, vector<RHI_Vertex_PosTexNorTan_Packed>* vertices_packed)
+	{
+		m_vertex_packed					= false;
+		m_dequantize_position_scale		= Vector4::One;
+		m_dequantize_position_offset	= Vector4::Zero;
+		m_dequantize_uv					= Vector4(1.0f, 1.0f, 0.0f, 0.0f);
+
+		if (!m_vertex_packing || m_is_animated)
+			return false;
+
+		// Uv bounds
+		Vector2 uv_min = Vector2(numeric_limits<float>::max());
+		Vector2 uv_max = Vector2(numeric_limits<float>::lowest());
+		for (const RHI_Vertex_PosTexNorTan& vertex : vertices)
+		{
+			uv_min = Vector2(Math::Min(uv_min.x, vertex.tex[0]), Math::Min(uv_min.y, vertex.tex[1]));
+			uv_max = Vector2(Math::Max(uv_max.x, vertex.tex[0]), Math::Max(uv_max.y, vertex.tex[1]));
+		}
+
+		const Vector2 uv_range = uv_max - uv_min;
+		if (uv_range.x > vertex_packing_uv_range_max || uv_range.y > vertex_packing_uv_range_max)
+		{
+			LOG_INFO("\"%s\" uses full precision vertices, its uvs span a range of %.1f x %.1f", GetResourceName().c_str(), uv_range.x, uv_range.y);
+			return false;
+		}
+
+		// Positions and uvs are stored relative to their bounds
+		const Vector3 position_min		= m_aabb.GetMin();
+		const Vector3 position_range	= m_aabb.GetMax() - m_aabb.GetMin();
+		const auto normalize = [](const float value, const float min, const float range) { return range > 0.0f ? (value - min) / range : 0.0f; };
+
+		vertices_packed->resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			const RHI_Vertex_PosTexNorTan& vertex	= vertices[i];
+			RHI_Vertex_PosTexNorTan_Packed& packed	= (*vertices_packed)[i];
+
+			packed.pos[0] = unorm16(normalize(vertex.pos[0], position_min.x, position_range.x));
+			packed.pos[1] = unorm16(normalize(vertex.pos[1], position_min.y, position_range.y));
+			packed.pos[2] = unorm16(normalize(vertex.pos[2], position_min.z, position_range.z));
+			packed.tex[0] = unorm16(normalize(vertex.tex[0], uv_min.x, uv_range.x));
+			packed.tex[1] = unorm16(normalize(vertex.tex[1], uv_min.y, uv_range.y));
+			octahedral_encode(vertex.nor, packed.nor);
+			octahedral_encode(vertex.tan, packed.tan);
+		}
+
+		m_vertex_packed					= true;
+		m_dequantize_position_scale		= Vector4(position_range, 0.0f);
+		m_dequantize_position_offset	= Vector4(position_min, 0.0f);
+		m_dequantize_uv					= Vector4(uv_range.x, uv_range.y, uv_min.x, uv_min.y);
+
+		return true;
+	}
+
+	bool Model::GeometryBuildBvh(SubMesh& sub_mesh)
+	{
+		// From now on, releasing the geometry keeps what ray queries read. If it's already released, read it back once.
+		m_geometry_keep_for_rays = true;
+		if (!IsGeometryResident())
+		{
+			if (m_geometry_positions.size() != m_vertex_count)
+			{
+				vector<Vector3> positions;
+				GetGeometryPositions(0, m_vertex_count, &positions);
+				m_geometry_positions = move(positions);
+			}
+
+			if (m_geometry_indices.size() != m_index_count && !GeometryRead(0, m_index_count, 0, 0, &m_geometry_indices, nullptr))
+			{
+				m_geometry_indices.clear();
+			}
+		}
+
+		const uint32_t index_count_total	= IsGeometryResident() ? m_mesh->Indices_Count()	: static_cast<uint32_t>(m_geometry_indices.size());
+		const uint32_t vertex_count_total	= IsGeometryResident() ? m_mesh->Vertices_Count()	: static_cast<uint32_t>(m_geometry_positions.size());
+		if (sub_mesh.index_offset + sub_mesh.index_count > index_count_total || sub_mesh.vertex_offset + sub_mesh.vertex_count > vertex_count_total)
+		{
+			LOG_ERROR("Sub-mesh at index offset %d of \"%s\" is out of range", sub_mesh.index_offset, GetResourceName().c_str());
+			return false;
+		}
+
+		const uint32_t triangle_count = sub_mesh.index_count / 3;
+		vector<BoundingBox> triangle_bounds(triangle_count);
+		for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+		{
+			Vector3 v0, v1, v2;
+			GeometryTriangle(sub_mesh, triangle, &v0, &v1, &v2);
+			triangle_bounds[triangle] = BoundingBox(
+				Vector3(Math::Min3(v0.x, v1.x, v2.x), Math::Min3(v0.y, v1.y, v2.y), Math::Min3(v0.z, v1.z, v2.z)),
+				Vector3(Math::Max3(v0.x, v1.x, v2.x), Math::Max3(v0.y, v1.y, v2.y), Math::Max3(v0.z, v1.z, v2.z))
+			);
+		}
+
+		sub_mesh.bvh.Build(triangle_bounds);
+		GeometryUpdateMemoryUsage();
+
+		return !sub_mesh.bvh.IsEmpty();
+	}
+
+	void Model::GeometryTriangle(const SubMesh& sub_mesh, const uint32_t triangle, Vector3* v0, Vector3* v1, Vector3* v2) const
+	{
+		// Indices are relative to the sub-mesh's vertex offset, like the ones in the index buffer
+		const uint32_t index = sub_mesh.index_offset + triangle * 3;
+		Vector3* positions[3] = { v0, v1, v2 };
+		if (IsGeometryResident())
+		{
+			const vector<uint32_t>& indices					= m_mesh->Indices_Get();
+			const vector<RHI_Vertex_PosTexNorTan>& vertices	= m_mesh->Vertices_Get();
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const float* position = vertices[sub_mesh.vertex_offset + indices[index + i]].pos;
+				*positions[i] = Vector3(position[0], position[1], position[2]);
+			}
+		}
+		else
+		{
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				*positions[i] = m_geometry_positions[sub_mesh.vertex_offset + m_geometry_indices[index + i]];
+			}
+		}
+	}
+
+	void Model::GeometryRelease(const string& file_path)
+	{
+		if (m_mesh->Vertices_Count() == 0)
+			return;
+
+		// The geometry has to be uploaded before it's dropped
+		if (!m_vertex_buffer || !m_index_buffer)
+			return;
+
+		if (m_geometry_keep_for_rays)
+		{
+			m_geometry_indices = m_mesh->Indices_Get();
+		}
+
+		if (m_geometry_keep_positions || m_geometry_keep_for_rays)
+		{
+			const vector<RHI_Vertex_PosTexNorTan>& vertices = m_mesh->Vertices_Get();
+			m_geometry_positions.resize(vertices.size());
+			for (size_t i = 0; i < vertices.size(); i++)
+			{
+				m_geometry_positions[i] = Vector3(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]);
+			}
+		}
+
+		m_mesh->Geometry_Clear();
+		m_geometry_file_path = file_path;
+
+		GeometryUpdateMemoryUsage();
+	}
+
+	bool Model::GeometryAcquire()
+	{
+		if (IsGeometryResident())
+			return true;
+
+		// The kept positions (and indices) are superseded by the geometry
+		if (!GeometryRead(0, m_index_count, 0, m_vertex_count, &m_mesh->Indices_Get(), &m_mesh->Vertices_Get()))
+			return false;
+
+		m_geometry_file_path.clear();
+		m_geometry_positions.clear();
+		m_geometry_positions.shrink_to_fit();
+		m_geometry_indices.clear();
+		m_geometry_indices.shrink_to_fit();
+
+		GeometryUpdateMemoryUsage();
+
+		return true;
+	}
+
+	bool Model::GeometryRead(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset, const uint32_t vertex_count, vector<uint32_t>* indices, vector<RHI_Vertex_PosTexNorTan>* vertices) const
+	{
+		auto file = make_unique<FileStream>(m_geometry_file_path, FileStream_Read);
+		if (!file->IsOpen())
+		{
+			LOG_ERROR("Failed to re-read geometry of \"%s\" from \"%s\"", GetResourceName().c_str(), m_geometry_file_path.c_str());
+			return false;
+		}
+
+		// Skip the header, see SaveToFile()
+		file->ReadAs<string>();
+		file->ReadAs<float>();
+
+		// A zero count range only skips past the vector
+		vector<uint32_t> indices_skipped;
+		vector<RHI_Vertex_PosTexNorTan> vertices_skipped;
+		file->Read(indices ? indices : &indices_skipped, indices ? index_offset : 0, indices ? index_count : 0);
+		file->Read(vertices ? vertices : &vertices_skipped, vertices ? vertex_offset : 0, vertices ? vertex_count : 0);
+		file->Close();
+
+		return (!indices || indices->size() == index_count) && (!vertices || vertices->size() == vertex_count);
+	}
+
+	void Model::GeometryUpdateMemoryUsage()
+	{
+		m_size_cpu = m_mesh->Geometry_MemoryUsage() + static_cast<uint32_t>(m_geometry_positions.size() * sizeof(Vector3) + m_geometry_indices.size() * sizeof(uint32_t));
+
+		for (const SubMesh& sub_mesh : m_sub_meshes)
+		{
+			m_size_cpu += sub_mesh.bvh.GetMemoryUsage();
+		}
+	}
+
 	float Model::GeometryComputeNormalizedScale() const
 	{
 		// Compute scale offset
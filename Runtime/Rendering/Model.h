@@ -24,10 +24,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <memory>
 #include <vector>
+#include <mutex>
 #include "Material.h"
+#include "MeshOptimizer.h"
 #include "../RHI/RHI_Definition.h"
 #include "../Resource/IResource.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Vector4.h"
+#include "../Math/Bvh.h"
 #include "../RHI/RHI_Object.h"
 //================================
 
@@ -51,13 +55,15 @@ namespace Spartan
 		bool SaveToFile(const std::string& file_path) override;
 		//=======================================================
 
-        // Geometry
+        // Geometry (if asked to optimize, it's done in place, so the caller gets the final counts)
         void AppendGeometry(
-            const std::vector<uint32_t>& indices,
-            const std::vector<RHI_Vertex_PosTexNorTan>& vertices,
+            std::vector<uint32_t>& indices,
+            std::vector<RHI_Vertex_PosTexNorTan>& vertices,
             uint32_t* index_offset  = nullptr,
-            uint32_t* vertex_offset = nullptr
-        ) const;
+            uint32_t* vertex_offset = nullptr,
+            bool optimize           = false
+        );
+        void AppendIndices(const std::vector<uint32_t>& indices, uint32_t* index_offset = nullptr);
         void GetGeometry(
             uint32_t index_offset,
             uint32_t index_count,
@@ -66,15 +72,45 @@ namespace Spartan
             std::vector<uint32_t>* indices,
             std::vector<RHI_Vertex_PosTexNorTan>* vertices
         ) const;
+        void GetGeometryPositions(uint32_t vertex_offset, uint32_t vertex_count, std::vector<Math::Vector3>* positions) const;
         void UpdateGeometry();
-        const auto& GetAabb() const { return m_aabb; }
-        const auto& GetMesh() const { return m_mesh; }
+        const auto& GetAabb()   const { return m_aabb; }
+        uint32_t GetIndexCount()  const { return m_index_count; }
+        uint32_t GetVertexCount() const { return m_vertex_count; }
+
+        // Once the engine file holds the geometry, the cpu copy is released and ranges are re-read from that file on demand.
+        // Models used for physics can keep a position only copy, since shapes are rebuilt whenever the scale changes.
+        bool IsGeometryResident() const { return m_geometry_file_path.empty(); }
+        void SetGeometryKeepPositions(bool keep_positions);
+
+        // Ray queries against the triangles of geometry appended with AppendGeometry(), identified by its index offset.
+        // The ray is in the geometry's local space. Returns false if there are no triangles for it, a miss has an infinite distance.
+        // The bvh of a sub-mesh is built by its first query, from then on the model keeps its indices and positions when releasing geometry.
+        bool RayTrace(
+            uint32_t index_offset,
+            const Math::Ray& ray,
+            bool any_hit,
+            float* distance,
+            uint32_t* triangle_index    = nullptr,
+            Math::Vector2* barycentrics = nullptr
+        );
+
+        // Optimization statistics, for geometry which was optimized before being appended
+        void AppendOptimizationStatistics(const MeshOptimizer::Statistics& statistics)  { m_optimization_statistics.Accumulate(statistics); }
+        const auto& GetOptimizationStatistics() const                                   { return m_optimization_statistics; }
 
 		// Add resources to the model
         void SetRootEntity(const std::shared_ptr<Entity>& entity) { m_root_entity = entity; }
 		void AddMaterial(std::shared_ptr<Material>& material, const std::shared_ptr<Entity>& entity) const;
 		void AddTexture(std::shared_ptr<Material>& material, TextureType texture_type, const std::string& file_path);
 
+        // Vertex packing, static meshes can use RHI_Vertex_PosTexNorTan_Packed, if their uvs don't span a range too large to quantize
+        void SetVertexPacking(const bool vertex_packing)       { m_vertex_packing = vertex_packing; }
+        bool IsVertexPacked()                           const { return m_vertex_packed; }
+        const auto& GetDequantizePositionScale()        const { return m_dequantize_position_scale; }
+        const auto& GetDequantizePositionOffset()       const { return m_dequantize_position_offset; }
+        const auto& GetDequantizeUv()                   const { return m_dequantize_uv; }
+
         // Misc
         bool IsAnimated()                           const { return m_is_animated; }
 		void SetAnimated(const bool is_animated)	      { m_is_animated = is_animated; }
@@ -83,8 +119,32 @@ namespace Spartan
 		auto GetSharedPtr()							      { return shared_from_this(); }
 
 	private:
+		// Geometry appended by a single AppendGeometry() call, with a triangle bvh for ray queries
+		struct SubMesh
+		{
+			uint32_t index_offset	= 0;
+			uint32_t index_count	= 0;
+			uint32_t vertex_offset	= 0;
+			uint32_t vertex_count	= 0;
+			Math::Bvh bvh;
+		};
+
 		// Geometry
 		bool GeometryCreateBuffers();
+		bool GeometryBuildBvh(SubMesh& sub_mesh);
+		void GeometryTriangle(const SubMesh& sub_mesh, uint32_t triangle, Math::Vector3* v0, Math::Vector3* v1, Math::Vector3* v2) const;
+		bool GeometryPackVertices(const std::vector<RHI_Vertex_PosTexNorTan>& vertices, std::vector<RHI_Vertex_PosTexNorTan_Packed>* vertices_packed);
+		void GeometryRelease(const std::string& file_path);
+		bool GeometryAcquire();
+		bool GeometryRead(
+			uint32_t index_offset,
+			uint32_t index_count,
+			uint32_t vertex_offset,
+			uint32_t vertex_count,
+			std::vector<uint32_t>* indices,
+			std::vector<RHI_Vertex_PosTexNorTan>* vertices
+		) const;
+		void GeometryUpdateMemoryUsage();
 		float GeometryComputeNormalizedScale() const;
 
 		// Misc
@@ -93,9 +153,28 @@ namespace Spartan
 		std::shared_ptr<RHI_IndexBuffer> m_index_buffer;
 		std::shared_ptr<Mesh> m_mesh;
 		Math::BoundingBox m_aabb;
+		MeshOptimizer::Statistics m_optimization_statistics;
+		std::vector<SubMesh> m_sub_meshes;
+		uint32_t m_index_count	= 0;
+		uint32_t m_vertex_count	= 0;
 		float m_normalized_scale	= 1.0f;
 		bool m_is_animated			= false;
 
+        // Vertex packing
+        bool m_vertex_packing                       = false;
+        bool m_vertex_packed                        = false;
+        Math::Vector4 m_dequantize_position_scale   = Math::Vector4::One;
+        Math::Vector4 m_dequantize_position_offset  = Math::Vector4::Zero;
+        Math::Vector4 m_dequantize_uv               = Math::Vector4(1.0f, 1.0f, 0.0f, 0.0f); // xy: scale, zw: offset
+
+        // Geometry release
+        std::string m_geometry_file_path; // empty while the cpu geometry is resident
+        std::vector<Math::Vector3> m_geometry_positions;
+        std::vector<uint32_t> m_geometry_indices;   // only kept for ray queries
+        bool m_geometry_keep_positions  = false;
+        bool m_geometry_keep_for_rays   = false;    // set by the first ray query
+        std::mutex m_mutex_bvh;
+
         // Dependencies
 		ResourceCache* m_resource_manager;
 		std::shared_ptr<RHI_Device> m_rhi_device;	
@@ -0,0 +1,327 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ==========================
+#include "RenderGraph.h"
+#include <algorithm>
+#include "../Logging/Log.h"
+#include "../RHI/RHI_Texture.h"
+#include "../RHI/RHI_TransientHeap.h"
+//=====================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    static uint32_t bytes_per_pixel(const RHI_Format format)
+    {
+        switch (format)
+        {
+            case RHI_Format_R8_Unorm:               return 1;
+            case RHI_Format_R16_Uint:               return 2;
+            case RHI_Format_R16_Float:              return 2;
+            case RHI_Format_R8G8_Unorm:             return 2;
+            case RHI_Format_R32G32_Float:           return 8;
+            case RHI_Format_R32G32B32_Float:        return 12;
+            case RHI_Format_R16G16B16A16_Float:     return 8;
+            case RHI_Format_R16G16B16A16_Unorm:     return 8;
+            case RHI_Format_R32G32B32A32_Float:     return 16;
+            case RHI_Format_D32_Float_S8X24_Uint:   return 8;
+            default:                                return 4;
+        }
+    }
+
+    static uint64_t align(const uint64_t value, const uint64_t alignment)
+    {
+        return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+    }
+
+    RenderGraph::RenderGraph(const shared_ptr<RHI_Device>& rhi_device)
+    {
+        m_rhi_device    = rhi_device;
+        m_aliasing      = RHI_TransientHeap::IsSupported();
+    }
+
+    RenderGraph::~RenderGraph() = default;
+
+    void RenderGraph::Clear()
+    {
+        m_passes.clear();
+        m_accesses.clear();
+    }
+
+    void RenderGraph::AddPass(const char* name, function<void()>&& execute)
+    {
+        const uint32_t access_index = static_cast<uint32_t>(m_accesses.size());
+        m_passes.emplace_back(Pass{ name, move(execute), access_index, access_index, false });
+    }
+
+    void RenderGraph::AddAccess(RHI_Texture* texture, const bool write)
+    {
+        if (!texture || m_passes.empty())
+            return;
+
+        m_accesses.emplace_back(Access{ texture, write });
+        m_passes.back().access_end = static_cast<uint32_t>(m_accesses.size());
+    }
+
+    bool RenderGraph::Compile()
+    {
+        // Cull, walking back from the passes which have an effect outside of the frame. Those are passes which write a
+        // render target that isn't transient, or which write nothing the graph knows about (e.g. light shadow maps).
+        m_needed.clear();
+        m_pass_count_culled = 0;
+        for (auto i = static_cast<int>(m_passes.size()) - 1; i >= 0; i--)
+        {
+            Pass& pass = m_passes[i];
+
+            bool needed     = true;
+            bool has_writes = false;
+            for (uint32_t j = pass.access_begin; j < pass.access_end; j++)
+            {
+                const Access& access = m_accesses[j];
+                if (!access.write)
+                    continue;
+
+                if (!has_writes)
+                {
+                    has_writes  = true;
+                    needed      = false;
+                }
+
+                needed = needed || !access.texture->IsTransient() || find(m_needed.begin(), m_needed.end(), access.texture) != m_needed.end();
+            }
+
+            pass.culled = !needed;
+            if (pass.culled)
+            {
+                m_pass_count_culled++;
+                continue;
+            }
+
+            for (uint32_t j = pass.access_begin; j < pass.access_end; j++)
+            {
+                const Access& access = m_accesses[j];
+                if (!access.write && access.texture->IsTransient() && find(m_needed.begin(), m_needed.end(), access.texture) == m_needed.end())
+                {
+                    m_needed.emplace_back(access.texture);
+                }
+            }
+        }
+
+        // Lifetimes of the transient render targets, the ones which are only used by culled passes keep an empty lifetime
+        m_lifetimes.clear();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_passes.size()); i++)
+        {
+            const Pass& pass = m_passes[i];
+            for (uint32_t j = pass.access_begin; j < pass.access_end; j++)
+            {
+                RHI_Texture* texture = m_accesses[j].texture;
+                if (!texture->IsTransient())
+                    continue;
+
+                auto it = find_if(m_lifetimes.begin(), m_lifetimes.end(), [texture](const Lifetime& lifetime) { return lifetime.texture == texture; });
+                if (it == m_lifetimes.end())
+                {
+                    m_lifetimes.emplace_back(Lifetime{ texture, numeric_limits<uint32_t>::max(), 0 });
+                    it = m_lifetimes.end() - 1;
+                }
+
+                if (!pass.culled)
+                {
+                    it->first   = min(it->first, i);
+                    it->last    = max(it->last, i);
+                }
+            }
+        }
+        sort(m_lifetimes.begin(), m_lifetimes.end(), [](const Lifetime& a, const Lifetime& b) { return a.texture < b.texture; });
+
+        // Without aliasing there is nothing to bind, the layout is only computed to be reported
+        if (!m_aliasing)
+        {
+            if (m_lifetimes != m_lifetimes_allocated)
+            {
+                Allocate();
+            }
+
+            return true;
+        }
+
+        bool bound_all = true;
+        bool bound_any = false;
+        for (const Lifetime& lifetime : m_lifetimes)
+        {
+            const bool bound    = lifetime.texture->IsMemoryBound();
+            bound_all           = bound_all && bound;
+            bound_any           = bound_any || bound;
+        }
+
+        if (bound_all && m_lifetimes == m_lifetimes_allocated)
+            return true;
+
+        // Memory can't be re-bound, so textures which already have it have to be re-created
+        if (bound_any)
+            return false;
+
+        Allocate();
+        return true;
+    }
+
+    void RenderGraph::Allocate()
+    {
+        struct Placement
+        {
+            const Lifetime* lifetime;
+            uint64_t size;
+            uint64_t alignment;
+            uint32_t memory_type_bits;
+            uint64_t offset;
+        };
+
+        // Largest first, they are the hardest to fit in a gap
+        vector<Placement> placements;
+        placements.reserve(m_lifetimes.size());
+        for (const Lifetime& lifetime : m_lifetimes)
+        {
+            const RHI_Texture* texture  = lifetime.texture;
+            uint64_t size               = texture->GetSizeGpu();
+            if (size == 0) // the API doesn't report it, estimate
+            {
+                size = static_cast<uint64_t>(texture->GetWidth()) * texture->GetHeight() * texture->GetArraySize() * bytes_per_pixel(texture->GetFormat());
+            }
+
+            placements.emplace_back(Placement{ &lifetime, size, max<uint64_t>(texture->GetMemoryAlignment(), 1), texture->GetMemoryTypeBits(), 0 });
+        }
+        sort(placements.begin(), placements.end(), [](const Placement& a, const Placement& b) { return a.size > b.size; });
+
+        // Free the previous heaps (waits for the GPU)
+        m_heaps.clear();
+        m_memory_transient          = 0;
+        m_memory_transient_aliased  = 0;
+
+        // Textures which can live in the same kind of memory share a heap, each one goes in the
+        // lowest gap which isn't used by an already placed texture that is alive at the same time.
+        vector<uint32_t> memory_types;
+        for (const Placement& placement : placements)
+        {
+            if (find(memory_types.begin(), memory_types.end(), placement.memory_type_bits) == memory_types.end())
+            {
+                memory_types.emplace_back(placement.memory_type_bits);
+            }
+        }
+
+        vector<const Placement*> overlapping;
+        for (const uint32_t memory_type_bits : memory_types)
+        {
+            uint64_t heap_size = 0;
+            for (Placement& placement : placements)
+            {
+                if (placement.memory_type_bits != memory_type_bits)
+                    continue;
+
+                overlapping.clear();
+                for (const Placement& other : placements)
+                {
+                    if (&other == &placement)
+                        break; // the rest aren't placed yet
+
+                    if (other.memory_type_bits == memory_type_bits && placement.lifetime->Overlaps(*other.lifetime))
+                    {
+                        overlapping.emplace_back(&other);
+                    }
+                }
+                sort(overlapping.begin(), overlapping.end(), [](const Placement* a, const Placement* b) { return a->offset < b->offset; });
+
+                uint64_t offset = 0;
+                for (const Placement* other : overlapping)
+                {
+                    offset = align(offset, placement.alignment);
+                    if (offset + placement.size <= other->offset)
+                        break;
+
+                    offset = max(offset, other->offset + other->size);
+                }
+                placement.offset = align(offset, placement.alignment);
+
+                heap_size           = max(heap_size, placement.offset + placement.size);
+                m_memory_transient  += placement.size;
+            }
+            m_memory_transient_aliased += heap_size;
+
+            if (!m_aliasing)
+                continue;
+
+            m_heaps.emplace_back(make_unique<RHI_TransientHeap>(m_rhi_device, heap_size, memory_type_bits));
+            const RHI_TransientHeap* heap = m_heaps.back().get();
+            for (const Placement& placement : placements)
+            {
+                if (placement.memory_type_bits == memory_type_bits && !heap->Bind(placement.lifetime->texture, placement.offset))
+                {
+                    LOG_ERROR("Failed to bind a transient render target to its heap");
+                }
+            }
+        }
+
+        m_lifetimes_allocated = m_lifetimes;
+
+        const float mb = 1024.0f * 1024.0f;
+        LOG_INFO("%d passes, %d culled, transient render targets take %.1f MB%s (%.1f MB without aliasing)",
+            GetPassCount(),
+            m_pass_count_culled,
+            static_cast<float>(m_memory_transient_aliased) / mb,
+            m_aliasing ? "" : " once the API supports aliasing",
+            static_cast<float>(m_memory_transient) / mb
+        );
+    }
+
+    void RenderGraph::Execute()
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_passes.size()); i++)
+        {
+            Pass& pass = m_passes[i];
+            if (pass.culled)
+                continue;
+
+            // When the lifetime of a transient render target begins, its memory holds whatever another one left there. Setting an
+            // undefined layout makes the next transition discard it, the content stays undefined (garbage, not black) until a pass
+            // writes it, so the first pass that uses a transient render target has to write all of it.
+            if (m_aliasing)
+            {
+                for (uint32_t j = pass.access_begin; j < pass.access_end; j++)
+                {
+                    RHI_Texture* texture = m_accesses[j].texture;
+                    if (!texture->IsTransient())
+                        continue;
+
+                    const auto it = lower_bound(m_lifetimes.begin(), m_lifetimes.end(), texture, [](const Lifetime& lifetime, const RHI_Texture* texture) { return lifetime.texture < texture; });
+                    if (it != m_lifetimes.end() && it->texture == texture && it->first == i)
+                    {
+                        texture->SetLayout(RHI_Image_Undefined);
+                    }
+                }
+            }
+
+            pass.execute();
+        }
+    }
+}
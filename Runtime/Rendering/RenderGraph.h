@@ -0,0 +1,107 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ======================
+#include <vector>
+#include <memory>
+#include <functional>
+#include "../Core/EngineDefs.h"
+#include "../RHI/RHI_Definition.h"
+//=================================
+
+namespace Spartan
+{
+    // The renderer declares its passes every frame, along with the render targets they read and write.
+    // Passes whose output nobody reads are culled, and transient render targets (RHI_Texture_Transient)
+    // whose lifetimes don't overlap are placed in the same memory.
+    class SPARTAN_CLASS RenderGraph
+    {
+    public:
+        RenderGraph(const std::shared_ptr<RHI_Device>& rhi_device);
+        ~RenderGraph();
+
+        // Declaration, Read() and Write() apply to the pass that was added last
+        void Clear();
+        void AddPass(const char* name, std::function<void()>&& execute);
+        void Read(RHI_Texture* texture)                         { AddAccess(texture, false); }
+        void Write(RHI_Texture* texture)                        { AddAccess(texture, true); }
+        void Read(const std::shared_ptr<RHI_Texture>& texture)  { AddAccess(texture.get(), false); }
+        void Write(const std::shared_ptr<RHI_Texture>& texture) { AddAccess(texture.get(), true); }
+
+        // Culls passes and computes the lifetimes of the transient render targets, binding them to memory if they aren't yet.
+        // Returns false if they are already bound to memory which was laid out for different lifetimes, they have to be re-created.
+        bool Compile();
+
+        // Runs the passes that survived culling, in the order they were added
+        void Execute();
+
+        // Stats
+        uint32_t GetPassCount()                 const { return static_cast<uint32_t>(m_passes.size()); }
+        uint32_t GetPassCountCulled()           const { return m_pass_count_culled; }
+        uint64_t GetMemoryTransient()           const { return m_memory_transient; }            // if every transient render target had its own memory
+        uint64_t GetMemoryTransientAliased()    const { return m_memory_transient_aliased; }    // what they take when aliased
+
+    private:
+        struct Pass
+        {
+            const char* name;
+            std::function<void()> execute;
+            uint32_t access_begin;
+            uint32_t access_end;
+            bool culled;
+        };
+
+        struct Access
+        {
+            RHI_Texture* texture;
+            bool write;
+        };
+
+        struct Lifetime
+        {
+            RHI_Texture* texture;
+            uint32_t first; // first pass that uses the texture
+            uint32_t last;  // last pass that uses the texture (smaller than first if it's not used)
+
+            bool Overlaps(const Lifetime& other) const { return first <= other.last && other.first <= last; }
+            bool operator==(const Lifetime& other) const { return texture == other.texture && first == other.first && last == other.last; }
+        };
+
+        void AddAccess(RHI_Texture* texture, const bool write);
+        void Allocate();
+
+        std::vector<Pass> m_passes;
+        std::vector<Access> m_accesses;
+        std::vector<RHI_Texture*> m_needed;
+        std::vector<Lifetime> m_lifetimes;
+        std::vector<Lifetime> m_lifetimes_allocated;
+        std::vector<std::unique_ptr<RHI_TransientHeap>> m_heaps;
+        uint32_t m_pass_count_culled            = 0;
+        uint64_t m_memory_transient             = 0;
+        uint64_t m_memory_transient_aliased     = 0;
+        bool m_aliasing                         = false;
+
+        // Dependencies
+        std::shared_ptr<RHI_Device> m_rhi_device;
+    };
+}
@@ -21,8 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==============================
 #include "Renderer.h"
+#include <unordered_set>
+#include <cstring>
 #include "Model.h"
 #include "Font/Font.h"
+#include "RenderGraph.h"
 #include "Gizmos/Grid.h"
 #include "Gizmos/Transform_Gizmo.h"
 #include "../Utilities/Sampling.h"
@@ -30,6 +33,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Resource/ResourceCache.h"
 #include "../Core/Engine.h"
 #include "../Core/Timer.h"
+#include "../World/World.h"
 #include "../World/Entity.h"
 #include "../World/Components/Transform.h"
 #include "../World/Components/Renderable.h"
@@ -53,6 +57,9 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // How far the camera can move before the renderables are sorted again
+    static const float renderables_sort_distance = 1.0f;
+
     Renderer::Renderer(Context* context) : ISubsystem(context)
     {
         // Options
@@ -85,6 +92,11 @@ namespace Spartan
         m_option_values[Option_Value_Sharpen_Clamp]           = 0.35f;
         m_option_values[Option_Value_Bloom_Intensity]         = 0.003f;
         m_option_values[Option_Value_Motion_Blur_Intensity]   = 0.01f;
+        m_option_values[Option_Value_DynamicResolution_TargetMs]  = 15.0f;
+        m_option_values[Option_Value_DynamicResolution_ScaleMin]  = 0.5f;
+        m_option_values[Option_Value_Ssao_Quality]                = static_cast<float>(Renderer_Effect_Quality_Half);
+        m_option_values[Option_Value_Ssr_Quality]                 = static_cast<float>(Renderer_Effect_Quality_Full);
+        m_option_values[Option_Value_VolumetricLighting_Quality]  = static_cast<float>(Renderer_Effect_Quality_Half);
 
 		// Subscribe to events
 		SUBSCRIBE_TO_EVENT(Event_World_Resolve_Complete,    EVENT_HANDLER_VARIANT(RenderablesAcquire));
@@ -97,6 +109,9 @@ namespace Spartan
 		UNSUBSCRIBE_FROM_EVENT(Event_World_Resolve_Complete, EVENT_HANDLER_VARIANT(RenderablesAcquire));
 
 		m_entities.clear();
+        m_entities_owned.clear();
+        m_entities_frame.clear();
+        m_lights_frame.clear();
 		m_camera = nullptr;
 
 		// Log to file as the renderer is no more
@@ -123,6 +138,9 @@ namespace Spartan
         // Create descriptor cache
         m_descriptor_cache = make_shared<RHI_DescriptorCache>(m_rhi_device.get());
 
+        // Create render graph
+        m_render_graph = make_unique<RenderGraph>(m_rhi_device);
+
         // Create swap chain
         {
             const WindowData& window_data = m_context->m_engine->GetWindowData();
@@ -184,6 +202,9 @@ namespace Spartan
 
         RHI_CommandList* cmd_list = m_swap_chain->GetCmdList();
 
+        // Pick up what the world resolved since the last frame, the passes only ever see this copy
+        RenderablesPublish();
+
 		// If there is no camera, do nothing
 		if (!m_camera)
 		{
@@ -200,6 +221,10 @@ namespace Spartan
 
 		m_frame_num++;
 		m_is_odd_frame = (m_frame_num % 2) == 1;
+        m_descriptor_cache->AdvanceFrame();
+
+        // Pick this frame's render resolution, everything below (jitter, viewports) depends on it
+        UpdateDynamicResolution();
 
 		// Get camera matrices
 		{
@@ -219,8 +244,8 @@ namespace Spartan
 				const uint64_t samples	        = 16;
 				const uint64_t index	        = m_frame_num % samples;
 				m_taa_jitter			        = Utility::Sampling::Halton2D(index, 2, 3) * 2.0f - 1.0f;
-				m_taa_jitter.x			        = m_taa_jitter.x / m_resolution.x;
-				m_taa_jitter.y			        = m_taa_jitter.y / m_resolution.y;
+				m_taa_jitter.x			        = m_taa_jitter.x / m_resolution_render.x;
+				m_taa_jitter.y			        = m_taa_jitter.y / m_resolution_render.y;
                 m_buffer_frame_cpu.projection   *= Matrix::CreateTranslation(Vector3(m_taa_jitter.x, m_taa_jitter.y, 0.0f));
 			}
 			else
@@ -235,9 +260,10 @@ namespace Spartan
             m_buffer_frame_cpu.view_projection_unjittered   = m_buffer_frame_cpu.view * m_camera->GetProjectionMatrix();
 		}
 
-		m_is_rendering = true;
+        // Create any pipelines that newly loaded content needs, before the passes would
+        PrecompilePipelines();
+
 		Pass_Main(cmd_list);
-		m_is_rendering = false;
 	}
 
 	void Renderer::SetResolution(uint32_t width, uint32_t height)
@@ -271,6 +297,46 @@ namespace Spartan
 		LOG_INFO("Resolution set to %dx%d", width, height);
 	}
 
+    void Renderer::UpdateDynamicResolution()
+    {
+        const bool enabled = GetOption(Render_DynamicResolution);
+
+        // The controller needs a gpu time every frame, not just every profiling interval
+        m_profiler->SetProfilingEveryFrame(enabled);
+
+        float scale = 1.0f;
+        if (enabled)
+        {
+            // Prefer the gpu time, fall back to the frame time if gpu profiling is unavailable
+            float time_ms = m_profiler->GetTimeGpu();
+            if (time_ms <= 0.0f)
+            {
+                time_ms = static_cast<float>(m_context->GetSubsystem<Timer>()->GetDeltaTimeMs());
+            }
+
+            scale = m_resolution_scale;
+            if (time_ms > 0.0f)
+            {
+                // Pixel count scales with the square of the scale, so does (roughly) the gpu time
+                const float headroom = m_option_values[Option_Value_DynamicResolution_TargetMs] / time_ms;
+
+                // Ignore small deviations, and ease into the new scale, so the resolution doesn't oscillate
+                if (headroom < 0.95f || headroom > 1.05f)
+                {
+                    scale = Lerp(scale, scale * Sqrt(headroom), 0.2f);
+                }
+            }
+
+            scale = Clamp(scale, m_option_values[Option_Value_DynamicResolution_ScaleMin], 1.0f);
+        }
+
+        m_resolution_scale = scale;
+
+        // Keep the render resolution even, like the resolution
+        m_resolution_render.x = Max(Round(m_resolution.x * m_resolution_scale * 0.5f) * 2.0f, 2.0f);
+        m_resolution_render.y = Max(Round(m_resolution.y * m_resolution_scale * 0.5f) * 2.0f, 2.0f);
+    }
+
 	void Renderer::DrawLine(const Vector3& from, const Vector3& to, const Vector4& color_from, const Vector4& color_to, const bool depth /*= true*/)
 	{
 		if (depth)
@@ -355,6 +421,7 @@ namespace Spartan
         m_buffer_frame_cpu.directional_light_intensity  = light_directional_intensity;
         m_buffer_frame_cpu.ssr_enabled                  = GetOption(Render_ScreenSpaceReflections) ? 1.0f : 0.0f;
         m_buffer_frame_cpu.shadow_resolution            = GetOptionValue<float>(Option_Value_ShadowResolution);
+        m_buffer_frame_cpu.resolution_scale             = m_resolution_render / m_resolution;
 
         // Update
         *buffer = m_buffer_frame_cpu;
@@ -385,38 +452,106 @@ namespace Spartan
 		return m_buffer_uber_gpu->Unmap();
 	}
 
-    bool Renderer::UpdateObjectBuffer(RHI_CommandList* cmd_list, const uint32_t entity_index /*= 0*/)
+    bool Renderer::UpdateObjectBuffer(RHI_CommandList* cmd_list)
     {
-        // Only update if needed
-        const bool same_content   = m_buffer_object_cpu == m_buffer_object_cpu_previous;
-        const bool same_offset    = m_buffer_object_gpu->GetOffsetIndexDynamic() == entity_index;
+        // Only update if needed (and if the element which holds the previous content hasn't been re-used since)
+        const bool same_content = m_buffer_object_cpu == m_buffer_object_cpu_previous;
+        const bool same_offset  = m_buffer_object_gpu->GetOffsetIndexDynamic() == m_buffer_object_offset_previous;
         if (same_content && same_offset)
             return true;
 
-        const uint32_t entity_count = entity_index + 1;
+        const uint32_t offset_index = AllocateObjectBuffer(1);
+        if (offset_index == numeric_limits<uint32_t>::max())
+            return false;
+
+        // Map  
+        BufferObject* buffer = static_cast<BufferObject*>(m_buffer_object_gpu->Map(offset_index));
+        if (!buffer)
+        {
+            LOG_ERROR("Failed to map buffer");
+            return false;
+        }
+
+        // Update
+        *buffer = m_buffer_object_cpu;
+        m_buffer_object_cpu_previous    = m_buffer_object_cpu;
+        m_buffer_object_offset_previous = offset_index;
 
-        // Re-allocate buffer with double size (if needed)
-        if (entity_count >= m_buffer_object_gpu->GetElementCount())
+        // Unmap
+        if (!m_buffer_object_gpu->Unmap())
+            return false;
+
+        BindObjectBuffer(cmd_list, offset_index);
+
+        return true;
+    }
+
+    uint32_t Renderer::AllocateObjectBuffer(const uint32_t count)
+    {
+        // Counted even if it doesn't fit, so that the regions grow before the next frame, see Pass_Main()
+        m_buffer_object_ring_used += count;
+
+        // Other regions belong to frames which can still be in flight, so this frame can't wrap into them, and it can't
+        // grow the buffer either, as the command list already references it. What doesn't fit is skipped for this frame.
+        if (m_buffer_object_ring_index + count > m_buffer_object_ring_end)
         {
-            const uint32_t new_size = Math::NextPowerOfTwo(entity_count);
-            if (!m_buffer_object_gpu->Create<BufferObject>(new_size))
+            if (!m_buffer_object_ring_full)
             {
-                LOG_ERROR("Failed to re-allocate buffer with %d offsets", new_size);
-                return false;
+                LOG_WARNING("The object buffer is full, %d objects are skipped this frame", count);
             }
+            m_buffer_object_ring_full = true;
+            return numeric_limits<uint32_t>::max();
         }
 
-        // Set new buffer offset
-        m_buffer_object_gpu->SetOffsetIndexDynamic(entity_index);
+        const uint32_t offset_index = m_buffer_object_ring_index;
+        m_buffer_object_ring_index += count;
+
+        // The previous content might be overwritten from now on, and mapping offset 0 discards the whole buffer (D3D11)
+        if (offset_index == 0 || (offset_index <= m_buffer_object_offset_previous && m_buffer_object_offset_previous < m_buffer_object_ring_index))
+        {
+            m_buffer_object_offset_previous = numeric_limits<uint32_t>::max();
+        }
+
+        return offset_index;
+    }
+
+    void Renderer::BindObjectBuffer(RHI_CommandList* cmd_list, const uint32_t offset_index)
+    {
+        m_buffer_object_gpu->SetOffsetIndexDynamic(offset_index);
 
         // Dynamic buffers with offsets have to be rebound whenever the offset changes
         if (cmd_list)
         {
             cmd_list->SetConstantBuffer(2, RHI_Shader_Vertex, m_buffer_object_gpu);
         }
+    }
 
-        // Map  
-        BufferObject* buffer = static_cast<BufferObject*>(m_buffer_object_gpu->Map(entity_index));
+    void Renderer::SetObjectDequantization(BufferObject& buffer, const Model* model)
+    {
+        // Packed vertices are normalized to the model's bounds, see Model::GeometryPackVertices()
+        const bool packed = model && model->IsVertexPacked();
+        buffer.dequantize_position_scale    = packed ? model->GetDequantizePositionScale()  : Vector4::One;
+        buffer.dequantize_position_offset   = packed ? model->GetDequantizePositionOffset() : Vector4::Zero;
+        buffer.dequantize_uv                = packed ? model->GetDequantizeUv()             : Vector4(1.0f, 1.0f, 0.0f, 0.0f);
+    }
+
+    bool Renderer::UpdateLightBuffer(const Light* light)
+    {
+        if (!light)
+            return false;
+
+        // Use the properties which were captured at the start of the frame
+        const auto it = m_lights_frame.find(light);
+        if (it == m_lights_frame.end())
+            return false;
+        m_buffer_light_cpu = it->second;
+
+        // Only update if needed
+        if (m_buffer_light_cpu == m_buffer_light_cpu_previous)
+            return true;
+
+        // Map
+        BufferLight* buffer = static_cast<BufferLight*>(m_buffer_light_gpu->Map());
         if (!buffer)
         {
             LOG_ERROR("Failed to map buffer");
@@ -424,121 +559,542 @@ namespace Spartan
         }
 
         // Update
-        *buffer = m_buffer_object_cpu;
-        m_buffer_object_cpu_previous = m_buffer_object_cpu;
+        *buffer = m_buffer_light_cpu;
+        m_buffer_light_cpu_previous = m_buffer_light_cpu;
 
         // Unmap
-        return m_buffer_object_gpu->Unmap();
+        return m_buffer_light_gpu->Unmap();
     }
 
-    bool Renderer::UpdateLightBuffer(const Light* light)
+    bool Renderer::UpdateClusterBuffers()
     {
-        if (!light)
-            return false;
+        m_lights_clustered.clear();
+        BufferClusterLights& lights = m_buffer_cluster_lights_cpu;
 
-        // Only update if needed
-        if (m_buffer_light_cpu == m_buffer_light_cpu_previous)
-            return true;
+        // Lights with shadow maps (or contact shadows) need a pass of their own, the rest can be clustered.
+        // If there are more than the buffer can hold, the remaining ones are shaded per light, like before.
+        // The properties are the ones captured at the start of the frame, see RenderablesPublish().
+        for (const Renderer_Object_Type type : { Renderer_Object_LightPoint, Renderer_Object_LightSpot })
+        {
+            for (Entity* entity : m_entities[type])
+            {
+                const Light* light  = entity->GetComponent<Light>();
+                const auto it       = m_lights_frame.find(light);
+                if (it == m_lights_frame.end())
+                    continue;
+
+                // y: shadows, z: contact shadows (already masked by the option)
+                const BufferLight& params = it->second;
+                if (params.normalBias_shadow_volumetric_contact.y != 0.0f || params.normalBias_shadow_volumetric_contact.z != 0.0f)
+                    continue;
+
+                if (m_lights_clustered.size() == cluster_light_max)
+                    break;
+
+                const uint32_t i            = static_cast<uint32_t>(m_lights_clustered.size());
+                const bool is_spot          = type == Renderer_Object_LightSpot;
+                lights.position_range[i]    = Vector4(params.position.x, params.position.y, params.position.z, params.intensity_range_angle_bias.y);
+                lights.color_intensity[i]   = Vector4(params.color.x, params.color.y, params.color.z, params.intensity_range_angle_bias.x);
+                lights.direction_angle[i]   = is_spot ? Vector4(params.direction.x, params.direction.y, params.direction.z, params.intensity_range_angle_bias.z) : Vector4::Zero;
+                m_lights_clustered.emplace_back(light);
+            }
+        }
+
+        // Exponential depth slices, so that clusters are roughly cubic
+        const float near_plane      = m_camera->GetNearPlane();
+        const float far_plane       = m_camera->GetFarPlane();
+        const float slice_scale     = static_cast<float>(cluster_count_z) / log(far_plane / near_plane);
+        const float slice_bias      = log(near_plane) * slice_scale;
+        const auto slice            = [slice_scale, slice_bias, near_plane](const float z) { return static_cast<uint32_t>(Clamp(log(Max(z, near_plane)) * slice_scale - slice_bias, 0.0f, static_cast<float>(cluster_count_z - 1))); };
+        const auto tile             = [](const float uv, const uint32_t count) { return static_cast<uint32_t>(Clamp(uv * count, 0.0f, static_cast<float>(count - 1))); };
+        lights.params               = Vector4(slice_scale, slice_bias, static_cast<float>(m_lights_clustered.size()), 0.0f);
+
+        // Compute the cluster range that each light's bounding sphere touches, and count the lights per cluster
+        struct ClusterRange { uint32_t x_min, x_max, y_min, y_max, z_min, z_max; };
+        static vector<ClusterRange> ranges;
+        static vector<uint32_t> cluster_light_count;
+        ranges.assign(m_lights_clustered.size(), ClusterRange{ 1, 0, 1, 0, 1, 0 });
+        cluster_light_count.assign(cluster_count, 0);
+
+        const Matrix& view          = m_camera->GetViewMatrix();
+        const Matrix& projection    = m_camera->GetProjectionMatrix();
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_lights_clustered.size()); i++)
+        {
+            const Vector3 center    = Vector3(lights.position_range[i].x, lights.position_range[i].y, lights.position_range[i].z) * view;
+            const float radius      = lights.position_range[i].w;
+            if (center.z + radius <= near_plane || center.z - radius >= far_plane)
+                continue;
+
+            ClusterRange& range = ranges[i];
+            range.z_min         = slice(center.z - radius);
+            range.z_max         = slice(center.z + radius);
+
+            // Project the corners of the sphere's bounding box, if it crosses the near plane, it can cover the whole screen
+            range.x_min = 0; range.x_max = cluster_count_x - 1;
+            range.y_min = 0; range.y_max = cluster_count_y - 1;
+            if (center.z - radius > near_plane)
+            {
+                Vector2 uv_min = Vector2(numeric_limits<float>::max());
+                Vector2 uv_max = Vector2(numeric_limits<float>::lowest());
+                for (uint32_t corner = 0; corner < 8; corner++)
+                {
+                    const Vector3 offset    = Vector3((corner & 1) ? radius : -radius, (corner & 2) ? radius : -radius, (corner & 4) ? radius : -radius);
+                    const Vector3 ndc       = (center + offset) * projection;
+                    const Vector2 uv        = Vector2(ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f);
+                    uv_min                  = Vector2(Min(uv_min.x, uv.x), Min(uv_min.y, uv.y));
+                    uv_max                  = Vector2(Max(uv_max.x, uv.x), Max(uv_max.y, uv.y));
+                }
+
+                if (uv_max.x < 0.0f || uv_max.y < 0.0f || uv_min.x > 1.0f || uv_min.y > 1.0f)
+                {
+                    range = ClusterRange{ 1, 0, 1, 0, 1, 0 };
+                    continue;
+                }
+
+                range.x_min = tile(uv_min.x, cluster_count_x); range.x_max = tile(uv_max.x, cluster_count_x);
+                range.y_min = tile(uv_min.y, cluster_count_y); range.y_max = tile(uv_max.y, cluster_count_y);
+            }
+
+            for (uint32_t z = range.z_min; z <= range.z_max; z++)
+                for (uint32_t y = range.y_min; y <= range.y_max; y++)
+                    for (uint32_t x = range.x_min; x <= range.x_max; x++)
+                    {
+                        cluster_light_count[x + y * cluster_count_x + z * cluster_count_x * cluster_count_y]++;
+                    }
+        }
 
         // Map
-        BufferLight* buffer = static_cast<BufferLight*>(m_buffer_light_gpu->Map());
+        BufferClusterGrid* grid         = static_cast<BufferClusterGrid*>(m_buffer_cluster_grid_gpu->Map());
+        BufferClusterIndices* indices   = grid ? static_cast<BufferClusterIndices*>(m_buffer_cluster_indices_gpu->Map()) : nullptr;
+        BufferClusterLights* buffer     = indices ? static_cast<BufferClusterLights*>(m_buffer_cluster_lights_gpu->Map()) : nullptr;
         if (!buffer)
         {
             LOG_ERROR("Failed to map buffer");
             return false;
         }
 
-        const bool volumetric         = static_cast<float>(m_options & Render_VolumetricLighting);
-        const bool contact_shadows    = static_cast<float>(m_options & Render_ScreenSpaceShadows);
+        // Give each cluster its slice of the index list (clusters which don't fit get no lights), then fill it
+        static uint32_t cluster_light_index[cluster_count];
+        static uint16_t light_indices[cluster_light_index_max];
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < cluster_count; i++)
+        {
+            const uint32_t count    = offset + cluster_light_count[i] <= cluster_light_index_max ? cluster_light_count[i] : 0;
+            grid->clusters[i]       = offset | (count << 16);
+            cluster_light_index[i]  = offset;
+            cluster_light_count[i]  = count;
+            offset                  += count;
+        }
+
+        for (uint32_t i = 0; i < static_cast<uint32_t>(ranges.size()); i++)
+        {
+            const ClusterRange& range = ranges[i];
+            for (uint32_t z = range.z_min; z <= range.z_max; z++)
+                for (uint32_t y = range.y_min; y <= range.y_max; y++)
+                    for (uint32_t x = range.x_min; x <= range.x_max; x++)
+                    {
+                        const uint32_t cluster = x + y * cluster_count_x + z * cluster_count_x * cluster_count_y;
+                        if (cluster_light_count[cluster] != 0)
+                        {
+                            light_indices[cluster_light_index[cluster]++] = static_cast<uint16_t>(i);
+                        }
+                    }
+        }
 
-        for (uint32_t i = 0; i < light->GetShadowArraySize(); i++) { m_buffer_light_cpu.view_projection[i] = light->GetViewMatrix(i) * light->GetProjectionMatrix(i); }
-        m_buffer_light_cpu.intensity_range_angle_bias               = Vector4(light->GetIntensity(), light->GetRange(), light->GetAngle(), GetOption(Render_ReverseZ) ? light->GetBias() : -light->GetBias());
-        m_buffer_light_cpu.normalBias_shadow_volumetric_contact     = Vector4(light->GetNormalBias(), light->GetShadowsEnabled(), contact_shadows && light->GetShadowsScreenSpaceEnabled(), volumetric && light->GetVolumetricEnabled());
-        m_buffer_light_cpu.color                                    = light->GetColor(); m_buffer_light_cpu.color.w = light->GetShadowsTransparentEnabled() ? 1.0f : 0.0f;
-        m_buffer_light_cpu.position                                 = light->GetTransform()->GetPosition();
-        m_buffer_light_cpu.direction                                = light->GetDirection();
+        for (uint32_t i = 0; i < (offset + 1) / 2; i++)
+        {
+            const uint32_t high = 2 * i + 1 < offset ? light_indices[2 * i + 1] : 0;
+            indices->indices[i] = light_indices[2 * i] | (high << 16);
+        }
 
         // Update
-        *buffer = m_buffer_light_cpu;
-        m_buffer_light_cpu_previous = m_buffer_light_cpu;
+        *buffer = lights;
+        sort(m_lights_clustered.begin(), m_lights_clustered.end());
 
         // Unmap
-        return m_buffer_light_gpu->Unmap();
+        return m_buffer_cluster_grid_gpu->Unmap() && m_buffer_cluster_indices_gpu->Unmap() && m_buffer_cluster_lights_gpu->Unmap();
+    }
+
+    bool Renderer::IsLightClustered(const Light* light) const
+    {
+        return binary_search(m_lights_clustered.begin(), m_lights_clustered.end(), light);
+    }
+
+    bool Renderer::UpdateMaterialBuffer()
+    {
+        if (!m_rhi_device->GetContextRhi()->bindless_textures)
+            return true;
+
+        // Texture slot order, must match Common_Texture.hlsl
+        static const TextureType texture_types[material_texture_slots] =
+        {
+            TextureType_Albedo, TextureType_Roughness, TextureType_Metallic, TextureType_Normal,
+            TextureType_Height, TextureType_Occlusion, TextureType_Emission, TextureType_Mask
+        };
+
+        BufferMaterial& buffer = m_buffer_material_cpu;
+
+        // Index 0 of the material buffer and of the texture table is a white default, for materials that don't fit
+        buffer.albedo[0]        = Vector4::One;
+        buffer.tiling_offset[0] = Vector4(1.0f, 1.0f, 0.0f, 0.0f);
+        buffer.properties[0]    = Vector4(1.0f, 0.0f, 0.0f, 0.0f);
+        memset(buffer.textures[0], 0, sizeof(buffer.textures[0]));
+
+        // Indices persist across frames, so the texture table (and the descriptor set which holds it) only changes when materials do.
+        // If something doesn't fit, start over once, which drops the indices of materials and textures that are gone.
+        bool fits = true;
+        for (const bool start_over : { false, true })
+        {
+            if (start_over)
+            {
+                if (fits)
+                    break;
+
+                m_material_indices.clear();
+                m_material_texture_indices.clear();
+                fits = true;
+            }
+
+            m_material_textures.assign(material_texture_table_size, m_tex_white.get());
+
+            for (const Renderer_Object_Type type : { Renderer_Object_Opaque, Renderer_Object_Transparent })
+            {
+                for (Entity* entity : m_entities[type])
+                {
+                    Renderable* renderable  = entity->GetRenderable();
+                    Material* material      = renderable ? renderable->GetMaterial().get() : nullptr;
+                    if (!material)
+                        continue;
+
+                    // Material index
+                    auto it_material = m_material_indices.find(material->GetId());
+                    if (it_material == m_material_indices.end())
+                    {
+                        const uint32_t index = static_cast<uint32_t>(m_material_indices.size()) + 1;
+                        if (index >= material_max)
+                        {
+                            fits = false;
+                            continue;
+                        }
+
+                        it_material = m_material_indices.emplace(material->GetId(), index).first;
+                    }
+                    const uint32_t index = it_material->second;
+
+                    // Texture indices
+                    memset(buffer.textures[index], 0, sizeof(buffer.textures[index]));
+                    for (uint32_t slot = 0; slot < material_texture_slots; slot++)
+                    {
+                        if (!material->HasTexture(texture_types[slot]))
+                            continue;
+
+                        RHI_Texture* texture = material->GetTexture_PtrRaw(texture_types[slot]);
+                        auto it_texture = m_material_texture_indices.find(texture->GetId());
+                        if (it_texture == m_material_texture_indices.end())
+                        {
+                            const uint32_t texture_index = static_cast<uint32_t>(m_material_texture_indices.size()) + 1;
+                            if (texture_index >= material_texture_table_size)
+                            {
+                                fits = false;
+                                continue;
+                            }
+
+                            it_texture = m_material_texture_indices.emplace(texture->GetId(), texture_index).first;
+                        }
+
+                        m_material_textures[it_texture->second] = texture;
+                        buffer.textures[index][slot / 2] |= it_texture->second << ((slot % 2) * 16);
+                    }
+
+                    // Properties
+                    buffer.albedo[index]        = material->GetColorAlbedo();
+                    buffer.tiling_offset[index] = Vector4(material->GetTiling().x, material->GetTiling().y, material->GetOffset().x, material->GetOffset().y);
+                    buffer.properties[index]    = Vector4
+                    (
+                        material->GetMultiplier(TextureType_Roughness),
+                        material->GetMultiplier(TextureType_Metallic),
+                        material->GetMultiplier(TextureType_Normal),
+                        material->GetMultiplier(TextureType_Height)
+                    );
+                }
+            }
+        }
+
+        if (!fits && !m_material_buffer_full)
+        {
+            LOG_WARNING("More than %d materials or %d textures, the rest will use a default material", material_max - 1, material_texture_table_size - 1);
+        }
+        m_material_buffer_full = !fits;
+
+        // Only update if needed
+        if (memcmp(&buffer, &m_buffer_material_cpu_previous, sizeof(BufferMaterial)) == 0)
+            return true;
+
+        // Map
+        BufferMaterial* buffer_gpu = static_cast<BufferMaterial*>(m_buffer_material_gpu->Map());
+        if (!buffer_gpu)
+        {
+            LOG_ERROR("Failed to map buffer");
+            return false;
+        }
+
+        // Update
+        *buffer_gpu = buffer;
+        m_buffer_material_cpu_previous = buffer;
+
+        // Unmap
+        return m_buffer_material_gpu->Unmap();
     }
 
-	void Renderer::RenderablesAcquire(const Variant& entities_variant)
+	void Renderer::RenderablesAcquire(const Variant& delta_variant)
 	{
         SCOPED_TIME_BLOCK(m_profiler);
 
-		// Clear previous state
-		m_entities.clear();
-		m_camera = nullptr;
+        const WorldDelta* delta = delta_variant.Get<const WorldDelta*>();
+        if (!delta)
+            return;
 
-		vector<shared_ptr<Entity>> entities = entities_variant.Get<vector<shared_ptr<Entity>>>();
-		for (const auto& entity : entities)
-		{
+        lock_guard<mutex> lock(m_mutex_snapshot);
+        RenderablesApply(m_snapshot_pending, *delta);
+
+        // Keep a copy for the other side of the snapshot, a full delta makes everything before it irrelevant
+        if (delta->full)
+        {
+            m_snapshot_pending.replay.clear();
+        }
+        m_snapshot_pending.replay.emplace_back(*delta);
+        m_snapshot_pending.dirty = true;
+	}
+
+	void Renderer::RenderablesApply(Snapshot& snapshot, const WorldDelta& delta)
+	{
+		// Clear previous state (if the world asks for it)
+        if (delta.full)
+        {
+            snapshot.entities.clear();
+            snapshot.entities_owned.clear();
+            snapshot.entity_buckets.clear();
+            snapshot.camera = nullptr;
+        }
+
+        // Drop entities which were removed or changed (changed ones are re-acquired below), only the buckets they are in are touched
+        if (!delta.removed.empty() || !delta.changed.empty())
+        {
+            unordered_map<Renderer_Object_Type, unordered_set<const Entity*>> entities_stale;
+            auto mark_stale = [&snapshot, &entities_stale](const Entity* entity)
+            {
+                const auto it = snapshot.entity_buckets.find(entity);
+                if (it == snapshot.entity_buckets.end())
+                    return;
+
+                for (uint32_t type = 0; type <= Renderer_Object_Camera; type++)
+                {
+                    if (it->second & (1 << type))
+                    {
+                        entities_stale[static_cast<Renderer_Object_Type>(type)].emplace(entity);
+                    }
+                }
+
+                snapshot.entity_buckets.erase(it);
+                snapshot.entities_owned.erase(entity);
+
+                if (snapshot.camera && snapshot.camera->GetEntity() == entity)
+                {
+                    snapshot.camera = nullptr;
+                }
+            };
+
+            for (const auto& entity : delta.removed) { mark_stale(entity.get()); }
+            for (const auto& entity : delta.changed) { mark_stale(entity.get()); }
+
+            for (const auto& it : entities_stale)
+            {
+                const auto& stale   = it.second;
+                auto& entities      = snapshot.entities[it.first];
+                entities.erase(remove_if(entities.begin(), entities.end(), [&stale](const Entity* entity) { return stale.count(entity) != 0; }), entities.end());
+            }
+        }
+
+        // Renderables are appended, RenderablesPublish() puts them in order
+        auto acquire = [&snapshot](const shared_ptr<Entity>& entity)
+        {
 			if (!entity || !entity->IsActive())
-				continue;
+				return;
 
 			// Get all the components we are interested in
             const auto renderable = entity->GetComponent<Renderable>();
             const auto light      = entity->GetComponent<Light>();
 			auto camera		= entity->GetComponent<Camera>();
 
+            uint32_t& buckets = snapshot.entity_buckets[entity.get()];
+            auto add = [&snapshot, &buckets, &entity](const Renderer_Object_Type type)
+            {
+                snapshot.entities[type].emplace_back(entity.get());
+                buckets |= 1 << type;
+            };
+
 			if (renderable)
 			{
 				const auto is_transparent = !renderable->HasMaterial() ? false : renderable->GetMaterial()->GetColorAlbedo().w < 1.0f;
-                m_entities[is_transparent ? Renderer_Object_Transparent : Renderer_Object_Opaque].emplace_back(entity.get());
+                add(is_transparent ? Renderer_Object_Transparent : Renderer_Object_Opaque);
 			}
 
 			if (light)
 			{
-				m_entities[Renderer_Object_Light].emplace_back(entity.get());
+				add(Renderer_Object_Light);
 
-                if (light->GetLightType() == LightType_Directional) m_entities[Renderer_Object_LightDirectional].emplace_back(entity.get());
-                if (light->GetLightType() == LightType_Point)       m_entities[Renderer_Object_LightPoint].emplace_back(entity.get());
-                if (light->GetLightType() == LightType_Spot)        m_entities[Renderer_Object_LightSpot].emplace_back(entity.get());
+                if (light->GetLightType() == LightType_Directional) add(Renderer_Object_LightDirectional);
+                if (light->GetLightType() == LightType_Point)       add(Renderer_Object_LightPoint);
+                if (light->GetLightType() == LightType_Spot)        add(Renderer_Object_LightSpot);
 			}
 
 			if (camera)
 			{
-				m_entities[Renderer_Object_Camera].emplace_back(entity.get());
-				m_camera = camera->GetPtrShared<Camera>();
+				add(Renderer_Object_Camera);
+				snapshot.camera = camera->GetPtrShared<Camera>();
 			}
-		}
 
-		RenderablesSort(&m_entities[Renderer_Object_Opaque]);
-		RenderablesSort(&m_entities[Renderer_Object_Transparent]);
+            if (renderable || light || camera)
+            {
+                snapshot.entities_owned[entity.get()] = entity;
+            }
+            else
+            {
+                snapshot.entity_buckets.erase(entity.get());
+            }
+        };
+
+        for (const auto& entity : delta.added)     { acquire(entity); }
+        for (const auto& entity : delta.changed)   { acquire(entity); }
+
+        // Fall back to any remaining camera, in case the current one was removed
+        if (!snapshot.camera && !snapshot.entities[Renderer_Object_Camera].empty())
+        {
+            snapshot.camera = snapshot.entities[Renderer_Object_Camera].back()->GetComponent<Camera>()->GetPtrShared<Camera>();
+        }
 	}
 
-	void Renderer::RenderablesSort(vector<Entity*>* renderables)
-	{
-		if (!m_camera || renderables->size() <= 2)
-			return;
+    void Renderer::RenderablesPublish()
+    {
+        {
+            lock_guard<mutex> lock(m_mutex_snapshot);
 
-		auto render_hash = [this](Entity* entity)
-		{
-			// Get renderable
-			auto renderable = entity->GetRenderable();
-			if (!renderable)
-				return 0.0f;
+            if (m_snapshot_pending.dirty)
+            {
+                // Swap instead of copying, then bring the pending side (which is now the previously published one) up to date
+                m_entities.swap(m_snapshot_pending.entities);
+                m_entities_owned.swap(m_snapshot_pending.entities_owned);
+                m_entity_buckets.swap(m_snapshot_pending.entity_buckets);
+                m_camera.swap(m_snapshot_pending.camera);
+
+                vector<WorldDelta> replay;
+                replay.swap(m_snapshot_pending.replay);
+                for (const WorldDelta& delta : replay)
+                {
+                    RenderablesApply(m_snapshot_pending, delta);
+                }
 
-			// Get material
-			const auto material = renderable->GetMaterial();
-			if (!material)
-				return 0.0f;
+                m_snapshot_pending.dirty    = false;
+                m_renderables_sorted        = false;
+            }
+        }
+
+        // The order is front to back from where the keys were computed, so it's redone when renderables were added
+        // or the camera has moved far enough for it to degrade. The keys are never compared against ones from another position.
+        if (m_camera)
+        {
+            const Vector3 camera_position = m_camera->GetTransform()->GetPosition();
+            if (!m_renderables_sorted || (camera_position - m_renderables_sort_position).LengthSquared() > renderables_sort_distance * renderables_sort_distance)
+            {
+                RenderablesSort(&m_entities[Renderer_Object_Opaque], camera_position);
+                RenderablesSort(&m_entities[Renderer_Object_Transparent], camera_position);
+                m_renderables_sort_position = camera_position;
+                m_renderables_sorted        = true;
+            }
+        }
 
-			const auto num_depth    = (renderable->GetAabb().GetCenter() - m_camera->GetTransform()->GetPosition()).LengthSquared();
-			const auto num_material = static_cast<float>(material->GetId());
+        // Transforms and light properties change without the world resolving, so they are copied every frame
+        for (const Renderer_Object_Type type : { Renderer_Object_Opaque, Renderer_Object_Transparent })
+        {
+            const vector<Entity*>& entities = m_entities[type];
+            vector<EntityFrame>& frames     = m_entities_frame[type];
+            frames.resize(entities.size());
 
-			return stof(to_string(num_depth) + "-" + to_string(num_material));
-		};
+            for (size_t i = 0; i < entities.size(); i++)
+            {
+                Renderable* renderable  = entities[i]->GetRenderable();
+                Transform* transform    = entities[i]->GetTransform();
 
-		// Sort by depth (front to back), then sort by material		
-		sort(renderables->begin(), renderables->end(), [&render_hash](Entity* a, Entity* b)
+                frames[i].transform     = transform ? transform->GetMatrix() : Matrix::Identity;
+                frames[i].material_id   = renderable && renderable->GetMaterial() ? renderable->GetMaterial()->GetId() : 0;
+            }
+        }
+
+        const bool volumetric       = m_options & Render_VolumetricLighting;
+        const bool contact_shadows  = m_options & Render_ScreenSpaceShadows;
+        m_lights_frame.clear();
+        for (Entity* entity : m_entities[Renderer_Object_Light])
+        {
+            const Light* light = entity->GetComponent<Light>();
+            if (!light)
+                continue;
+
+            BufferLight& params = m_lights_frame[light];
+            for (uint32_t i = 0; i < light->GetShadowArraySize(); i++) { params.view_projection[i] = light->GetViewMatrix(i) * light->GetProjectionMatrix(i); }
+            params.intensity_range_angle_bias               = Vector4(light->GetIntensity(), light->GetRange(), light->GetAngle(), GetOption(Render_ReverseZ) ? light->GetBias() : -light->GetBias());
+            params.normalBias_shadow_volumetric_contact     = Vector4(light->GetNormalBias(), light->GetShadowsEnabled(), contact_shadows && light->GetShadowsScreenSpaceEnabled(), volumetric && light->GetVolumetricEnabled());
+            params.color                                    = light->GetColor(); params.color.w = light->GetShadowsTransparentEnabled() ? 1.0f : 0.0f;
+            params.position                                 = light->GetTransform()->GetPosition();
+            params.direction                                = light->GetDirection();
+        }
+    }
+
+    void Renderer::ClearEntities()
+    {
+        lock_guard<mutex> lock(m_mutex_snapshot);
+
+        m_snapshot_pending.entities.clear();
+        m_snapshot_pending.entities_owned.clear();
+        m_snapshot_pending.entity_buckets.clear();
+        m_snapshot_pending.camera   = nullptr;
+        m_snapshot_pending.dirty    = true;
+
+        // Make the published side empty itself as well
+        m_snapshot_pending.replay.clear();
+        m_snapshot_pending.replay.emplace_back();
+        m_snapshot_pending.replay.back().full = true;
+    }
+
+	void Renderer::RenderablesSort(vector<Entity*>* renderables, const Vector3& camera_position)
+	{
+        // Front to back, then by material, packed so that two keys compare as integers (positive floats order like their bits)
+		auto sort_key = [&camera_position](const Entity* entity)
 		{
-            return render_hash(a) < render_hash(b);
-		});
+			Renderable* renderable = entity->GetRenderable();
+			if (!renderable || !renderable->GetMaterial())
+				return uint64_t(0);
+
+			const float depth = (renderable->GetAabb().GetCenter() - camera_position).LengthSquared();
+            uint32_t depth_bits;
+            memcpy(&depth_bits, &depth, sizeof(depth));
+
+			return (static_cast<uint64_t>(depth_bits) << 32) | renderable->GetMaterial()->GetId();
+		};
+
+        // Compute the keys once, instead of twice per comparison
+        static vector<pair<uint64_t, Entity*>> renderables_keyed;
+        renderables_keyed.clear();
+        for (Entity* entity : *renderables)
+        {
+            renderables_keyed.emplace_back(sort_key(entity), entity);
+        }
+
+        sort(renderables_keyed.begin(), renderables_keyed.end(), [](const pair<uint64_t, Entity*>& a, const pair<uint64_t, Entity*>& b) { return a.first < b.first; });
+
+        for (size_t i = 0; i < renderables_keyed.size(); i++)
+        {
+            (*renderables)[i] = renderables_keyed[i].second;
+        }
 	}
 
     const shared_ptr<Spartan::RHI_Texture>& Renderer::GetEnvironmentTexture()
@@ -580,6 +1136,18 @@ namespace Spartan
         {
             value = Clamp(value, static_cast<float>(m_resolution_shadow_min), static_cast<float>(m_rhi_device->GetContextRhi()->max_texture_dimension_2d));
         }
+        else if (option == Option_Value_DynamicResolution_ScaleMin)
+        {
+            value = Clamp(value, 0.25f, 1.0f);
+        }
+        else if (option == Option_Value_DynamicResolution_TargetMs)
+        {
+            value = Max(value, 1.0f);
+        }
+        else if (option == Option_Value_Ssao_Quality || option == Option_Value_Ssr_Quality || option == Option_Value_VolumetricLighting_Quality)
+        {
+            value = Clamp(Round(value), static_cast<float>(Renderer_Effect_Quality_Full), static_cast<float>(Renderer_Effect_Quality_Quarter));
+        }
 
         if (m_option_values[option] == value)
             return;
@@ -599,6 +1167,12 @@ namespace Spartan
                 }
             }
         }
+
+        // Effect quality handling
+        if (option == Option_Value_Ssao_Quality || option == Option_Value_Ssr_Quality || option == Option_Value_VolumetricLighting_Quality)
+        {
+            CreateRenderTextures();
+        }
     }
 
     uint32_t Renderer::GetMaxResolution() const
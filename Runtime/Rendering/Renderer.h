@@ -23,6 +23,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ========================
 #include <unordered_map>
+#include <unordered_set>
+#include <mutex>
 #include "../Core/ISubsystem.h"
 #include "../RHI/RHI_Definition.h"
 #include "../RHI/RHI_Viewport.h"
@@ -34,14 +36,17 @@ namespace Spartan
 {
     // Forward declarations
 	class Entity;
+	class Model;
 	class Camera;
 	class Light;
 	class ResourceCache;
 	class Font;
 	class Variant;
+	struct WorldDelta;
 	class Grid;
 	class Transform_Gizmo;
 	class Profiler;
+    class RenderGraph;
 	namespace Math
 	{
 		class BoundingBox;
@@ -71,7 +76,8 @@ namespace Spartan
 		Render_ChromaticAberration	        = 1 << 18,
 		Render_Dithering			        = 1 << 19,
         Render_ReverseZ                     = 1 << 20,
-        Render_DepthPrepass                 = 1 << 21
+        Render_DepthPrepass                 = 1 << 21,
+        Render_DynamicResolution            = 1 << 22  // Scales the render resolution to hit Option_Value_DynamicResolution_TargetMs
 	};
 
     enum Renderer_Option_Value
@@ -84,7 +90,20 @@ namespace Spartan
         Option_Value_Bloom_Intensity,
         Option_Value_Sharpen_Strength,
         Option_Value_Sharpen_Clamp, // Limits maximum amount of sharpening a pixel receives - Algorithm's default: 0.035f
-        Option_Value_Motion_Blur_Intensity
+        Option_Value_Motion_Blur_Intensity,
+        Option_Value_DynamicResolution_TargetMs,    // GPU frame time to aim for
+        Option_Value_DynamicResolution_ScaleMin,    // Lowest fraction of the resolution to render at
+        Option_Value_Ssao_Quality,                  // Renderer_Effect_Quality
+        Option_Value_Ssr_Quality,                   // Renderer_Effect_Quality
+        Option_Value_VolumetricLighting_Quality     // Renderer_Effect_Quality
+    };
+
+    // The resolution screen space effects run at, the lower ones are upsampled (depth aware) and accumulated over time
+    enum Renderer_Effect_Quality
+    {
+        Renderer_Effect_Quality_Full,
+        Renderer_Effect_Quality_Half,
+        Renderer_Effect_Quality_Quarter
     };
 
     enum Renderer_ToneMapping_Type
@@ -126,9 +145,12 @@ namespace Spartan
 	enum Renderer_Shader_Type
 	{
 		Shader_Gbuffer_V,
+		Shader_Gbuffer_Packed_V,
 		Shader_Depth_V,
+		Shader_Depth_Packed_V,
         Shader_Depth_P,
 		Shader_Quad_V,
+        Shader_Quad_Scaled_V,
 		Shader_Texture_P,
         Shader_Copy_C,
 		Shader_Fxaa_P,
@@ -154,6 +176,11 @@ namespace Spartan
         Shader_LightDirectional_P,
         Shader_LightPoint_P,
         Shader_LightSpot_P,
+        Shader_LightClustered_P,
+        Shader_LightDirectional_Volumetric_P,
+        Shader_LightPoint_Volumetric_P,
+        Shader_LightSpot_Volumetric_P,
+        Shader_TemporalAccumulate_P,
 		Shader_Composition_P,
 		Shader_Color_V,
         Shader_Color_P,
@@ -162,6 +189,7 @@ namespace Spartan
 		Shader_Ssao_P,
         Shader_Ssr_P,
 		Shader_Entity_V,
+		Shader_Entity_Packed_V,
         Shader_Entity_Transform_P,
 		Shader_BlurBox_P,
 		Shader_BlurGaussian_P,
@@ -185,6 +213,8 @@ namespace Spartan
         RenderTarget_Light_Specular,
         // Volumetric light
         RenderTarget_Light_Volumetric,
+        RenderTarget_Light_Volumetric_2,
+        RenderTarget_Light_Volumetric_History,
         // Composition
         RenderTarget_Composition_Hdr,
         RenderTarget_Composition_Hdr_2,
@@ -193,6 +223,7 @@ namespace Spartan
         // SSAO
         RenderTarget_Ssao_Noisy,
         RenderTarget_Ssao,
+        RenderTarget_Ssao_History,
         // SSR
         RenderTarget_Ssr,
         // Frame
@@ -223,6 +254,10 @@ namespace Spartan
         const auto& GetResolution() const { return m_resolution; }
         void SetResolution(uint32_t width, uint32_t height);
 
+        // Render resolution, the part of the render targets the scene is rendered at (smaller than the resolution when dynamic resolution kicks in)
+        const auto& GetResolutionRender() const { return m_resolution_render; }
+        auto GetResolutionScale() const         { return m_resolution_scale; }
+
 		// Editor
 		float m_gizmo_transform_size    = 0.015f;
 		float m_gizmo_transform_speed   = 12.0f;
@@ -262,7 +297,6 @@ namespace Spartan
         const auto& GetCamera()                     const { return m_camera; }
         auto IsInitialized()                        const { return m_initialized; }
         auto& GetShaders()                          const { return m_shaders; }
-        auto IsRendering()                          const { return m_is_rendering; }
         uint32_t GetMaxResolution() const;
 
         // Globals
@@ -281,15 +315,21 @@ namespace Spartan
 		void CreateShaders();
 		void CreateSamplers();
 		void CreateRenderTextures();
+		void CreateRenderTexturesTransient();
 
 		// Passes
 		void Pass_Main(RHI_CommandList* cmd_list);
 		void Pass_LightDepth(RHI_CommandList* cmd_list, const Renderer_Object_Type object_type);
         void Pass_DepthPrePass(RHI_CommandList* cmd_list);
 		void Pass_GBuffer(RHI_CommandList* cmd_list, const Renderer_Object_Type object_type);
+        void SetPipelineState_GBuffer(RHI_PipelineState& pso, const bool is_transparent);
+        RHI_Viewport GetViewportScaled(const RHI_Texture* texture) const;
+        void PrecompilePipelines();
 		void Pass_Ssao(RHI_CommandList* cmd_list, const bool use_stencil);
         void Pass_Ssr(RHI_CommandList* cmd_list, const bool use_stencil);
         void Pass_Light(RHI_CommandList* cmd_list, const bool use_stencil);
+        void Pass_LightVolumetric(RHI_CommandList* cmd_list, const bool use_stencil);
+        void Pass_TemporalAccumulate(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out, std::shared_ptr<RHI_Texture>& tex_history);
 		void Pass_Composition(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_out, const bool use_stencil);
         void Pass_AlphaBlend(RHI_CommandList* cmd_list, RHI_Texture* tex_in, RHI_Texture* tex_out, const bool use_stencil);
 		void Pass_PostProcess(RHI_CommandList* cmd_list);
@@ -304,6 +344,7 @@ namespace Spartan
 		void Pass_Dithering(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
 		void Pass_Bloom(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
         void Pass_Upsample(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
+        void Pass_Upscale(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out);
         void Pass_Downsample(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out, const Renderer_Shader_Type pixel_shader);
 		void Pass_BlurBox(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out, const float sigma, const float pixel_stride, const bool use_stencil);
 		void Pass_BlurGaussian(RHI_CommandList* cmd_list, std::shared_ptr<RHI_Texture>& tex_in, std::shared_ptr<RHI_Texture>& tex_out, const float sigma, const float pixel_stride = 1.0f);
@@ -319,17 +360,29 @@ namespace Spartan
         // Constant buffers
         bool UpdateFrameBuffer();
         bool UpdateUberBuffer();
-        bool UpdateObjectBuffer(RHI_CommandList* cmd_list, const uint32_t entity_index = 0);
+        bool UpdateObjectBuffer(RHI_CommandList* cmd_list);
+        uint32_t AllocateObjectBuffer(const uint32_t count);
+        void BindObjectBuffer(RHI_CommandList* cmd_list, const uint32_t offset_index);
+        static void SetObjectDequantization(BufferObject& buffer, const Model* model);
         bool UpdateLightBuffer(const Light* light);
+        bool UpdateClusterBuffers();
+        bool IsLightClustered(const Light* light) const;
+        bool UpdateMaterialBuffer();
 
         // Misc
-        void RenderablesAcquire(const Variant& renderables);
-        void RenderablesSort(std::vector<Entity*>* renderables);
-        void ClearEntities() { m_entities.clear(); }
+        void UpdateDynamicResolution();
+        struct Snapshot;
+        void RenderablesAcquire(const Variant& delta_variant);
+        void RenderablesApply(Snapshot& snapshot, const WorldDelta& delta);
+        void RenderablesSort(std::vector<Entity*>* renderables, const Math::Vector3& camera_position);
+        void RenderablesPublish();
+        void ClearEntities();
+        void RenderGraphBuild(RHI_CommandList* cmd_list);
 
         // Render textures
         std::unordered_map<Renderer_RenderTarget_Type, std::shared_ptr<RHI_Texture>> m_render_targets;
         std::vector<std::shared_ptr<RHI_Texture>> m_render_tex_bloom;
+        std::unique_ptr<RenderGraph> m_render_graph;
 
         // Standard textures
         std::shared_ptr<RHI_Texture> m_tex_noise_normal;
@@ -385,6 +438,10 @@ namespace Spartan
 		Math::Vector2 m_resolution	= Math::Vector2(1920, 1080);
 		RHI_Viewport m_viewport		= RHI_Viewport(0, 0, 1920, 1080);
 
+        // Dynamic resolution
+        Math::Vector2 m_resolution_render   = Math::Vector2(1920, 1080);
+        float m_resolution_scale            = 1.0f;
+
         // Options
         uint64_t m_options = 0;
         std::unordered_map<Renderer_Option_Value, float> m_option_values;
@@ -401,7 +458,6 @@ namespace Spartan
         float m_far_plane                       = 0.0f;
         uint64_t m_frame_num                    = 0;
         bool m_is_odd_frame                     = false;
-        bool m_is_rendering                     = false;
         bool m_brdf_specular_lut_rendered       = false;      
         const float m_gizmo_size_max            = 5.0f;
         const float m_gizmo_size_min            = 0.1f;
@@ -414,18 +470,69 @@ namespace Spartan
         BufferUber m_buffer_uber_cpu_previous;
         std::shared_ptr<RHI_ConstantBuffer> m_buffer_uber_gpu;
 
+        // Per draw constants, a ring which is written in order and bound by offset (grows between frames if a frame needs more)
         BufferObject m_buffer_object_cpu;
         BufferObject m_buffer_object_cpu_previous;
         std::shared_ptr<RHI_ConstantBuffer> m_buffer_object_gpu;
+        uint32_t m_buffer_object_ring_index         = 0;
+        uint32_t m_buffer_object_ring_end           = 0; // end of this frame's region
+        uint32_t m_buffer_object_ring_used          = 0; // this frame
+        bool m_buffer_object_ring_full              = false;
+        uint32_t m_buffer_object_offset_previous    = 0; // the element that holds m_buffer_object_cpu_previous
+        std::vector<uint32_t> m_buffer_object_offsets;   // per entity, written by the G-Buffer pass
 
         BufferLight m_buffer_light_cpu;
         BufferLight m_buffer_light_cpu_previous;
         std::shared_ptr<RHI_ConstantBuffer> m_buffer_light_gpu;
+
+        BufferClusterLights m_buffer_cluster_lights_cpu;
+        std::shared_ptr<RHI_ConstantBuffer> m_buffer_cluster_lights_gpu;
+        std::shared_ptr<RHI_ConstantBuffer> m_buffer_cluster_grid_gpu;
+        std::shared_ptr<RHI_ConstantBuffer> m_buffer_cluster_indices_gpu;
+        std::vector<const Light*> m_lights_clustered; // sorted, the lights which are shaded by the clustered pass this frame
+
+        BufferMaterial m_buffer_material_cpu            = {};
+        BufferMaterial m_buffer_material_cpu_previous   = {};
+        std::shared_ptr<RHI_ConstantBuffer> m_buffer_material_gpu;
+        std::unordered_map<uint32_t, uint32_t> m_material_indices;          // material id to material buffer index
+        std::unordered_map<uint32_t, uint32_t> m_material_texture_indices;  // texture id to texture table index
+        std::vector<RHI_Texture*> m_material_textures;                      // the texture table, bound once per G-Buffer pass
+
+        // Pipeline precompilation
+        std::unordered_set<uint32_t> m_pipelines_precompiled;               // ids of the shader variations whose pipelines exist
+        std::size_t m_pipelines_precompiled_key = 0;
+        bool m_material_buffer_full = false;
         //======================================================
 
-        // Entities & Components
+        // Entities & Components (read by the passes, only updated at the start of Tick())
         std::unordered_map<Renderer_Object_Type, std::vector<Entity*>> m_entities;
+        std::unordered_map<const Entity*, std::shared_ptr<Entity>> m_entities_owned; // keeps rendered entities alive, even if the world unloads them meanwhile
+        std::unordered_map<const Entity*, uint32_t> m_entity_buckets;
         std::shared_ptr<Camera> m_camera;
+        Math::Vector3 m_renderables_sort_position;  // where the camera was when the renderables were last sorted
+        bool m_renderables_sorted = false;
+
+        // Per frame copy of the entity state the passes read, so that they don't read transforms, lights and materials live
+        struct EntityFrame
+        {
+            Math::Matrix transform;
+            uint32_t material_id = 0;
+        };
+        std::unordered_map<Renderer_Object_Type, std::vector<EntityFrame>> m_entities_frame; // parallel to m_entities, for opaque and transparent renderables
+        std::unordered_map<const Light*, BufferLight> m_lights_frame;
+
+        // Entities & Components (pending, written by world events which can come from a loading thread)
+        struct Snapshot
+        {
+            std::unordered_map<Renderer_Object_Type, std::vector<Entity*>> entities;
+            std::unordered_map<const Entity*, std::shared_ptr<Entity>> entities_owned;
+            std::unordered_map<const Entity*, uint32_t> entity_buckets; // the buckets an entity is in, one bit per Renderer_Object_Type
+            std::shared_ptr<Camera> camera;
+            std::vector<WorldDelta> replay; // deltas the published side hasn't seen, applied to it once it becomes the pending side again
+            bool dirty = false;
+        };
+        Snapshot m_snapshot_pending;
+        std::mutex m_mutex_snapshot;
 
         // RHI Core
         std::shared_ptr<RHI_Device> m_rhi_device;
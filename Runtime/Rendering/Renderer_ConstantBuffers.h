@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ===============
 #include "..\Math\Vector2.h"
 #include "..\Math\Vector3.h"
+#include "..\Math\Vector4.h"
 #include "..\Math\Matrix.h"
 //==========================
 
@@ -63,6 +64,9 @@ namespace Spartan
 
         Math::Vector2 taa_jitter_offset_previous;
         Math::Vector2 taa_jitter_offset;
+
+        Math::Vector2 resolution_scale;
+        Math::Vector2 padding;
     };
     
     // Medium frequency - Updates a few dozen times
@@ -113,13 +117,22 @@ namespace Spartan
         Math::Matrix object;
         Math::Matrix wvp_current;
         Math::Matrix wvp_previous;
+        Math::Vector4 dequantize_position_scale     = Math::Vector4::One;
+        Math::Vector4 dequantize_position_offset    = Math::Vector4::Zero;
+        Math::Vector4 dequantize_uv                 = Math::Vector4(1.0f, 1.0f, 0.0f, 0.0f); // xy: scale, zw: offset
+        uint32_t material_index                     = 0; // into the material buffer (bindless only)
+        Math::Vector3 padding                       = Math::Vector3::Zero;
     
         bool operator==(const BufferObject& rhs) const
         {
             return
-                object          == rhs.object       &&
-                wvp_current     == rhs.wvp_current  &&
-                wvp_previous    == rhs.wvp_previous;
+                object                      == rhs.object                       &&
+                wvp_current                 == rhs.wvp_current                  &&
+                wvp_previous                == rhs.wvp_previous                 &&
+                dequantize_position_scale   == rhs.dequantize_position_scale    &&
+                dequantize_position_offset  == rhs.dequantize_position_offset   &&
+                dequantize_uv               == rhs.dequantize_uv                &&
+                material_index              == rhs.material_index;
         }
     };
     
@@ -144,4 +157,50 @@ namespace Spartan
                 direction                               == rhs.direction;
         }
     };
+
+    // Clustered lighting - Updates once per frame
+    // Lights without shadow maps are binned into view space clusters (froxels), a grid of screen tiles
+    // with exponentially distributed depth slices, and are all shaded by a single full-screen pass.
+    // The sizes must match Common_Buffer.hlsl, each buffer is kept within 16 KB (the smallest uniform buffer range Vulkan guarantees).
+    static const uint32_t cluster_count_x           = 16;
+    static const uint32_t cluster_count_y           = 9;
+    static const uint32_t cluster_count_z           = 24;
+    static const uint32_t cluster_count             = cluster_count_x * cluster_count_y * cluster_count_z;
+    static const uint32_t cluster_light_max         = 256;
+    static const uint32_t cluster_light_index_max   = 8192;
+
+    struct BufferClusterLights
+    {
+        Math::Vector4 params; // x: depth slice scale, y: depth slice bias, z: light count
+        Math::Vector4 position_range[cluster_light_max];
+        Math::Vector4 color_intensity[cluster_light_max];
+        Math::Vector4 direction_angle[cluster_light_max]; // angle is zero for point lights
+    };
+
+    // Per cluster, the offset of its first light index (low 16 bits) and the light count (high 16 bits)
+    struct BufferClusterGrid
+    {
+        uint32_t clusters[cluster_count];
+    };
+
+    // Two 16 bit light indices per element
+    struct BufferClusterIndices
+    {
+        uint32_t indices[cluster_light_index_max / 2];
+    };
+
+    // Bindless materials - Updates when materials change
+    // The properties of every material that gets drawn, the G-Buffer pass only provides the index of the material (through the object buffer)
+    // and its textures are looked up in a texture table. The sizes must match Common_Buffer.hlsl and Common_Texture.hlsl.
+    static const uint32_t material_max                  = 256;
+    static const uint32_t material_texture_table_size   = 256;
+    static const uint32_t material_texture_slots        = 8;
+
+    struct BufferMaterial
+    {
+        Math::Vector4 albedo[material_max];
+        Math::Vector4 tiling_offset[material_max];
+        Math::Vector4 properties[material_max]; // x: roughness, y: metallic, z: normal, w: height
+        uint32_t textures[material_max][material_texture_slots / 2]; // two 16 bit texture table indices per element, in material texture slot order
+    };
 }
@@ -23,14 +23,21 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Renderer.h"
 #include "Model.h"
 #include "Font/Font.h"
+#include "RenderGraph.h"
 #include "../Profiling/Profiler.h"
+#include "../Threading/Threading.h"
+#include "../Utilities/Hash.h"
 #include "ShaderVariation.h"
 #include "Gizmos/Grid.h"
 #include "Gizmos/Transform_Gizmo.h"
 #include "../RHI/RHI_CommandList.h"
+#include "../RHI/RHI_ConstantBuffer.h"
+#include "../RHI/RHI_DescriptorCache.h"
 #include "../RHI/RHI_Implementation.h"
 #include "../RHI/RHI_VertexBuffer.h"
+#include "../RHI/RHI_Vertex.h"
 #include "../RHI/RHI_PipelineState.h"
+#include "../RHI/RHI_PipelineCache.h"
 #include "../RHI/RHI_Texture.h"
 #include "../World/Entity.h"
 #include "../World/Components/Light.h"
@@ -46,6 +53,25 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // Models with packed vertices need their own vertex shaders, so passes draw them after the rest
+    static bool has_packed_vertices(const vector<Entity*>& entities)
+    {
+        for (const Entity* entity : entities)
+        {
+            const Renderable* renderable = entity->GetRenderable();
+            const Model* model = renderable ? renderable->GeometryModel() : nullptr;
+            if (model && model->IsVertexPacked())
+                return true;
+        }
+
+        return false;
+    }
+
+    static uint32_t vertex_stride(const bool packed)
+    {
+        return static_cast<uint32_t>(packed ? sizeof(RHI_Vertex_PosTexNorTan_Packed) : sizeof(RHI_Vertex_PosTexNorTan));
+    }
+
     void Renderer::SetGlobalSamplersAndConstantBuffers(RHI_CommandList* cmd_list) const
     {
         // Constant buffers
@@ -53,6 +79,10 @@ namespace Spartan
         cmd_list->SetConstantBuffer(1, RHI_Shader_Vertex | RHI_Shader_Pixel | RHI_Shader_Compute, m_buffer_uber_gpu);
         cmd_list->SetConstantBuffer(2, RHI_Shader_Vertex, m_buffer_object_gpu);
         cmd_list->SetConstantBuffer(3, RHI_Shader_Pixel, m_buffer_light_gpu);
+        cmd_list->SetConstantBuffer(4, RHI_Shader_Pixel, m_buffer_cluster_lights_gpu);
+        cmd_list->SetConstantBuffer(5, RHI_Shader_Pixel, m_buffer_cluster_grid_gpu);
+        cmd_list->SetConstantBuffer(6, RHI_Shader_Pixel, m_buffer_cluster_indices_gpu);
+        cmd_list->SetConstantBuffer(7, RHI_Shader_Pixel, m_buffer_material_gpu);
         
         // Samplers
         cmd_list->SetSampler(0, m_sampler_compare_depth);
@@ -71,62 +101,232 @@ namespace Spartan
 
         SCOPED_TIME_BLOCK(m_profiler);
 
+        // The object buffer has a region per swap chain buffer, as frames are in flight at the same time. A frame only writes its own
+        // region, which the gpu is done with, since the command list of the same swap chain buffer was waited for. If the last frame
+        // needed more than a region holds, grow them (in between frames, creating waits for the gpu and nothing references the buffer yet).
+        const uint32_t region_count = Math::Max(m_swap_chain->GetBufferCount(), 1u);
+        uint32_t region_size        = m_buffer_object_gpu->GetElementCount() / region_count;
+        if (m_buffer_object_ring_used > region_size)
+        {
+            const uint32_t new_region_size = Math::NextPowerOfTwo(m_buffer_object_ring_used);
+            if (m_buffer_object_gpu->Create<BufferObject>(new_region_size * region_count))
+            {
+                region_size = new_region_size;
+            }
+        }
+        m_buffer_object_ring_index      = (m_swap_chain->GetImageIndex() % region_count) * region_size;
+        m_buffer_object_ring_end        = m_buffer_object_ring_index + region_size;
+        m_buffer_object_ring_used       = 0;
+        m_buffer_object_ring_full       = false;
+        m_buffer_object_offset_previous = numeric_limits<uint32_t>::max();
+
         // Updates onces, used almost everywhere
         UpdateFrameBuffer();
+        UpdateClusterBuffers();
+        UpdateMaterialBuffer();
 
-        // Runs only once
-        Pass_BrdfSpecularLut(cmd_list);
+        // Declare the passes and the render targets they use, then cull and alias them
+        RenderGraphBuild(cmd_list);
+        if (!m_render_graph->Compile())
+        {
+            // The lifetimes changed (an option was toggled, transparent objects appeared, etc.) and the transient
+            // render targets are bound to memory laid out for the old ones, so they (and only they) have to be re-created.
+            CreateRenderTexturesTransient();
+            RenderGraphBuild(cmd_list);
+            m_render_graph->Compile();
+        }
+
+        m_render_graph->Execute();
+	}
 
+    void Renderer::RenderGraphBuild(RHI_CommandList* cmd_list)
+    {
+        // The render targets are resolved when a pass executes, as some passes swap them (ping-ponging)
+        RenderGraph& graph                  = *m_render_graph;
+        auto& rt                            = m_render_targets;
         const bool draw_transparent_objects = !m_entities[Renderer_Object_Transparent].empty();
+        const bool ssao                     = GetOption(Render_ScreenSpaceAmbientOcclusion);
+        const bool ssr                      = GetOption(Render_ScreenSpaceReflections);
+
+        graph.Clear();
+
+        // Runs only once
+        graph.AddPass("brdf_specular_lut", [this, cmd_list]() { Pass_BrdfSpecularLut(cmd_list); });
+        graph.Write(rt[RenderTarget_Brdf_Specular_Lut]);
 
         // Depth
         {
-            Pass_LightDepth(cmd_list, Renderer_Object_Opaque);
+            // The shadow maps belong to the lights, so these passes are never culled
+            graph.AddPass("light_depth_opaque", [this, cmd_list]() { Pass_LightDepth(cmd_list, Renderer_Object_Opaque); });
             if (draw_transparent_objects)
             {
-                Pass_LightDepth(cmd_list, Renderer_Object_Transparent);
+                graph.AddPass("light_depth_transparent", [this, cmd_list]() { Pass_LightDepth(cmd_list, Renderer_Object_Transparent); });
             }
 
             if (GetOption(Render_DepthPrepass))
             {
-                Pass_DepthPrePass(cmd_list);
+                graph.AddPass("depth_prepass", [this, cmd_list]() { Pass_DepthPrePass(cmd_list); });
+                graph.Write(rt[RenderTarget_Gbuffer_Depth]);
             }
         }
 
         // G-Buffer to Composition
+        const auto add_lighting = [&](const bool transparent)
         {
-            // Lighting
-            Pass_GBuffer(cmd_list, Renderer_Object_Opaque);
-            Pass_Ssao(cmd_list, false);
-            Pass_Ssr(cmd_list, false);
-            Pass_Light(cmd_list, false);
-            Pass_Composition(cmd_list, m_render_targets[RenderTarget_Composition_Hdr], false);
+            const Renderer_Object_Type object_type = transparent ? Renderer_Object_Transparent : Renderer_Object_Opaque;
 
-            // Lighting for transparent objects
-            if (draw_transparent_objects)
+            graph.AddPass("gbuffer", [this, cmd_list, object_type]() { Pass_GBuffer(cmd_list, object_type); });
+            if (transparent || GetOption(Render_DepthPrepass))
+            {
+                graph.Read(rt[RenderTarget_Gbuffer_Depth]);
+            }
+            graph.Write(rt[RenderTarget_Gbuffer_Albedo]);
+            graph.Write(rt[RenderTarget_Gbuffer_Normal]);
+            graph.Write(rt[RenderTarget_Gbuffer_Material]);
+            graph.Write(rt[RenderTarget_Gbuffer_Velocity]);
+            graph.Write(rt[RenderTarget_Gbuffer_Depth]);
+
+            graph.AddPass("ssao", [this, cmd_list, transparent]() { Pass_Ssao(cmd_list, transparent); });
+            graph.Read(rt[RenderTarget_Gbuffer_Depth]);
+            graph.Read(rt[RenderTarget_Gbuffer_Normal]);
+            graph.Read(rt[RenderTarget_Gbuffer_Velocity]);
+            graph.Write(rt[RenderTarget_Ssao_Noisy]);
+            graph.Write(rt[RenderTarget_Ssao]);
+            graph.Read(rt[RenderTarget_Ssao_History]);
+            graph.Write(rt[RenderTarget_Ssao_History]);
+
+            graph.AddPass("ssr", [this, cmd_list, transparent]() { Pass_Ssr(cmd_list, transparent); });
+            graph.Read(rt[RenderTarget_Gbuffer_Normal]);
+            graph.Read(rt[RenderTarget_Gbuffer_Depth]);
+            graph.Write(rt[RenderTarget_Ssr]);
+
+            graph.AddPass("light", [this, cmd_list, transparent]() { Pass_Light(cmd_list, transparent); });
+            graph.Read(rt[RenderTarget_Gbuffer_Albedo]);
+            graph.Read(rt[RenderTarget_Gbuffer_Normal]);
+            graph.Read(rt[RenderTarget_Gbuffer_Material]);
+            graph.Read(rt[RenderTarget_Gbuffer_Depth]);
+            graph.Read(rt[RenderTarget_Composition_Hdr_2]);
+            if (ssao)
+            {
+                graph.Read(rt[RenderTarget_Ssao_Noisy]);
+                graph.Read(rt[RenderTarget_Ssao]);
+            }
+            if (ssr)
+            {
+                graph.Read(rt[RenderTarget_Ssr]);
+            }
+            graph.Write(rt[RenderTarget_Light_Diffuse]);
+            graph.Write(rt[RenderTarget_Light_Specular]);
+
+            graph.AddPass("light_volumetric", [this, cmd_list, transparent]() { Pass_LightVolumetric(cmd_list, transparent); });
+            graph.Read(rt[RenderTarget_Gbuffer_Depth]);
+            graph.Read(rt[RenderTarget_Gbuffer_Velocity]);
+            graph.Write(rt[RenderTarget_Light_Volumetric]);
+            graph.Write(rt[RenderTarget_Light_Volumetric_2]);
+            graph.Read(rt[RenderTarget_Light_Volumetric_History]);
+            graph.Write(rt[RenderTarget_Light_Volumetric_History]);
+
+            const Renderer_RenderTarget_Type tex_out = transparent ? RenderTarget_Composition_Hdr_2 : RenderTarget_Composition_Hdr;
+            graph.AddPass("composition", [this, cmd_list, transparent, tex_out]() { Pass_Composition(cmd_list, m_render_targets[tex_out], transparent); });
+            graph.Read(rt[RenderTarget_Gbuffer_Albedo]);
+            graph.Read(rt[RenderTarget_Gbuffer_Normal]);
+            graph.Read(rt[RenderTarget_Gbuffer_Material]);
+            graph.Read(rt[RenderTarget_Gbuffer_Depth]);
+            if (ssao)
+            {
+                graph.Read(rt[RenderTarget_Ssao_Noisy]);
+                graph.Read(rt[RenderTarget_Ssao]);
+            }
+            graph.Read(rt[RenderTarget_Light_Diffuse]);
+            graph.Read(rt[RenderTarget_Light_Specular]);
+            if (GetOption(Render_VolumetricLighting))
             {
-                Pass_GBuffer(cmd_list, Renderer_Object_Transparent);
-                Pass_Ssao(cmd_list, true);
-                Pass_Ssr(cmd_list, true);
-                Pass_Light(cmd_list, true);
-                Pass_Composition(cmd_list, m_render_targets[RenderTarget_Composition_Hdr_2], true);
-
-                // Alpha blend the transparent composition on top of opaque one
-                Pass_AlphaBlend(cmd_list, m_render_targets[RenderTarget_Composition_Hdr_2].get(), m_render_targets[RenderTarget_Composition_Hdr].get(), true);
+                // The volumetric pass ends with a temporal accumulation which swaps the two, so either can be the result
+                graph.Read(rt[RenderTarget_Light_Volumetric]);
+                graph.Read(rt[RenderTarget_Light_Volumetric_2]);
             }
+            if (ssr)
+            {
+                graph.Read(rt[RenderTarget_Ssr]);
+            }
+            graph.Read(rt[RenderTarget_Composition_Hdr_2]);
+            graph.Read(rt[RenderTarget_Brdf_Specular_Lut]);
+            graph.Write(rt[tex_out]);
+        };
+
+        add_lighting(false);
+        if (draw_transparent_objects)
+        {
+            add_lighting(true);
+
+            // Alpha blend the transparent composition on top of opaque one
+            graph.AddPass("alpha_blend", [this, cmd_list]() { Pass_AlphaBlend(cmd_list, m_render_targets[RenderTarget_Composition_Hdr_2].get(), m_render_targets[RenderTarget_Composition_Hdr].get(), true); });
+            graph.Read(rt[RenderTarget_Composition_Hdr_2]);
+            graph.Read(rt[RenderTarget_Gbuffer_Depth]);
+            graph.Write(rt[RenderTarget_Composition_Hdr]);
         }
 
         // Post-processing
-        {  
-            Pass_PostProcess(cmd_list);
-            Pass_Outline(cmd_list, m_render_targets[RenderTarget_Composition_Ldr]);
-            Pass_Lines(cmd_list, m_render_targets[RenderTarget_Composition_Ldr]);
-            Pass_TransformHandle(cmd_list, m_render_targets[RenderTarget_Composition_Ldr].get());
-            Pass_Icons(cmd_list, m_render_targets[RenderTarget_Composition_Ldr].get());      
-            Pass_DebugBuffer(cmd_list, m_render_targets[RenderTarget_Composition_Ldr]);
-            Pass_Text(cmd_list, m_render_targets[RenderTarget_Composition_Ldr].get());
+        {
+            graph.AddPass("post_process", [this, cmd_list]() { Pass_PostProcess(cmd_list); });
+            for (const Renderer_RenderTarget_Type type : { RenderTarget_Composition_Hdr, RenderTarget_Composition_Hdr_2, RenderTarget_Composition_Ldr, RenderTarget_Composition_Ldr_2, RenderTarget_TaaHistory })
+            {
+                graph.Read(rt[type]);
+                graph.Write(rt[type]);
+            }
+            if (GetOption(Render_AntiAliasing_Taa) || GetOption(Render_MotionBlur))
+            {
+                graph.Read(rt[RenderTarget_Gbuffer_Velocity]);
+            }
+            graph.Read(rt[RenderTarget_Gbuffer_Depth]);
+            if (GetOption(Render_Bloom))
+            {
+                for (const auto& tex_bloom : m_render_tex_bloom)
+                {
+                    graph.Read(tex_bloom);
+                    graph.Write(tex_bloom);
+                }
+            }
+
+            if (GetOption(Render_Debug_SelectionOutline))
+            {
+                graph.AddPass("outline", [this, cmd_list]() { Pass_Outline(cmd_list, m_render_targets[RenderTarget_Composition_Ldr]); });
+                graph.Read(rt[RenderTarget_Gbuffer_Depth]);
+                graph.Read(rt[RenderTarget_Gbuffer_Normal]);
+                graph.Write(rt[RenderTarget_Composition_Ldr]);
+            }
+
+            graph.AddPass("lines", [this, cmd_list]() { Pass_Lines(cmd_list, m_render_targets[RenderTarget_Composition_Ldr]); });
+            graph.Read(rt[RenderTarget_Gbuffer_Depth]);
+            graph.Write(rt[RenderTarget_Composition_Ldr]);
+
+            graph.AddPass("transform_handle", [this, cmd_list]() { Pass_TransformHandle(cmd_list, m_render_targets[RenderTarget_Composition_Ldr].get()); });
+            graph.Write(rt[RenderTarget_Composition_Ldr]);
+
+            graph.AddPass("icons", [this, cmd_list]() { Pass_Icons(cmd_list, m_render_targets[RenderTarget_Composition_Ldr].get()); });
+            graph.Write(rt[RenderTarget_Composition_Ldr]);
+
+            if (m_debug_buffer != Renderer_Buffer_None)
+            {
+                graph.AddPass("debug_buffer", [this, cmd_list]() { Pass_DebugBuffer(cmd_list, m_render_targets[RenderTarget_Composition_Ldr]); });
+                for (const auto& it : rt)
+                {
+                    if (it.second && it.second->IsTransient())
+                    {
+                        graph.Read(it.second);
+                    }
+                }
+                for (const auto& tex_bloom : m_render_tex_bloom)
+                {
+                    graph.Read(tex_bloom);
+                }
+                graph.Write(rt[RenderTarget_Composition_Ldr]);
+            }
+
+            graph.AddPass("text", [this, cmd_list]() { Pass_Text(cmd_list, m_render_targets[RenderTarget_Composition_Ldr].get()); });
+            graph.Write(rt[RenderTarget_Composition_Ldr]);
         }
-	}
+    }
 
 	void Renderer::Pass_LightDepth(RHI_CommandList* cmd_list, const Renderer_Object_Type object_type)
 	{
@@ -135,17 +335,20 @@ namespace Spartan
         // Transparent objects, read the opaque depth but don't write their own, instead, they write their color information using a pixel shader.
 
 		// Acquire shader
-		RHI_Shader* shader_v = m_shaders[Shader_Depth_V].get();
-        RHI_Shader* shader_p = m_shaders[Shader_Depth_P].get();
+		RHI_Shader* shader_v        = m_shaders[Shader_Depth_V].get();
+		RHI_Shader* shader_v_packed = m_shaders[Shader_Depth_Packed_V].get();
+        RHI_Shader* shader_p        = m_shaders[Shader_Depth_P].get();
 		if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
 			return;
 
         // Get entities
-        const auto& entities = m_entities[object_type];
+        const auto& entities        = m_entities[object_type];
+        const auto& entities_frame  = m_entities_frame[object_type];
         if (entities.empty())
             return;
 
         const bool transparent_pass = object_type == Renderer_Object_Transparent;
+        const bool has_packed       = has_packed_vertices(entities) && shader_v_packed->IsCompiled();
 
         // Go through all of the lights
 		const auto& entities_light = m_entities[Renderer_Object_Light];
@@ -154,8 +357,9 @@ namespace Spartan
             const Light* light = entities_light[light_index]->GetComponent<Light>();
 
             // Skip some obvious cases
-            if (!light || !light->GetShadowsEnabled())
+            if (!light || !light->GetShadowsEnabled() || m_lights_frame.find(light) == m_lights_frame.end())
                 continue;
+            const BufferLight& light_frame = m_lights_frame[light];
 
             // Skip lights that don't cast transparent shadows (if this is a transparent pass)
             if (transparent_pass && !light->GetShadowsTransparentEnabled())
@@ -169,7 +373,6 @@ namespace Spartan
 
             // Set render state
             static RHI_PipelineState pipeline_state;
-            pipeline_state.shader_vertex                    = shader_v;
             pipeline_state.shader_pixel                     = transparent_pass ? shader_p : nullptr;
             pipeline_state.blend_state                      = transparent_pass ? m_blend_alpha.get() : m_blend_disabled.get();
             pipeline_state.depth_stencil_state              = transparent_pass ? m_depth_stencil_enabled_disabled_read.get() : m_depth_stencil_enabled_disabled_write.get();
@@ -185,11 +388,7 @@ namespace Spartan
                 pipeline_state.render_target_color_texture_array_index          = array_index;
                 pipeline_state.render_target_depth_stencil_texture_array_index  = array_index;
 
-                // Set clear values
-                pipeline_state.clear_color[0] = Vector4::One;
-                pipeline_state.clear_depth    = transparent_pass ? state_dont_clear_depth : GetClearDepth();
-
-                const Matrix& view_projection = light->GetViewMatrix(array_index) * light->GetProjectionMatrix(array_index);
+                const Matrix& view_projection = light_frame.view_projection[array_index];
 
                 // Set appropriate rasterizer state
                 if (light->GetLightType() == LightType_Directional)
@@ -204,70 +403,84 @@ namespace Spartan
                     pipeline_state.rasterizer_state = m_rasterizer_cull_back_solid.get();
                 }
 
-                if (cmd_list->Begin(pipeline_state))
+                // Full precision and packed vertices need different vertex shaders, so draw them one after the other, clearing only in the first
+                for (const bool packed : { false, true })
                 {
-                    // Useful to avoid constant buffer updates
-                    uint32_t m_set_material_id = 0;
+                    if (packed && !has_packed)
+                        break;
 
-                    for (uint32_t entity_index = 0; entity_index < static_cast<uint32_t>(entities.size()); entity_index++)
+                    pipeline_state.shader_vertex        = packed ? shader_v_packed : shader_v;
+                    pipeline_state.vertex_buffer_stride = vertex_stride(packed);
+                    pipeline_state.clear_color[0]       = !packed ? Vector4::One : state_dont_clear_color;
+                    pipeline_state.clear_depth          = !packed && !transparent_pass ? GetClearDepth() : state_dont_clear_depth;
+
+                    if (cmd_list->Begin(pipeline_state))
                     {
-                        Entity* entity = entities[entity_index];
+                        // Useful to avoid constant buffer updates
+                        uint32_t m_set_material_id = 0;
 
-                        // Acquire renderable component
-                        const auto& renderable = entity->GetRenderable();
-                        if (!renderable)
-                            continue;
+                        for (uint32_t entity_index = 0; entity_index < static_cast<uint32_t>(entities.size()); entity_index++)
+                        {
+                            Entity* entity = entities[entity_index];
 
-                        // Skip meshes that don't cast shadows
-                        if (!renderable->GetCastShadows())
-                            continue;
+                            // Acquire renderable component
+                            const auto& renderable = entity->GetRenderable();
+                            if (!renderable)
+                                continue;
 
-                        // Acquire geometry
-                        const auto& model = renderable->GeometryModel();
-                        if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                            continue;
+                            // Skip meshes that don't cast shadows
+                            if (!renderable->GetCastShadows())
+                                continue;
 
-                        // Acquire material
-                        const auto& material = renderable->GetMaterial();
-                        if (!material)
-                            continue;
+                            // Acquire geometry
+                            const auto& model = renderable->GeometryModel();
+                            if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer() || model->IsVertexPacked() != packed)
+                                continue;
 
-                        // Skip objects outside of the view frustum
-                        if (!light->IsInViewFrustrum(renderable, array_index))
-                            continue;
+                            // Acquire material
+                            const auto& material = renderable->GetMaterial();
+                            if (!material)
+                                continue;
 
-                        // Bind material
-                        if (transparent_pass && m_set_material_id != material->GetId())
-                        {
-                            // Bind material textures
-                            RHI_Texture* tex_albedo = material->GetTexture_PtrRaw(TextureType_Albedo);
-                            cmd_list->SetTexture(28, tex_albedo ? tex_albedo : m_tex_white.get());
+                            // Skip objects outside of the view frustum
+                            if (!light->IsInViewFrustrum(renderable, array_index))
+                                continue;
 
-                            // Update uber buffer with material properties
-                            m_buffer_uber_cpu.mat_albedo    = material->GetColorAlbedo();
-                            m_buffer_uber_cpu.mat_tiling_uv = material->GetTiling();
-                            m_buffer_uber_cpu.mat_offset_uv = material->GetOffset();
+                            // Bind material
+                            if (transparent_pass && m_set_material_id != material->GetId())
+                            {
+                                // Bind material textures
+                                RHI_Texture* tex_albedo = material->GetTexture_PtrRaw(TextureType_Albedo);
+                                cmd_list->SetTexture(28, tex_albedo ? tex_albedo : m_tex_white.get());
 
-                            // Update constant buffer
-                            UpdateUberBuffer();
+                                // Update uber buffer with material properties
+                                m_buffer_uber_cpu.mat_albedo    = material->GetColorAlbedo();
+                                m_buffer_uber_cpu.mat_tiling_uv = material->GetTiling();
+                                m_buffer_uber_cpu.mat_offset_uv = material->GetOffset();
 
-                            m_set_material_id = material->GetId();
-                        }
+                                // Update constant buffer
+                                UpdateUberBuffer();
 
-                        // Bind geometry
-                        cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                        cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                                m_set_material_id = material->GetId();
+                            }
 
-                        // Update uber buffer with cascade transform
-                        m_buffer_object_cpu.object = entity->GetTransform()->GetMatrix() * view_projection;
-                        if (!UpdateObjectBuffer(cmd_list, array_index))
-                            continue;
+                            // Bind geometry
+                            cmd_list->SetBufferIndex(model->GetIndexBuffer());
+                            cmd_list->SetBufferVertex(model->GetVertexBuffer());
+
+                            // Update uber buffer with cascade transform
+                            m_buffer_object_cpu.object = entities_frame[entity_index].transform * view_projection;
+                            SetObjectDequantization(m_buffer_object_cpu, model);
+                            if (!UpdateObjectBuffer(cmd_list))
+                                continue;
 
-                        cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                            const uint32_t lod = renderable->GeometryLodSelect(m_camera.get(), true);
+                            cmd_list->DrawIndexed(renderable->GeometryIndexCount(lod), renderable->GeometryIndexOffset(lod), renderable->GeometryVertexOffset());
 
+                        }
+                        cmd_list->End(); // end of array
+                        cmd_list->Submit();
                     }
-                    cmd_list->End(); // end of array
-                    cmd_list->Submit();
                 }
             }
         }
@@ -279,86 +492,186 @@ namespace Spartan
         // just their depth information into a depth map.
 
         // Acquire required resources/data
-        const auto& shader_depth    = m_shaders[Shader_Depth_V];
-        const auto& tex_depth       = m_render_targets[RenderTarget_Gbuffer_Depth];
-        const auto& entities        = m_entities[Renderer_Object_Opaque];
+        const auto& shader_depth        = m_shaders[Shader_Depth_V];
+        const auto& shader_depth_packed = m_shaders[Shader_Depth_Packed_V];
+        const auto& tex_depth           = m_render_targets[RenderTarget_Gbuffer_Depth];
+        const auto& entities            = m_entities[Renderer_Object_Opaque];
+        const auto& entities_frame      = m_entities_frame[Renderer_Object_Opaque];
 
         // Ensure the shader has compiled
         if (!shader_depth->IsCompiled())
             return;
 
+        const bool has_packed = has_packed_vertices(entities) && shader_depth_packed->IsCompiled();
+
         // Set render state
         static RHI_PipelineState pipeline_state;
-        pipeline_state.shader_vertex                = shader_depth.get();
         pipeline_state.shader_pixel                 = nullptr;
         pipeline_state.rasterizer_state             = m_rasterizer_cull_back_solid.get();
         pipeline_state.blend_state                  = m_blend_disabled.get();
         pipeline_state.depth_stencil_state          = m_depth_stencil_enabled_disabled_write.get();
         pipeline_state.render_target_depth_texture  = tex_depth.get();
-        pipeline_state.clear_depth                  = GetClearDepth();
-        pipeline_state.viewport                     = tex_depth->GetViewport();
+        pipeline_state.viewport                     = GetViewportScaled(tex_depth.get());
         pipeline_state.primitive_topology           = RHI_PrimitiveTopology_TriangleList;
         pipeline_state.pass_name                    = "Pass_DepthPrePass";
 
-        // Submit commands
-        if (cmd_list->Begin(pipeline_state))
-        { 
-            if (!entities.empty())
-            {
-                // Variables that help reduce state changes
-                uint32_t currently_bound_geometry = 0;
+        // Full precision and packed vertices need different vertex shaders, so draw them one after the other, clearing only in the first
+        for (const bool packed : { false, true })
+        {
+            if (packed && !has_packed)
+                break;
 
-                // Draw opaque
-                for (const auto& entity : entities)
+            pipeline_state.shader_vertex        = packed ? shader_depth_packed.get() : shader_depth.get();
+            pipeline_state.vertex_buffer_stride = vertex_stride(packed);
+            pipeline_state.clear_depth          = !packed ? GetClearDepth() : state_dont_clear_depth;
+
+            // Submit commands
+            if (cmd_list->Begin(pipeline_state))
+            { 
+                if (!entities.empty())
                 {
-                    // Get renderable
-                    const auto& renderable = entity->GetRenderable();
-                    if (!renderable)
-                        continue;
+                    // Variables that help reduce state changes
+                    uint32_t currently_bound_geometry = 0;
 
-                    // Get geometry
-                    const auto& model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                        continue;
+                    // Draw opaque
+                    for (uint32_t entity_index = 0; entity_index < static_cast<uint32_t>(entities.size()); entity_index++)
+                    {
+                        Entity* entity = entities[entity_index];
 
-                    // Skip objects outside of the view frustum
-                    if (!m_camera->IsInViewFrustrum(renderable))
-                        continue;
+                        // Get renderable
+                        const auto& renderable = entity->GetRenderable();
+                        if (!renderable)
+                            continue;
 
-                    // Bind geometry
-                    if (currently_bound_geometry != model->GetId())
-                    {
-                        cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                        cmd_list->SetBufferVertex(model->GetVertexBuffer());
-                        currently_bound_geometry = model->GetId();
-                    }
+                        // Get geometry
+                        const auto& model = renderable->GeometryModel();
+                        if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer() || model->IsVertexPacked() != packed)
+                            continue;
 
-                    // Update uber buffer with entity transform
-                    if (Transform* transform = entity->GetTransform())
-                    {
-                        // Update uber buffer with cascade transform
-                        m_buffer_uber_cpu.transform = transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
-                        UpdateUberBuffer(); // only updates if needed
+                        // Skip objects outside of the view frustum
+                        if (!m_camera->IsInViewFrustrum(renderable))
+                            continue;
+
+                        // Bind geometry
+                        if (currently_bound_geometry != model->GetId())
+                        {
+                            cmd_list->SetBufferIndex(model->GetIndexBuffer());
+                            cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                            currently_bound_geometry = model->GetId();
+                        }
+
+                        // Update object buffer with entity transform (the depth shader reads it from there)
+                        m_buffer_object_cpu.object = entities_frame[entity_index].transform * m_buffer_frame_cpu.view_projection;
+                        SetObjectDequantization(m_buffer_object_cpu, model);
+                        if (!UpdateObjectBuffer(cmd_list))
+                            continue;
+
+                        // Draw, with the same level of detail as the g-buffer pass so that the depth matches
+                        const uint32_t lod = renderable->GeometryLodSelect(m_camera.get());
+                        cmd_list->DrawIndexed(renderable->GeometryIndexCount(lod), renderable->GeometryIndexOffset(lod), renderable->GeometryVertexOffset());
                     }
+                }
+                cmd_list->End();
+                cmd_list->Submit();
+            }
+        }
+    }
+
+    void Renderer::SetPipelineState_GBuffer(RHI_PipelineState& pso, const bool is_transparent)
+    {
+        RHI_Texture* tex_albedo             = m_render_targets[RenderTarget_Gbuffer_Albedo].get();
+        pso.shader_vertex                   = m_shaders[Shader_Gbuffer_V].get();
+        pso.vertex_buffer_stride            = vertex_stride(false);
+        pso.blend_state                     = m_blend_disabled.get();
+        pso.rasterizer_state                = GetOption(Render_Debug_Wireframe) ? m_rasterizer_cull_back_wireframe.get() : m_rasterizer_cull_back_solid.get();
+        pso.depth_stencil_state             = is_transparent ? m_depth_stencil_enabled_enabled_write.get() : m_depth_stencil_enabled_disabled_write.get(); // GetOptionValue(Render_DepthPrepass) is not accounted for anymore, have to fix
+        pso.render_target_color_textures[0] = tex_albedo;
+        pso.clear_color[0]                  = !is_transparent ? Vector4::Zero : state_dont_clear_color;
+        pso.render_target_color_textures[1] = m_render_targets[RenderTarget_Gbuffer_Normal].get();
+        pso.clear_color[1]                  = !is_transparent ? Vector4::Zero : state_dont_clear_color;
+        pso.render_target_color_textures[2] = m_render_targets[RenderTarget_Gbuffer_Material].get();
+        pso.clear_color[2]                  = !is_transparent ? Vector4::Zero : state_dont_clear_color;
+        pso.render_target_color_textures[3] = m_render_targets[RenderTarget_Gbuffer_Velocity].get();
+        pso.clear_color[3]                  = !is_transparent ? Vector4::Zero : state_dont_clear_color;
+        pso.render_target_depth_texture     = m_render_targets[RenderTarget_Gbuffer_Depth].get();
+        pso.clear_depth                     = is_transparent || GetOption(Render_DepthPrepass) ? state_dont_clear_depth : GetClearDepth();
+        pso.clear_stencil                   = 0;
+        pso.viewport                        = GetViewportScaled(tex_albedo);
+        pso.primitive_topology              = RHI_PrimitiveTopology_TriangleList;
+    }
+
+    RHI_Viewport Renderer::GetViewportScaled(const RHI_Texture* texture) const
+    {
+        // The scene is rendered to the top-left part of the render targets, the rest is left unused
+        RHI_Viewport viewport   = texture->GetViewport();
+        viewport.width          *= m_resolution_render.x / m_resolution.x;
+        viewport.height         *= m_resolution_render.y / m_resolution.y;
+        return viewport;
+    }
 
-                    // Draw	
-                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+    void Renderer::PrecompilePipelines()
+    {
+        // Most pipelines are known up front and get created on the first frame, the G-Buffer ones
+        // depend on content (one per material shader variation), so they are created as the variations compile.
+        RHI_Shader* shader_v        = m_shaders[Shader_Gbuffer_V].get();
+        RHI_Shader* shader_v_packed = m_shaders[Shader_Gbuffer_Packed_V].get();
+        if (!shader_v->IsCompiled())
+            return;
+
+        // Anything the pipelines depend on, other than the pixel shader, invalidates what was precompiled
+        size_t key = 0;
+        Utility::Hash::hash_combine(key, m_render_targets[RenderTarget_Gbuffer_Albedo]->GetId());
+        Utility::Hash::hash_combine(key, shader_v_packed->IsCompiled());
+        Utility::Hash::hash_combine(key, GetOption(Render_Debug_Wireframe));
+        if (key != m_pipelines_precompiled_key)
+        {
+            m_pipelines_precompiled.clear();
+            m_pipelines_precompiled_key = key;
+        }
+
+        // Gather the states of the shader variations which compiled since the last time
+        vector<RHI_PipelineState> states;
+        vector<void*> descriptor_set_layouts;
+        for (const shared_ptr<ShaderVariation>& variation : ShaderVariation::GetVariations())
+        {
+            if (!variation->IsCompiled() || !m_pipelines_precompiled.emplace(variation->GetId()).second)
+                continue;
+
+            for (const bool is_transparent : { false, true })
+            {
+                for (const bool packed : { false, true })
+                {
+                    if (packed && !shader_v_packed->IsCompiled())
+                        continue;
+
+                    RHI_PipelineState pso;
+                    SetPipelineState_GBuffer(pso, is_transparent);
+                    pso.ResetClearValues(); // the draws don't clear, Pass_GBuffer() clears separately
+                    pso.shader_vertex           = packed ? shader_v_packed : shader_v;
+                    pso.vertex_buffer_stride    = vertex_stride(packed);
+                    pso.shader_pixel            = static_cast<RHI_Shader*>(variation.get());
+
+                    // Descriptor set layouts are cheap, so they are created here, on this thread
+                    descriptor_set_layouts.emplace_back(m_descriptor_cache->GetResource_DescriptorSetLayout(pso));
+                    states.emplace_back(pso);
                 }
             }
-            cmd_list->End();
-            cmd_list->Submit();
         }
+
+        // Pipeline creation is the expensive part, so it's spread across the thread pool
+        m_context->GetSubsystem<Threading>()->ParallelFor(static_cast<uint32_t>(states.size()), [this, &states, &descriptor_set_layouts](const uint32_t i)
+        {
+            m_pipeline_cache->Precompile(states[i], descriptor_set_layouts[i]);
+        });
     }
 
 	void Renderer::Pass_GBuffer(RHI_CommandList* cmd_list, const Renderer_Object_Type object_type)
 	{
         // Acquire required resources/shaders
-        RHI_Texture* tex_albedo       = m_render_targets[RenderTarget_Gbuffer_Albedo].get();
-        RHI_Texture* tex_normal       = m_render_targets[RenderTarget_Gbuffer_Normal].get();
-        RHI_Texture* tex_material     = m_render_targets[RenderTarget_Gbuffer_Material].get();
-        RHI_Texture* tex_velocity     = m_render_targets[RenderTarget_Gbuffer_Velocity].get();
-        RHI_Texture* tex_depth        = m_render_targets[RenderTarget_Gbuffer_Depth].get();
         RHI_Shader* shader_v          = m_shaders[Shader_Gbuffer_V].get();
+        RHI_Shader* shader_v_packed   = m_shaders[Shader_Gbuffer_Packed_V].get();
+        auto& entities                = m_entities[object_type];
+        const auto& entities_frame    = m_entities_frame[object_type];
 
         // Validate that the shader has compiled
         if (!shader_v->IsCompiled())
@@ -366,140 +679,185 @@ namespace Spartan
 
         // Clear values that depend on the objects being opaque or transparent
         const bool is_transparent = object_type == Renderer_Object_Transparent;
+        const bool has_packed     = has_packed_vertices(entities) && shader_v_packed->IsCompiled();
+        const bool bindless       = m_rhi_device->GetContextRhi()->bindless_textures;
+
+        // Write the object constants of all the visible entities in one sweep, the draws only bind them by offset
+        const uint32_t entity_count = static_cast<uint32_t>(entities.size());
+        m_buffer_object_offsets.assign(entity_count, numeric_limits<uint32_t>::max());
+        const uint32_t offset_first = entity_count != 0 ? AllocateObjectBuffer(entity_count) : numeric_limits<uint32_t>::max();
+        if (offset_first != numeric_limits<uint32_t>::max())
+        {
+            const uint32_t stride       = m_buffer_object_gpu->GetStride();
+            uint8_t* buffer             = static_cast<uint8_t*>(m_buffer_object_gpu->Map(offset_first));
+            if (!buffer)
+            {
+                LOG_ERROR("Failed to map buffer");
+                return;
+            }
+
+            // Entities don't depend on each other, so they are split in batches across the thread pool
+            const uint32_t batch_size   = 128;
+            const uint32_t batch_count  = (entity_count + batch_size - 1) / batch_size;
+            m_context->GetSubsystem<Threading>()->ParallelFor(batch_count, [&](const uint32_t batch)
+            {
+                const uint32_t end = Min((batch + 1) * batch_size, entity_count);
+                for (uint32_t i = batch * batch_size; i < end; i++)
+                {
+                    Entity* entity          = entities[i];
+                    Renderable* renderable  = entity->GetRenderable();
+                    Transform* transform    = entity->GetTransform();
+                    if (!renderable || !transform || !renderable->GetMaterial())
+                        continue;
+
+                    // Skip objects outside of the view frustum
+                    if (!m_camera->IsInViewFrustrum(renderable))
+                        continue;
+
+                    BufferObject object;
+                    object.object       = entities_frame[i].transform;
+                    object.wvp_current  = entities_frame[i].transform * m_buffer_frame_cpu.view_projection;
+                    object.wvp_previous = transform->GetWvpLastFrame();
+                    SetObjectDequantization(object, renderable->GeometryModel());
+
+                    // Bindless, the material properties and textures are already in the material buffer and texture table
+                    if (bindless)
+                    {
+                        const auto it = m_material_indices.find(entities_frame[i].material_id);
+                        object.material_index = it != m_material_indices.end() ? it->second : 0;
+                    }
+
+                    // Save matrix for velocity computation
+                    transform->SetWvpLastFrame(object.wvp_current);
+
+                    // Write it in one go, the memory is meant for writing only
+                    *reinterpret_cast<BufferObject*>(buffer + static_cast<uint64_t>(i) * stride) = object;
+                    m_buffer_object_offsets[i] = offset_first + i;
+                }
+            });
+
+            m_buffer_object_gpu->Unmap();
+        }
 
         // Set render state
         RHI_PipelineState pso;
-        pso.shader_vertex                   = shader_v;
-        pso.vertex_buffer_stride            = static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)); // assume all vertex buffers have the same stride (which they do)
-        pso.blend_state                     = m_blend_disabled.get();
-        pso.rasterizer_state                = GetOption(Render_Debug_Wireframe) ? m_rasterizer_cull_back_wireframe.get() : m_rasterizer_cull_back_solid.get();
-        pso.depth_stencil_state             = is_transparent ? m_depth_stencil_enabled_enabled_write.get() : m_depth_stencil_enabled_disabled_write.get(); // GetOptionValue(Render_DepthPrepass) is not accounted for anymore, have to fix
-        pso.render_target_color_textures[0] = tex_albedo;
-        pso.clear_color[0]                  = !is_transparent ? Vector4::Zero : state_dont_clear_color;
-        pso.render_target_color_textures[1] = tex_normal;
-        pso.clear_color[1]                  = !is_transparent ? Vector4::Zero : state_dont_clear_color;
-        pso.render_target_color_textures[2] = tex_material;
-        pso.clear_color[2]                  = !is_transparent ? Vector4::Zero : state_dont_clear_color;
-        pso.render_target_color_textures[3] = tex_velocity;
-        pso.clear_color[3]                  = !is_transparent ? Vector4::Zero : state_dont_clear_color;
-        pso.render_target_depth_texture     = tex_depth;
-        pso.clear_depth                     = is_transparent || GetOption(Render_DepthPrepass) ? state_dont_clear_depth : GetClearDepth();
-        pso.clear_stencil                   = 0;
-        pso.viewport                         = tex_albedo->GetViewport();
-        pso.primitive_topology               = RHI_PrimitiveTopology_TriangleList;
+        SetPipelineState_GBuffer(pso, is_transparent);
 
         // Clear
         cmd_list->Clear(pso);
 
-        // Only useful to minimize D3D11 state changes (Vulkan backend is smarter)
-        uint32_t m_set_material_id = 0;
-        
-        // Iterate through all the G-Buffer shader variations
-        for (const shared_ptr<ShaderVariation>& resource : ShaderVariation::GetVariations())
+        // Full precision and packed vertices need different vertex shaders, so draw them one after the other
+        for (const bool packed : { false, true })
         {
-            if (!resource->IsCompiled())
-                continue;
+            if (packed && !has_packed)
+                break;
 
-            // Set pixel shader
-            pso.shader_pixel = static_cast<RHI_Shader*>(resource.get());
+            pso.shader_vertex        = packed ? shader_v_packed : shader_v;
+            pso.vertex_buffer_stride = vertex_stride(packed);
 
-            // Set pass name
-            pso.pass_name = pso.shader_pixel->GetName().c_str();
+            // Only useful to minimize D3D11 state changes (Vulkan backend is smarter)
+            uint32_t m_set_material_id = 0;
+        
+            // Iterate through all the G-Buffer shader variations
+            for (const shared_ptr<ShaderVariation>& resource : ShaderVariation::GetVariations())
+            {
+                if (!resource->IsCompiled())
+                    continue;
 
-            auto& entities = m_entities[object_type];
+                // Set pixel shader
+                pso.shader_pixel = static_cast<RHI_Shader*>(resource.get());
 
-            // Submit command list
-            if (cmd_list->Begin(pso))
-            {
-                for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
-                {
-                    Entity* entity = entities[i];
+                // Set pass name
+                pso.pass_name = pso.shader_pixel->GetName().c_str();
 
-                    // Get renderable
-                    const auto& renderable = entity->GetRenderable();
-                    if (!renderable)
-                        continue;
+                // Submit command list
+                if (cmd_list->Begin(pso))
+                {
+                    // Bindless, the textures of all materials are bound once (see UpdateMaterialBuffer())
+                    if (bindless)
+                    {
+                        cmd_list->SetTextureArray(32, m_material_textures);
+                    }
 
-                    // Get material
-                    Material* material = renderable->GetMaterial().get();
-                    if (!material)
-                        continue;
+                    for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+                    {
+                        Entity* entity = entities[i];
 
-                    // Skip transparent objects that won't contribute
-                    if (material->GetColorAlbedo().w == 0 && is_transparent)
-                        continue;
+                        // Get renderable
+                        const auto& renderable = entity->GetRenderable();
+                        if (!renderable)
+                            continue;
 
-                    // Get shader
-                    const auto& shader = material->GetShader();
-                    if (!shader || !shader->IsCompiled())
-                        continue;
+                        // Get material
+                        Material* material = renderable->GetMaterial().get();
+                        if (!material)
+                            continue;
 
-                    // Get geometry
-                    const auto& model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                        continue;
+                        // Skip transparent objects that won't contribute
+                        if (material->GetColorAlbedo().w == 0 && is_transparent)
+                            continue;
 
-                    // Draw matching shader entities
-                    if (pso.shader_pixel->GetId() == shader->GetId())
-                    {
-                        // Skip objects outside of the view frustum
-                        if (!m_camera->IsInViewFrustrum(renderable))
+                        // Get shader
+                        const auto& shader = material->GetShader();
+                        if (!shader || !shader->IsCompiled())
                             continue;
 
-                        // Set geometry (will only happen if not already set)
-                        cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                        cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                        // Get geometry
+                        const auto& model = renderable->GeometryModel();
+                        if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer() || model->IsVertexPacked() != packed)
+                            continue;
 
-                        // Bind material
-                        if (m_set_material_id != material->GetId())
+                        // Draw matching shader entities
+                        if (pso.shader_pixel->GetId() == shader->GetId())
                         {
-                            // Bind material textures		
-                            cmd_list->SetTexture(0, material->GetTexture_PtrRaw(TextureType_Albedo));
-                            cmd_list->SetTexture(1, material->GetTexture_PtrRaw(TextureType_Roughness));
-                            cmd_list->SetTexture(2, material->GetTexture_PtrRaw(TextureType_Metallic));
-                            cmd_list->SetTexture(3, material->GetTexture_PtrRaw(TextureType_Normal));
-                            cmd_list->SetTexture(4, material->GetTexture_PtrRaw(TextureType_Height));
-                            cmd_list->SetTexture(5, material->GetTexture_PtrRaw(TextureType_Occlusion));
-                            cmd_list->SetTexture(6, material->GetTexture_PtrRaw(TextureType_Emission));
-                            cmd_list->SetTexture(7, material->GetTexture_PtrRaw(TextureType_Mask));
-                        
-                            // Update uber buffer with material properties
-                            m_buffer_uber_cpu.mat_albedo        = material->GetColorAlbedo();
-                            m_buffer_uber_cpu.mat_tiling_uv     = material->GetTiling();
-                            m_buffer_uber_cpu.mat_offset_uv     = material->GetOffset();
-                            m_buffer_uber_cpu.mat_roughness_mul = material->GetMultiplier(TextureType_Roughness);
-                            m_buffer_uber_cpu.mat_metallic_mul  = material->GetMultiplier(TextureType_Metallic);
-                            m_buffer_uber_cpu.mat_normal_mul    = material->GetMultiplier(TextureType_Normal);
-                            m_buffer_uber_cpu.mat_height_mul    = material->GetMultiplier(TextureType_Height);
-
-                            // Update constant buffer
-                            UpdateUberBuffer();
-
-                            m_set_material_id = material->GetId();
-                        }
-                        
-                        // Update uber buffer with entity transform
-                        if (Transform* transform = entity->GetTransform())
-                        {
-                            m_buffer_object_cpu.object          = transform->GetMatrix();
-                            m_buffer_object_cpu.wvp_current     = transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
-                            m_buffer_object_cpu.wvp_previous    = transform->GetWvpLastFrame();
+                            // Skip objects outside of the view frustum (their constants weren't written)
+                            if (m_buffer_object_offsets[i] == numeric_limits<uint32_t>::max())
+                                continue;
 
-                            // Save matrix for velocity computation
-                            transform->SetWvpLastFrame(m_buffer_object_cpu.wvp_current);
+                            // Set geometry (will only happen if not already set)
+                            cmd_list->SetBufferIndex(model->GetIndexBuffer());
+                            cmd_list->SetBufferVertex(model->GetVertexBuffer());
 
-                            // Update object buffer
-                            if (!UpdateObjectBuffer(cmd_list, i))
-                                continue;
-                        }
+                            // Bind material (bindless materials only need their index, which is in the object buffer)
+                            if (!bindless && m_set_material_id != material->GetId())
+                            {
+                                // Bind material textures		
+                                cmd_list->SetTexture(0, material->GetTexture_PtrRaw(TextureType_Albedo));
+                                cmd_list->SetTexture(1, material->GetTexture_PtrRaw(TextureType_Roughness));
+                                cmd_list->SetTexture(2, material->GetTexture_PtrRaw(TextureType_Metallic));
+                                cmd_list->SetTexture(3, material->GetTexture_PtrRaw(TextureType_Normal));
+                                cmd_list->SetTexture(4, material->GetTexture_PtrRaw(TextureType_Height));
+                                cmd_list->SetTexture(5, material->GetTexture_PtrRaw(TextureType_Occlusion));
+                                cmd_list->SetTexture(6, material->GetTexture_PtrRaw(TextureType_Emission));
+                                cmd_list->SetTexture(7, material->GetTexture_PtrRaw(TextureType_Mask));
+                        
+                                // Update uber buffer with material properties
+                                m_buffer_uber_cpu.mat_albedo        = material->GetColorAlbedo();
+                                m_buffer_uber_cpu.mat_tiling_uv     = material->GetTiling();
+                                m_buffer_uber_cpu.mat_offset_uv     = material->GetOffset();
+                                m_buffer_uber_cpu.mat_roughness_mul = material->GetMultiplier(TextureType_Roughness);
+                                m_buffer_uber_cpu.mat_metallic_mul  = material->GetMultiplier(TextureType_Metallic);
+                                m_buffer_uber_cpu.mat_normal_mul    = material->GetMultiplier(TextureType_Normal);
+                                m_buffer_uber_cpu.mat_height_mul    = material->GetMultiplier(TextureType_Height);
+
+                                // Update constant buffer
+                                UpdateUberBuffer();
+
+                                m_set_material_id = material->GetId();
+                            }
+                        
+                            // Bind object buffer
+                            BindObjectBuffer(cmd_list, m_buffer_object_offsets[i]);
                         
-                        // Render	
-                        cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
-                        m_profiler->m_renderer_meshes_rendered++;
+                            // Render	
+                            const uint32_t lod = renderable->GeometryLodSelect(m_camera.get());
+                            cmd_list->DrawIndexed(renderable->GeometryIndexCount(lod), renderable->GeometryIndexOffset(lod), renderable->GeometryVertexOffset());
+                            m_profiler->m_renderer_meshes_rendered++;
+                        }
                     }
+                    cmd_list->End();
+                    cmd_list->Submit();
                 }
-                cmd_list->End();
-                cmd_list->Submit();
             }
         }
 	}
@@ -510,7 +868,7 @@ namespace Spartan
             return;
 
         // Acquire shaders
-        const auto& shader_v = m_shaders[Shader_Quad_V];
+        const auto& shader_v = m_shaders[Shader_Quad_Scaled_V];
         const auto& shader_p = m_shaders[Shader_Ssao_P];
         if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
             return;
@@ -520,19 +878,23 @@ namespace Spartan
         auto& tex_ssao_blurred  = m_render_targets[RenderTarget_Ssao];
         auto& tex_depth         = m_render_targets[RenderTarget_Gbuffer_Depth];
 
+        // The stencil can only mask passes at the full resolution, below it transparent objects get everything re-computed
+        const bool is_full_res  = GetOptionValue<uint32_t>(Option_Value_Ssao_Quality) == Renderer_Effect_Quality_Full;
+        const bool stencil      = use_stencil && is_full_res;
+
         // Set render state
         static RHI_PipelineState pipeline_state;
         pipeline_state.shader_vertex                            = shader_v.get();
         pipeline_state.shader_pixel                             = shader_p.get();
         pipeline_state.rasterizer_state                         = m_rasterizer_cull_back_solid.get();
         pipeline_state.blend_state                              = m_blend_disabled.get();
-        pipeline_state.depth_stencil_state                      = !use_stencil ? m_depth_stencil_disabled.get() : m_depth_stencil_disabled_enabled_read.get();
+        pipeline_state.depth_stencil_state                      = !stencil ? m_depth_stencil_disabled.get() : m_depth_stencil_disabled_enabled_read.get();
         pipeline_state.vertex_buffer_stride                     = m_quad.GetVertexBuffer()->GetStride();
-        pipeline_state.render_target_color_textures[0]          = use_stencil ? tex_ssao_blurred.get() : tex_ssao_noisy.get();
-        pipeline_state.clear_color[0]                           = use_stencil ? state_dont_clear_color : Vector4::One;
-        pipeline_state.render_target_depth_texture              = use_stencil ? tex_depth.get() : nullptr;
-        pipeline_state.render_target_depth_texture_read_only    = use_stencil;
-        pipeline_state.viewport                                 = tex_ssao_noisy->GetViewport();
+        pipeline_state.render_target_color_textures[0]          = stencil ? tex_ssao_blurred.get() : tex_ssao_noisy.get();
+        pipeline_state.clear_color[0]                           = stencil ? state_dont_clear_color : Vector4::One;
+        pipeline_state.render_target_depth_texture              = stencil ? tex_depth.get() : nullptr;
+        pipeline_state.render_target_depth_texture_read_only    = stencil;
+        pipeline_state.viewport                                 = GetViewportScaled(tex_ssao_noisy.get());
         pipeline_state.primitive_topology                       = RHI_PrimitiveTopology_TriangleList;
         pipeline_state.pass_name                                = "Pass_Ssao";
 
@@ -557,12 +919,18 @@ namespace Spartan
             const auto pixel_stride = 2.0f;
             Pass_BlurBilateralGaussian(
                 cmd_list,
-                use_stencil ? tex_ssao_blurred : tex_ssao_noisy,
-                use_stencil ? tex_ssao_noisy : tex_ssao_blurred,
+                stencil ? tex_ssao_blurred : tex_ssao_noisy,
+                stencil ? tex_ssao_noisy : tex_ssao_blurred,
                 sigma,
                 pixel_stride,
-                use_stencil
+                stencil
             );
+
+            // Recover the detail lost to the lower resolution over time (the result ends up in tex_ssao_blurred)
+            if (!is_full_res && !use_stencil)
+            {
+                Pass_TemporalAccumulate(cmd_list, tex_ssao_blurred, tex_ssao_noisy, m_render_targets[RenderTarget_Ssao_History]);
+            }
         }
 	}
 
@@ -572,7 +940,7 @@ namespace Spartan
             return;
 
         // Acquire shaders
-        const auto& shader_v = m_shaders[Shader_Quad_V];
+        const auto& shader_v = m_shaders[Shader_Quad_Scaled_V];
         const auto& shader_p = m_shaders[Shader_Ssr_P];
         if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
             return;
@@ -581,19 +949,22 @@ namespace Spartan
         auto& tex_ssr   = m_render_targets[RenderTarget_Ssr];
         auto& tex_depth = m_render_targets[RenderTarget_Gbuffer_Depth];
 
+        // The stencil can only mask passes at the full resolution, below it transparent objects get everything re-computed
+        const bool stencil = use_stencil && GetOptionValue<uint32_t>(Option_Value_Ssr_Quality) == Renderer_Effect_Quality_Full;
+
         // Set render state
         static RHI_PipelineState pipeline_state;
         pipeline_state.shader_vertex                            = shader_v.get();
         pipeline_state.shader_pixel                             = shader_p.get();
         pipeline_state.rasterizer_state                         = m_rasterizer_cull_back_solid.get();
         pipeline_state.blend_state                              = m_blend_disabled.get();
-        pipeline_state.depth_stencil_state                      = !use_stencil ? m_depth_stencil_disabled.get() : m_depth_stencil_disabled_enabled_read.get();
+        pipeline_state.depth_stencil_state                      = !stencil ? m_depth_stencil_disabled.get() : m_depth_stencil_disabled_enabled_read.get();
         pipeline_state.vertex_buffer_stride                     = m_quad.GetVertexBuffer()->GetStride();
         pipeline_state.render_target_color_textures[0]          = tex_ssr.get();
-        pipeline_state.clear_color[0]                           = use_stencil ? state_dont_clear_color : Vector4::Zero;
-        pipeline_state.render_target_depth_texture              = use_stencil ? tex_depth.get() : nullptr;
-        pipeline_state.render_target_depth_texture_read_only    = use_stencil;
-        pipeline_state.viewport                                 = tex_ssr->GetViewport();
+        pipeline_state.clear_color[0]                           = stencil ? state_dont_clear_color : Vector4::Zero;
+        pipeline_state.render_target_depth_texture              = stencil ? tex_depth.get() : nullptr;
+        pipeline_state.render_target_depth_texture_read_only    = stencil;
+        pipeline_state.viewport                                 = GetViewportScaled(tex_ssr.get());
         pipeline_state.primitive_topology                       = RHI_PrimitiveTopology_TriangleList;
         pipeline_state.pass_name                                = "Pass_Ssr";
 
@@ -647,17 +1018,17 @@ namespace Spartan
     void Renderer::Pass_Light(RHI_CommandList* cmd_list, const bool use_stencil)
     {
         // Acquire shaders
-        const auto& shader_v                = m_shaders[Shader_Quad_V];
+        const auto& shader_v                = m_shaders[Shader_Quad_Scaled_V];
         const auto& shader_p_directional    = m_shaders[Shader_LightDirectional_P];
         const auto& shader_p_point          = m_shaders[Shader_LightPoint_P];
         const auto& shader_p_spot           = m_shaders[Shader_LightSpot_P];
-        if (!shader_v->IsCompiled() || !shader_p_directional->IsCompiled() || !shader_p_point->IsCompiled() || !shader_p_spot->IsCompiled())
+        const auto& shader_p_clustered      = m_shaders[Shader_LightClustered_P];
+        if (!shader_v->IsCompiled() || !shader_p_directional->IsCompiled() || !shader_p_point->IsCompiled() || !shader_p_spot->IsCompiled() || !shader_p_clustered->IsCompiled())
             return;
 
         // Acquire render targets
         auto& tex_diffuse       = m_render_targets[RenderTarget_Light_Diffuse];
         auto& tex_specular      = m_render_targets[RenderTarget_Light_Specular];
-        auto& tex_volumetric    = m_render_targets[RenderTarget_Light_Volumetric];
         auto& tex_depth         = m_render_targets[RenderTarget_Gbuffer_Depth];
 
         // Update uber buffer
@@ -675,25 +1046,23 @@ namespace Spartan
         pipeline_state.clear_color[0]                           = Vector4::Zero;
         pipeline_state.render_target_color_textures[1]          = tex_specular.get();
         pipeline_state.clear_color[1]                           = Vector4::Zero;
-        pipeline_state.render_target_color_textures[2]          = tex_volumetric.get();
-        pipeline_state.clear_color[2]                           = Vector4::Zero;
         pipeline_state.render_target_depth_texture              = use_stencil ? tex_depth.get() : nullptr;
         pipeline_state.render_target_depth_texture_read_only    = use_stencil;
-        pipeline_state.viewport                                 = tex_diffuse->GetViewport();
+        pipeline_state.viewport                                 = GetViewportScaled(tex_diffuse.get());
         pipeline_state.primitive_topology                       = RHI_PrimitiveTopology_TriangleList;
         pipeline_state.pass_name                                = "Pass_Light";
 
-        auto draw_lights = [this, &cmd_list, &shader_p_directional, &shader_p_point, &shader_p_spot](Renderer_Object_Type type)
+        // Lights without shadows are binned into clusters (see UpdateClusterBuffers()), the clustered shader draws all of them at once
+        auto draw_lights = [this, &cmd_list](RHI_Shader* shader_p, const vector<Entity*>& entities, const bool clustered)
         {
-            const vector<Entity*>& entities = m_entities[type];
-            if (entities.empty())
-                return;
+            const bool draw = clustered ? !m_lights_clustered.empty() : any_of(entities.begin(), entities.end(), [this](Entity* entity)
+            {
+                const Light* light = entity->GetComponent<Light>();
+                return light && !IsLightClustered(light);
+            });
 
-            // Choose correct shader
-            RHI_Shader* shader_p = nullptr;
-            if (type == Renderer_Object_LightDirectional)   shader_p = shader_p_directional.get();
-            else if (type == Renderer_Object_LightPoint)    shader_p = shader_p_point.get();
-            else if (type == Renderer_Object_LightSpot)     shader_p = shader_p_spot.get();
+            if (!draw)
+                return;
 
             // Set pixel shader
             pipeline_state.shader_pixel = shader_p;
@@ -710,10 +1079,16 @@ namespace Spartan
                 cmd_list->SetTexture(26, (m_options & Render_ScreenSpaceReflections)         ? m_render_targets[RenderTarget_Ssr]    : m_tex_black);
                 cmd_list->SetTexture(27, m_render_targets[RenderTarget_Composition_Hdr_2]); // previous frame before post-processing
 
+                if (clustered)
+                {
+                    cmd_list->DrawIndexed(Rectangle::GetIndexCount());
+                }
+
                 // Iterate through all the light entities
                 for (const auto& entity : entities)
                 {
-                    if (Light* light = entity->GetComponent<Light>())
+                    Light* light = entity->GetComponent<Light>();
+                    if (light && !IsLightClustered(light))
                     {
                         // Update light buffer
                         UpdateLightBuffer(light);
@@ -752,15 +1127,157 @@ namespace Spartan
         };
 
         // Draw lights
-        draw_lights(Renderer_Object_LightDirectional);
-        draw_lights(Renderer_Object_LightPoint);
-        draw_lights(Renderer_Object_LightSpot);
+        draw_lights(shader_p_directional.get(),  m_entities[Renderer_Object_LightDirectional], false);
+        draw_lights(shader_p_point.get(),        m_entities[Renderer_Object_LightPoint], false);
+        draw_lights(shader_p_spot.get(),         m_entities[Renderer_Object_LightSpot], false);
+        draw_lights(shader_p_clustered.get(),    vector<Entity*>(), true);
+    }
+
+    void Renderer::Pass_LightVolumetric(RHI_CommandList* cmd_list, const bool use_stencil)
+    {
+        if ((m_options & Render_VolumetricLighting) == 0)
+            return;
+
+        // Acquire shaders
+        const auto& shader_v                = m_shaders[Shader_Quad_Scaled_V];
+        const auto& shader_p_directional    = m_shaders[Shader_LightDirectional_Volumetric_P];
+        const auto& shader_p_point          = m_shaders[Shader_LightPoint_Volumetric_P];
+        const auto& shader_p_spot           = m_shaders[Shader_LightSpot_Volumetric_P];
+        if (!shader_v->IsCompiled() || !shader_p_directional->IsCompiled() || !shader_p_point->IsCompiled() || !shader_p_spot->IsCompiled())
+            return;
+
+        // Acquire render targets
+        auto& tex_volumetric    = m_render_targets[RenderTarget_Light_Volumetric];
+        auto& tex_depth         = m_render_targets[RenderTarget_Gbuffer_Depth];
+
+        // The stencil can only mask passes at the full resolution, below it transparent objects get everything re-computed
+        const bool is_full_res  = GetOptionValue<uint32_t>(Option_Value_VolumetricLighting_Quality) == Renderer_Effect_Quality_Full;
+        const bool stencil      = use_stencil && is_full_res;
+
+        // Update uber buffer
+        m_buffer_uber_cpu.resolution = Vector2(static_cast<float>(tex_volumetric->GetWidth()), static_cast<float>(tex_volumetric->GetHeight()));
+        UpdateUberBuffer();
+
+        // Set render state
+        static RHI_PipelineState pipeline_state;
+        pipeline_state.shader_vertex                            = shader_v.get();
+        pipeline_state.shader_pixel                             = shader_p_directional.get();
+        pipeline_state.rasterizer_state                         = m_rasterizer_cull_back_solid.get();
+        pipeline_state.blend_state                              = m_blend_additive.get();
+        pipeline_state.depth_stencil_state                      = stencil ? m_depth_stencil_disabled_enabled_read.get() : m_depth_stencil_disabled.get();
+        pipeline_state.vertex_buffer_stride                     = m_quad.GetVertexBuffer()->GetStride();
+        pipeline_state.render_target_color_textures[0]          = tex_volumetric.get();
+        pipeline_state.clear_color[0]                           = Vector4::Zero;
+        pipeline_state.render_target_depth_texture              = stencil ? tex_depth.get() : nullptr;
+        pipeline_state.render_target_depth_texture_read_only    = stencil;
+        pipeline_state.viewport                                 = GetViewportScaled(tex_volumetric.get());
+        pipeline_state.primitive_topology                       = RHI_PrimitiveTopology_TriangleList;
+        pipeline_state.pass_name                                = "Pass_LightVolumetric";
+
+        // Only lights with shadows can be volumetric (the shadow map is what's ray-marched)
+        const auto is_volumetric = [](Entity* entity)
+        {
+            const Light* light = entity->GetComponent<Light>();
+            return light && light->GetShadowsEnabled() && light->GetVolumetricEnabled();
+        };
+
+        bool drawn = false;
+        const auto draw_lights = [this, &cmd_list, &tex_depth, &is_volumetric, &drawn](RHI_Shader* shader_p, const vector<Entity*>& entities, const uint32_t slot_depth)
+        {
+            if (none_of(entities.begin(), entities.end(), is_volumetric))
+                return;
+
+            // Set pixel shader
+            pipeline_state.shader_pixel = shader_p;
+
+            if (cmd_list->Begin(pipeline_state))
+            {
+                cmd_list->SetBufferVertex(m_quad.GetVertexBuffer());
+                cmd_list->SetBufferIndex(m_quad.GetIndexBuffer());
+                cmd_list->SetTexture(12, tex_depth);
+
+                for (Entity* entity : entities)
+                {
+                    if (!is_volumetric(entity))
+                        continue;
+
+                    Light* light = entity->GetComponent<Light>();
+                    UpdateLightBuffer(light);
+                    cmd_list->SetTexture(slot_depth, light->GetDepthTexture());
+                    cmd_list->DrawIndexed(Rectangle::GetIndexCount());
+                }
+
+                cmd_list->End();
+                cmd_list->Submit();
+                drawn = true;
+            }
+        };
+
+        // Draw lights
+        draw_lights(shader_p_directional.get(),  m_entities[Renderer_Object_LightDirectional],   13);
+        draw_lights(shader_p_point.get(),        m_entities[Renderer_Object_LightPoint],         15);
+        draw_lights(shader_p_spot.get(),         m_entities[Renderer_Object_LightSpot],          17);
+
+        // Composition reads the render target regardless, so it has to be cleared even if there was nothing to draw
+        if (!drawn)
+        {
+            cmd_list->Clear(pipeline_state);
+            return;
+        }
+
+        // Recover the detail lost to the lower resolution over time
+        if (!is_full_res && !use_stencil)
+        {
+            Pass_TemporalAccumulate(cmd_list, tex_volumetric, m_render_targets[RenderTarget_Light_Volumetric_2], m_render_targets[RenderTarget_Light_Volumetric_History]);
+        }
+    }
+
+    void Renderer::Pass_TemporalAccumulate(RHI_CommandList* cmd_list, shared_ptr<RHI_Texture>& tex_in, shared_ptr<RHI_Texture>& tex_out, shared_ptr<RHI_Texture>& tex_history)
+    {
+        // Acquire shaders
+        const auto& shader_v = m_shaders[Shader_Quad_Scaled_V];
+        const auto& shader_p = m_shaders[Shader_TemporalAccumulate_P];
+        if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
+            return;
+
+        // Set render state
+        static RHI_PipelineState pipeline_state;
+        pipeline_state.shader_vertex                    = shader_v.get();
+        pipeline_state.shader_pixel                     = shader_p.get();
+        pipeline_state.rasterizer_state                 = m_rasterizer_cull_back_solid.get();
+        pipeline_state.blend_state                      = m_blend_disabled.get();
+        pipeline_state.depth_stencil_state              = m_depth_stencil_disabled.get();
+        pipeline_state.vertex_buffer_stride             = m_quad.GetVertexBuffer()->GetStride();
+        pipeline_state.render_target_color_textures[0]  = tex_out.get();
+        pipeline_state.viewport                         = GetViewportScaled(tex_out.get());
+        pipeline_state.primitive_topology               = RHI_PrimitiveTopology_TriangleList;
+        pipeline_state.pass_name                        = "Pass_TemporalAccumulate";
+
+        // Submit commands
+        if (cmd_list->Begin(pipeline_state))
+        {
+            m_buffer_uber_cpu.resolution = Vector2(static_cast<float>(tex_out->GetWidth()), static_cast<float>(tex_out->GetHeight()));
+            UpdateUberBuffer();
+
+            cmd_list->SetBufferVertex(m_quad.GetVertexBuffer());
+            cmd_list->SetBufferIndex(m_quad.GetIndexBuffer());
+            cmd_list->SetTexture(28, tex_in);
+            cmd_list->SetTexture(29, tex_history);
+            cmd_list->SetTexture(11, m_render_targets[RenderTarget_Gbuffer_Velocity]);
+            cmd_list->DrawIndexed(Rectangle::GetIndexCount());
+            cmd_list->End();
+            cmd_list->Submit();
+        }
+
+        // Keep the result for the next frame, and hand it back through tex_in
+        Pass_Copy(cmd_list, tex_out, tex_history);
+        tex_in.swap(tex_out);
     }
 
 	void Renderer::Pass_Composition(RHI_CommandList* cmd_list, shared_ptr<RHI_Texture>& tex_out, const bool use_stencil)
 	{
         // Acquire shaders
-        const auto& shader_v = m_shaders[Shader_Quad_V];
+        const auto& shader_v = m_shaders[Shader_Quad_Scaled_V];
 		const auto& shader_p = m_shaders[Shader_Composition_P];
 		if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
 			return;
@@ -776,7 +1293,7 @@ namespace Spartan
         pipeline_state.render_target_color_textures[0]  = tex_out.get();
         pipeline_state.clear_color[0]                   = Vector4::Zero;
         pipeline_state.render_target_depth_texture      = use_stencil ? m_render_targets[RenderTarget_Gbuffer_Depth].get() : nullptr;
-        pipeline_state.viewport                         = tex_out->GetViewport();
+        pipeline_state.viewport                         = GetViewportScaled(tex_out.get());
         pipeline_state.primitive_topology               = RHI_PrimitiveTopology_TriangleList;
         pipeline_state.pass_name                        = "Pass_Composition";
 
@@ -813,7 +1330,7 @@ namespace Spartan
     void Renderer::Pass_AlphaBlend(RHI_CommandList* cmd_list, RHI_Texture* tex_in, RHI_Texture* tex_out, const bool use_stencil)
     {
         // Acquire shaders
-        const auto& shader_v    = m_shaders[Shader_Quad_V];
+        const auto& shader_v    = m_shaders[Shader_Quad_Scaled_V];
         const auto& shader_p    = m_shaders[Shader_Texture_P];
         if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
             return;
@@ -833,7 +1350,7 @@ namespace Spartan
         pipeline_state.render_target_color_textures[0]  = tex_out;
         pipeline_state.clear_color[0]                   = use_stencil ? state_dont_clear_color : Vector4::Zero;
         pipeline_state.render_target_depth_texture      = use_stencil ? m_render_targets[RenderTarget_Gbuffer_Depth].get() : nullptr;
-        pipeline_state.viewport                         = tex_out->GetViewport();
+        pipeline_state.viewport                         = GetViewportScaled(tex_out);
         pipeline_state.primitive_topology               = RHI_PrimitiveTopology_TriangleList;
         pipeline_state.pass_name                        = "Pass_AlphaBlend";
         
@@ -860,12 +1377,21 @@ namespace Spartan
         auto& tex_in_ldr    = m_render_targets[RenderTarget_Composition_Ldr];
         auto& tex_out_ldr   = m_render_targets[RenderTarget_Composition_Ldr_2];
 
-        // TAA	
+        // The composition only covers the render resolution, the passes below work at the full resolution
+        const bool is_scaled                = m_resolution_render != m_resolution;
+        const RHI_Texture* tex_composition  = tex_in_hdr.get();
+
+        // TAA (also upscales to the full resolution)
         if (GetOption(Render_AntiAliasing_Taa))
         {
             Pass_TAA(cmd_list, tex_in_hdr, tex_out_hdr);
             tex_in_hdr.swap(tex_out_hdr);
         }
+        else if (is_scaled)
+        {
+            Pass_Upscale(cmd_list, tex_in_hdr, tex_out_hdr);
+            tex_in_hdr.swap(tex_out_hdr);
+        }
 
         // Motion Blur
         if (GetOption(Render_MotionBlur))
@@ -891,6 +1417,12 @@ namespace Spartan
             Pass_Copy(cmd_list, tex_in_hdr, tex_in_ldr);
         }
 
+        // Next frame's lighting reads the previous frame out of Hdr_2 with screen uvs, so make sure it's not left holding the scaled composition
+        if (is_scaled && tex_out_hdr.get() == tex_composition)
+        {
+            tex_in_hdr.swap(tex_out_hdr);
+        }
+
         // Dithering
         if (GetOption(Render_Dithering))
         {
@@ -963,6 +1495,43 @@ namespace Spartan
         }
     }
 
+    void Renderer::Pass_Upscale(RHI_CommandList* cmd_list, shared_ptr<RHI_Texture>& tex_in, shared_ptr<RHI_Texture>& tex_out)
+    {
+        // Acquire shaders
+        const auto& shader_v = m_shaders[Shader_Quad_Scaled_V];
+        const auto& shader_p = m_shaders[Shader_Texture_P];
+        if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
+            return;
+
+        // Set render state
+        static RHI_PipelineState pipeline_state;
+        pipeline_state.shader_vertex                    = shader_v.get();
+        pipeline_state.shader_pixel                     = shader_p.get();
+        pipeline_state.rasterizer_state                 = m_rasterizer_cull_back_solid.get();
+        pipeline_state.blend_state                      = m_blend_disabled.get();
+        pipeline_state.depth_stencil_state              = m_depth_stencil_disabled.get();
+        pipeline_state.vertex_buffer_stride             = m_quad.GetVertexBuffer()->GetStride();
+        pipeline_state.render_target_color_textures[0]  = tex_out.get();
+        pipeline_state.clear_color[0]                   = state_dont_clear_color;
+        pipeline_state.viewport                         = tex_out->GetViewport();
+        pipeline_state.primitive_topology               = RHI_PrimitiveTopology_TriangleList;
+        pipeline_state.pass_name                        = "Pass_Upscale";
+
+        // Submit commands
+        if (cmd_list->Begin(pipeline_state))
+        {
+            m_buffer_uber_cpu.resolution = Vector2(static_cast<float>(tex_out->GetWidth()), static_cast<float>(tex_out->GetHeight()));
+            UpdateUberBuffer();
+
+            cmd_list->SetBufferVertex(m_quad.GetVertexBuffer());
+            cmd_list->SetBufferIndex(m_quad.GetIndexBuffer());
+            cmd_list->SetTexture(28, tex_in);
+            cmd_list->DrawIndexed(m_quad.GetIndexCount());
+            cmd_list->End();
+            cmd_list->Submit();
+        }
+    }
+
     void Renderer::Pass_Downsample(RHI_CommandList* cmd_list, shared_ptr<RHI_Texture>& tex_in, shared_ptr<RHI_Texture>& tex_out, const Renderer_Shader_Type pixel_shader)
     {
         // Acquire shaders
@@ -2039,8 +2608,8 @@ namespace Spartan
 
         if (const Entity* entity = m_gizmo_transform->GetSelectedEntity())
         {
-            // Get renderable
-            const Renderable* renderable = entity->GetRenderable();
+            // Get renderable (not const, picking a level of detail updates its bounding box)
+            Renderable* renderable = entity->GetRenderable();
             if (!renderable)
                 return;
 
@@ -2055,7 +2624,7 @@ namespace Spartan
                 return;
 
             // Acquire shaders
-            const auto& shader_v = m_shaders[Shader_Entity_V];
+            const auto& shader_v = m_shaders[model->IsVertexPacked() ? Shader_Entity_Packed_V : Shader_Entity_V];
             const auto& shader_p = m_shaders[Shader_Entity_Outline_P];
             if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
                 return;
@@ -2089,11 +2658,16 @@ namespace Spartan
                     UpdateUberBuffer();
                 }
 
+                // Update object buffer with vertex dequantization
+                SetObjectDequantization(m_buffer_object_cpu, model);
+                UpdateObjectBuffer(cmd_list);
+
                 cmd_list->SetTexture(12, tex_depth);
                 cmd_list->SetTexture(9, tex_normal);
                 cmd_list->SetBufferVertex(model->GetVertexBuffer());
                 cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                const uint32_t lod = renderable->GeometryLodSelect(m_camera.get());
+                cmd_list->DrawIndexed(renderable->GeometryIndexCount(lod), renderable->GeometryIndexOffset(lod), renderable->GeometryVertexOffset());
                 cmd_list->End();
                 cmd_list->Submit();
             }
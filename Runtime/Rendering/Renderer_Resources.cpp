@@ -49,10 +49,22 @@ namespace Spartan
 
         bool is_dynamic = true;
         m_buffer_object_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, is_dynamic);
-        m_buffer_object_gpu->Create<BufferObject>();
+        m_buffer_object_gpu->Create<BufferObject>(4096);
 
         m_buffer_light_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device);
         m_buffer_light_gpu->Create<BufferLight>();
+
+        m_buffer_cluster_lights_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device);
+        m_buffer_cluster_lights_gpu->Create<BufferClusterLights>();
+
+        m_buffer_cluster_grid_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device);
+        m_buffer_cluster_grid_gpu->Create<BufferClusterGrid>();
+
+        m_buffer_cluster_indices_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device);
+        m_buffer_cluster_indices_gpu->Create<BufferClusterIndices>();
+
+        m_buffer_material_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device);
+        m_buffer_material_gpu->Create<BufferMaterial>();
     }
 
     void Renderer::CreateDepthStencilStates()
@@ -109,19 +121,31 @@ namespace Spartan
         m_quad = Math::Rectangle(0, 0, m_resolution.x, m_resolution.y);
         m_quad.CreateBuffers(this);
 
+        // Render targets flagged as transient only live within a frame, the render graph aliases their memory
+
         // G-Buffer
         // Stencil is used to mask transparent objects and also has a read only version
         // From and below Texture_Format_R8G8B8A8_UNORM, normals have noticeable banding
-        m_render_targets[RenderTarget_Gbuffer_Albedo]   = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R8G8B8A8_Unorm);
-        m_render_targets[RenderTarget_Gbuffer_Normal]   = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16B16A16_Float);
-        m_render_targets[RenderTarget_Gbuffer_Material] = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R8G8B8A8_Unorm);
-        m_render_targets[RenderTarget_Gbuffer_Velocity] = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16_Float);
-        m_render_targets[RenderTarget_Gbuffer_Depth]    = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_D32_Float_S8X24_Uint, 1, RHI_Texture_DepthStencilViewReadOnly);
+        m_render_targets[RenderTarget_Gbuffer_Albedo]   = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R8G8B8A8_Unorm, 1, RHI_Texture_Transient);
+        m_render_targets[RenderTarget_Gbuffer_Normal]   = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16B16A16_Float, 1, RHI_Texture_Transient);
+        m_render_targets[RenderTarget_Gbuffer_Material] = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R8G8B8A8_Unorm, 1, RHI_Texture_Transient);
+        m_render_targets[RenderTarget_Gbuffer_Velocity] = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16_Float, 1, RHI_Texture_Transient);
+        m_render_targets[RenderTarget_Gbuffer_Depth]    = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_D32_Float_S8X24_Uint, 1, RHI_Texture_DepthStencilViewReadOnly | RHI_Texture_Transient);
 
         // Light
-        m_render_targets[RenderTarget_Light_Diffuse]    = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float);
-        m_render_targets[RenderTarget_Light_Specular]   = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float);
-        m_render_targets[RenderTarget_Light_Volumetric] = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float);
+        m_render_targets[RenderTarget_Light_Diffuse]    = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, RHI_Texture_Transient);
+        m_render_targets[RenderTarget_Light_Specular]   = make_unique<RHI_Texture2D>(m_context, width, height, RHI_Format_R11G11B10_Float, 1, RHI_Texture_Transient);
+
+        // Screen space effects run at a fraction of the resolution, depending on their Renderer_Effect_Quality
+        // Below the full resolution they are accumulated over time, the history has to outlive the frame, so it's not transient
+        const uint32_t volumetric_shift = GetOptionValue<uint32_t>(Option_Value_VolumetricLighting_Quality);
+        const uint32_t ssao_shift       = GetOptionValue<uint32_t>(Option_Value_Ssao_Quality);
+        const uint32_t ssr_shift        = GetOptionValue<uint32_t>(Option_Value_Ssr_Quality);
+
+        // Volumetric light
+        m_render_targets[RenderTarget_Light_Volumetric]         = make_unique<RHI_Texture2D>(m_context, width >> volumetric_shift, height >> volumetric_shift, RHI_Format_R11G11B10_Float, 1, RHI_Texture_Transient);
+        m_render_targets[RenderTarget_Light_Volumetric_2]       = make_unique<RHI_Texture2D>(m_context, width >> volumetric_shift, height >> volumetric_shift, RHI_Format_R11G11B10_Float, 1, RHI_Texture_Transient);
+        m_render_targets[RenderTarget_Light_Volumetric_History] = make_unique<RHI_Texture2D>(m_context, width >> volumetric_shift, height >> volumetric_shift, RHI_Format_R11G11B10_Float);
 
         // BRDF Specular Lut
         m_render_targets[RenderTarget_Brdf_Specular_Lut] = make_unique<RHI_Texture2D>(m_context, 400, 400, RHI_Format_R8G8_Unorm);
@@ -139,17 +163,18 @@ namespace Spartan
         }
 
         // SSAO
-        m_render_targets[RenderTarget_Ssao_Noisy]   = make_unique<RHI_Texture2D>(m_context, static_cast<uint32_t>(width), static_cast<uint32_t>(height), RHI_Format_R8_Unorm);
-        m_render_targets[RenderTarget_Ssao]         = make_unique<RHI_Texture2D>(m_context, static_cast<uint32_t>(width), static_cast<uint32_t>(height), RHI_Format_R8_Unorm);
+        m_render_targets[RenderTarget_Ssao_Noisy]   = make_unique<RHI_Texture2D>(m_context, width >> ssao_shift, height >> ssao_shift, RHI_Format_R8_Unorm, 1, RHI_Texture_Transient);
+        m_render_targets[RenderTarget_Ssao]         = make_unique<RHI_Texture2D>(m_context, width >> ssao_shift, height >> ssao_shift, RHI_Format_R8_Unorm, 1, RHI_Texture_Transient);
+        m_render_targets[RenderTarget_Ssao_History] = make_unique<RHI_Texture2D>(m_context, width >> ssao_shift, height >> ssao_shift, RHI_Format_R8_Unorm);
 
         // SSR
-        m_render_targets[RenderTarget_Ssr] = make_shared<RHI_Texture2D>(m_context, width, height, RHI_Format_R16G16_Float, 1, RHI_Texture_UnorderedAccessView);
+        m_render_targets[RenderTarget_Ssr] = make_shared<RHI_Texture2D>(m_context, width >> ssr_shift, height >> ssr_shift, RHI_Format_R16G16_Float, 1, RHI_Texture_UnorderedAccessView | RHI_Texture_Transient);
 
         // Bloom
         {
             // Create as many bloom textures as required to scale down to or below 16px (in any dimension)
             m_render_tex_bloom.clear();
-            m_render_tex_bloom.emplace_back(make_unique<RHI_Texture2D>(m_context, width / 2, height / 2, RHI_Format_R11G11B10_Float));
+            m_render_tex_bloom.emplace_back(make_unique<RHI_Texture2D>(m_context, width / 2, height / 2, RHI_Format_R11G11B10_Float, 1, RHI_Texture_Transient));
             while (m_render_tex_bloom.back()->GetWidth() > 16 && m_render_tex_bloom.back()->GetHeight() > 16)
             {
                 m_render_tex_bloom.emplace_back(
@@ -157,13 +182,38 @@ namespace Spartan
                         m_context,
                         m_render_tex_bloom.back()->GetWidth() / 2,
                         m_render_tex_bloom.back()->GetHeight() / 2,
-                        RHI_Format_R11G11B10_Float
+                        RHI_Format_R11G11B10_Float,
+                        1,
+                        RHI_Texture_Transient
                         )
                 );
             }
         }
     }
 
+    void Renderer::CreateRenderTexturesTransient()
+    {
+        // New textures with the same description, they have no memory yet, so the render graph can bind them for the new lifetimes.
+        // Everything else (histories, composition, etc.) is kept, so that temporal effects don't lose what they accumulated.
+        auto recreate = [this](shared_ptr<RHI_Texture>& texture)
+        {
+            if (texture && texture->IsTransient())
+            {
+                texture = make_shared<RHI_Texture2D>(m_context, texture->GetWidth(), texture->GetHeight(), texture->GetFormat(), texture->GetArraySize(), texture->GetFlags());
+            }
+        };
+
+        for (auto& it : m_render_targets)
+        {
+            recreate(it.second);
+        }
+
+        for (shared_ptr<RHI_Texture>& texture : m_render_tex_bloom)
+        {
+            recreate(texture);
+        }
+    }
+
     void Renderer::CreateShaders()
     {
         // Get standard shader directory
@@ -173,15 +223,26 @@ namespace Spartan
         m_shaders[Shader_Quad_V] = make_shared<RHI_Shader>(m_rhi_device);
         m_shaders[Shader_Quad_V]->CompileAsync<RHI_Vertex_PosTex>(m_context, RHI_Shader_Vertex, dir_shaders + "Quad.hlsl");
 
+        // Quad - Scaled (samples the part of the scene render targets that holds the scene)
+        m_shaders[Shader_Quad_Scaled_V] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_Quad_Scaled_V]->AddDefine("RESOLUTION_SCALED");
+        m_shaders[Shader_Quad_Scaled_V]->CompileAsync<RHI_Vertex_PosTex>(m_context, RHI_Shader_Vertex, dir_shaders + "Quad.hlsl");
+
         // Depth Vertex
         m_shaders[Shader_Depth_V] = make_shared<RHI_Shader>(m_rhi_device);
         m_shaders[Shader_Depth_V]->CompileAsync<RHI_Vertex_PosTex>(m_context, RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+        m_shaders[Shader_Depth_Packed_V] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_Depth_Packed_V]->AddDefine("VERTEX_PACKED");
+        m_shaders[Shader_Depth_Packed_V]->CompileAsync<RHI_Vertex_PosTexNorTan_Packed>(m_context, RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
         m_shaders[Shader_Depth_P] = make_shared<RHI_Shader>(m_rhi_device);
         m_shaders[Shader_Depth_P]->CompileAsync(m_context, RHI_Shader_Pixel, dir_shaders + "Depth.hlsl");
 
         // G-Buffer
         m_shaders[Shader_Gbuffer_V] = make_shared<RHI_Shader>(m_rhi_device);
         m_shaders[Shader_Gbuffer_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(m_context, RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+        m_shaders[Shader_Gbuffer_Packed_V] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_Gbuffer_Packed_V]->AddDefine("VERTEX_PACKED");
+        m_shaders[Shader_Gbuffer_Packed_V]->CompileAsync<RHI_Vertex_PosTexNorTan_Packed>(m_context, RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
 
         // BRDF - Specular Lut
         m_shaders[Shader_BrdfSpecularLut] = make_shared<RHI_Shader>(m_rhi_device);
@@ -203,6 +264,25 @@ namespace Spartan
         m_shaders[Shader_LightSpot_P]->AddDefine("SPOT");
         m_shaders[Shader_LightSpot_P]->CompileAsync(m_context, RHI_Shader_Pixel, dir_shaders + "Light.hlsl");
 
+        // Light - Clustered
+        m_shaders[Shader_LightClustered_P] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_LightClustered_P]->AddDefine("CLUSTERED");
+        m_shaders[Shader_LightClustered_P]->CompileAsync(m_context, RHI_Shader_Pixel, dir_shaders + "Light.hlsl");
+
+        // Light - Volumetric
+        m_shaders[Shader_LightDirectional_Volumetric_P] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_LightDirectional_Volumetric_P]->AddDefine("DIRECTIONAL");
+        m_shaders[Shader_LightDirectional_Volumetric_P]->AddDefine("VOLUMETRIC");
+        m_shaders[Shader_LightDirectional_Volumetric_P]->CompileAsync(m_context, RHI_Shader_Pixel, dir_shaders + "Light.hlsl");
+        m_shaders[Shader_LightPoint_Volumetric_P] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_LightPoint_Volumetric_P]->AddDefine("POINT");
+        m_shaders[Shader_LightPoint_Volumetric_P]->AddDefine("VOLUMETRIC");
+        m_shaders[Shader_LightPoint_Volumetric_P]->CompileAsync(m_context, RHI_Shader_Pixel, dir_shaders + "Light.hlsl");
+        m_shaders[Shader_LightSpot_Volumetric_P] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_LightSpot_Volumetric_P]->AddDefine("SPOT");
+        m_shaders[Shader_LightSpot_Volumetric_P]->AddDefine("VOLUMETRIC");
+        m_shaders[Shader_LightSpot_Volumetric_P]->CompileAsync(m_context, RHI_Shader_Pixel, dir_shaders + "Light.hlsl");
+
         // Texture
         m_shaders[Shader_Texture_P] = make_shared<RHI_Shader>(m_rhi_device);
         m_shaders[Shader_Texture_P]->AddDefine("PASS_TEXTURE");
@@ -322,6 +402,11 @@ namespace Spartan
         m_shaders[Shader_BlurGaussianBilateral_P]->AddDefine("PASS_BLUR_BILATERAL_GAUSSIAN");
         m_shaders[Shader_BlurGaussianBilateral_P]->CompileAsync(m_context, RHI_Shader_Pixel, dir_shaders + "Quad.hlsl");
 
+        // Temporal accumulation
+        m_shaders[Shader_TemporalAccumulate_P] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_TemporalAccumulate_P]->AddDefine("PASS_TEMPORAL_ACCUMULATE");
+        m_shaders[Shader_TemporalAccumulate_P]->CompileAsync(m_context, RHI_Shader_Pixel, dir_shaders + "Quad.hlsl");
+
         // SSAO
         m_shaders[Shader_Ssao_P] = make_shared<RHI_Shader>(m_rhi_device);
         m_shaders[Shader_Ssao_P]->CompileAsync(m_context, RHI_Shader_Pixel, dir_shaders + "SSAO.hlsl");
@@ -333,6 +418,9 @@ namespace Spartan
         // Entity
         m_shaders[Shader_Entity_V] = make_shared<RHI_Shader>(m_rhi_device);
         m_shaders[Shader_Entity_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(m_context, RHI_Shader_Vertex, dir_shaders + "Entity.hlsl");
+        m_shaders[Shader_Entity_Packed_V] = make_shared<RHI_Shader>(m_rhi_device);
+        m_shaders[Shader_Entity_Packed_V]->AddDefine("VERTEX_PACKED");
+        m_shaders[Shader_Entity_Packed_V]->CompileAsync<RHI_Vertex_PosTexNorTan_Packed>(m_context, RHI_Shader_Vertex, dir_shaders + "Entity.hlsl");
 
         // Entity - Transform
         m_shaders[Shader_Entity_Transform_P] = make_shared<RHI_Shader>(m_rhi_device);
@@ -19,9 +19,11 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES ===============
+//= INCLUDES ==========================
 #include "ShaderVariation.h"
-//==========================
+#include "../RHI/RHI_Device.h"
+#include "../RHI/RHI_Implementation.h"
+//=====================================
 
 //= NAMESPACES =====
 using namespace std;
@@ -71,5 +73,8 @@ namespace Spartan
 		AddDefine("OCCLUSION_MAP",	HasOcclusionTexture()	? "1" : "0");
 		AddDefine("EMISSION_MAP",	HasEmissionTexture()	? "1" : "0");
 		AddDefine("MASK_MAP",		HasMaskTexture()		? "1" : "0");
+
+		// Material properties and textures come from the material buffer and texture table (see Renderer::UpdateMaterialBuffer())
+		AddDefine("BINDLESS",		m_rhi_device->GetContextRhi()->bindless_textures ? "1" : "0");
 	}
 }
@@ -23,11 +23,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =========================
 #include "ImageImporter.h"
+#include <array>
 #include <FreeImage.h>
 #include <Utilities.h>
+#include "TextureCompressor.h"
 #include "../../Threading/Threading.h"
 #include "../../Core/Settings.h"
+#include "../../Math/Simd.h"
 #include "../../Math/MathHelper.h"
+#include "../../Rendering/Renderer.h"
+#include "../../RHI/RHI_Device.h"
 #include "../../RHI/RHI_Texture2D.h"
 //====================================
 
@@ -39,22 +44,149 @@ namespace _ImagImporter
 {
 	static FREE_IMAGE_FILTER rescale_filter = FILTER_LANCZOS3;
 
-	// A struct that rescaling threads will work with
-	struct RescaleJob
+	// Opaque color is compressed to BC1, unless its top mip falls below this (dB), then it gets BC7 at twice the size
+	static const float bc1_psnr_min = 38.0f;
+
+	// Taps of a separable 2:1 downsample, output texel i reads source texels 2i + first ... 2i + first + count - 1
+	struct MipFilter
 	{
-		uint32_t width		    = 0;
-		uint32_t height		    = 0;
-		uint32_t channels	    = 0;
-		vector<std::byte>* data	= nullptr;
-		bool done			    = false;
+		float weights[6]	= {};
+		uint32_t count		= 0;
+		int32_t first		= 0;
+	};
+
+	// Averages the two texels under each output texel, normal maps use it since it doesn't ring (they are renormalized anyway)
+	static const MipFilter& mip_filter_box()
+	{
+		static const MipFilter filter = { { 0.5f, 0.5f }, 2, 0 };
+		return filter;
+	}
 
-		RescaleJob(const uint32_t width, const uint32_t height, const uint32_t channels)
+	// Kaiser windowed sinc over the six closest texels, sharper than a box and without its aliasing
+	static const MipFilter& mip_filter_kaiser()
+	{
+		static const MipFilter filter = []()
 		{
-			this->width		= width;
-			this->height	= height;
-			this->channels	= channels;
+			const auto bessel_i0 = [](const float x)
+			{
+				float sum	= 1.0f;
+				float term	= 1.0f;
+				for (uint32_t k = 1; k < 16; k++)
+				{
+					term	*= (x / (2.0f * k)) * (x / (2.0f * k));
+					sum		+= term;
+				}
+				return sum;
+			};
+
+			const float pi		= 3.14159265358979f;
+			const float alpha	= 4.0f;
+			const float radius	= 3.0f;
+
+			MipFilter kaiser;
+			kaiser.count	= 6;
+			kaiser.first	= -2;
+			float sum		= 0.0f;
+			for (uint32_t i = 0; i < kaiser.count; i++)
+			{
+				// Distance from the output texel center, in source texels
+				const float d		= static_cast<float>(i) - 2.5f;
+				const float x		= d / radius;
+				const float sinc	= sin(pi * d * 0.5f) / (pi * d * 0.5f);
+				const float window	= bessel_i0(alpha * sqrt(1.0f - x * x)) / bessel_i0(alpha);
+				kaiser.weights[i]	= sinc * window;
+				sum					+= kaiser.weights[i];
+			}
+			for (float& weight : kaiser.weights)
+			{
+				weight /= sum;
+			}
+
+			return kaiser;
+		}();
+
+		return filter;
+	}
+
+	static float srgb_to_linear(const float x) { return x <= 0.04045f ? x / 12.92f : pow((x + 0.055f) / 1.055f, 2.4f); }
+	static float linear_to_srgb(const float x) { return x <= 0.0031308f ? x * 12.92f : 1.055f * pow(x, 1.0f / 2.4f) - 0.055f; }
+
+	// Unpacks a row of texels to four floats each (missing channels are 0), sRGB color is converted to linear
+	static void mip_decode_row(const std::byte* texels, const uint32_t count, const uint32_t channels, const uint32_t bytes_per_channel, const bool is_srgb, float* output)
+	{
+		static const auto srgb_table = []()
+		{
+			array<float, 256> table;
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				table[i] = srgb_to_linear(i / 255.0f);
+			}
+			return table;
+		}();
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				float value = 0.0f;
+				if (c < channels)
+				{
+					const uint32_t index = i * channels + c;
+					if (bytes_per_channel == 1)
+					{
+						const uint8_t byte	= static_cast<uint8_t>(texels[index]);
+						value				= (is_srgb && c < 3) ? srgb_table[byte] : byte / 255.0f;
+					}
+					else
+					{
+						memcpy(&value, &texels[index * sizeof(float)], sizeof(float));
+					}
+				}
+				output[i * 4 + c] = value;
+			}
 		}
-	};
+	}
+
+	// The reverse of mip_decode_row()
+	static void mip_encode_row(const float* texels, const uint32_t count, const uint32_t channels, const uint32_t bytes_per_channel, const bool is_srgb, std::byte* output)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			for (uint32_t c = 0; c < channels; c++)
+			{
+				const uint32_t index = i * channels + c;
+				const float value	 = texels[i * 4 + c];
+				if (bytes_per_channel == 1)
+				{
+					const float value_encoded	= (is_srgb && c < 3) ? linear_to_srgb(value) : value;
+					output[index]				= static_cast<std::byte>(static_cast<uint8_t>(Spartan::Math::Clamp(value_encoded, 0.0f, 1.0f) * 255.0f + 0.5f));
+				}
+				else
+				{
+					memcpy(&output[index * sizeof(float)], &value, sizeof(float));
+				}
+			}
+		}
+	}
+
+	// Normals are stored as n * 0.5 + 0.5, filtering shortens them
+	static void mip_renormalize_row(float* texels, const uint32_t count)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			float* texel	= &texels[i * 4];
+			const float x	= texel[0] * 2.0f - 1.0f;
+			const float y	= texel[1] * 2.0f - 1.0f;
+			const float z	= texel[2] * 2.0f - 1.0f;
+			const float length = sqrt(x * x + y * y + z * z);
+			if (length > 1e-6f)
+			{
+				texel[0] = x / length * 0.5f + 0.5f;
+				texel[1] = y / length * 0.5f + 0.5f;
+				texel[2] = z / length * 0.5f + 0.5f;
+			}
+		}
+	}
 }
 
 namespace Spartan
@@ -150,20 +282,28 @@ namespace Spartan
 		// If the texture supports mipmaps, generate them
 		if (generate_mipmaps)
 		{
-			GenerateMipmaps(bitmap, texture, image_width, image_height, image_channels);
+			GenerateMipmaps(texture, image_width, image_height, image_channels, ComputeBitsPerChannel(bitmap), image_is_grayscale);
 		}
 
 		// Free memory 
 		FreeImage_Unload(bitmap);
 
+		// Block compress the mips, if the texture asked for it
+		RHI_Format texture_format = image_format;
+		if ((texture->GetFlags() & RHI_Texture_CompressWhenLoading) && image_format == RHI_Format_R8G8B8A8_Unorm)
+		{
+			texture_format = CompressMipmaps(file_path, texture, image_width, image_height, image_is_grayscale, image_is_transparent);
+		}
+		const bool is_compressed = TextureCompressor::IsBlockFormat(texture_format);
+
 		// Fill RHI_Texture with image properties
-		texture->SetBpp(image_bpp);
+		texture->SetBpp(is_compressed ? TextureCompressor::GetBlockSize(texture_format) / 2 : image_bpp); // a 4x4 block's bits per texel
 		texture->SetBpc(image_bytes_per_channel);
 		texture->SetWidth(image_width);
 		texture->SetHeight(image_height);
 		texture->SetChannels(image_channels);
 		texture->SetTransparency(image_is_transparent);
-		texture->SetFormat(image_format);
+		texture->SetFormat(texture_format);
 		texture->SetGrayscale(image_is_grayscale);
 
 		return true;
@@ -193,65 +333,132 @@ namespace Spartan
 		return true;
 	}
 
-	void ImageImporter::GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels)
+	void ImageImporter::GenerateMipmaps(RHI_Texture* texture, uint32_t width, uint32_t height, const uint32_t channels, const uint32_t bytes_per_channel, const bool is_grayscale)
 	{
-		if (!texture)
+		if (!texture || channels == 0 || channels > 4 || (bytes_per_channel != 1 && bytes_per_channel != sizeof(float)))
 		{
 			LOG_ERROR_INVALID_PARAMETER();
 			return;
 		}
-	
-		// Create a RescaleJob for every mip that we need
-		vector<_ImagImporter::RescaleJob> jobs;
+
+		// Color is filtered in linear space, normal maps are renormalized (grayscale ones are height maps)
+		const uint16_t flags					= texture->GetFlags();
+		const bool is_srgb						= (flags & RHI_Texture_Srgb) && bytes_per_channel == 1;
+		const bool is_normal					= (flags & RHI_Texture_NormalMap) && !is_grayscale;
+		const _ImagImporter::MipFilter& filter	= is_normal ? _ImagImporter::mip_filter_box() : _ImagImporter::mip_filter_kaiser();
+		Threading* threading					= m_context->GetSubsystem<Threading>();
+
+		// Every level is filtered from the previous one as it's stored (8-bit levels stay 8-bit), decoding source rows as the filter
+		// reaches them. Full precision is only needed for a few rows at a time, so large textures don't need a float copy of themselves.
+		const size_t texel_size	= static_cast<size_t>(channels) * bytes_per_channel;
+		uint32_t level_index	= 0;
 		while (width > 1 && height > 1)
 		{
-			width	= Math::Max(width / 2, static_cast<uint32_t>(1));
-			height	= Math::Max(height / 2, static_cast<uint32_t>(1));
-			jobs.emplace_back(width, height, channels);
-			
-			// Resize the RHI_Texture vector accordingly
-			const auto size = width * height * channels;
-			auto mip		= texture->AddMipmap();
-			mip->reserve(size);
-			mip->resize(size);
+			const uint32_t mip_width	= width / 2;
+			const uint32_t mip_height	= height / 2;
+
+			vector<std::byte>* mip = texture->AddMipmap();
+			mip->resize(mip_width * mip_height * texel_size);
+			const std::byte* texels_in	= texture->GetData(level_index)->data();
+			std::byte* texels_out		= mip->data();
+
+			// Output rows are split in batches, so that the scratch rows are allocated once per batch
+			const uint32_t batch_size	= 16;
+			const uint32_t batch_count	= (mip_height + batch_size - 1) / batch_size;
+			threading->ParallelFor(batch_count, [&](const uint32_t batch)
+			{
+				vector<float> row_decoded(width * 4);
+				vector<float> row_vertical(width * 4);
+				vector<float> row_out(mip_width * 4);
+
+				const uint32_t end = Math::Min((batch + 1) * batch_size, mip_height);
+				for (uint32_t y = batch * batch_size; y < end; y++)
+				{
+					// Vertical pass, accumulating whole source rows, so that the reads stay sequential
+					fill(row_vertical.begin(), row_vertical.end(), 0.0f);
+					for (uint32_t tap = 0; tap < filter.count; tap++)
+					{
+						const int32_t y_in				= Math::Clamp(static_cast<int32_t>(y * 2 + tap) + filter.first, 0, static_cast<int32_t>(height) - 1);
+						const Math::Simd::float4 weight	= Math::Simd::Splat(filter.weights[tap]);
+						_ImagImporter::mip_decode_row(texels_in + static_cast<size_t>(y_in) * width * texel_size, width, channels, bytes_per_channel, is_srgb, row_decoded.data());
+						for (uint32_t x = 0; x < width; x++)
+						{
+							const Math::Simd::float4 sum = Math::Simd::LoadUnaligned(&row_vertical[x * 4]);
+							Math::Simd::StoreUnaligned(&row_vertical[x * 4], Math::Simd::Add(sum, Math::Simd::Mul(Math::Simd::LoadUnaligned(&row_decoded[x * 4]), weight)));
+						}
+					}
+
+					// Horizontal pass, the row gets half as wide (and the kernel's negative lobes can overshoot)
+					for (uint32_t x = 0; x < mip_width; x++)
+					{
+						Math::Simd::float4 sum = Math::Simd::Splat(0.0f);
+						for (uint32_t tap = 0; tap < filter.count; tap++)
+						{
+							const int32_t x_in	= Math::Clamp(static_cast<int32_t>(x * 2 + tap) + filter.first, 0, static_cast<int32_t>(width) - 1);
+							sum					= Math::Simd::Add(sum, Math::Simd::Mul(Math::Simd::LoadUnaligned(&row_vertical[x_in * 4]), Math::Simd::Splat(filter.weights[tap])));
+						}
+						Math::Simd::StoreUnaligned(&row_out[x * 4], Math::Simd::Max(sum, Math::Simd::Splat(0.0f)));
+					}
+
+					if (is_normal)
+					{
+						_ImagImporter::mip_renormalize_row(row_out.data(), mip_width);
+					}
+
+					_ImagImporter::mip_encode_row(row_out.data(), mip_width, channels, bytes_per_channel, is_srgb, texels_out + static_cast<size_t>(y) * mip_width * texel_size);
+				}
+			});
+
+			width	= mip_width;
+			height	= mip_height;
+			level_index++;
 		}
+	}
 
-		// Pass data pointers (now that the RHI_Texture mip vector has been constructed)
-		for (uint32_t i = 0; i < jobs.size(); i++)
+	RHI_Format ImageImporter::CompressMipmaps(const string& file_path, RHI_Texture* texture, const uint32_t width, const uint32_t height, const bool is_grayscale, const bool is_transparent) const
+	{
+		// The top mip of a block compressed texture has to be a multiple of the block size (4x4)
+		if (width % 4 != 0 || height % 4 != 0 || !m_context->GetSubsystem<Renderer>()->GetRhiDevice()->IsBlockCompressionSupported())
+			return RHI_Format_R8G8B8A8_Unorm;
+
+		// Normal maps which are grayscale are height maps (the model importer moves them to the height slot).
+		// Only grayscale images go to BC4, masks are sampled as rgb and only for grayscale images the red channel carries everything.
+		const uint16_t flags	= texture->GetFlags();
+		RHI_Format format		= is_transparent ? RHI_Format_BC7_Unorm : RHI_Format_BC1_Unorm;
+		if ((flags & RHI_Texture_NormalMap) && !is_grayscale)
+		{
+			format = RHI_Format_BC5_Unorm;
+		}
+		else if (is_grayscale && !is_transparent && !(flags & RHI_Texture_Srgb))
 		{
-			// reminder: i + 1 because the 0 mip is the default image size
-			jobs[i].data = texture->GetData(i + 1);
+			format = RHI_Format_BC4_Unorm;
 		}
 
-		// Parallelize mipmap generation using multiple threads (because FreeImage_Rescale() using FILTER_LANCZOS3 is expensive)
-		auto threading = m_context->GetSubsystem<Threading>();
-		for (auto& job : jobs)
+		// Compress the top mip and measure what got lost
+		Threading* threading		= m_context->GetSubsystem<Threading>();
+		vector<std::byte>* mip_top	= texture->GetData(0);
+		vector<std::byte> blocks	= TextureCompressor::Compress(*mip_top, width, height, format, threading);
+		float psnr					= TextureCompressor::ComputePsnr(*mip_top, TextureCompressor::Decompress(blocks, width, height, format), format);
+		if (format == RHI_Format_BC1_Unorm && psnr < _ImagImporter::bc1_psnr_min)
 		{
-			threading->AddTask([this, &job, &bitmap]()
-			{
-				const auto bitmap_scaled = FreeImage_Rescale(bitmap, job.width, job.height, _ImagImporter::rescale_filter);
-				if (!GetBitsFromFibitmap(job.data, bitmap_scaled, job.width, job.height, job.channels))
-				{
-					LOG_ERROR("Failed to create mip level %dx%d", job.width, job.height);
-				}
-				FreeImage_Unload(bitmap_scaled);
-				job.done = true;
-			});
+			format	= RHI_Format_BC7_Unorm;
+			blocks	= TextureCompressor::Compress(*mip_top, width, height, format, threading);
+			psnr	= TextureCompressor::ComputePsnr(*mip_top, TextureCompressor::Decompress(blocks, width, height, format), format);
 		}
+		*mip_top = move(blocks);
 
-		// Wait until all mipmaps have been generated
-		auto ready = false;
-		while (!ready)
+		// Compress the rest of the chain
+		for (uint32_t i = 1; i < static_cast<uint32_t>(texture->GetData().size()); i++)
 		{
-			ready = true;
-			for (const auto& job : jobs)
-			{
-				if (!job.done)
-				{
-					ready = false;
-				}
-			}
+			const uint32_t mip_width	= Math::Max(width >> i, static_cast<uint32_t>(1));
+			const uint32_t mip_height	= Math::Max(height >> i, static_cast<uint32_t>(1));
+			vector<std::byte>* mip		= texture->GetData(i);
+			*mip = TextureCompressor::Compress(*mip, mip_width, mip_height, format, threading);
 		}
+
+		LOG_INFO("\"%s\" compressed to %s, PSNR: %.2f dB", FileSystem::GetFileNameFromFilePath(file_path).c_str(), rhi_format_to_string(format), psnr);
+
+		return format;
 	}
 
 	uint32_t ImageImporter::ComputeChannelCount(FIBITMAP* bitmap) const
@@ -44,7 +44,8 @@ namespace Spartan
 
 	private:	
 		bool GetBitsFromFibitmap(std::vector<std::byte>* data, FIBITMAP* bitmap, uint32_t width, uint32_t height, uint32_t channels) const;
-		void GenerateMipmaps(FIBITMAP* bitmap, RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels);
+		void GenerateMipmaps(RHI_Texture* texture, uint32_t width, uint32_t height, uint32_t channels, uint32_t bytes_per_channel, bool is_grayscale);
+		RHI_Format CompressMipmaps(const std::string& file_path, RHI_Texture* texture, uint32_t width, uint32_t height, bool is_grayscale, bool is_transparent) const;
 
 		uint32_t ComputeChannelCount(FIBITMAP* bitmap) const;
 		uint32_t ComputeBitsPerChannel(FIBITMAP* bitmap) const;
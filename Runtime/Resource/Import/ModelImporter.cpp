@@ -26,13 +26,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <assimp/version.h>
 #include "AssimpHelper.h"
 #include "../ProgressReport.h"
-#include "../../RHI/RHI_Texture.h"
+#include "../../RHI/RHI_Texture2D.h"
 #include "../../Core/Settings.h"
 #include "../../Rendering/Model.h"
 #include "../../Rendering/Animation.h"
 #include "../../Rendering/Material.h"
 #include "../../World/World.h"
 #include "../../World/Components/Renderable.h"
+#include "../../Threading/Threading.h"
+#include "../ResourceCache.h"
 //============================================
 
 //= NAMESPACES ================
@@ -43,6 +45,61 @@ using namespace Assimp;
 
 namespace Spartan
 {
+    // Levels of detail
+    static const float lod_error_first          = 0.01f;    // relative to the mesh size, doubles with every level
+    static const float lod_reduction_min        = 0.8f;     // a level has to be at most this fraction of the previous one
+    static const uint32_t lod_triangle_min      = 256;      // smaller meshes are not worth simplifying further
+
+    struct MaterialTextureSlot
+    {
+        TextureType type;
+        aiTextureType type_assimp_pbr;
+        aiTextureType type_assimp_legacy; // fallback
+    };
+
+    static const MaterialTextureSlot material_texture_slots[] =
+    {
+        // Engine texture,      Assimp texture pbr,                 Assimp texture legacy (fallback)
+        { TextureType_Albedo,    aiTextureType_BASE_COLOR,           aiTextureType_DIFFUSE },
+        { TextureType_Roughness, aiTextureType_DIFFUSE_ROUGHNESS,    aiTextureType_SHININESS },   // Use specular as fallback
+        { TextureType_Metallic,  aiTextureType_METALNESS,            aiTextureType_AMBIENT },     // Use ambient as fallback
+        { TextureType_Normal,    aiTextureType_NORMAL_CAMERA,        aiTextureType_NORMALS },
+        { TextureType_Occlusion, aiTextureType_AMBIENT_OCCLUSION,    aiTextureType_LIGHTMAP },
+        { TextureType_Occlusion, aiTextureType_LIGHTMAP,             aiTextureType_LIGHTMAP },
+        { TextureType_Emission,  aiTextureType_EMISSION_COLOR,       aiTextureType_EMISSIVE },
+        { TextureType_Height,    aiTextureType_HEIGHT,               aiTextureType_NONE },
+        { TextureType_Mask,      aiTextureType_OPACITY,              aiTextureType_NONE }
+    };
+
+    // Textures are block compressed on import, the format depends on what the slot holds (see RHI_Texture_CompressWhenLoading).
+    // Normal and height maps are often mixed up, the importer tells them apart by whether they are grayscale, like LoadMaterial() does.
+    static uint16_t material_texture_flags(const TextureType type)
+    {
+        uint16_t flags = RHI_Texture_CompressWhenLoading;
+        flags |= type == TextureType_Albedo                                 ? RHI_Texture_Srgb      : 0;
+        flags |= type == TextureType_Normal || type == TextureType_Height   ? RHI_Texture_NormalMap : 0;
+        return flags;
+    }
+
+    // Returns the (validated) file path of the texture a material uses for a slot, or an empty string
+    static string material_texture_path(const aiMaterial* assimp_material, const MaterialTextureSlot& slot, const string& model_path, aiTextureType* type_assimp_out = nullptr)
+    {
+        aiTextureType type_assimp   = assimp_material->GetTextureCount(slot.type_assimp_pbr)    > 0 ? slot.type_assimp_pbr      : aiTextureType_NONE;
+        type_assimp                 = assimp_material->GetTextureCount(slot.type_assimp_legacy) > 0 ? slot.type_assimp_legacy   : type_assimp;
+
+        if (type_assimp_out)
+        {
+            *type_assimp_out = type_assimp;
+        }
+
+        aiString texture_path;
+        if (assimp_material->GetTextureCount(type_assimp) == 0 || AI_SUCCESS != assimp_material->GetTexture(type_assimp, 0, &texture_path))
+            return "";
+
+        const auto deduced_path = AssimpHelper::texture_validate_path(texture_path.data, model_path);
+        return FileSystem::IsSupportedImageFile(deduced_path) ? deduced_path : "";
+    }
+
 	ModelImporter::ModelImporter(Context* context)
 	{
 		m_context	= context;
@@ -118,27 +175,32 @@ namespace Spartan
 		// Read the 3D model file from disk
 		if (const aiScene* scene = importer.ReadFile(file_path, importer_flags))
 		{
-			FIRE_EVENT(Event_World_Stop);
-
             params.scene            = scene;
             params.has_animation    = scene->mNumAnimations != 0;
 
+            // Update progress tracking
+            int job_count = 0;
+            AssimpHelper::compute_node_count(scene->mRootNode, &job_count);
+            ProgressReport::Get().SetJobCount(g_progress_model_importer, job_count + static_cast<int>(scene->mNumMeshes));
+
+            // Decode textures and convert meshes on all threads, this doesn't touch the world so it can keep ticking
+            LoadTextures(params);
+            LoadMeshes(params);
+
+			FIRE_EVENT(Event_World_Stop);
+
             // Create root entity to match Assimp's root node
             const bool is_active = false;
             shared_ptr<Entity> new_entity = m_world->EntityCreate(is_active);
             new_entity->SetName(params.name); // Set custom name, which is more descriptive than "RootNode"
             params.model->SetRootEntity(new_entity);
 
-            // Update progress tracking
-            int job_count = 0;
-            AssimpHelper::compute_node_count(scene->mRootNode, &job_count);
-            ProgressReport::Get().SetJobCount(g_progress_model_importer, job_count);
-
             // Parse all nodes, starting from the root node and continuing recursively
 			ParseNode(scene->mRootNode, params, nullptr, new_entity.get());
             // Parse animations
 			ParseAnimations(params);
-            // Update model geometry
+            // Update model geometry, with packed vertices unless it's animated
+            model->SetVertexPacking(true);
 			model->UpdateGeometry();
 
 			FIRE_EVENT(Event_World_Start);
@@ -153,7 +215,7 @@ namespace Spartan
         return params.scene != nullptr;
 	}
 
-	void ModelImporter::ParseNode(const aiNode* assimp_node, const ModelParams& params, Entity* parent_node, Entity* new_entity)
+	void ModelImporter::ParseNode(const aiNode* assimp_node, ModelParams& params, Entity* parent_node, Entity* new_entity)
 	{
         if (parent_node) // parent node is already set
         {
@@ -184,12 +246,12 @@ namespace Spartan
 		ProgressReport::Get().IncrementJobsDone(g_progress_model_importer);
 	}
 
-    void ModelImporter::ParseNodeMeshes(const aiNode* assimp_node, Entity* new_entity, const ModelParams& params)
+    void ModelImporter::ParseNodeMeshes(const aiNode* assimp_node, Entity* new_entity, ModelParams& params)
     {
         for (uint32_t i = 0; i < assimp_node->mNumMeshes; i++)
         {
             auto entity = new_entity; // set the current entity
-            const auto assimp_mesh = params.scene->mMeshes[assimp_node->mMeshes[i]]; // get mesh
+            const uint32_t mesh_index = assimp_node->mMeshes[i]; // get mesh
             string _name = assimp_node->mName.C_Str(); // get name
 
             // if this node has many meshes, then assign a new entity for each one of them
@@ -205,7 +267,7 @@ namespace Spartan
             entity->SetName(_name);
 
             // Process mesh
-            LoadMesh(assimp_mesh, entity, params);
+            LoadMesh(mesh_index, entity, params);
             entity->SetActive(true);
         }
     }
@@ -260,81 +322,194 @@ namespace Spartan
 		}
 	}
 
-	void ModelImporter::LoadMesh(aiMesh* assimp_mesh, Entity* entity_parent, const ModelParams& params)
-	{
-		if (!assimp_mesh || !entity_parent)
-		{
-			LOG_ERROR_INVALID_PARAMETER();
-			return;
-		}
+    void ModelImporter::LoadMeshes(ModelParams& params)
+    {
+        const uint32_t mesh_count = params.scene->mNumMeshes;
+        params.meshes.clear();
+        params.meshes.resize(mesh_count);
 
-        const uint32_t vertex_count = assimp_mesh->mNumVertices;
-        const uint32_t index_count  = assimp_mesh->mNumFaces * 3;
+        // Count how many nodes use each mesh, so that the converted data can be freed once it's appended to the model
+        params.mesh_references.assign(mesh_count, 0);
+        function<void(const aiNode*)> count_references = [&params, &count_references](const aiNode* assimp_node)
+        {
+            for (uint32_t i = 0; i < assimp_node->mNumMeshes; i++)
+            {
+                params.mesh_references[assimp_node->mMeshes[i]]++;
+            }
 
-		// Vertices
-        vector<RHI_Vertex_PosTexNorTan> vertices = vector<RHI_Vertex_PosTexNorTan>(vertex_count);
-		{
-			for (uint32_t i = 0; i < vertex_count; i++)
-			{
-				auto& vertex = vertices[i];
+            for (uint32_t i = 0; i < assimp_node->mNumChildren; i++)
+            {
+                count_references(assimp_node->mChildren[i]);
+            }
+        };
+        count_references(params.scene->mRootNode);
 
-				// Position
-				const auto& pos = assimp_mesh->mVertices[i];
-				vertex.pos[0] = pos.x;
-				vertex.pos[1] = pos.y;
-				vertex.pos[2] = pos.z;
+        ProgressReport::Get().SetStatus(g_progress_model_importer, "Converting meshes...");
 
-				// Normal
-				if (assimp_mesh->mNormals)
-				{
-					const auto& normal = assimp_mesh->mNormals[i];
-					vertex.nor[0] = normal.x;
-					vertex.nor[1] = normal.y;
-					vertex.nor[2] = normal.z;
-				}
+        m_context->GetSubsystem<Threading>()->ParallelFor(mesh_count, [&params](const uint32_t mesh_index)
+        {
+            const aiMesh* assimp_mesh   = params.scene->mMeshes[mesh_index];
+            ModelMesh& mesh             = params.meshes[mesh_index];
+            ProgressReport::Get().IncrementJobsDone(g_progress_model_importer);
+
+            if (params.mesh_references[mesh_index] == 0)
+                return;
+
+            const uint32_t vertex_count = assimp_mesh->mNumVertices;
+            const uint32_t index_count  = assimp_mesh->mNumFaces * 3;
+
+		    // Vertices
+            mesh.vertices = vector<RHI_Vertex_PosTexNorTan>(vertex_count);
+		    {
+			    for (uint32_t i = 0; i < vertex_count; i++)
+			    {
+				    auto& vertex = mesh.vertices[i];
+
+				    // Position
+				    const auto& pos = assimp_mesh->mVertices[i];
+				    vertex.pos[0] = pos.x;
+				    vertex.pos[1] = pos.y;
+				    vertex.pos[2] = pos.z;
+
+				    // Normal
+				    if (assimp_mesh->mNormals)
+				    {
+					    const auto& normal = assimp_mesh->mNormals[i];
+					    vertex.nor[0] = normal.x;
+					    vertex.nor[1] = normal.y;
+					    vertex.nor[2] = normal.z;
+				    }
+
+				    // Tangent
+				    if (assimp_mesh->mTangents)
+				    {
+					    const auto& tangent = assimp_mesh->mTangents[i];
+					    vertex.tan[0] = tangent.x;
+					    vertex.tan[1] = tangent.y;
+					    vertex.tan[2] = tangent.z;
+				    }
+
+				    // Texture coordinates
+				    const uint32_t uv_channel = 0;
+				    if (assimp_mesh->HasTextureCoords(uv_channel))
+				    {
+					    const auto& tex_coords = assimp_mesh->mTextureCoords[uv_channel][i];
+					    vertex.tex[0] = tex_coords.x;
+					    vertex.tex[1] = tex_coords.y;
+				    }
+			    }
+		    }
+
+		    // Indices
+		    mesh.indices = vector<uint32_t>(index_count);
+		    {
+			    // Get indices by iterating through each face of the mesh.
+			    for (uint32_t face_index = 0; face_index < assimp_mesh->mNumFaces; face_index++)
+			    {
+				    // if (aiPrimitiveType_LINE | aiPrimitiveType_POINT) && aiProcess_Triangulate) then (face.mNumIndices == 3)
+				    auto& face					= assimp_mesh->mFaces[face_index];
+				    const auto indices_index	= (face_index * 3);
+				    mesh.indices[indices_index + 0]	= face.mIndices[0];
+				    mesh.indices[indices_index + 1]	= face.mIndices[1];
+				    mesh.indices[indices_index + 2]	= face.mIndices[2];
+			    }
+		    }
+
+		    // Compute AABB
+		    mesh.aabb = BoundingBox(mesh.vertices);
+
+            // Optimize here, while in parallel, so the model can append it as is
+            mesh.optimization = MeshOptimizer::Optimize(mesh.indices, mesh.vertices);
+
+            // Levels of detail, each simplified from the previous one, with a growing error budget
+            float lod_error = lod_error_first;
+            for (uint32_t lod = 1; lod < renderable_lod_count; lod++, lod_error *= 2.0f)
+            {
+                const vector<uint32_t>& lod_previous = mesh.lods.empty() ? mesh.indices : mesh.lods.back();
+                if (lod_previous.size() / 3 < lod_triangle_min)
+                    break;
 
-				// Tangent
-				if (assimp_mesh->mTangents)
-				{
-					const auto& tangent = assimp_mesh->mTangents[i];
-					vertex.tan[0] = tangent.x;
-					vertex.tan[1] = tangent.y;
-					vertex.tan[2] = tangent.z;
-				}
+                vector<uint32_t> lod_indices = MeshOptimizer::Simplify(lod_previous, mesh.vertices, static_cast<uint32_t>(lod_previous.size() / 2), lod_error);
 
-				// Texture coordinates
-				const uint32_t uv_channel = 0;
-				if (assimp_mesh->HasTextureCoords(uv_channel))
-				{
-					const auto& tex_coords = assimp_mesh->mTextureCoords[uv_channel][i];
-					vertex.tex[0] = tex_coords.x;
-					vertex.tex[1] = tex_coords.y;
-				}
-			}
-		}
+                // Not worth another level (and draw call range) if it barely got simpler
+                if (lod_indices.size() > lod_previous.size() * lod_reduction_min)
+                    break;
+
+                MeshOptimizer::OptimizeVertexCache(lod_indices, static_cast<uint32_t>(mesh.vertices.size()));
+                mesh.lods.emplace_back(move(lod_indices));
+            }
+        });
+
+        for (const ModelMesh& mesh : params.meshes)
+        {
+            params.model->AppendOptimizationStatistics(mesh.optimization);
+        }
+    }
+
+    void ModelImporter::LoadTextures(ModelParams& params)
+    {
+        // Gather the unique file paths, textures are usually shared between materials
+        vector<string> file_paths;
+        unordered_map<string, uint16_t> file_flags; // from the first slot which uses the file
+        params.textures.clear();
+        for (uint32_t i = 0; i < params.scene->mNumMaterials; i++)
+        {
+            for (const MaterialTextureSlot& slot : material_texture_slots)
+            {
+                const string file_path = material_texture_path(params.scene->mMaterials[i], slot, params.file_path);
+                if (!file_path.empty() && params.textures.emplace(file_path, nullptr).second)
+                {
+                    file_paths.emplace_back(file_path);
+                    file_flags[file_path] = material_texture_flags(slot.type);
+                }
+            }
+        }
+
+        // Textures which are already cached don't have to be loaded again
+        ResourceCache* resource_cache = m_context->GetSubsystem<ResourceCache>();
+        file_paths.erase(remove_if(file_paths.begin(), file_paths.end(), [&params, resource_cache](const string& file_path)
+        {
+            shared_ptr<RHI_Texture> texture = resource_cache->GetByName<RHI_Texture2D>(FileSystem::GetFileNameNoExtensionFromFilePath(file_path));
+            params.textures[file_path] = texture;
+            return texture != nullptr;
+        }), file_paths.end());
+
+        ProgressReport::Get().SetJobCount(g_progress_model_importer, ProgressReport::Get().GetJobCount(g_progress_model_importer) + static_cast<int>(file_paths.size()));
+        ProgressReport::Get().SetStatus(g_progress_model_importer, "Loading " + to_string(file_paths.size()) + " textures...");
+
+        // Decode them (generate their mips and block compress them)
+        vector<shared_ptr<RHI_Texture>> textures(file_paths.size());
+        m_context->GetSubsystem<Threading>()->ParallelFor(static_cast<uint32_t>(file_paths.size()), [this, &file_paths, &file_flags, &textures](const uint32_t i)
+        {
+			const bool generate_mipmaps = true;
+            auto texture = make_shared<RHI_Texture2D>(m_context, generate_mipmaps, file_flags.at(file_paths[i]));
+			texture->LoadFromFile(file_paths[i]);
+            textures[i] = texture;
+
+            ProgressReport::Get().IncrementJobsDone(g_progress_model_importer);
+        });
 
-		// Indices
-		vector<uint32_t> indices = vector<uint32_t>(index_count);
+        for (size_t i = 0; i < file_paths.size(); i++)
+        {
+            params.textures[file_paths[i]] = textures[i];
+        }
+    }
+
+	void ModelImporter::LoadMesh(const uint32_t mesh_index, Entity* entity_parent, ModelParams& params)
+	{
+		if (mesh_index >= params.meshes.size() || !entity_parent)
 		{
-			// Get indices by iterating through each face of the mesh.
-			for (uint32_t face_index = 0; face_index < assimp_mesh->mNumFaces; face_index++)
-			{
-				// if (aiPrimitiveType_LINE | aiPrimitiveType_POINT) && aiProcess_Triangulate) then (face.mNumIndices == 3)
-				auto& face					= assimp_mesh->mFaces[face_index];
-				const auto indices_index	= (face_index * 3);
-				indices[indices_index + 0]	= face.mIndices[0];
-				indices[indices_index + 1]	= face.mIndices[1];
-				indices[indices_index + 2]	= face.mIndices[2];
-			}
+			LOG_ERROR_INVALID_PARAMETER();
+			return;
 		}
 
-		// Compute AABB (before doing move operation on vertices)
-		const auto aabb = BoundingBox(vertices);
+        const aiMesh* assimp_mesh   = params.scene->mMeshes[mesh_index];
+        ModelMesh& mesh             = params.meshes[mesh_index];
 
-		// Add the mesh to the model
+		// Add the mesh to the model (it was optimized while the meshes were processed in parallel)
 		uint32_t index_offset;
 		uint32_t vertex_offset;
-        params.model->AppendGeometry(move(indices), move(vertices), &index_offset, &vertex_offset);
+        params.model->AppendGeometry(mesh.indices, mesh.vertices, &index_offset, &vertex_offset);
 
 		// Add a renderable component to this entity
 		auto renderable	= entity_parent->AddComponent<Renderable>();
@@ -343,13 +518,27 @@ namespace Spartan
 		renderable->GeometrySet(
 			entity_parent->GetName(),
 			index_offset,
-			static_cast<uint32_t>(indices.size()),
+			static_cast<uint32_t>(mesh.indices.size()),
 			vertex_offset,
-			static_cast<uint32_t>(vertices.size()),
-			aabb,
+			static_cast<uint32_t>(mesh.vertices.size()),
+			mesh.aabb,
             params.model
 		);
 
+        // Levels of detail, they share the vertices of the full resolution geometry
+        for (const vector<uint32_t>& lod : mesh.lods)
+        {
+            uint32_t lod_index_offset;
+            params.model->AppendIndices(lod, &lod_index_offset);
+            renderable->GeometryLodAdd(lod_index_offset, static_cast<uint32_t>(lod.size()));
+        }
+
+        // Free the converted data after the last node which uses it
+        if (--params.mesh_references[mesh_index] == 0)
+        {
+            mesh = ModelMesh();
+        }
+
 		// Material
 		if (params.scene->HasMaterials())
 		{
@@ -430,64 +619,39 @@ namespace Spartan
 
 		material->SetColorAlbedo(Vector4(color_diffuse.r, color_diffuse.g, color_diffuse.b, opacity.r));
 
-		// TEXTURES
-		const auto load_mat_tex = [&params, &assimp_material, &material](const TextureType type_spartan, const aiTextureType type_assimp_pbr, const aiTextureType type_assimp_legacy)
+		// TEXTURES (already loaded by LoadTextures())
+		for (const MaterialTextureSlot& slot : material_texture_slots)
 		{
-            aiTextureType type_assimp   = assimp_material->GetTextureCount(type_assimp_pbr)     > 0 ? type_assimp_pbr       : aiTextureType_NONE;
-            type_assimp                 = assimp_material->GetTextureCount(type_assimp_legacy)  > 0 ? type_assimp_legacy    : type_assimp;
+            aiTextureType type_assimp       = aiTextureType_NONE;
+            const string file_path          = material_texture_path(assimp_material, slot, params.file_path, &type_assimp);
+            const auto it                   = params.textures.find(file_path);
+            if (file_path.empty() || it == params.textures.end() || !it->second)
+                continue;
+
+            const shared_ptr<RHI_Texture>& texture = it->second;
+            material->SetTextureSlot(slot.type, texture);
 
-			aiString texture_path;
-			if (assimp_material->GetTextureCount(type_assimp) > 0)
+			if (type_assimp == aiTextureType_BASE_COLOR || type_assimp == aiTextureType_DIFFUSE)
 			{
-				if (AI_SUCCESS == assimp_material->GetTexture(type_assimp, 0, &texture_path))
-				{
-					const auto deduced_path = AssimpHelper::texture_validate_path(texture_path.data, params.file_path);
-					if (FileSystem::IsSupportedImageFile(deduced_path))
-					{
-                        params.model->AddTexture(material, type_spartan, AssimpHelper::texture_validate_path(texture_path.data, params.file_path));
-
-						if (type_assimp == aiTextureType_BASE_COLOR || type_assimp == aiTextureType_DIFFUSE)
-						{
-							// FIX: materials that have a diffuse texture should not be tinted black/gray
-							material->SetColorAlbedo(Vector4::One);
-						}
-
-						// Some models (or Assimp) pass a normal map as a height map
-						// auto textureType others pass a height map as a normal map, we try to fix that.
-						if (type_spartan == TextureType_Normal || type_spartan == TextureType_Height)
-						{
-                            if (const auto texture = material->GetTexture_PtrShared(type_spartan))
-                            {
-                                auto proper_type = type_spartan;
-                                proper_type = (proper_type == TextureType_Normal && texture->GetGrayscale()) ? TextureType_Height : proper_type;
-                                proper_type = (proper_type == TextureType_Height && !texture->GetGrayscale()) ? TextureType_Normal : proper_type;
-
-                                if (proper_type != type_spartan)
-                                {
-                                    material->SetTextureSlot(type_spartan, shared_ptr<RHI_Texture>());
-                                    material->SetTextureSlot(proper_type, texture);
-                                }
-                            }
-                            else
-                            {
-                                LOG_ERROR("Failed to get texture");
-                            }
-						}
-					}
-				}
+				// FIX: materials that have a diffuse texture should not be tinted black/gray
+				material->SetColorAlbedo(Vector4::One);
 			}
-		};
-
-        // Engine texture,                  Assimp texture pbr,                 Assimp texture legacy (fallback)
-		load_mat_tex(TextureType_Albedo,    aiTextureType_BASE_COLOR,           aiTextureType_DIFFUSE);
-		load_mat_tex(TextureType_Roughness, aiTextureType_DIFFUSE_ROUGHNESS,    aiTextureType_SHININESS);   // Use specular as fallback
-		load_mat_tex(TextureType_Metallic,  aiTextureType_METALNESS,            aiTextureType_AMBIENT);     // Use ambient as fallback
-		load_mat_tex(TextureType_Normal,    aiTextureType_NORMAL_CAMERA,        aiTextureType_NORMALS);
-		load_mat_tex(TextureType_Occlusion, aiTextureType_AMBIENT_OCCLUSION,    aiTextureType_LIGHTMAP);
-        load_mat_tex(TextureType_Occlusion, aiTextureType_LIGHTMAP,             aiTextureType_LIGHTMAP);
-		load_mat_tex(TextureType_Emission,  aiTextureType_EMISSION_COLOR,       aiTextureType_EMISSIVE);
-		load_mat_tex(TextureType_Height,    aiTextureType_HEIGHT,               aiTextureType_NONE);
-		load_mat_tex(TextureType_Mask,      aiTextureType_OPACITY,              aiTextureType_NONE);
+
+			// Some models (or Assimp) pass a normal map as a height map
+			// auto textureType others pass a height map as a normal map, we try to fix that.
+			if (slot.type == TextureType_Normal || slot.type == TextureType_Height)
+			{
+                auto proper_type = slot.type;
+                proper_type = (proper_type == TextureType_Normal && texture->GetGrayscale()) ? TextureType_Height : proper_type;
+                proper_type = (proper_type == TextureType_Height && !texture->GetGrayscale()) ? TextureType_Normal : proper_type;
+
+                if (proper_type != slot.type)
+                {
+                    material->SetTextureSlot(slot.type, shared_ptr<RHI_Texture>());
+                    material->SetTextureSlot(proper_type, texture);
+                }
+			}
+		}
 
 		return material;
 	}
@@ -22,9 +22,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =====================
-#include "../../Core/EngineDefs.h"
 #include <memory>
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include "../../Core/EngineDefs.h"
+#include "../../RHI/RHI_Vertex.h"
+#include "../../Math/BoundingBox.h"
+#include "../../Rendering/MeshOptimizer.h"
 //================================
 
 struct aiNode;
@@ -39,6 +44,17 @@ namespace Spartan
 	class Entity;
 	class Model;
 	class World;
+    class RHI_Texture;
+
+    // A mesh converted to engine vertices/indices, ready to be appended to the model
+    struct ModelMesh
+    {
+        std::vector<uint32_t> indices;
+        std::vector<RHI_Vertex_PosTexNorTan> vertices;
+        Math::BoundingBox aabb;
+        MeshOptimizer::Statistics optimization;
+        std::vector<std::vector<uint32_t>> lods; // simplified indices, into the same vertices
+    };
 
     struct ModelParams
     {
@@ -51,6 +67,9 @@ namespace Spartan
         bool has_animation;
         Model* model            = nullptr;
         const aiScene* scene    = nullptr;
+        std::vector<ModelMesh> meshes;                                              // one per scene mesh, converted in parallel
+        std::vector<uint32_t> mesh_references;                                      // nodes left to use each mesh, it's freed after the last one
+        std::unordered_map<std::string, std::shared_ptr<RHI_Texture>> textures;     // one per unique file path, decoded in parallel
     };
 
 	class SPARTAN_CLASS ModelImporter
@@ -63,12 +82,16 @@ namespace Spartan
 
 	private:
         // Parsing
-		void ParseNode(const aiNode* assimp_node, const ModelParams& params, Entity* parent_node = nullptr, Entity* new_entity = nullptr);
-        void ParseNodeMeshes(const aiNode* assimp_node, Entity* new_entity, const ModelParams& params);
+		void ParseNode(const aiNode* assimp_node, ModelParams& params, Entity* parent_node = nullptr, Entity* new_entity = nullptr);
+        void ParseNodeMeshes(const aiNode* assimp_node, Entity* new_entity, ModelParams& params);
         void ParseAnimations(const ModelParams& params);
 
+        // Loading (in parallel, before any entity is created)
+        void LoadMeshes(ModelParams& params);
+        void LoadTextures(ModelParams& params);
+
         // Loading
-		void LoadMesh(aiMesh* assimp_mesh, Entity* entity_parent, const ModelParams& params);
+		void LoadMesh(uint32_t mesh_index, Entity* entity_parent, ModelParams& params);
         void LoadBones(const aiMesh* assimp_mesh, const ModelParams& params);
 		std::shared_ptr<Material> LoadMaterial(aiMaterial* assimp_material, const ModelParams& params);
 
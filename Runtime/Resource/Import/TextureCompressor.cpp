@@ -0,0 +1,758 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ===========================
+#include "TextureCompressor.h"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include "../../Math/Simd.h"
+#include "../../Logging/Log.h"
+#include "../../Threading/Threading.h"
+//======================================
+
+//= NAMESPACES ================
+using namespace std;
+using namespace Spartan::Math;
+//=============================
+
+namespace Spartan::TextureCompressor
+{
+    namespace
+    {
+        using Simd::float4;
+
+        // 4x4 texels, channels in [0, 255]
+        struct Block
+        {
+            float4 texels[16];
+        };
+
+        // Contribution of the second endpoint to each palette entry, in index order
+        const float bc1_weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        const float bc4_weights[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+        const uint32_t bc7_weights_int[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+        const float bc7_weights[16] =
+        {
+            0.0f  / 64.0f, 4.0f  / 64.0f, 9.0f  / 64.0f, 13.0f / 64.0f, 17.0f / 64.0f, 21.0f / 64.0f, 26.0f / 64.0f, 30.0f / 64.0f,
+            34.0f / 64.0f, 38.0f / 64.0f, 43.0f / 64.0f, 47.0f / 64.0f, 51.0f / 64.0f, 55.0f / 64.0f, 60.0f / 64.0f, 64.0f / 64.0f
+        };
+
+        float dot(const float4 a, const float4 b)
+        {
+            alignas(16) float v[4];
+            Simd::Store(v, Simd::Mul(a, b));
+            return v[0] + v[1] + v[2] + v[3];
+        }
+
+        float4 lerp(const float4 a, const float4 b, const float t)
+        {
+            return Simd::Add(a, Simd::Mul(Simd::Sub(b, a), Simd::Splat(t)));
+        }
+
+        float4 saturate(const float4 a)
+        {
+            return Simd::Min(Simd::Max(a, Simd::Splat(0.0f)), Simd::Splat(255.0f));
+        }
+
+        float lane(const float4 a, const uint32_t index)
+        {
+            alignas(16) float v[4];
+            Simd::Store(v, a);
+            return v[index];
+        }
+
+        void load_block(const vector<std::byte>& texels, const uint32_t width, const uint32_t height, const uint32_t block_x, const uint32_t block_y, Block& block)
+        {
+            for (uint32_t y = 0; y < 4; y++)
+            {
+                const uint32_t texel_y = min(block_y * 4 + y, height - 1);
+                for (uint32_t x = 0; x < 4; x++)
+                {
+                    const uint32_t texel_x  = min(block_x * 4 + x, width - 1);
+                    const uint8_t* texel    = reinterpret_cast<const uint8_t*>(texels.data()) + (texel_y * width + texel_x) * 4;
+                    block.texels[y * 4 + x] = Simd::Set(texel[0], texel[1], texel[2], texel[3]);
+                }
+            }
+        }
+
+        // Single channel blocks have the channel in all four lanes, so that the rgba code below works for them as is
+        void load_block_channel(const Block& block, const uint32_t channel, Block& block_channel)
+        {
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                block_channel.texels[i] = Simd::Splat(lane(block.texels[i], channel));
+            }
+        }
+
+        // Endpoints at the extremes of the block along its principal axis (the dominant eigenvector of the covariance)
+        void fit_principal_axis(const Block& block, float4& endpoint_0, float4& endpoint_1)
+        {
+            float4 mean      = Simd::Splat(0.0f);
+            float4 texel_min = block.texels[0];
+            float4 texel_max = block.texels[0];
+            for (const float4& texel : block.texels)
+            {
+                mean      = Simd::Add(mean, texel);
+                texel_min = Simd::Min(texel_min, texel);
+                texel_max = Simd::Max(texel_max, texel);
+            }
+            mean = Simd::Mul(mean, Simd::Splat(1.0f / 16.0f));
+
+            // Covariance, one row per channel
+            float4 covariance[4] = { Simd::Splat(0.0f), Simd::Splat(0.0f), Simd::Splat(0.0f), Simd::Splat(0.0f) };
+            for (const float4& texel : block.texels)
+            {
+                const float4 d = Simd::Sub(texel, mean);
+                covariance[0] = Simd::Add(covariance[0], Simd::Mul(d, Simd::Splat<0>(d)));
+                covariance[1] = Simd::Add(covariance[1], Simd::Mul(d, Simd::Splat<1>(d)));
+                covariance[2] = Simd::Add(covariance[2], Simd::Mul(d, Simd::Splat<2>(d)));
+                covariance[3] = Simd::Add(covariance[3], Simd::Mul(d, Simd::Splat<3>(d)));
+            }
+
+            // Power iteration, starting from the diagonal of the bounding box
+            float4 axis         = Simd::Sub(texel_max, texel_min);
+            float axis_length   = sqrt(dot(axis, axis));
+            if (axis_length < 0.5f) // a single color
+            {
+                endpoint_0 = mean;
+                endpoint_1 = mean;
+                return;
+            }
+            axis = Simd::Mul(axis, Simd::Splat(1.0f / axis_length));
+
+            for (uint32_t i = 0; i < 8; i++)
+            {
+                float4 axis_next = Simd::Mul(covariance[0], Simd::Splat<0>(axis));
+                axis_next        = Simd::Add(axis_next, Simd::Mul(covariance[1], Simd::Splat<1>(axis)));
+                axis_next        = Simd::Add(axis_next, Simd::Mul(covariance[2], Simd::Splat<2>(axis)));
+                axis_next        = Simd::Add(axis_next, Simd::Mul(covariance[3], Simd::Splat<3>(axis)));
+
+                axis_length = sqrt(dot(axis_next, axis_next));
+                if (axis_length < 1e-6f)
+                    break;
+
+                axis = Simd::Mul(axis_next, Simd::Splat(1.0f / axis_length));
+            }
+
+            // Project the texels on the axis
+            float t_min = numeric_limits<float>::max();
+            float t_max = -numeric_limits<float>::max();
+            for (const float4& texel : block.texels)
+            {
+                const float t = dot(Simd::Sub(texel, mean), axis);
+                t_min = min(t_min, t);
+                t_max = max(t_max, t);
+            }
+
+            endpoint_0 = saturate(Simd::Add(mean, Simd::Mul(axis, Simd::Splat(t_min))));
+            endpoint_1 = saturate(Simd::Add(mean, Simd::Mul(axis, Simd::Splat(t_max))));
+        }
+
+        void make_palette(const float4 endpoint_0, const float4 endpoint_1, const float* weights, const uint32_t count, float4* palette)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                palette[i] = lerp(endpoint_0, endpoint_1, weights[i]);
+            }
+        }
+
+        // Picks the closest palette entry for every texel and returns the squared error. The palette is transposed so
+        // that the distances to four entries are computed at once, the count has to be a multiple of four.
+        float select_indices(const Block& block, const float4* palette, const uint32_t count, uint8_t* indices)
+        {
+            float4 palette_t[16];
+            for (uint32_t i = 0; i < count; i += 4)
+            {
+                palette_t[i + 0] = palette[i + 0];
+                palette_t[i + 1] = palette[i + 1];
+                palette_t[i + 2] = palette[i + 2];
+                palette_t[i + 3] = palette[i + 3];
+                Simd::Transpose(palette_t[i + 0], palette_t[i + 1], palette_t[i + 2], palette_t[i + 3]);
+            }
+
+            float error = 0.0f;
+            for (uint32_t texel_index = 0; texel_index < 16; texel_index++)
+            {
+                const float4 texel = block.texels[texel_index];
+                const float4 r     = Simd::Splat<0>(texel);
+                const float4 g     = Simd::Splat<1>(texel);
+                const float4 b     = Simd::Splat<2>(texel);
+                const float4 a     = Simd::Splat<3>(texel);
+
+                float distance_min = numeric_limits<float>::max();
+                for (uint32_t i = 0; i < count; i += 4)
+                {
+                    const float4 dr = Simd::Sub(r, palette_t[i + 0]);
+                    const float4 dg = Simd::Sub(g, palette_t[i + 1]);
+                    const float4 db = Simd::Sub(b, palette_t[i + 2]);
+                    const float4 da = Simd::Sub(a, palette_t[i + 3]);
+
+                    float4 distance = Simd::Mul(dr, dr);
+                    distance        = Simd::Add(distance, Simd::Mul(dg, dg));
+                    distance        = Simd::Add(distance, Simd::Mul(db, db));
+                    distance        = Simd::Add(distance, Simd::Mul(da, da));
+
+                    alignas(16) float distances[4];
+                    Simd::Store(distances, distance);
+                    for (uint32_t j = 0; j < 4; j++)
+                    {
+                        // Strictly less, so ties go to the lowest index (degenerate endpoints end up with index 0)
+                        if (distances[j] < distance_min)
+                        {
+                            distance_min         = distances[j];
+                            indices[texel_index] = static_cast<uint8_t>(i + j);
+                        }
+                    }
+                }
+
+                error += distance_min;
+            }
+
+            return error;
+        }
+
+        // Endpoints which minimize the squared error for the given indices (least squares), false if all texels share one weight
+        bool fit_least_squares(const Block& block, const uint8_t* indices, const float* weights, float4& endpoint_0, float4& endpoint_1)
+        {
+            float aa    = 0.0f;
+            float ab    = 0.0f;
+            float bb    = 0.0f;
+            float4 ax   = Simd::Splat(0.0f);
+            float4 bx   = Simd::Splat(0.0f);
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const float b = weights[indices[i]];
+                const float a = 1.0f - b;
+
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                ax = Simd::Add(ax, Simd::Mul(block.texels[i], Simd::Splat(a)));
+                bx = Simd::Add(bx, Simd::Mul(block.texels[i], Simd::Splat(b)));
+            }
+
+            const float determinant = aa * bb - ab * ab;
+            if (fabs(determinant) < 1e-6f)
+                return false;
+
+            const float4 determinant_inverse = Simd::Splat(1.0f / determinant);
+            endpoint_0 = saturate(Simd::Mul(Simd::Sub(Simd::Mul(ax, Simd::Splat(bb)), Simd::Mul(bx, Simd::Splat(ab))), determinant_inverse));
+            endpoint_1 = saturate(Simd::Mul(Simd::Sub(Simd::Mul(bx, Simd::Splat(aa)), Simd::Mul(ax, Simd::Splat(ab))), determinant_inverse));
+
+            return true;
+        }
+
+        // Fits the endpoints, encodes them, refines them for the indices they got and keeps the refinement if it does better
+        template<uint32_t block_size, typename Encode>
+        void encode_block(const Block& block, const float* weights, const uint32_t weight_count, uint8_t* output, Encode&& encode)
+        {
+            float4 endpoint_0;
+            float4 endpoint_1;
+            fit_principal_axis(block, endpoint_0, endpoint_1);
+            const float error = encode(block, endpoint_0, endpoint_1, output);
+
+            float4 palette[16];
+            uint8_t indices[16];
+            make_palette(endpoint_0, endpoint_1, weights, weight_count, palette);
+            select_indices(block, palette, weight_count, indices);
+
+            uint8_t output_refined[block_size];
+            if (fit_least_squares(block, indices, weights, endpoint_0, endpoint_1) && encode(block, endpoint_0, endpoint_1, output_refined) < error)
+            {
+                memcpy(output, output_refined, block_size);
+            }
+        }
+
+        //= BC1 ==================================================================================
+        uint16_t quantize_565(const float4 color)
+        {
+            alignas(16) float v[4];
+            Simd::Store(v, color);
+            const uint32_t r = static_cast<uint32_t>(round(v[0] * 31.0f / 255.0f));
+            const uint32_t g = static_cast<uint32_t>(round(v[1] * 63.0f / 255.0f));
+            const uint32_t b = static_cast<uint32_t>(round(v[2] * 31.0f / 255.0f));
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        void dequantize_565(const uint16_t color, uint32_t* rgb)
+        {
+            const uint32_t r = (color >> 11) & 31;
+            const uint32_t g = (color >> 5) & 63;
+            const uint32_t b = color & 31;
+            rgb[0] = (r << 3) | (r >> 2);
+            rgb[1] = (g << 2) | (g >> 4);
+            rgb[2] = (b << 3) | (b >> 2);
+        }
+
+        float encode_bc1_endpoints(const Block& block, const float4 endpoint_0, const float4 endpoint_1, uint8_t* output)
+        {
+            uint16_t color_0 = quantize_565(endpoint_0);
+            uint16_t color_1 = quantize_565(endpoint_1);
+
+            // color_0 > color_1 selects the four color mode
+            if (color_0 < color_1)
+            {
+                swap(color_0, color_1);
+            }
+
+            uint32_t rgb_0[3];
+            uint32_t rgb_1[3];
+            dequantize_565(color_0, rgb_0);
+            dequantize_565(color_1, rgb_1);
+
+            float4 palette[4];
+            uint8_t indices[16];
+            const float4 color_0_decoded = Simd::Set(static_cast<float>(rgb_0[0]), static_cast<float>(rgb_0[1]), static_cast<float>(rgb_0[2]), 0.0f);
+            const float4 color_1_decoded = Simd::Set(static_cast<float>(rgb_1[0]), static_cast<float>(rgb_1[1]), static_cast<float>(rgb_1[2]), 0.0f);
+            make_palette(color_0_decoded, color_1_decoded, bc1_weights, 4, palette);
+            const float error = select_indices(block, palette, 4, indices);
+
+            uint32_t index_bits = 0;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                index_bits |= indices[i] << (i * 2);
+            }
+
+            memcpy(output + 0, &color_0, 2);
+            memcpy(output + 2, &color_1, 2);
+            memcpy(output + 4, &index_bits, 4);
+
+            return error;
+        }
+
+        void encode_bc1(const Block& block, uint8_t* output)
+        {
+            // Opaque, alpha doesn't take part in the fit
+            Block block_rgb;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                block_rgb.texels[i] = Simd::Mul(block.texels[i], Simd::Set(1.0f, 1.0f, 1.0f, 0.0f));
+            }
+
+            encode_block<8>(block_rgb, bc1_weights, 4, output, encode_bc1_endpoints);
+        }
+
+        void decode_bc1(const uint8_t* input, uint8_t* texels)
+        {
+            uint16_t color_0;
+            uint16_t color_1;
+            uint32_t index_bits;
+            memcpy(&color_0, input + 0, 2);
+            memcpy(&color_1, input + 2, 2);
+            memcpy(&index_bits, input + 4, 4);
+
+            uint32_t palette[4][4] = {};
+            dequantize_565(color_0, palette[0]);
+            dequantize_565(color_1, palette[1]);
+            palette[0][3] = palette[1][3] = palette[2][3] = 255;
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                if (color_0 > color_1)
+                {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                    palette[3][3] = 255;
+                }
+                else
+                {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                }
+            }
+
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const uint32_t index = (index_bits >> (i * 2)) & 3;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    texels[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+                }
+            }
+        }
+
+        //= BC4 ==================================================================================
+        float encode_bc4_endpoints(const Block& block, const float4 endpoint_0, const float4 endpoint_1, uint8_t* output)
+        {
+            uint8_t value_0 = static_cast<uint8_t>(round(lane(endpoint_0, 0)));
+            uint8_t value_1 = static_cast<uint8_t>(round(lane(endpoint_1, 0)));
+
+            // value_0 > value_1 selects the eight value mode
+            if (value_0 < value_1)
+            {
+                swap(value_0, value_1);
+            }
+
+            float4 palette[8];
+            uint8_t indices[16];
+            make_palette(Simd::Splat(value_0), Simd::Splat(value_1), bc4_weights, 8, palette);
+            const float error = select_indices(block, palette, 8, indices);
+
+            uint64_t index_bits = 0;
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                index_bits |= static_cast<uint64_t>(indices[i]) << (i * 3);
+            }
+
+            output[0] = value_0;
+            output[1] = value_1;
+            for (uint32_t i = 0; i < 6; i++)
+            {
+                output[2 + i] = static_cast<uint8_t>(index_bits >> (i * 8));
+            }
+
+            return error;
+        }
+
+        void encode_bc4(const Block& block, const uint32_t channel, uint8_t* output)
+        {
+            Block block_channel;
+            load_block_channel(block, channel, block_channel);
+
+            encode_block<8>(block_channel, bc4_weights, 8, output, encode_bc4_endpoints);
+        }
+
+        void decode_bc4(const uint8_t* input, const uint32_t channel, uint8_t* texels)
+        {
+            uint32_t palette[8];
+            palette[0] = input[0];
+            palette[1] = input[1];
+            if (palette[0] > palette[1])
+            {
+                for (uint32_t i = 2; i < 8; i++)
+                {
+                    palette[i] = ((8 - i) * palette[0] + (i - 1) * palette[1]) / 7;
+                }
+            }
+            else
+            {
+                for (uint32_t i = 2; i < 6; i++)
+                {
+                    palette[i] = ((6 - i) * palette[0] + (i - 1) * palette[1]) / 5;
+                }
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+
+            uint64_t index_bits = 0;
+            for (uint32_t i = 0; i < 6; i++)
+            {
+                index_bits |= static_cast<uint64_t>(input[2 + i]) << (i * 8);
+            }
+
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                texels[i * 4 + channel] = static_cast<uint8_t>(palette[(index_bits >> (i * 3)) & 7]);
+            }
+        }
+
+        //= BC7 (MODE 6) =========================================================================
+        // 7 bits per channel plus a p-bit which is shared by the channels of an endpoint, whichever p-bit fits best wins
+        void quantize_bc7(const float4 endpoint, uint32_t* channels, uint32_t& p_bit)
+        {
+            alignas(16) float v[4];
+            Simd::Store(v, endpoint);
+
+            float error_min = numeric_limits<float>::max();
+            for (uint32_t p = 0; p < 2; p++)
+            {
+                uint32_t quantized[4];
+                float error = 0.0f;
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    quantized[c]    = static_cast<uint32_t>(min(max(round((v[c] - p) / 2.0f), 0.0f), 127.0f));
+                    const float d   = static_cast<float>((quantized[c] << 1) | p) - v[c];
+                    error          += d * d;
+                }
+
+                if (error < error_min)
+                {
+                    error_min = error;
+                    p_bit     = p;
+                    memcpy(channels, quantized, sizeof(quantized));
+                }
+            }
+        }
+
+        float4 dequantize_bc7(const uint32_t* channels, const uint32_t p_bit)
+        {
+            return Simd::Set
+            (
+                static_cast<float>((channels[0] << 1) | p_bit),
+                static_cast<float>((channels[1] << 1) | p_bit),
+                static_cast<float>((channels[2] << 1) | p_bit),
+                static_cast<float>((channels[3] << 1) | p_bit)
+            );
+        }
+
+        float encode_bc7_endpoints(const Block& block, const float4 endpoint_0, const float4 endpoint_1, uint8_t* output)
+        {
+            uint32_t channels_0[4];
+            uint32_t channels_1[4];
+            uint32_t p_bit_0;
+            uint32_t p_bit_1;
+            quantize_bc7(endpoint_0, channels_0, p_bit_0);
+            quantize_bc7(endpoint_1, channels_1, p_bit_1);
+
+            float4 palette[16];
+            uint8_t indices[16];
+            make_palette(dequantize_bc7(channels_0, p_bit_0), dequantize_bc7(channels_1, p_bit_1), bc7_weights, 16, palette);
+            const float error = select_indices(block, palette, 16, indices);
+
+            // The first (anchor) index is stored without its top bit, flip the line if it would need it
+            if (indices[0] & 8)
+            {
+                swap(channels_0, channels_1);
+                swap(p_bit_0, p_bit_1);
+                for (uint8_t& index : indices)
+                {
+                    index = 15 - index;
+                }
+            }
+
+            uint64_t bits[2]  = { 0, 0 };
+            uint32_t position = 0;
+            const auto write  = [&bits, &position](const uint32_t value, const uint32_t count)
+            {
+                for (uint32_t i = 0; i < count; i++, position++)
+                {
+                    bits[position / 64] |= static_cast<uint64_t>((value >> i) & 1) << (position % 64);
+                }
+            };
+
+            write(1 << 6, 7); // mode 6
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                write(channels_0[c], 7);
+                write(channels_1[c], 7);
+            }
+            write(p_bit_0, 1);
+            write(p_bit_1, 1);
+            write(indices[0], 3);
+            for (uint32_t i = 1; i < 16; i++)
+            {
+                write(indices[i], 4);
+            }
+
+            memcpy(output, bits, 16);
+
+            return error;
+        }
+
+        void encode_bc7(const Block& block, uint8_t* output)
+        {
+            encode_block<16>(block, bc7_weights, 16, output, encode_bc7_endpoints);
+        }
+
+        void decode_bc7(const uint8_t* input, uint8_t* texels)
+        {
+            uint64_t bits[2];
+            memcpy(bits, input, 16);
+
+            uint32_t position = 0;
+            const auto read   = [&bits, &position](const uint32_t count)
+            {
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < count; i++, position++)
+                {
+                    value |= static_cast<uint32_t>((bits[position / 64] >> (position % 64)) & 1) << i;
+                }
+                return value;
+            };
+
+            // Only mode 6 is written
+            if (read(7) != (1 << 6))
+            {
+                memset(texels, 0, 64);
+                return;
+            }
+
+            uint32_t endpoints[2][4];
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                endpoints[0][c] = read(7) << 1;
+                endpoints[1][c] = read(7) << 1;
+            }
+            const uint32_t p_bit_0 = read(1);
+            const uint32_t p_bit_1 = read(1);
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                endpoints[0][c] |= p_bit_0;
+                endpoints[1][c] |= p_bit_1;
+            }
+
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                const uint32_t weight = bc7_weights_int[read(i == 0 ? 3 : 4)];
+                for (uint32_t c = 0; c < 4; c++)
+                {
+                    texels[i * 4 + c] = static_cast<uint8_t>(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+                }
+            }
+        }
+    }
+
+    bool IsBlockFormat(const RHI_Format format)
+    {
+        return GetBlockSize(format) != 0;
+    }
+
+    uint32_t GetBlockSize(const RHI_Format format)
+    {
+        switch (format)
+        {
+            case RHI_Format_BC1_Unorm: return 8;
+            case RHI_Format_BC4_Unorm: return 8;
+            case RHI_Format_BC5_Unorm: return 16;
+            case RHI_Format_BC7_Unorm: return 16;
+            default:                   return 0;
+        }
+    }
+
+    vector<std::byte> Compress(const vector<std::byte>& texels, const uint32_t width, const uint32_t height, const RHI_Format format, Threading* threading /*= nullptr*/)
+    {
+        const uint32_t block_size = GetBlockSize(format);
+        if (block_size == 0 || width == 0 || height == 0 || texels.size() < width * height * 4)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return vector<std::byte>();
+        }
+
+        const uint32_t block_count_x = (width + 3) / 4;
+        const uint32_t block_count_y = (height + 3) / 4;
+        vector<std::byte> blocks(block_count_x * block_count_y * block_size);
+
+        const auto compress_row = [&](const uint32_t block_y)
+        {
+            Block block;
+            for (uint32_t block_x = 0; block_x < block_count_x; block_x++)
+            {
+                load_block(texels, width, height, block_x, block_y, block);
+
+                uint8_t* output = reinterpret_cast<uint8_t*>(&blocks[(block_y * block_count_x + block_x) * block_size]);
+                switch (format)
+                {
+                    case RHI_Format_BC1_Unorm: encode_bc1(block, output);                                   break;
+                    case RHI_Format_BC4_Unorm: encode_bc4(block, 0, output);                                break;
+                    case RHI_Format_BC5_Unorm: encode_bc4(block, 0, output); encode_bc4(block, 1, output + 8); break;
+                    case RHI_Format_BC7_Unorm: encode_bc7(block, output);                                   break;
+                    default: break;
+                }
+            }
+        };
+
+        if (threading)
+        {
+            threading->ParallelFor(block_count_y, compress_row);
+        }
+        else
+        {
+            for (uint32_t block_y = 0; block_y < block_count_y; block_y++)
+            {
+                compress_row(block_y);
+            }
+        }
+
+        return blocks;
+    }
+
+    vector<std::byte> Decompress(const vector<std::byte>& blocks, const uint32_t width, const uint32_t height, const RHI_Format format)
+    {
+        const uint32_t block_size    = GetBlockSize(format);
+        const uint32_t block_count_x = (width + 3) / 4;
+        const uint32_t block_count_y = (height + 3) / 4;
+        if (block_size == 0 || blocks.size() < block_count_x * block_count_y * block_size)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return vector<std::byte>();
+        }
+
+        vector<std::byte> texels(width * height * 4);
+        for (uint32_t block_y = 0; block_y < block_count_y; block_y++)
+        {
+            for (uint32_t block_x = 0; block_x < block_count_x; block_x++)
+            {
+                const uint8_t* input = reinterpret_cast<const uint8_t*>(&blocks[(block_y * block_count_x + block_x) * block_size]);
+
+                uint8_t block[64] = {};
+                switch (format)
+                {
+                    case RHI_Format_BC1_Unorm: decode_bc1(input, block);                                break;
+                    case RHI_Format_BC4_Unorm: decode_bc4(input, 0, block);                             break;
+                    case RHI_Format_BC5_Unorm: decode_bc4(input, 0, block); decode_bc4(input + 8, 1, block); break;
+                    case RHI_Format_BC7_Unorm: decode_bc7(input, block);                                break;
+                    default: break;
+                }
+
+                // Single channel formats don't write alpha
+                if (format == RHI_Format_BC4_Unorm || format == RHI_Format_BC5_Unorm)
+                {
+                    for (uint32_t i = 0; i < 16; i++)
+                    {
+                        block[i * 4 + 3] = 255;
+                    }
+                }
+
+                // Copy the texels which are inside the image
+                for (uint32_t y = 0; y < 4 && block_y * 4 + y < height; y++)
+                {
+                    for (uint32_t x = 0; x < 4 && block_x * 4 + x < width; x++)
+                    {
+                        memcpy(&texels[((block_y * 4 + y) * width + block_x * 4 + x) * 4], &block[(y * 4 + x) * 4], 4);
+                    }
+                }
+            }
+        }
+
+        return texels;
+    }
+
+    float ComputePsnr(const vector<std::byte>& texels, const vector<std::byte>& texels_decoded, const RHI_Format format)
+    {
+        uint32_t channel_count = 4;
+        switch (format)
+        {
+            case RHI_Format_BC1_Unorm: channel_count = 3; break;
+            case RHI_Format_BC4_Unorm: channel_count = 1; break;
+            case RHI_Format_BC5_Unorm: channel_count = 2; break;
+            default: break;
+        }
+
+        const size_t texel_count = min(texels.size(), texels_decoded.size()) / 4;
+        if (texel_count == 0)
+            return 0.0f;
+
+        double error = 0.0;
+        for (size_t i = 0; i < texel_count; i++)
+        {
+            for (uint32_t c = 0; c < channel_count; c++)
+            {
+                const double d = to_integer<int>(texels[i * 4 + c]) - to_integer<int>(texels_decoded[i * 4 + c]);
+                error += d * d;
+            }
+        }
+
+        const double mse = error / (texel_count * channel_count);
+        return mse > 0.0 ? static_cast<float>(10.0 * log10(255.0 * 255.0 / mse)) : numeric_limits<float>::infinity();
+    }
+}
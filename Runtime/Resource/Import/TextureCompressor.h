@@ -0,0 +1,54 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES =======================
+#include <vector>
+#include "../../RHI/RHI_Definition.h"
+//==================================
+
+namespace Spartan
+{
+    class Threading;
+}
+
+// Block compression of RGBA8 texels, done once when a texture is imported. Images are split into 4x4 blocks,
+// sizes which aren't a multiple of 4 repeat their last row/column to fill the blocks at the edges.
+namespace Spartan::TextureCompressor
+{
+    bool IsBlockFormat(RHI_Format format);
+
+    // Bytes per 4x4 block, 8 for BC1/BC4 and 16 for BC5/BC7
+    uint32_t GetBlockSize(RHI_Format format);
+
+    // BC1 keeps rgb (opaque, four color mode), BC4 red, BC5 red and green and BC7 all four channels (mode 6, a single rgba line).
+    // Endpoints are fit along the principal axis of each block and then refined with least squares for the indices they got.
+    // Rows of blocks are encoded in parallel when a threading subsystem is provided.
+    std::vector<std::byte> Compress(const std::vector<std::byte>& texels, uint32_t width, uint32_t height, RHI_Format format, Threading* threading = nullptr);
+
+    // Decodes blocks (as written by Compress) back to RGBA8 texels, channels the format doesn't store are 0 and alpha is 255
+    std::vector<std::byte> Decompress(const std::vector<std::byte>& blocks, uint32_t width, uint32_t height, RHI_Format format);
+
+    // Peak signal to noise ratio in dB, over the channels the format stores, infinite if the texels are identical
+    float ComputePsnr(const std::vector<std::byte>& texels, const std::vector<std::byte>& texels_decoded, RHI_Format format);
+}
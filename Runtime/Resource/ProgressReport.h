@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Core/EngineDefs.h"
 #include <string>
 #include <map>
+#include <atomic>
 //=============================
 
 namespace Spartan
@@ -46,7 +47,7 @@ namespace Spartan
 		}
 
 		std::string status;
-		int jobsDone;
+		std::atomic<int> jobsDone; // can be incremented by worker threads
 		int jobCount;
 		bool isLoading;
 	};
@@ -70,6 +71,7 @@ namespace Spartan
 		const std::string& GetStatus(int progressID)				{ return m_reports[progressID].status; }
 		void SetStatus(int progressID, const std::string& status)	{ m_reports[progressID].status = status; }
 		void SetJobCount(int progressID, int jobCount)				{ m_reports[progressID].jobCount = jobCount;}
+		int GetJobCount(int progressID)								{ return m_reports[progressID].jobCount; }
 		void IncrementJobsDone(int progressID)						{ m_reports[progressID].jobsDone++; }
 		void SetJobsDone(int progressID, int jobsDone)				{ m_reports[progressID].jobsDone = jobsDone; }
 		float GetPercentage(int progressID)							{ return static_cast<float>(m_reports[progressID].jobsDone) / static_cast<float>(m_reports[progressID].jobCount); }
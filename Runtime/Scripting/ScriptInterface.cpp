@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <angelscript.h>
 #include "../Rendering/Material.h"
 #include "../Input/Input.h"
+#include "../World/World.h"
 #include "../World/Entity.h"
 #include "../World/Components/RigidBody.h"
 #include "../World/Components/Camera.h"
@@ -47,6 +48,7 @@ namespace Spartan
 		RegisterTypes();
 		RegisterMath();
 		RegisterInput();
+		RegisterWorld();
 		RegisterVector2();
 		RegisterVector3();
 		RegisterQuaternion();
@@ -122,6 +124,7 @@ namespace Spartan
     {
 		m_scriptEngine->RegisterObjectType("Settings", 0, asOBJ_REF | asOBJ_NOCOUNT);
 		m_scriptEngine->RegisterObjectType("Input", 0, asOBJ_REF | asOBJ_NOCOUNT);
+		m_scriptEngine->RegisterObjectType("World", 0, asOBJ_REF | asOBJ_NOCOUNT);
 		m_scriptEngine->RegisterObjectType("Time", 0, asOBJ_REF | asOBJ_NOCOUNT);
 		m_scriptEngine->RegisterObjectType("Entity", 0, asOBJ_REF | asOBJ_NOCOUNT);
 		m_scriptEngine->RegisterObjectType("Transform", 0, asOBJ_REF | asOBJ_NOCOUNT);
@@ -148,6 +151,31 @@ namespace Spartan
 		m_scriptEngine->RegisterObjectMethod("Input", "bool GetKeyUp(KeyCode key)", asMETHOD(Input, GetKeyUp), asCALL_THISCALL);
 	}
 
+	/*------------------------------------------------------------------------------
+										[WORLD]
+	------------------------------------------------------------------------------*/
+	static bool world_ray_trace_any(World* world, const Vector3& start, const Vector3& end)
+	{
+		return world->RayTraceAny(Ray(start, end));
+	}
+
+	static Entity* world_ray_trace_closest(World* world, const Vector3& start, const Vector3& end, Vector3& position)
+	{
+		RayHit hit;
+		if (!world->RayTraceClosest(Ray(start, end), &hit))
+			return nullptr;
+
+		position = hit.m_position;
+		return hit.m_entity.get();
+	}
+
+	void ScriptInterface::RegisterWorld() const
+	{
+		m_scriptEngine->RegisterGlobalProperty("World world", m_context->GetSubsystem<World>());
+		m_scriptEngine->RegisterObjectMethod("World", "bool RayTraceAny(const Vector3 &in, const Vector3 &in)", asFUNCTION(world_ray_trace_any), asCALL_CDECL_OBJFIRST);
+		m_scriptEngine->RegisterObjectMethod("World", "Entity@ RayTraceClosest(const Vector3 &in, const Vector3 &in, Vector3 &out)", asFUNCTION(world_ray_trace_closest), asCALL_CDECL_OBJFIRST);
+	}
+
 	/*------------------------------------------------------------------------------
 										[Entity]
 	------------------------------------------------------------------------------*/
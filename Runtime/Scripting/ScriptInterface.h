@@ -36,6 +36,7 @@ namespace Spartan
 		void RegisterEnumerations() const;
 		void RegisterTypes() const;
 		void RegisterInput() const;
+		void RegisterWorld() const;
 		void RegisterEntity();
 		void RegisterTransform() const;
 		void RegisterMaterial() const;
@@ -0,0 +1,75 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =========
+#include <array>
+#include <atomic>
+#include <cstdint>
+//====================
+
+namespace Spartan
+{
+    // Lock-free ring buffer with a single producer thread and a single consumer thread
+    template <typename T, uint32_t capacity>
+    class RingBuffer
+    {
+        static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        // Producer: fills the next free slot in place, returns false if the buffer is full
+        template <typename Function>
+        bool TryPush(Function&& fill)
+        {
+            const uint32_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) == capacity)
+                return false;
+
+            fill(m_items[head & (capacity - 1)]);
+            m_head.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // Consumer: invokes the function for every item pushed so far and frees their slots
+        template <typename Function>
+        void Pop(Function&& function)
+        {
+            const uint32_t head = m_head.load(std::memory_order_acquire);
+            uint32_t tail       = m_tail.load(std::memory_order_relaxed);
+
+            for (; tail != head; tail++)
+            {
+                function(m_items[tail & (capacity - 1)]);
+            }
+
+            m_tail.store(tail, std::memory_order_release);
+        }
+
+        bool IsEmpty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+    private:
+        std::array<T, capacity> m_items;
+        std::atomic<uint32_t> m_head = 0;
+        std::atomic<uint32_t> m_tail = 0;
+    };
+}
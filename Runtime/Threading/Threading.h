@@ -27,6 +27,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <mutex>
 #include <deque>
 #include <map>
+#include <atomic>
+#include <algorithm>
 #include <functional>
 #include "../Logging/Log.h"
 #include "../Core/ISubsystem.h"
@@ -81,36 +83,56 @@ namespace Spartan
 			m_condition_var.notify_one();
 		}
 
+        // Invokes function(start, end) over [0, range) split in one chunk per thread (plus the calling one).
+        // It goes through ParallelFor(), so it's safe to call from a task, the caller works on the chunks instead of waiting for the pool.
         template <typename Function>
         void Loop(Function&& function, uint32_t range)
         {
-            uint32_t available_threads  = GetThreadsAvailable();
-            vector<bool> tasks_done     = vector<bool>(available_threads, false);
-            const uint32_t task_count         = available_threads + 1; // plus one for the current thread
+            const uint32_t task_count   = GetThreadsAvailable() + 1; // plus one for the current thread
+            const uint32_t chunk_size   = range / task_count;
 
-            uint32_t start  = 0;
-            uint32_t end    = 0;
-            for (uint32_t i = 0; i < available_threads; i++)
+            ParallelFor(task_count, [&function, task_count, chunk_size, range](const uint32_t i)
             {
-                start   = (range / task_count) * i;
-                end     = start + (range / task_count);
-
-                // Kick off task
-                AddTask([&function, &tasks_done, i, start, end] { function(start, end); tasks_done[i] = true; });
-            }
+                const uint32_t start    = chunk_size * i;
+                const uint32_t end      = i == task_count - 1 ? range : start + chunk_size;
+                function(start, end);
+            });
+        }
 
-            // Do last task in the current thread
-            function(end, range);
+        // Invokes function(i) for every i in [0, count) on the pool and on the calling thread, returns once all invocations are done.
+        // Work is handed out one index at a time, so if the pool is busy, the calling thread simply does more of it.
+        template <typename Function>
+        void ParallelFor(uint32_t count, Function&& function)
+        {
+            struct State
+            {
+                std::atomic<uint32_t> next = 0;
+                std::atomic<uint32_t> done = 0;
+            };
 
-            // Wait till the threads are done
-            uint32_t tasks = 0;
-            while (tasks != tasks_done.size())
+            // Tasks which start late (after all the work is done) only touch the state
+            auto state  = std::make_shared<State>();
+            auto work   = [state, count, &function]()
             {
-                tasks = 0;
-                for (const bool job_done : tasks_done)
+                for (uint32_t i = state->next++; i < count; i = state->next++)
                 {
-                    tasks += job_done ? 1 : 0;
+                    function(i);
+                    state->done++;
                 }
+            };
+
+            const uint32_t task_count = std::min(m_thread_count, count > 0 ? count - 1 : 0);
+            for (uint32_t i = 0; i < task_count; i++)
+            {
+                AddTask(work);
+            }
+
+            work();
+
+            // Wait for the invocations which are still in flight
+            while (state->done != count)
+            {
+                std::this_thread::yield();
             }
         }
 
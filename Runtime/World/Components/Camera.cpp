@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Transform.h"
 #include "Renderable.h"
 #include "../Entity.h"
+#include "../World.h"
 #include "../../Math/RayHit.h"
 #include "../../Core/Context.h"
 #include "../../Input/Input.h"
@@ -170,58 +171,10 @@ namespace Spartan
 		if (x_outside || y_outside)
 			return false;
 
-		// Trace ray
-		m_ray		= Ray(GetTransform()->GetPosition(), Unproject(mouse_position_relative));
-		auto hits	= m_ray.Trace(m_context);
-
-        // Create a struct to hold hit related data
-        struct scored_entity
-        {
-            scored_entity(const shared_ptr<Entity>& entity, const float distance_ray, const float distance_obb)
-            {
-                this->entity = entity;
-                score = distance_ray * 0.1f + distance_obb * 0.9f;
-            }
-
-            shared_ptr<Entity> entity;
-            float score;
-        };
-        vector<scored_entity> m_scored;
-
-        // Go through all the hits and score them
-        m_scored.reserve(hits.size());
-		for (const auto& hit : hits)
-		{
-            // Filter hits that start inside OBBs
-			if (hit.m_inside)
-				continue;
-
-            // Score this hit
-            const BoundingBox& aabb = hit.m_entity->GetComponent<Renderable>()->GetAabb();
-            const float distance_abb      = Vector3::DistanceSquared(hit.m_position, aabb.GetCenter());
-            m_scored.emplace_back
-            (
-                hit.m_entity,
-                1.0f - hit.m_distance / m_ray.GetLength(),          // normalized ray distance score
-                1.0f - (distance_abb / aabb.GetExtents().Length())  // normalized aabb center distance score
-            );
-		}
-        m_scored.shrink_to_fit();
-
-        // Return entity with highest score
-        picked = nullptr;
-        if (!m_scored.empty())
-        {
-            // ordering descendingly
-            sort(m_scored.begin(), m_scored.end(), [](const scored_entity& a, const scored_entity& b) { return a.score > b.score; });
-
-            picked = m_scored.front().entity;
-            return true;
-        }
-
-        // If no hit was good enough but there are hits, compromise by picking the closest one
-        if (!picked && !hits.empty())
-            picked = hits.front().m_entity;
+		// Trace ray, against triangles, so the closest hit is the entity under the cursor
+		m_ray = Ray(GetTransform()->GetPosition(), Unproject(mouse_position_relative));
+		RayHit hit;
+		picked = m_context->GetSubsystem<World>()->RayTraceClosest(m_ray, &hit) ? hit.m_entity : nullptr;
 
 		return true;
 	}
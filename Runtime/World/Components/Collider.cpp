@@ -184,12 +184,11 @@ namespace Spartan
 				return;
 			}
 
-			// Get geometry
-			vector<uint32_t> indices;
-			vector<RHI_Vertex_PosTexNorTan> vertices;
-			renderable->GeometryGet(&indices, &vertices);
+			// Get geometry (the hull only needs positions)
+			vector<Vector3> positions;
+			renderable->GeometryGetPositions(&positions);
 
-			if (vertices.empty())
+			if (positions.empty())
 			{
 				LOG_WARNING("No vertices.");
 				return;
@@ -197,9 +196,9 @@ namespace Spartan
 
 			// Construct hull approximation
 			m_shape = new btConvexHullShape(
-				(btScalar*)&vertices[0],					// points
-				renderable->GeometryVertexCount(),			// point count
-				static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)));	// stride
+				(btScalar*)&positions[0],					// points
+				static_cast<int>(positions.size()),			// point count
+				static_cast<uint32_t>(sizeof(Vector3)));	// stride
 
 			// Scaling has to be done before (potential) optimization
 			m_shape->setLocalScaling(ToBtVector3(worldScale));
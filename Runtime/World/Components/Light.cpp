@@ -171,8 +171,7 @@ namespace Spartan
             CreateShadowMap();
         }
 
-        
-        m_context->GetSubsystem<World>()->MakeDirty();
+        m_context->GetSubsystem<World>()->MakeDirty(m_entity);
 	}
 
 	void Light::SetShadowsEnabled(bool cast_shadows)
@@ -362,11 +361,7 @@ namespace Spartan
             };
 
             // Project frustum corners into world space
-            for (Vector3& frustum_corner : frustum_corners)
-            {
-                Vector4 inverted_corner = Vector4(frustum_corner, 1.0f) * view_projection_inverted;
-                frustum_corner = inverted_corner / inverted_corner.w;
-            }
+            Matrix::TransformPoints(view_projection_inverted, frustum_corners, frustum_corners, 8);
 
             // Compute split distance
             {
@@ -22,11 +22,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES ============================
 #include "Renderable.h"
 #include "Transform.h"
+#include "Camera.h"
 #include "../../IO/FileStream.h"
 #include "../../Resource/ResourceCache.h"
 #include "../../Utilities/Geometry.h"
 #include "../../RHI/RHI_Texture2D.h"
 #include "../../Rendering/Model.h"
+#include "../../Math/Ray.h"
+#include "../World.h"
 //=======================================
 
 //= NAMESPACES ===============
@@ -36,6 +39,10 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+	// Projected size (fraction of the screen height) below which each level of detail after the first is used
+	static const float lod_screen_sizes[renderable_lod_count - 1] = { 0.25f, 0.12f, 0.06f };
+	static const float lod_shadow_scale = 2.0f;
+
 	inline void build(const Geometry_Type type, Renderable* renderable)
 	{	
 		auto model = make_shared<Model>(renderable->GetContext());
@@ -121,6 +128,12 @@ namespace Spartan
 		stream->Write(m_geometryIndexCount);
 		stream->Write(m_geometryVertexOffset);
 		stream->Write(m_geometryVertexCount);
+		stream->Write(static_cast<uint32_t>(m_geometry_lods.size()));
+		for (const Geometry_Lod& lod : m_geometry_lods)
+		{
+			stream->Write(lod.index_offset);
+			stream->Write(lod.index_count);
+		}
 		stream->Write(m_bounding_box);
 		stream->Write(m_model ? m_model->GetResourceName() : "");
 
@@ -142,6 +155,12 @@ namespace Spartan
 		m_geometryIndexCount	= stream->ReadAs<uint32_t>();
 		m_geometryVertexOffset	= stream->ReadAs<uint32_t>();
 		m_geometryVertexCount	= stream->ReadAs<uint32_t>();
+		m_geometry_lods.resize(stream->GetVersion() >= World_Version_Lods ? stream->ReadAs<uint32_t>() : 0);
+		for (Geometry_Lod& lod : m_geometry_lods)
+		{
+			stream->Read(&lod.index_offset);
+			stream->Read(&lod.index_count);
+		}
 		stream->Read(&m_bounding_box);
 		string model_name;
 		stream->Read(&model_name);
@@ -176,6 +195,7 @@ namespace Spartan
 		m_geometryIndexCount	= index_count;
 		m_geometryVertexOffset	= vertex_offset;
 		m_geometryVertexCount	= vertex_count;
+		m_geometry_lods.clear();
 		m_bounding_box			= bounding_box;
 		m_model					= model ? model->GetSharedPtr() : nullptr;
 	}
@@ -206,6 +226,75 @@ namespace Spartan
 		m_model->GetGeometry(m_geometryIndexOffset, m_geometryIndexCount, m_geometryVertexOffset, m_geometryVertexCount, indices, vertices);
 	}
 
+	void Renderable::GeometryGetPositions(vector<Vector3>* positions)
+	{
+		if (!m_model)
+		{
+			LOG_ERROR("Invalid model");
+			return;
+		}
+
+		// Physics asks again whenever the scale changes, so have the model keep a compact copy instead of re-reading it
+		m_model->SetGeometryKeepPositions(true);
+		m_model->GetGeometryPositions(m_geometryVertexOffset, m_geometryVertexCount, positions);
+	}
+
+	float Renderable::GeometryRayTrace(const Ray& ray, const bool any_hit, uint32_t* triangle_index /*= nullptr*/, Vector2* barycentrics /*= nullptr*/)
+	{
+		// Triangles, in the geometry's local space
+		if (m_model)
+		{
+			const Matrix transform_inverse	= GetTransform()->GetMatrix().Inverted();
+			const Ray ray_local				= Ray(ray.GetStart() * transform_inverse, ray.GetEnd() * transform_inverse);
+
+			float distance_local = INFINITY;
+			if (ray_local.GetLength() > 0.0f && m_model->RayTrace(m_geometryIndexOffset, ray_local, any_hit, &distance_local, triangle_index, barycentrics))
+			{
+				// Both rays span the same segment, so the distance scales with their lengths
+				return distance_local == INFINITY ? INFINITY : distance_local * (ray.GetLength() / ray_local.GetLength());
+			}
+		}
+
+		// Bounding box, which doesn't count when the ray starts inside of it (it would hide everything within)
+		const float distance = ray.HitDistance(GetAabb());
+		return (distance != 0.0f && distance <= ray.GetLength()) ? distance : INFINITY;
+	}
+
+	void Renderable::GeometryLodAdd(const uint32_t index_offset, const uint32_t index_count)
+	{
+		if (m_geometry_lods.size() + 1 >= renderable_lod_count)
+		{
+			LOG_WARNING("Maximum level of detail count reached");
+			return;
+		}
+
+		m_geometry_lods.push_back({ index_offset, index_count });
+	}
+
+	uint32_t Renderable::GeometryLodSelect(const Camera* camera, const bool shadow /*= false*/)
+	{
+		if (m_geometry_lods.empty() || !camera || camera->GetProjectionType() != Projection_Perspective)
+			return 0;
+
+		// Projected size of the bounding sphere, as a fraction of the screen height
+		const BoundingBox& aabb	= GetAabb();
+		const float radius		= aabb.GetExtents().Length();
+		const float distance	= Vector3::Distance(camera->GetTransform()->GetPosition(), aabb.GetCenter());
+		if (distance <= radius)
+			return 0;
+
+		const float screen_size	= radius / (distance * tan(camera->GetFovVerticalRad() * 0.5f));
+		const float scale		= shadow ? lod_shadow_scale : 1.0f;
+
+		uint32_t lod = 0;
+		while (lod < m_geometry_lods.size() && screen_size < lod_screen_sizes[lod] * scale)
+		{
+			lod++;
+		}
+
+		return lod;
+	}
+
     const BoundingBox& Renderable::GetAabb()
 	{
         if (m_last_transform != GetTransform()->GetMatrix())
@@ -33,10 +33,13 @@ namespace Spartan
 	class Model;
 	class Mesh;
 	class Light;
+	class Camera;
 	class Material;
 	namespace Math
 	{
 		class Vector3;
+		class Vector2;
+		class Ray;
 	}
 
 	enum Geometry_Type
@@ -49,6 +52,16 @@ namespace Spartan
 		Geometry_Default_Cone
 	};
 
+	// An index range into the model which uses the vertices of the full resolution geometry
+	struct Geometry_Lod
+	{
+		uint32_t index_offset	= 0;
+		uint32_t index_count	= 0;
+	};
+
+	// Levels of detail, including the full resolution geometry
+	static const uint32_t renderable_lod_count = 4;
+
 	class SPARTAN_CLASS Renderable : public IComponent
 	{
 	public:
@@ -73,6 +86,7 @@ namespace Spartan
         void GeometryClear();
         void GeometrySet(Geometry_Type type);
 		void GeometryGet(std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices) const;
+		void GeometryGetPositions(std::vector<Math::Vector3>* positions);
 		auto GeometryIndexOffset()	                const { return m_geometryIndexOffset; }
 		auto GeometryIndexCount()	                const { return m_geometryIndexCount; }		
 		auto GeometryVertexOffset()                 const { return m_geometryVertexOffset; }
@@ -84,6 +98,22 @@ namespace Spartan
         const Math::BoundingBox& GetAabb();
 		//=====================================================================================================
 
+		//= RAY QUERIES =====================================================================================
+		// Tests the geometry's triangles, or its bounding box if the model has none for it.
+		// Returns the distance along the (world space) ray, or infinity if there is no hit.
+		float GeometryRayTrace(const Math::Ray& ray, bool any_hit, uint32_t* triangle_index = nullptr, Math::Vector2* barycentrics = nullptr);
+		//=====================================================================================================
+
+		//= LEVEL OF DETAIL ===================================================================================
+		void GeometryLodAdd(uint32_t index_offset, uint32_t index_count);
+		uint32_t GeometryLodCount()							const { return static_cast<uint32_t>(m_geometry_lods.size()) + 1; }
+		uint32_t GeometryIndexOffset(const uint32_t lod)	const { return lod == 0 ? m_geometryIndexOffset : m_geometry_lods[lod - 1].index_offset; }
+		uint32_t GeometryIndexCount(const uint32_t lod)		const { return lod == 0 ? m_geometryIndexCount : m_geometry_lods[lod - 1].index_count; }
+
+		// Picks a level from the projected size of the bounding box, shadows switch sooner
+		uint32_t GeometryLodSelect(const Camera* camera, bool shadow = false);
+		//=====================================================================================================
+
 		//= MATERIAL ============================================================
 		// Sets a material from memory (adds it to the resource cache by default)
 		void SetMaterial(const std::shared_ptr<Material>& material);
@@ -110,6 +140,7 @@ namespace Spartan
 		uint32_t m_geometryIndexCount;
 		uint32_t m_geometryVertexOffset;
 		uint32_t m_geometryVertexCount;
+		std::vector<Geometry_Lod> m_geometry_lods;
 		std::shared_ptr<Model> m_model;
 		Geometry_Type m_geometry_type;
 		Math::BoundingBox m_bounding_box;
@@ -395,9 +395,9 @@ namespace Spartan
             renderable->GeometrySet(
                 "Terrain",
                 0,                                  // index offset
-                model->GetMesh()->Indices_Count(),  // index count
+                model->GetIndexCount(),             // index count
                 0,                                  // vertex offset
-                model->GetMesh()->Vertices_Count(), // vertex count
+                model->GetVertexCount(),            // vertex count
                 model->GetAabb(),
                 model.get()
             );
@@ -406,7 +406,7 @@ namespace Spartan
         }
     }
 
-    void Terrain::UpdateFromVertices(const vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
+    void Terrain::UpdateFromVertices(vector<uint32_t>& indices, vector<RHI_Vertex_PosTexNorTan>& vertices)
     {
         // Add vertices and indices into a model struct (and cache that)
         if (!m_model)
@@ -121,6 +121,47 @@ namespace Spartan
 		clone_entity_and_descendants(this);
 	}
 
+    void Entity::SetName(const string& name)
+    {
+        if (name == m_name)
+            return;
+
+        const string name_old = m_name;
+        m_name = name;
+
+        // Keep the world's lookup tables in sync
+        if (World* world = m_context->GetSubsystem<World>())
+        {
+            world->_EntityOnNameChanged(this, name_old);
+        }
+    }
+
+    void Entity::SetActive(const bool active)
+    {
+        if (active == m_is_active)
+            return;
+
+        m_is_active = active;
+
+        // Make the scene resolve, as subsystems (e.g. the renderer) ignore inactive entities
+        FIRE_EVENT_DATA(Event_World_Resolve_Pending, this);
+    }
+
+    void Entity::SetId(const uint32_t id)
+    {
+        if (id == m_id)
+            return;
+
+        const uint32_t id_old = m_id;
+        m_id = id;
+
+        // Keep the world's lookup tables in sync
+        if (World* world = m_context->GetSubsystem<World>())
+        {
+            world->_EntityOnIdChanged(this, id_old);
+        }
+    }
+
 	void Entity::Start()
 	{
 		// call component Start()
@@ -211,8 +252,8 @@ namespace Spartan
         {
             stream->Read(&m_is_active);
             stream->Read(&m_hierarchy_visibility);
-            stream->Read(&m_id);
-            stream->Read(&m_name);
+            SetId(stream->ReadAs<uint32_t>());
+            SetName(stream->ReadAs<string>());
         }
 
         // COMPONENTS
@@ -272,7 +313,7 @@ namespace Spartan
         }
 
 		// Make the scene resolve
-		FIRE_EVENT(Event_World_Resolve_Pending);
+		FIRE_EVENT_DATA(Event_World_Resolve_Pending, this);
 	}
 
     IComponent* Entity::AddComponent(const ComponentType type, uint32_t id /*= 0*/)
@@ -336,6 +377,6 @@ namespace Spartan
         }
 
 		// Make the scene resolve
-		FIRE_EVENT(Event_World_Resolve_Pending);
+		FIRE_EVENT_DATA(Event_World_Resolve_Pending, this);
 	}
 }
@@ -21,12 +21,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==========================
 #include "World.h"
+#include <unordered_set>
+#include <algorithm>
 #include "Entity.h"
 #include "Components/Transform.h"
 #include "Components/Camera.h"
 #include "Components/Light.h"
 #include "Components/Environment.h"
 #include "Components/AudioListener.h"
+#include "Components/Renderable.h"
 #include "../Core/Engine.h"
 #include "../Core/Stopwatch.h"
 #include "../Resource/ResourceCache.h"
@@ -44,12 +47,36 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // Leads versioned files, unversioned ones lead with the root entity count which is never this large
+    static const uint32_t world_file_magic = 0xFFFF5744;
+
 	World::World(Context* context) : ISubsystem(context)
 	{
 		// Subscribe to events
-		SUBSCRIBE_TO_EVENT(Event_World_Resolve_Pending, [this](Variant) { m_is_dirty = true; });
-		SUBSCRIBE_TO_EVENT(Event_World_Stop,	        [this](Variant)	{ m_state = Idle; });
-		SUBSCRIBE_TO_EVENT(Event_World_Start,	        [this](Variant)	{ m_state = Ticking; });
+		SUBSCRIBE_TO_EVENT(Event_World_Resolve_Pending, [this](const Variant& var)
+        {
+            // Entities pass themselves along, so only they have to be resolved
+            Entity* entity = var.Is<Entity*>() ? var.Get<Entity*>() : nullptr;
+            MakeDirty(entity);
+        });
+
+        // A loader which asked for the entities (or already has them) owns the state until it's done, it would wait forever otherwise
+		SUBSCRIBE_TO_EVENT(Event_World_Stop, [this](Variant)
+        {
+            lock_guard<mutex> lock(m_mutex_state);
+            if (m_state != Request_Loading && m_state != Loading)
+            {
+                m_state = Idle;
+            }
+        });
+		SUBSCRIBE_TO_EVENT(Event_World_Start, [this](Variant)
+        {
+            lock_guard<mutex> lock(m_mutex_state);
+            if (m_state != Request_Loading && m_state != Loading)
+            {
+                m_state = Ticking;
+            }
+        });
 	}
 
 	World::~World()
@@ -61,8 +88,9 @@ namespace Spartan
 
 	bool World::Initialize()
 	{
-		m_input		= m_context->GetSubsystem<Input>();
-		m_profiler	= m_context->GetSubsystem<Profiler>();
+		m_input		    = m_context->GetSubsystem<Input>();
+		m_profiler	    = m_context->GetSubsystem<Profiler>();
+        m_thread_id_tick = this_thread::get_id();
 
 		CreateCamera();
 		CreateEnvironment();
@@ -73,9 +101,14 @@ namespace Spartan
 
 	void World::Tick(float delta_time)
 	{	
+		// Hand the entities over to the loading thread, this is a frame boundary so nothing is using them
 		if (m_state == Request_Loading)
 		{
-			m_state = Loading;
+            {
+                lock_guard<mutex> lock(m_mutex_state);
+                m_state = Loading;
+            }
+            m_condition_state.notify_all();
 			return;
 		}
 
@@ -84,6 +117,9 @@ namespace Spartan
 
         SCOPED_TIME_BLOCK(m_profiler);
 
+        // Entities are about to move, scripts querying rays while ticking get a refitted bvh
+        RayBvhRefit();
+
         // Tick entities
 		{
             // Detect game toggling
@@ -116,25 +152,61 @@ namespace Spartan
             }
 		}
 
+        // Queries made after the tick (e.g. picking) have to see where everything ended up
+        RayBvhRefit();
+
         if (m_is_dirty)
         {
-            // Update dirty entities
+            // Entities were added, removed or changed, the bvh has to be rebuilt
+            RayBvhInvalidate();
+
+            // Remove entities which are pending destruction
+            {
+                // Swap, as removing can mark more entities (descendants) for destruction
+                vector<shared_ptr<Entity>> entities_pending_destruction;
+                entities_pending_destruction.swap(m_entities_pending_destruction);
+
+                for (const auto& entity : entities_pending_destruction)
+                {
+                    _EntityRemove(entity);
+                }
+            }
+
+            // Build the delta
             {
-                // Make a copy so we can iterate while removing entities
-                auto entities_copy = m_entities;
+                lock_guard<mutex> lock(m_mutex_entities_changed);
 
-                for (const auto& entity : entities_copy)
+                if (m_delta.full)
                 {
-                    if (entity->IsPendingDestruction())
+                    m_delta.added   = m_entities;
+                    m_delta.removed.clear();
+                    m_delta.changed.clear();
+                }
+                else
+                {
+                    // Entities which were just added will be acquired in full anyway
+                    unordered_set<const Entity*> entities_resolved;
+                    for (const auto& entity : m_delta.added)
+                    {
+                        entities_resolved.emplace(entity.get());
+                    }
+
+                    for (const Entity* entity : m_entities_changed)
                     {
-                        _EntityRemove(entity);
+                        const int64_t index = _EntityIndexGet(entity);
+                        if (index == -1 || !entities_resolved.emplace(entity).second)
+                            continue;
+
+                        m_delta.changed.emplace_back(m_entities[index]);
                     }
                 }
+                m_entities_changed.clear();
             }
 
             // Notify Renderer
-            FIRE_EVENT_DATA(Event_World_Resolve_Complete, m_entities);
-            m_is_dirty = false;
+            FIRE_EVENT_DATA(Event_World_Resolve_Complete, static_cast<const WorldDelta*>(&m_delta));
+            m_delta.Clear();
+            m_is_dirty = !m_entities_pending_destruction.empty();
         }
 	}
 
@@ -145,6 +217,16 @@ namespace Spartan
 
         m_entities.clear();
         m_entities.shrink_to_fit();
+        m_entity_index_by_id.clear();
+        m_entity_ids_by_name.clear();
+        m_entities_pending_destruction.clear();
+        RayBvhInvalidate();
+
+        // Subscribers have to start over
+        lock_guard<mutex> lock(m_mutex_entities_changed);
+        m_entities_changed.clear();
+        m_delta.Clear();
+        m_delta.full = true;
 
 		m_is_dirty = true;
 	}
@@ -182,6 +264,11 @@ namespace Spartan
 
 		ProgressReport::Get().SetJobCount(g_progress_world, root_entity_count);
 
+		// Save version
+		file->Write(world_file_magic);
+		file->Write(static_cast<uint32_t>(World_Version_Latest));
+		file->SetVersion(World_Version_Latest);
+
 		// Save root entity count
 		file->Write(root_entity_count);
 
@@ -216,8 +303,18 @@ namespace Spartan
 			return false;
 		}
 
-		// Thread safety: Wait for scene and the renderer to stop the entities (could do double buffering in the future)
-		while (m_state != Loading || m_context->GetSubsystem<Renderer>()->IsRendering()) { m_state = Request_Loading; this_thread::sleep_for(chrono::milliseconds(16)); }
+		// Thread safety: Wait for the world to stop ticking the entities. The renderer keeps drawing
+        // its own snapshot (which owns the entities it references), so it doesn't have to be waited for.
+        if (this_thread::get_id() == m_thread_id_tick)
+        {
+            m_state = Loading;
+        }
+        else
+        {
+            unique_lock<mutex> lock(m_mutex_state);
+            m_state = Request_Loading;
+            m_condition_state.wait(lock, [this] { return m_state == Loading; });
+        }
 
 		// Start progress report and timing
 		ProgressReport::Get().Reset(g_progress_world);
@@ -231,15 +328,36 @@ namespace Spartan
 		// Read all the resource file paths
 		auto file = make_unique<FileStream>(file_path, FileStream_Read);
 		if (!file->IsOpen())
+        {
+            m_state = Ticking;
+            ProgressReport::Get().SetIsLoading(g_progress_world, false);
 			return false;
+        }
 
 		m_name = FileSystem::GetFileNameNoExtensionFromFilePath(file_path);
 
 		// Notify subsystems that need to load data
 		FIRE_EVENT(Event_World_Load);
 
-		// Load root entity count
-        const auto root_entity_count = file->ReadAs<uint32_t>();
+		// Load version and root entity count
+        auto root_entity_count = file->ReadAs<uint32_t>();
+        if (root_entity_count == world_file_magic)
+        {
+            file->SetVersion(file->ReadAs<uint32_t>());
+            root_entity_count = file->ReadAs<uint32_t>();
+        }
+        else
+        {
+            file->SetVersion(World_Version_Unversioned);
+        }
+
+        if (file->GetVersion() > World_Version_Latest)
+        {
+            LOG_ERROR("%s was saved by a newer version of the engine.", file_path.c_str());
+            m_state = Ticking;
+            ProgressReport::Get().SetIsLoading(g_progress_world, false);
+            return false;
+        }
 
 		ProgressReport::Get().SetJobCount(g_progress_world, root_entity_count);
 
@@ -268,9 +386,16 @@ namespace Spartan
 
     shared_ptr<Entity>& World::EntityCreate(bool is_active /*= true*/)
     {
-        auto& entity = m_entities.emplace_back(make_shared<Entity>(m_context));
+        // Set up before locking, activation can fire events which end up in MakeDirty()
+        auto entity = make_shared<Entity>(m_context);
         entity->SetActive(is_active);
-        return entity;
+
+        lock_guard<mutex> lock(m_mutex_entities_changed);
+        auto& entity_added = m_entities.emplace_back(entity);
+        _EntityIndexAdd(static_cast<uint32_t>(m_entities.size() - 1));
+        m_delta.added.emplace_back(entity);
+        m_is_dirty = true;
+        return entity_added;
     }
 
     shared_ptr<Entity>& World::EntityAdd(const shared_ptr<Entity>& entity)
@@ -280,7 +405,12 @@ namespace Spartan
 		if (!entity)
 			return empty;
 
-		return m_entities.emplace_back(entity);
+        lock_guard<mutex> lock(m_mutex_entities_changed);
+        auto& entity_added = m_entities.emplace_back(entity);
+        _EntityIndexAdd(static_cast<uint32_t>(m_entities.size() - 1));
+        m_delta.added.emplace_back(entity);
+        m_is_dirty = true;
+		return entity_added;
 	}
 
 	bool World::EntityExists(const shared_ptr<Entity>& entity)
@@ -288,20 +418,38 @@ namespace Spartan
 		if (!entity)
 			return false;
 
-		return EntityGetById(entity->GetId()) != nullptr;
+		return _EntityIndexGet(entity.get()) != -1;
 	}
 
 	void World::EntityRemove(const shared_ptr<Entity>& entity)
 	{
-		if (!entity)
+		if (!entity || entity->IsPendingDestruction())
 			return;
 
         // Mark for destruction but don't delete now
 	    // as the Renderer might still be using it.
         entity->MarkForDestruction();
+        m_entities_pending_destruction.emplace_back(entity);
         m_is_dirty = true;
 	}
 
+    void World::MakeDirty(Entity* entity /*= nullptr*/)
+    {
+        lock_guard<mutex> lock(m_mutex_entities_changed);
+
+        m_is_dirty = true;
+
+        // Without knowing which entity changed, everything has to be resolved
+        if (entity)
+        {
+            m_entities_changed.emplace_back(entity);
+        }
+        else
+        {
+            m_delta.full = true;
+        }
+    }
+
 	vector<shared_ptr<Entity>> World::EntityGetRoots()
 	{
 		vector<shared_ptr<Entity>> root_entities;
@@ -318,11 +466,12 @@ namespace Spartan
 
 	const shared_ptr<Entity>& World::EntityGetByName(const string& name)
 	{
-		for (const auto& entity : m_entities)
-		{
-			if (entity->GetName() == name)
-				return entity;
-		}
+        const auto range = m_entity_ids_by_name.equal_range(name);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (const auto& entity = EntityGetById(it->second))
+                return entity;
+        }
 
         static shared_ptr<Entity> empty;
 		return empty;
@@ -330,11 +479,9 @@ namespace Spartan
 
 	const shared_ptr<Entity>& World::EntityGetById(const uint32_t id)
 	{
-		for (const auto& entity : m_entities)
-		{
-			if (entity->GetId() == id)
-				return entity;
-		}
+        const auto it = m_entity_index_by_id.find(id);
+        if (it != m_entity_index_by_id.end())
+            return m_entities[it->second];
 
         static shared_ptr<Entity> empty;
 		return empty;
@@ -353,17 +500,48 @@ namespace Spartan
         // Keep a reference to it's parent (in case it has one)
         auto parent = entity->GetTransform()->GetParent();
 
-        // Remove this entity
-        for (auto it = m_entities.begin(); it < m_entities.end();)
+        // Remove this entity (swap with the last one and pop, so removal is O(1))
+        unique_lock<mutex> lock(m_mutex_entities_changed);
+        const int64_t index = _EntityIndexGet(entity.get());
+        if (index != -1)
         {
-            const auto temp = *it;
-            if (temp->GetId() == entity->GetId())
+            const uint32_t index_removed    = static_cast<uint32_t>(index);
+            const uint32_t index_last       = static_cast<uint32_t>(m_entities.size() - 1);
+
+            // Drop the lookup entries of the removed entity
+            m_entity_index_by_id.erase(entity->GetId());
+            const auto range = m_entity_ids_by_name.equal_range(entity->GetName());
+            for (auto it = range.first; it != range.second; ++it)
             {
-                it = m_entities.erase(it);
-                break;
+                if (it->second == entity->GetId())
+                {
+                    m_entity_ids_by_name.erase(it);
+                    break;
+                }
             }
-            ++it;
+
+            // Move the last entity into the freed slot
+            if (index_removed != index_last)
+            {
+                m_entities[index_removed] = move(m_entities[index_last]);
+                m_entity_index_by_id[m_entities[index_removed]->GetId()] = index_removed;
+            }
+
+            m_entities.pop_back();
+
+            // Update the delta, an entity which was added since the last resolve was never published
+            const auto it_added = find(m_delta.added.begin(), m_delta.added.end(), entity);
+            if (it_added != m_delta.added.end())
+            {
+                m_delta.added.erase(it_added);
+            }
+            else
+            {
+                m_delta.removed.emplace_back(entity);
+            }
+            m_entities_changed.erase(remove(m_entities_changed.begin(), m_entities_changed.end(), entity.get()), m_entities_changed.end());
         }
+        lock.unlock();
 
         // If there was a parent, update it
         if (parent)
@@ -372,6 +550,72 @@ namespace Spartan
         }
     }
 
+    // The caller holds m_mutex_entities_changed
+    void World::_EntityIndexAdd(const uint32_t index)
+    {
+        const auto& entity = m_entities[index];
+        m_entity_index_by_id[entity->GetId()] = index;
+        m_entity_ids_by_name.emplace(entity->GetName(), entity->GetId());
+    }
+
+    // Returns the index of an entity in m_entities, or -1 if the entity doesn't belong to the world
+    int64_t World::_EntityIndexGet(const Entity* entity) const
+    {
+        if (!entity)
+            return -1;
+
+        const auto it = m_entity_index_by_id.find(entity->GetId());
+        if (it == m_entity_index_by_id.end() || m_entities[it->second].get() != entity)
+            return -1;
+
+        return static_cast<int64_t>(it->second);
+    }
+
+    void World::_EntityOnIdChanged(const Entity* entity, const uint32_t id_old)
+    {
+        lock_guard<mutex> lock(m_mutex_entities_changed);
+
+        // Only entities which are part of the world are indexed
+        const auto it = m_entity_index_by_id.find(id_old);
+        if (it == m_entity_index_by_id.end() || m_entities[it->second].get() != entity)
+            return;
+
+        const uint32_t index = it->second;
+        m_entity_index_by_id.erase(it);
+        m_entity_index_by_id[entity->GetId()] = index;
+
+        const auto range = m_entity_ids_by_name.equal_range(entity->GetName());
+        for (auto it_name = range.first; it_name != range.second; ++it_name)
+        {
+            if (it_name->second == id_old)
+            {
+                it_name->second = entity->GetId();
+                break;
+            }
+        }
+    }
+
+    void World::_EntityOnNameChanged(const Entity* entity, const string& name_old)
+    {
+        lock_guard<mutex> lock(m_mutex_entities_changed);
+
+        // Only entities which are part of the world are indexed
+        if (_EntityIndexGet(entity) == -1)
+            return;
+
+        const auto range = m_entity_ids_by_name.equal_range(name_old);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == entity->GetId())
+            {
+                m_entity_ids_by_name.erase(it);
+                break;
+            }
+        }
+
+        m_entity_ids_by_name.emplace(entity->GetName(), entity->GetId());
+    }
+
 	shared_ptr<Entity>& World::CreateEnvironment()
 	{
 		auto& environment = EntityCreate();
@@ -408,4 +652,132 @@ namespace Spartan
 
 		return light;
 	}
+
+    bool World::RayTraceClosest(const Ray& ray, RayHit* hit /*= nullptr*/)
+    {
+        lock_guard<mutex> lock(m_mutex_ray_bvh);
+        RayBvhUpdate();
+
+        uint32_t entity_hit     = 0;
+        uint32_t triangle_hit   = 0;
+        Vector2 barycentrics_hit;
+        const float distance = m_ray_bvh.Trace(ray, ray.GetLength(), false, [&](const uint32_t entity_index, const float distance_max)
+        {
+            uint32_t triangle = 0;
+            Vector2 barycentrics;
+            const float entity_distance = m_ray_bvh_entities[entity_index]->GetRenderable()->GeometryRayTrace(ray, false, &triangle, &barycentrics);
+            if (entity_distance > distance_max)
+                return INFINITY;
+
+            entity_hit          = entity_index;
+            triangle_hit        = triangle;
+            barycentrics_hit    = barycentrics;
+            return entity_distance;
+        });
+
+        if (distance == INFINITY)
+            return false;
+
+        if (hit)
+        {
+            *hit = RayHit(m_ray_bvh_entities[entity_hit], ray.GetStart() + ray.GetDirection() * distance, distance, false, triangle_hit, barycentrics_hit);
+        }
+
+        return true;
+    }
+
+    bool World::RayTraceAny(const Ray& ray)
+    {
+        lock_guard<mutex> lock(m_mutex_ray_bvh);
+        RayBvhUpdate();
+
+        return m_ray_bvh.Trace(ray, ray.GetLength(), true, [this, &ray](const uint32_t entity_index, float)
+        {
+            return m_ray_bvh_entities[entity_index]->GetRenderable()->GeometryRayTrace(ray, true);
+        }) != INFINITY;
+    }
+
+    vector<RayHit> World::RayTraceAll(const Ray& ray)
+    {
+        lock_guard<mutex> lock(m_mutex_ray_bvh);
+        RayBvhUpdate();
+
+        // Collect every hit, reporting none to the bvh so that it doesn't cull anything
+        vector<RayHit> hits;
+        m_ray_bvh.Trace(ray, ray.GetLength(), false, [this, &ray, &hits](const uint32_t entity_index, float)
+        {
+            uint32_t triangle = 0;
+            Vector2 barycentrics;
+            const float distance = m_ray_bvh_entities[entity_index]->GetRenderable()->GeometryRayTrace(ray, false, &triangle, &barycentrics);
+            if (distance != INFINITY)
+            {
+                hits.emplace_back(m_ray_bvh_entities[entity_index], ray.GetStart() + ray.GetDirection() * distance, distance, false, triangle, barycentrics);
+            }
+
+            return INFINITY;
+        });
+
+        sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b) { return a.m_distance < b.m_distance; });
+
+        return hits;
+    }
+
+    void World::RayBvhInvalidate()
+    {
+        lock_guard<mutex> lock(m_mutex_ray_bvh);
+
+        // Don't keep removed entities alive until the next query
+        m_ray_bvh_entities.clear();
+        m_ray_bvh_dirty = true;
+    }
+
+    void World::RayBvhRefit()
+    {
+        lock_guard<mutex> lock(m_mutex_ray_bvh);
+        m_ray_bvh_refit = true;
+    }
+
+    void World::RayBvhUpdate()
+    {
+        // Same entities, only their bounds may have changed
+        if (!m_ray_bvh_dirty)
+        {
+            if (m_ray_bvh_refit)
+            {
+                vector<BoundingBox> bounds;
+                bounds.reserve(m_ray_bvh_entities.size());
+                for (const shared_ptr<Entity>& entity : m_ray_bvh_entities)
+                {
+                    Renderable* renderable = entity->GetRenderable();
+                    bounds.emplace_back(renderable ? renderable->GetAabb() : BoundingBox());
+                }
+
+                m_ray_bvh.Refit(bounds);
+                m_ray_bvh_refit = false;
+            }
+
+            return;
+        }
+
+        vector<BoundingBox> bounds;
+        bounds.reserve(m_entities.size());
+        m_ray_bvh_entities.clear();
+        for (const shared_ptr<Entity>& entity : m_entities)
+        {
+            Renderable* renderable = entity->GetRenderable();
+            if (!renderable || !entity->IsActive())
+                continue;
+
+            const BoundingBox& aabb = renderable->GetAabb();
+            if (!aabb.Defined())
+                continue;
+
+            m_ray_bvh_entities.emplace_back(entity);
+            bounds.emplace_back(aabb);
+        }
+
+        m_ray_bvh.Build(bounds);
+        m_ray_bvh_dirty = false;
+        m_ray_bvh_refit = false;
+    }
 }
@@ -25,8 +25,15 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 #include "../Core/EngineDefs.h"
 #include "../Core/ISubsystem.h"
+#include "../Math/Bvh.h"
+#include "../Math/RayHit.h"
 //=============================
 
 namespace Spartan
@@ -36,6 +43,14 @@ namespace Spartan
 	class Input;
 	class Profiler;
 
+    // World file versions, components check the stream's version before reading data that older files don't have
+    enum World_Version : uint32_t
+    {
+        World_Version_Unversioned   = 0, // files which lead with the root entity count
+        World_Version_Lods          = 1, // renderables store their levels of detail
+        World_Version_Latest        = World_Version_Lods
+    };
+
 	enum Scene_State
 	{
 		Ticking,
@@ -44,8 +59,27 @@ namespace Spartan
 		Loading
 	};
 
+    // What changed in the world since the last resolve, it's passed along with Event_World_Resolve_Complete.
+    // It's only valid while the event is being fired, so subscribers must use immediate delivery.
+    struct WorldDelta
+    {
+        std::vector<std::shared_ptr<Entity>> added;     // Entities which were created or added
+        std::vector<std::shared_ptr<Entity>> removed;   // Entities which were removed (kept alive until the event returns)
+        std::vector<std::shared_ptr<Entity>> changed;   // Entities which had components added/removed or were (de)activated
+        bool full = false;                              // Subscribers should discard their state and treat everything as added
+
+        void Clear()
+        {
+            added.clear();
+            removed.clear();
+            changed.clear();
+            full = false;
+        }
+    };
+
 	class SPARTAN_CLASS World : public ISubsystem
 	{
+        friend class Entity;
 	public:
 		World(Context* context);
 		~World();
@@ -59,7 +93,7 @@ namespace Spartan
 		bool SaveToFile(const std::string& filePath);
 		bool LoadFromFile(const std::string& file_path);
 		const auto& GetName() const { return m_name; }
-        void MakeDirty() { m_is_dirty = true; }
+        void MakeDirty(Entity* entity = nullptr);
 
 		//= Entities ===========================================================================
 		std::shared_ptr<Entity>& EntityCreate(bool is_active = true);
@@ -73,9 +107,29 @@ namespace Spartan
 		auto EntityGetCount() const         { return static_cast<uint32_t>(m_entities.size()); }
 		//======================================================================================
 
+		//= RAY QUERIES ===================================================================================
+		// Two levels, a bvh over the bounding boxes of active renderables, then the triangles of their models
+		bool RayTraceClosest(const Math::Ray& ray, Math::RayHit* hit = nullptr);
+		bool RayTraceAny(const Math::Ray& ray);
+		std::vector<Math::RayHit> RayTraceAll(const Math::Ray& ray); // closest hit of each renderable, sorted by distance
+		//=================================================================================================
+
 	private:
         void _EntityRemove(const std::shared_ptr<Entity>& entity);
 
+        //= LOOKUP ====================================================================
+        void _EntityIndexAdd(uint32_t index);
+        int64_t _EntityIndexGet(const Entity* entity) const;
+        void _EntityOnIdChanged(const Entity* entity, uint32_t id_old);
+        void _EntityOnNameChanged(const Entity* entity, const std::string& name_old);
+        //=============================================================================
+
+        //= RAY QUERIES ==========
+        void RayBvhInvalidate();
+        void RayBvhRefit();
+        void RayBvhUpdate();
+        //========================
+
 		//= COMMON ENTITY CREATION ========================
 		std::shared_ptr<Entity>& CreateEnvironment();
 		std::shared_ptr<Entity> CreateCamera();
@@ -84,11 +138,31 @@ namespace Spartan
 
         std::string m_name;
         bool m_was_in_editor_mode   = false;
-        bool m_is_dirty             = true;
-        Scene_State m_state         = Ticking;	
+        std::atomic<bool> m_is_dirty = true;
+        std::atomic<Scene_State> m_state = Ticking;
+        std::mutex m_mutex_state;
+        std::condition_variable m_condition_state;
+        std::thread::id m_thread_id_tick;	
         Input* m_input              = nullptr;
         Profiler* m_profiler        = nullptr;
 
         std::vector<std::shared_ptr<Entity>> m_entities;
+
+        // Lookup tables, kept in sync with m_entities on create, remove, id change and rename
+        std::unordered_map<uint32_t, uint32_t> m_entity_index_by_id;            // id -> index into m_entities
+        std::unordered_multimap<std::string, uint32_t> m_entity_ids_by_name;    // name -> id
+
+        // Incremental resolve
+        WorldDelta m_delta;
+        std::vector<Entity*> m_entities_changed;
+        std::mutex m_mutex_entities_changed; // guards m_entities growth, the lookup tables, m_delta and m_entities_changed, entities can be created and modified by worker threads (e.g. the model importer)
+        std::vector<std::shared_ptr<Entity>> m_entities_pending_destruction;
+
+        // Ray queries, the first query after entities were added, removed or changed rebuilds the bvh, after they moved it refits it
+        Math::Bvh m_ray_bvh;
+        std::vector<std::shared_ptr<Entity>> m_ray_bvh_entities;
+        bool m_ray_bvh_dirty = true;
+        bool m_ray_bvh_refit = false;
+        std::mutex m_mutex_ray_bvh;
 	};
 }